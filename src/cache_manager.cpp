@@ -1,4 +1,5 @@
 #include "cache_manager.hpp"
+#include "probes.hpp"
 #include <algorithm>
 #include <stdexcept>
 
@@ -6,11 +7,13 @@ namespace valkyrie {
 
 CacheManager::CacheManager(size_t max_size_bytes)
     : max_size_(max_size_bytes)
-    , current_size_(0) {
+    , current_size_(0)
+    , unread_prefetch_size_(0) {
 }
 
 void CacheManager::insert_chunk(const std::string& s3_key, size_t offset,
-                                 const std::vector<char>& data, CacheZone zone) {
+                                 const std::vector<char>& data, CacheZone zone,
+                                 std::optional<PredictionSource> prefetched_by) {
     evict_if_needed(data.size());
 
     std::unique_lock<std::shared_mutex> lock(cache_mutex_);
@@ -19,6 +22,7 @@ void CacheManager::insert_chunk(const std::string& s3_key, size_t offset,
     auto& file_ptr = files_[s3_key];
     if (!file_ptr) {
         file_ptr = std::make_shared<FileEntry>(s3_key, zone);
+        num_files_++;
 
         // Track in appropriate zone
         if (zone == CacheZone::HOT) {
@@ -28,10 +32,33 @@ void CacheManager::insert_chunk(const std::string& s3_key, size_t offset,
         }
     }
 
-    // Insert chunk
+    // Insert chunk (replacing a duplicate download frees the old copy). A
+    // record-sized chunk never replaces a longer one at the same offset.
     {
         std::unique_lock<std::shared_mutex> file_lock(file_ptr->mutex);
-        file_ptr->chunks[offset] = Chunk(data);
+        auto existing = file_ptr->chunks.find(offset);
+        if (existing != file_ptr->chunks.end()) {
+            const Chunk& old = existing->second;
+            if (old.data.size() > data.size()) {
+                return;
+            }
+            if (old.prefetched_by.has_value() && !old.read) {
+                outcomes_.source(*old.prefetched_by).wasted.add(old.data.size());
+                unread_prefetch_size_ -= old.data.size();
+            }
+            current_size_ -= old.data.size();
+            zone_size(file_ptr->zone) -= old.data.size();
+        } else {
+            num_chunks_++;
+        }
+
+        file_ptr->chunks[offset] = Chunk(data, prefetched_by);
+        zone_size(file_ptr->zone) += data.size();
+    }
+
+    if (prefetched_by.has_value()) {
+        outcomes_.source(*prefetched_by).inserted.add(data.size());
+        unread_prefetch_size_ += data.size();
     }
 
     current_size_ += data.size();
@@ -54,6 +81,52 @@ std::optional<Chunk> CacheManager::get_chunk(const std::string& s3_key, size_t o
     return chunk_it->second;
 }
 
+std::optional<std::pair<size_t, Chunk>> CacheManager::get_chunk_containing(
+        const std::string& s3_key, size_t offset) {
+    std::shared_lock<std::shared_mutex> lock(cache_mutex_);
+
+    auto it = files_.find(s3_key);
+    if (it == files_.end()) {
+        return std::nullopt;
+    }
+
+    std::shared_lock<std::shared_mutex> file_lock(it->second->mutex);
+    auto chunk_it = find_covering(*it->second, offset, 1);
+    if (chunk_it == it->second->chunks.end()) {
+        return std::nullopt;
+    }
+    return std::make_pair(chunk_it->first, chunk_it->second);
+}
+
+bool CacheManager::contains_range(const std::string& s3_key, size_t offset, size_t length) const {
+    std::shared_lock<std::shared_mutex> lock(cache_mutex_);
+
+    auto it = files_.find(s3_key);
+    if (it == files_.end()) return false;
+
+    std::shared_lock<std::shared_mutex> file_lock(it->second->mutex);
+    return find_covering(*it->second, offset, length) != it->second->chunks.end();
+}
+
+std::map<size_t, Chunk>::const_iterator CacheManager::find_covering(
+        const FileEntry& entry, size_t offset, size_t length) const {
+    const auto& chunks = entry.chunks;
+    auto covers = [&](std::map<size_t, Chunk>::const_iterator c) {
+        return c != chunks.end() && c->first <= offset &&
+               offset + length <= c->first + c->second.data.size();
+    };
+
+    // Nearest chunk starting at or before offset (a record-aligned chunk)...
+    auto chunk_it = chunks.upper_bound(offset);
+    if (chunk_it != chunks.begin() && covers(std::prev(chunk_it))) {
+        return std::prev(chunk_it);
+    }
+
+    // ...or the fixed-size chunk it falls in, which may start further back
+    auto aligned = chunks.find(offset / DEFAULT_CHUNK_SIZE * DEFAULT_CHUNK_SIZE);
+    return covers(aligned) ? aligned : chunks.end();
+}
+
 void CacheManager::access(const std::string& s3_key, size_t offset) {
     std::unique_lock<std::shared_mutex> lock(cache_mutex_);
 
@@ -67,7 +140,17 @@ void CacheManager::access(const std::string& s3_key, size_t offset) {
         std::unique_lock<std::shared_mutex> file_lock(file->mutex);
         auto chunk_it = file->chunks.find(offset);
         if (chunk_it != file->chunks.end()) {
-            chunk_it->second.update_access_time();
+            Chunk& chunk = chunk_it->second;
+            chunk.update_access_time();
+
+            // First read of a prefetched chunk: it paid off
+            if (chunk.prefetched_by.has_value() && !chunk.read) {
+                auto& outcome = outcomes_.source(*chunk.prefetched_by);
+                outcome.useful.add(chunk.data.size());
+                outcome.lead_time_us.record(chunk.last_access_time - chunk.insert_time);
+                unread_prefetch_size_ -= chunk.data.size();
+            }
+            chunk.read = true;
         }
     }
 
@@ -75,6 +158,10 @@ void CacheManager::access(const std::string& s3_key, size_t offset) {
     if (file->zone == CacheZone::PREFETCH) {
         file->zone = CacheZone::HOT;
 
+        size_t file_size = calculate_file_size(*file);
+        prefetch_zone_size_ -= file_size;
+        hot_zone_size_ += file_size;
+
         // Move from prefetch_fifo to hot_lru
         auto fifo_it = std::find(prefetch_fifo_.begin(), prefetch_fifo_.end(), s3_key);
         if (fifo_it != prefetch_fifo_.end()) {
@@ -84,11 +171,25 @@ void CacheManager::access(const std::string& s3_key, size_t offset) {
     }
 }
 
+void CacheManager::record_late_prefetch(PredictionSource source, size_t bytes) {
+    outcomes_.source(source).late.add(bytes);
+}
+
 bool CacheManager::contains(const std::string& s3_key) const {
     std::shared_lock<std::shared_mutex> lock(cache_mutex_);
     return files_.find(s3_key) != files_.end();
 }
 
+bool CacheManager::contains_chunk(const std::string& s3_key, size_t offset) const {
+    std::shared_lock<std::shared_mutex> lock(cache_mutex_);
+
+    auto it = files_.find(s3_key);
+    if (it == files_.end()) return false;
+
+    std::shared_lock<std::shared_mutex> file_lock(it->second->mutex);
+    return it->second->chunks.count(offset) > 0;
+}
+
 CacheZone CacheManager::get_zone(const std::string& s3_key) const {
     std::shared_lock<std::shared_mutex> lock(cache_mutex_);
 
@@ -104,12 +205,83 @@ void CacheManager::promote_to_hot(const std::string& s3_key) {
     access(s3_key, 0);  // Use access logic for promotion
 }
 
+bool CacheManager::evict(const std::string& s3_key) {
+    std::unique_lock<std::shared_mutex> lock(cache_mutex_);
+    if (files_.find(s3_key) == files_.end()) return false;
+    erase_file(s3_key);
+    return true;
+}
+
+size_t CacheManager::drop_unpinned() {
+    std::unique_lock<std::shared_mutex> lock(cache_mutex_);
+
+    std::vector<std::string> victims;
+    for (const auto& [key, file] : files_) {
+        if (!pinned_.count(key)) victims.push_back(key);
+    }
+    for (const auto& key : victims) {
+        erase_file(key);
+    }
+    return victims.size();
+}
+
+bool CacheManager::pin(const std::string& s3_key, size_t bytes) {
+    std::unique_lock<std::shared_mutex> lock(cache_mutex_);
+
+    // Pinning a pinned file again replaces its reservation
+    auto it = pinned_.find(s3_key);
+    size_t reserved = pinned_bytes_ - (it != pinned_.end() ? it->second : 0) + bytes;
+    if (reserved > static_cast<size_t>(max_size_ * MAX_PINNED_FRACTION)) {
+        return false;
+    }
+
+    pinned_[s3_key] = bytes;
+    pinned_bytes_ = reserved;
+    return true;
+}
+
+bool CacheManager::unpin(const std::string& s3_key) {
+    std::unique_lock<std::shared_mutex> lock(cache_mutex_);
+    auto it = pinned_.find(s3_key);
+    if (it == pinned_.end()) return false;
+    pinned_bytes_ -= it->second;
+    pinned_.erase(it);
+    return true;
+}
+
+bool CacheManager::is_pinned(const std::string& s3_key) const {
+    std::shared_lock<std::shared_mutex> lock(cache_mutex_);
+    return pinned_.count(s3_key) > 0;
+}
+
+size_t CacheManager::get_num_pinned() const {
+    std::shared_lock<std::shared_mutex> lock(cache_mutex_);
+    return pinned_.size();
+}
+
+std::vector<CacheManager::FileResidency> CacheManager::get_residency() const {
+    std::shared_lock<std::shared_mutex> lock(cache_mutex_);
+
+    std::vector<FileResidency> files;
+    files.reserve(files_.size());
+    for (const auto& [key, file] : files_) {
+        std::shared_lock<std::shared_mutex> file_lock(file->mutex);
+        files.push_back({key, file->zone, calculate_file_size(*file), file->chunks.size(),
+                         pinned_.count(key) > 0});
+    }
+
+    std::sort(files.begin(), files.end(),
+              [](const FileResidency& a, const FileResidency& b) { return a.s3_key < b.s3_key; });
+    return files;
+}
+
 CacheManager::Stats CacheManager::get_stats() const {
     std::shared_lock<std::shared_mutex> lock(cache_mutex_);
 
     Stats stats;
     stats.current_size = current_size_;
     stats.max_size = max_size_;
+    stats.unread_prefetch_size = unread_prefetch_size_;
     stats.num_files = files_.size();
 
     size_t hot_size = 0, prefetch_size = 0, num_chunks = 0;
@@ -138,24 +310,20 @@ void CacheManager::evict_if_needed(size_t required_space) {
 
     while (current_size_ + required_space > max_size_) {
         // Try evicting from prefetch first (less important)
-        if (!prefetch_fifo_.empty()) {
-            evict_fifo_prefetch();
-        } else if (!hot_lru_.empty()) {
-            evict_lru_hot();
-        } else {
-            break;  // Cache empty, can't evict more
-        }
+        if (evict_fifo_prefetch()) continue;
+        if (evict_lru_hot()) continue;
+        break;  // Cache empty (or all pinned, bounded by pin()), can't evict more
     }
 }
 
-void CacheManager::evict_lru_hot() {
-    if (hot_lru_.empty()) return;
-
+bool CacheManager::evict_lru_hot() {
     // Find LRU (oldest access time)
     std::string lru_key;
     uint64_t oldest_time = UINT64_MAX;
 
     for (const auto& key : hot_lru_) {
+        if (pinned_.count(key)) continue;
+
         auto it = files_.find(key);
         if (it == files_.end()) continue;
 
@@ -168,33 +336,58 @@ void CacheManager::evict_lru_hot() {
         }
     }
 
-    if (!lru_key.empty()) {
-        auto it = files_.find(lru_key);
-        if (it != files_.end()) {
-            size_t freed = calculate_file_size(*it->second);
-            files_.erase(it);
-            current_size_ -= freed;
+    if (lru_key.empty()) return false;
+    erase_file(lru_key);
+    return true;
+}
 
-            auto lru_it = std::find(hot_lru_.begin(), hot_lru_.end(), lru_key);
-            if (lru_it != hot_lru_.end()) {
-                hot_lru_.erase(lru_it);
-            }
+bool CacheManager::evict_fifo_prefetch() {
+    // Evict first (oldest) unpinned entry
+    for (const auto& key : prefetch_fifo_) {
+        if (!pinned_.count(key)) {
+            erase_file(std::string(key));  // erase_file() removes `key` from the FIFO
+            return true;
         }
     }
+    return false;
 }
 
-void CacheManager::evict_fifo_prefetch() {
-    if (prefetch_fifo_.empty()) return;
-
-    // Evict first (oldest) entry
-    std::string key = prefetch_fifo_.front();
-    prefetch_fifo_.erase(prefetch_fifo_.begin());
-
-    auto it = files_.find(key);
+void CacheManager::erase_file(const std::string& s3_key) {
+    auto it = files_.find(s3_key);
     if (it != files_.end()) {
-        size_t freed = calculate_file_size(*it->second);
+        account_evicted(*it->second);
+        size_t file_size = calculate_file_size(*it->second);
+        current_size_ -= file_size;
+        zone_size(it->second->zone) -= file_size;
         files_.erase(it);
-        current_size_ -= freed;
+    }
+
+    auto lru_it = std::find(hot_lru_.begin(), hot_lru_.end(), s3_key);
+    if (lru_it != hot_lru_.end()) {
+        hot_lru_.erase(lru_it);
+    }
+    auto fifo_it = std::find(prefetch_fifo_.begin(), prefetch_fifo_.end(), s3_key);
+    if (fifo_it != prefetch_fifo_.end()) {
+        prefetch_fifo_.erase(fifo_it);
+    }
+}
+
+void CacheManager::account_evicted(const FileEntry& entry) {
+    std::shared_lock<std::shared_mutex> file_lock(entry.mutex);
+    for (const auto& [offset, chunk] : entry.chunks) {
+        if (chunk.prefetched_by.has_value() && !chunk.read) {
+            outcomes_.source(*chunk.prefetched_by).wasted.add(chunk.data.size());
+            unread_prefetch_size_ -= chunk.data.size();
+        }
+    }
+
+    num_chunks_ -= entry.chunks.size();
+    num_files_--;
+
+    VALKYRIE_PROBE2(cache__evict, entry.s3_key.c_str(), calculate_file_size(entry));
+
+    if (tracer_) {
+        tracer_->record(TraceEventType::EVICT, entry.s3_key, 0, calculate_file_size(entry));
     }
 }
 
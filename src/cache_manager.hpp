@@ -1,6 +1,9 @@
 #pragma once
 
 #include "types.hpp"
+#include "histogram.hpp"
+#include "sharded_counter.hpp"
+#include "tracer.hpp"
 #include <string>
 #include <vector>
 #include <map>
@@ -10,6 +13,7 @@
 #include <chrono>
 #include <memory>
 #include <future>
+#include <atomic>
 
 namespace valkyrie {
 
@@ -19,11 +23,19 @@ struct Chunk {
     std::shared_future<void> ready_future;  // For async loading
     uint64_t last_access_time;  // Microseconds since epoch
 
-    Chunk() : last_access_time(0) {}
+    // Prefetch accounting: set when a predictor fetched the chunk
+    uint64_t insert_time;
+    std::optional<PredictionSource> prefetched_by;
+    bool read;  // Reader has touched it since insertion
 
-    Chunk(std::vector<char> d)
+    Chunk() : last_access_time(0), insert_time(0), read(false) {}
+
+    Chunk(std::vector<char> d, std::optional<PredictionSource> source = std::nullopt)
         : data(std::move(d))
-        , last_access_time(get_current_time()) {}
+        , last_access_time(get_current_time())
+        , insert_time(last_access_time)
+        , prefetched_by(source)
+        , read(false) {}
 
     static uint64_t get_current_time() {
         return std::chrono::duration_cast<std::chrono::microseconds>(
@@ -48,36 +60,129 @@ struct FileEntry {
         : s3_key(key), total_size(0), zone(z) {}
 };
 
+// What became of prefetched chunks, per prediction source
+struct PrefetchOutcomes {
+    struct Counter {
+        ShardedCounter count;
+        ShardedCounter bytes;
+
+        void add(uint64_t n_bytes) {
+            count.add(1);
+            bytes.add(n_bytes);
+        }
+    };
+
+    struct PerSource {
+        Counter inserted;   // Prefetched chunks that landed in the cache
+        Counter useful;     // Read at least once before eviction
+        Counter wasted;     // Evicted without ever being read
+        Counter late;       // Reader needed it while the prefetch was still in flight
+        LogLinearHistogram lead_time_us;  // Landed -> first read (timeliness)
+    };
+
+    PerSource sources[NUM_PREDICTION_SOURCES];
+
+    PerSource& source(PredictionSource src) { return sources[static_cast<size_t>(src)]; }
+    const PerSource& source(PredictionSource src) const {
+        return sources[static_cast<size_t>(src)];
+    }
+};
+
 // Main cache manager with two-tier architecture
 class CacheManager {
 public:
     explicit CacheManager(size_t max_size_bytes);
 
-    // Insert chunk into cache
+    // Insert chunk into cache. prefetched_by tags chunks fetched ahead of the
+    // reader so their outcome (useful/wasted) can be accounted.
     void insert_chunk(const std::string& s3_key, size_t offset,
-                      const std::vector<char>& data, CacheZone zone);
+                      const std::vector<char>& data, CacheZone zone,
+                      std::optional<PredictionSource> prefetched_by = std::nullopt);
 
     // Get chunk if exists
     std::optional<Chunk> get_chunk(const std::string& s3_key, size_t offset);
 
-    // Access chunk (updates LRU, may promote zone)
+    // Chunk whose bytes cover `offset`, with its start offset. Record-aligned
+    // chunks start anywhere, so they are not found by get_chunk().
+    std::optional<std::pair<size_t, Chunk>> get_chunk_containing(const std::string& s3_key,
+                                                                 size_t offset);
+
+    // True if one cached chunk covers [offset, offset + length)
+    bool contains_range(const std::string& s3_key, size_t offset, size_t length) const;
+
+    // Access chunk (updates LRU, may promote zone, marks prefetches useful)
     void access(const std::string& s3_key, size_t offset);
 
+    // Record that a reader had to wait for a prefetch that was still in flight
+    void record_late_prefetch(PredictionSource source, size_t bytes);
+
+    const PrefetchOutcomes& get_prefetch_outcomes() const { return outcomes_; }
+
+    // Bytes of prefetched chunks that no reader has touched yet
+    size_t get_unread_prefetch_bytes() const {
+        return unread_prefetch_size_.load(std::memory_order_relaxed);
+    }
+
+    size_t get_max_size() const { return max_size_; }
+
+    // Lock-free gauges (metrics scrapes must not contend with the data path)
+    size_t get_size() const { return current_size_.load(std::memory_order_relaxed); }
+    size_t get_num_files() const { return num_files_.load(std::memory_order_relaxed); }
+    size_t get_num_chunks() const { return num_chunks_.load(std::memory_order_relaxed); }
+    size_t get_hot_zone_size() const { return hot_zone_size_.load(std::memory_order_relaxed); }
+    size_t get_prefetch_zone_size() const {
+        return prefetch_zone_size_.load(std::memory_order_relaxed);
+    }
+
+    // Record evictions to `tracer` (nullptr disables). Call before use.
+    void set_tracer(Tracer* tracer) { tracer_ = tracer; }
+
     // Check if file exists in cache
     bool contains(const std::string& s3_key) const;
 
+    // Check if a specific chunk is cached (no copy)
+    bool contains_chunk(const std::string& s3_key, size_t offset) const;
+
     // Get file's zone
     CacheZone get_zone(const std::string& s3_key) const;
 
     // Promote from PREFETCH to HOT
     void promote_to_hot(const std::string& s3_key);
 
+    // Drop one file (pinned or not); false if it was not cached
+    bool evict(const std::string& s3_key);
+
+    // Drop every unpinned file; returns the number of files dropped
+    size_t drop_unpinned();
+
+    // Pinned files are never evicted to make room. A pin reserves the file's
+    // size and is refused (false) if all reservations would exceed
+    // MAX_PINNED_FRACTION of the capacity, so eviction of unpinned files can
+    // always keep the cache within it. Pins outlive the file's chunks.
+    static constexpr double MAX_PINNED_FRACTION = 0.5;
+    bool pin(const std::string& s3_key, size_t bytes);
+    bool unpin(const std::string& s3_key);
+    bool is_pinned(const std::string& s3_key) const;
+    size_t get_num_pinned() const;
+    size_t get_pinned_bytes() const { return pinned_bytes_.load(std::memory_order_relaxed); }
+
+    // What is resident for one cached file
+    struct FileResidency {
+        std::string s3_key;
+        CacheZone zone;
+        size_t bytes;
+        size_t chunks;
+        bool pinned;
+    };
+    std::vector<FileResidency> get_residency() const;
+
     // Get cache statistics
     struct Stats {
         size_t current_size;
         size_t max_size;
         size_t hot_zone_size;
         size_t prefetch_zone_size;
+        size_t unread_prefetch_size;
         size_t num_files;
         size_t num_chunks;
     };
@@ -85,12 +190,32 @@ public:
 
 private:
     void evict_if_needed(size_t required_space);
-    void evict_lru_hot();
-    void evict_fifo_prefetch();
+
+    // Evict one unpinned file; false if none is left in that zone.
+    // Caller holds cache_mutex_ exclusively (also for erase_file()).
+    bool evict_lru_hot();
+    bool evict_fifo_prefetch();
+    void erase_file(const std::string& s3_key);
     size_t calculate_file_size(const FileEntry& entry) const;
 
+    // Chunk covering [offset, offset + length); caller holds entry.mutex
+    std::map<size_t, Chunk>::const_iterator find_covering(const FileEntry& entry,
+                                                          size_t offset, size_t length) const;
+    void account_evicted(const FileEntry& entry);
+
+    std::atomic<size_t>& zone_size(CacheZone zone) {
+        return zone == CacheZone::HOT ? hot_zone_size_ : prefetch_zone_size_;
+    }
+
     size_t max_size_;
-    size_t current_size_;
+
+    // Written under cache_mutex_; atomic so the gauges above can skip the lock
+    std::atomic<size_t> current_size_;
+    std::atomic<size_t> unread_prefetch_size_;
+    std::atomic<size_t> num_files_{0};
+    std::atomic<size_t> num_chunks_{0};
+    std::atomic<size_t> hot_zone_size_{0};
+    std::atomic<size_t> prefetch_zone_size_{0};
 
     // File storage: s3_key -> FileEntry
     std::unordered_map<std::string, std::shared_ptr<FileEntry>> files_;
@@ -101,6 +226,13 @@ private:
 
     // FIFO tracking for PREFETCH zone (insertion order)
     std::vector<std::string> prefetch_fifo_;
+
+    // Keys exempt from eviction -> bytes reserved for them (see pin())
+    std::unordered_map<std::string, size_t> pinned_;
+    std::atomic<size_t> pinned_bytes_{0};  // Written under cache_mutex_
+
+    PrefetchOutcomes outcomes_;
+    Tracer* tracer_ = nullptr;
 };
 
 }  // namespace valkyrie
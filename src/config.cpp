@@ -1,7 +1,11 @@
 #include "config.hpp"
+#include "inventory.hpp"
 #include <iostream>
+#include <cstdio>
 #include <cstring>
+#include <sstream>
 #include <stdexcept>
+#include <arpa/inet.h>
 
 namespace valkyrie {
 
@@ -76,6 +80,37 @@ bool Config::parse(int argc, char* argv[]) {
                 return false;
             }
         }
+        else if (arg == "--adaptive-lookahead") {
+            adaptive_lookahead = true;
+        }
+        else if (arg == "--prefetch-budget") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --prefetch-budget requires an argument\n";
+                return false;
+            }
+            try {
+                prefetch_budget = std::stod(argv[++i]);
+            } catch (const std::exception& e) {
+                std::cerr << "Error: Invalid value for --prefetch-budget\n";
+                return false;
+            }
+        }
+        else if (arg == "--parquet-columns") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --parquet-columns requires an argument\n";
+                return false;
+            }
+            std::istringstream columns(argv[++i]);
+            std::string column;
+            while (std::getline(columns, column, ',')) {
+                if (!column.empty()) {
+                    parquet_columns.push_back(column);
+                }
+            }
+        }
+        else if (arg == "--record-index") {
+            record_index = true;
+        }
         else if (arg == "--manifest") {
             if (i + 1 >= argc) {
                 std::cerr << "Error: --manifest requires an argument\n";
@@ -83,6 +118,57 @@ bool Config::parse(int argc, char* argv[]) {
             }
             manifest_path = argv[++i];
         }
+        else if (arg == "--access-history") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --access-history requires an argument\n";
+                return false;
+            }
+            access_history_path = argv[++i];
+        }
+        else if (arg == "--control-socket") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --control-socket requires an argument\n";
+                return false;
+            }
+            control_socket_path = argv[++i];
+        }
+        else if (arg == "--list-bucket") {
+            list_bucket = true;
+        }
+        else if (arg == "--metadata-snapshot") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --metadata-snapshot requires an argument\n";
+                return false;
+            }
+            metadata_snapshot = argv[++i];
+            list_bucket = true;  // The listing refreshes the snapshot
+        }
+        else if (arg == "--inventory") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --inventory requires an argument\n";
+                return false;
+            }
+            inventory_path = argv[++i];
+        }
+        else if (arg == "--inventory-schema") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --inventory-schema requires an argument\n";
+                return false;
+            }
+            inventory_schema = argv[++i];
+        }
+        else if (arg == "--dir-ttl") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --dir-ttl requires an argument\n";
+                return false;
+            }
+            try {
+                dir_ttl = std::stoi(argv[++i]);
+            } catch (const std::exception& e) {
+                std::cerr << "Error: Invalid value for --dir-ttl\n";
+                return false;
+            }
+        }
         else if (arg == "--metrics-port") {
             if (i + 1 >= argc) {
                 std::cerr << "Error: --metrics-port requires an argument\n";
@@ -95,6 +181,13 @@ bool Config::parse(int argc, char* argv[]) {
                 return false;
             }
         }
+        else if (arg == "--metrics-address") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --metrics-address requires an argument\n";
+                return false;
+            }
+            metrics_address = argv[++i];
+        }
         else if (arg == "--enable-tracing") {
             enable_tracing = true;
         }
@@ -105,6 +198,51 @@ bool Config::parse(int argc, char* argv[]) {
             }
             trace_output = argv[++i];
         }
+        else if (arg == "--log-level") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --log-level requires an argument\n";
+                return false;
+            }
+            auto level = Logger::parse_level(argv[++i]);
+            if (!level.has_value()) {
+                std::cerr << "Error: --log-level must be debug, info, warn or error\n";
+                return false;
+            }
+            log_level = *level;
+        }
+        else if (arg == "--mock-s3") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --mock-s3 requires an argument\n";
+                return false;
+            }
+            if (!parse_mock_store(argv[++i])) {
+                return false;
+            }
+        }
+        else if (arg == "--mock-latency-ms") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --mock-latency-ms requires an argument\n";
+                return false;
+            }
+            try {
+                mock_latency_ms = std::stod(argv[++i]);
+            } catch (const std::exception& e) {
+                std::cerr << "Error: Invalid value for --mock-latency-ms\n";
+                return false;
+            }
+        }
+        else if (arg == "--mock-bandwidth") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --mock-bandwidth requires an argument\n";
+                return false;
+            }
+            try {
+                mock_bandwidth = parse_size(argv[++i]);
+            } catch (const std::exception& e) {
+                std::cerr << "Error: Invalid value for --mock-bandwidth\n";
+                return false;
+            }
+        }
         else if (arg == "--help" || arg == "-h") {
             print_usage(argv[0]);
             return false;
@@ -127,13 +265,33 @@ bool Config::validate() const {
         return false;
     }
 
-    if (s3_config.bucket.empty()) {
-        std::cerr << "Error: --bucket is required\n";
-        return false;
+    // A mock store needs no bucket
+    if (mock_objects == 0) {
+        if (s3_config.bucket.empty()) {
+            std::cerr << "Error: --bucket is required\n";
+            return false;
+        }
+
+        if (s3_config.region.empty()) {
+            std::cerr << "Error: --region is required\n";
+            return false;
+        }
     }
 
-    if (s3_config.region.empty()) {
-        std::cerr << "Error: --region is required\n";
+    if (!inventory_path.empty()) {
+        if (list_bucket) {
+            std::cerr << "Error: --inventory is a fixed namespace; it cannot be combined "
+                         "with --list-bucket or --metadata-snapshot\n";
+            return false;
+        }
+        if (!InventoryReader(inventory_schema, "", "").valid()) {
+            std::cerr << "Error: --inventory-schema must include Key and Size\n";
+            return false;
+        }
+    }
+
+    if (mock_objects > 0 && (mock_latency_ms < 0 || mock_bandwidth == 0)) {
+        std::cerr << "Error: mock latency must be >= 0 and bandwidth > 0\n";
         return false;
     }
 
@@ -156,8 +314,24 @@ bool Config::validate() const {
         return false;
     }
 
-    if (metrics_port < 1024 || metrics_port > 65535) {
-        std::cerr << "Error: metrics port must be between 1024 and 65535\n";
+    if (!(prefetch_budget > 0.0 && prefetch_budget <= 1.0)) {
+        std::cerr << "Error: prefetch budget must be greater than 0 and at most 1\n";
+        return false;
+    }
+
+    if (dir_ttl < 0) {
+        std::cerr << "Error: directory TTL must be >= 0\n";
+        return false;
+    }
+
+    if (metrics_port != 0 && (metrics_port < 1024 || metrics_port > 65535)) {
+        std::cerr << "Error: metrics port must be 0 (disabled) or between 1024 and 65535\n";
+        return false;
+    }
+
+    in_addr metrics_addr{};
+    if (::inet_pton(AF_INET, metrics_address.c_str(), &metrics_addr) != 1) {
+        std::cerr << "Error: metrics address must be an IPv4 address\n";
         return false;
     }
 
@@ -175,10 +349,38 @@ void Config::print_usage(const char* program_name) {
               << "  --cache-size SIZE       Cache size (e.g., 16G, 512M) (default: 16GB)\n"
               << "  --workers N             Number of S3 worker threads (1-128) (default: 8)\n"
               << "  --lookahead N           Prefetch lookahead count (1-256) (default: 3)\n"
+              << "  --adaptive-lookahead    Size prefetch window by read rate and S3 bandwidth\n"
+              << "                          (--lookahead becomes the upper bound in files)\n"
+              << "  --prefetch-budget F     Max fraction of the cache held by unread and\n"
+              << "                          in-flight prefetches (0-1] (default: 0.5)\n"
+              << "  --parquet-columns LIST  Comma-separated Parquet columns to prefetch\n"
+              << "                          (nested fields as a.b; default: all columns)\n"
+              << "  --record-index          Prefetch whole records of files with a\n"
+              << "                          \"<key>.index\" sidecar (TFRecord/ArrayRecord)\n"
               << "  --manifest PATH         File containing list of S3 keys to prefetch\n"
-              << "  --metrics-port PORT     Prometheus metrics port (default: 9090)\n"
-              << "  --enable-tracing        Enable performance tracing\n"
-              << "  --trace-output PATH     Trace output file (default: trace.json)\n"
+              << "  --access-history PATH   Access trace for the learned (Markov) predictor;\n"
+              << "                          loaded at mount, rewritten at unmount\n"
+              << "  --control-socket PATH   Unix socket for runtime manifest/lookahead control\n"
+              << "  --list-bucket           List the whole bucket in the background at mount\n"
+              << "                          (parallel; object sizes known before first access)\n"
+              << "  --metadata-snapshot PATH\n"
+              << "                          Serve the namespace from PATH at mount, refresh it\n"
+              << "                          in the background (implies --list-bucket), rewrite PATH\n"
+              << "  --inventory PATH        Serve the namespace from an S3 Inventory report\n"
+              << "                          (CSV file or directory of them); no listing\n"
+              << "  --inventory-schema F    Report columns, as fileSchema in its manifest.json\n"
+              << "                          (default: \"" << DEFAULT_INVENTORY_SCHEMA << "\")\n"
+              << "  --dir-ttl SECONDS       Re-list a directory after this long (default: 300)\n"
+              << "  --metrics-port PORT     Prometheus metrics port, 0 to disable (default: 9090)\n"
+              << "  --metrics-address ADDR  Address the metrics port listens on\n"
+              << "                          (default: 127.0.0.1; 0.0.0.0 for all interfaces)\n"
+              << "  --enable-tracing        Record open/read/miss/download/evict events\n"
+              << "  --trace-output PATH     Binary trace file (default: valkyrie.trace)\n"
+              << "  --log-level LEVEL       debug, info, warn or error (default: info)\n"
+              << "  --mock-s3 NxSIZE        Serve N zero-filled SIZE objects from memory instead\n"
+              << "                          of S3 (e.g. 256x64M; --bucket not needed)\n"
+              << "  --mock-latency-ms MS    Mock median time to first byte (default: 30)\n"
+              << "  --mock-bandwidth SIZE   Mock aggregate bytes/s (default: 1G)\n"
               << "  --help, -h              Show this help message\n\n"
               << "Examples:\n"
               << "  " << program_name << " --mount /tmp/data --bucket my-bucket --region us-east-1\n"
@@ -197,4 +399,33 @@ bool Config::parse_cache_size(const std::string& size_str) {
     }
 }
 
+bool Config::parse_mock_store(const std::string& spec) {
+    size_t x = spec.find('x');
+    try {
+        if (x == std::string::npos) {
+            throw std::invalid_argument("missing x");
+        }
+        size_t pos;
+        mock_objects = std::stoul(spec.substr(0, x), &pos);
+        if (pos != x || mock_objects == 0) {
+            throw std::invalid_argument("bad count");
+        }
+        mock_object_size = parse_size(spec.substr(x + 1));
+        if (mock_object_size == 0) {
+            throw std::invalid_argument("bad size");
+        }
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: Invalid --mock-s3 value: " << spec << "\n";
+        std::cerr << "Expected COUNTxSIZE (e.g., 256x64M)\n";
+        return false;
+    }
+}
+
+std::string Config::mock_object_key(size_t index) {
+    char name[32];
+    snprintf(name, sizeof(name), "shard_%06zu.bin", index);
+    return name;
+}
+
 }  // namespace valkyrie
@@ -2,8 +2,10 @@
 
 #include "types.hpp"
 #include "s3_worker_pool.hpp"
+#include "logger.hpp"
 #include <string>
 #include <optional>
+#include <vector>
 
 namespace valkyrie {
 
@@ -16,10 +18,30 @@ struct Config {
     size_t cache_size = DEFAULT_CACHE_SIZE;
     int num_workers = DEFAULT_WORKER_COUNT;
     int lookahead = DEFAULT_LOOKAHEAD;
+    bool adaptive_lookahead = false;  // Size window by consumption rate and bandwidth
+    double prefetch_budget = DEFAULT_PREFETCH_BUDGET;  // Cache fraction for unread prefetches
     std::string manifest_path;
-    int metrics_port = 9090;
+    std::vector<std::string> parquet_columns;  // Parquet prefetch column filter (all if empty)
+    bool record_index = false;  // Record-aligned prefetch from "<key>.index" sidecars
+    std::string access_history_path;  // Markov model trace (read at start, written at stop)
+    std::string control_socket_path;  // Runtime manifest/lookahead control (disabled if empty)
+    int dir_ttl = DEFAULT_DIRECTORY_TTL_SEC;  // Seconds before a directory is listed again
+    bool list_bucket = false;  // List every object in the background at mount
+    std::string metadata_snapshot;  // Namespace mapped at mount, rewritten after each listing
+    std::string inventory_path;  // S3 Inventory CSV file or directory; the whole namespace
+    std::string inventory_schema = DEFAULT_INVENTORY_SCHEMA;  // fileSchema of its manifest.json
+    int metrics_port = 9090;  // 0 disables the metrics endpoint
+    std::string metrics_address = "127.0.0.1";  // IPv4 address it listens on
     bool enable_tracing = false;
-    std::string trace_output = "trace.json";
+    std::string trace_output = "valkyrie.trace";  // Binary event trace (see valkyrie-trace2json)
+    LogLevel log_level = LogLevel::INFO;
+
+    // Mock object store instead of S3 (benchmarks, demos): mock_objects
+    // zero-filled objects named shard_000000.bin... (disabled if 0)
+    size_t mock_objects = 0;
+    size_t mock_object_size = 64 * 1024 * 1024;
+    double mock_latency_ms = 30.0;        // Median time to first byte
+    size_t mock_bandwidth = 1024UL * 1024 * 1024;  // Aggregate bytes/s
 
     // Parse from command line
     bool parse(int argc, char* argv[]);
@@ -30,8 +52,12 @@ struct Config {
     // Print usage
     static void print_usage(const char* program_name);
 
+    // Key of the index-th mock object
+    static std::string mock_object_key(size_t index);
+
 private:
     bool parse_cache_size(const std::string& size_str);
+    bool parse_mock_store(const std::string& spec);
 };
 
 }  // namespace valkyrie
@@ -0,0 +1,247 @@
+#include "control_server.hpp"
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0  // macOS: SO_NOSIGPIPE is set per socket instead
+#endif
+
+namespace valkyrie {
+
+ControlServer::ControlServer(const std::string& socket_path, Predictor& predictor)
+    : socket_path_(socket_path)
+    , predictor_(predictor)
+    , listen_fd_(-1)
+    , stop_flag_(false) {
+}
+
+ControlServer::~ControlServer() {
+    stop();
+}
+
+bool ControlServer::start() {
+    sockaddr_un addr{};
+    if (socket_path_.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "ControlServer: Socket path too long: " << socket_path_ << "\n";
+        return false;
+    }
+
+    listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd_ < 0) {
+        std::cerr << "ControlServer: socket() failed: " << std::strerror(errno) << "\n";
+        return false;
+    }
+
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, socket_path_.c_str(), sizeof(addr.sun_path) - 1);
+
+    ::unlink(socket_path_.c_str());  // Stale socket from a previous mount
+
+    // Owner only, set before listen() so no one can connect in between; the
+    // process umask would otherwise decide who may change the manifest
+    if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        ::chmod(socket_path_.c_str(), 0600) < 0 ||
+        ::listen(listen_fd_, 4) < 0) {
+        std::cerr << "ControlServer: Failed to listen on " << socket_path_
+                  << ": " << std::strerror(errno) << "\n";
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+
+    server_thread_ = std::thread(&ControlServer::server_loop, this);
+    std::cout << "ControlServer: Listening on " << socket_path_ << "\n";
+    return true;
+}
+
+void ControlServer::stop() {
+    if (stop_flag_.exchange(true)) {
+        return;  // Already stopped
+    }
+
+    if (server_thread_.joinable()) {
+        server_thread_.join();
+    }
+
+    if (listen_fd_ >= 0) {
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        ::unlink(socket_path_.c_str());
+    }
+}
+
+void ControlServer::server_loop() {
+    while (!stop_flag_) {
+        pollfd pfd{listen_fd_, POLLIN, 0};
+        int ready = ::poll(&pfd, 1, POLL_INTERVAL_MS);
+        if (ready <= 0) continue;  // Timeout or EINTR: re-check stop flag
+
+        int client_fd = ::accept(listen_fd_, nullptr, nullptr);
+        if (client_fd < 0) continue;
+
+        // A stuck client must not wedge the control thread
+        timeval timeout{CLIENT_TIMEOUT_SEC, 0};
+        ::setsockopt(client_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        ::setsockopt(client_fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+#ifdef SO_NOSIGPIPE
+        int one = 1;
+        ::setsockopt(client_fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+
+        handle_client(client_fd);
+        ::close(client_fd);
+    }
+}
+
+void ControlServer::handle_client(int client_fd) {
+    std::string pending;
+    char buf[512];
+
+    while (!stop_flag_) {
+        ssize_t n = ::recv(client_fd, buf, sizeof(buf), 0);
+        if (n <= 0) break;  // EOF, timeout or error
+
+        pending.append(buf, n);
+        if (pending.size() > MAX_COMMAND_LENGTH) {
+            const char* err = "ERR command too long\n";
+            ::send(client_fd, err, std::strlen(err), MSG_NOSIGNAL);
+            break;
+        }
+
+        size_t newline;
+        while ((newline = pending.find('\n')) != std::string::npos) {
+            std::string response = execute(pending.substr(0, newline)) + "\n";
+            pending.erase(0, newline + 1);
+
+            if (::send(client_fd, response.data(), response.size(), MSG_NOSIGNAL) < 0) {
+                return;
+            }
+        }
+    }
+}
+
+std::string ControlServer::execute(const std::string& command) {
+    std::istringstream iss(command);
+    std::string verb;
+    iss >> verb;
+
+    if (verb == "manifest") {
+        std::string action, path;
+        iss >> action;
+        std::getline(iss >> std::ws, path);
+        while (!path.empty() && (path.back() == '\r' || path.back() == ' ')) {
+            path.pop_back();
+        }
+        return handle_manifest(action, path);
+    }
+
+    if (verb == "position") {
+        std::string target;
+        std::getline(iss >> std::ws, target);
+        while (!target.empty() && (target.back() == '\r' || target.back() == ' ')) {
+            target.pop_back();
+        }
+        return handle_position(target);
+    }
+
+    if (verb == "epoch") {
+        uint64_t epoch;
+        if (!(iss >> epoch)) return "ERR usage: epoch N";
+        if (!predictor_.set_shuffle_epoch(epoch)) return "ERR manifest is not shuffled";
+        return "OK epoch " + std::to_string(epoch);
+    }
+
+    if (verb == "lookahead") {
+        int lookahead;
+        if (!(iss >> lookahead)) return "ERR usage: lookahead N";
+        if (!predictor_.set_lookahead(lookahead)) return "ERR lookahead must be between 0 and 100";
+        return "OK lookahead " + std::to_string(lookahead);
+    }
+
+    if (verb == "status") {
+        std::ostringstream oss;
+        oss << "OK manifest_entries=" << predictor_.get_manifest_size()
+            << " lookahead=" << predictor_.get_lookahead()
+            << " epoch=" << predictor_.get_shuffle_epoch();
+        return oss.str();
+    }
+
+    if (verb.empty()) return "ERR empty command";
+    return "ERR unknown command: " + verb;
+}
+
+std::string ControlServer::handle_manifest(const std::string& action, const std::string& path) {
+    if (action == "clear") {
+        predictor_.set_manifest(nullptr);
+        return "OK manifest cleared";
+    }
+
+    if (action != "load" && action != "append") {
+        return "ERR usage: manifest load|append PATH | manifest clear";
+    }
+
+    if (path.empty()) {
+        return "ERR manifest " + action + " requires a path";
+    }
+
+    // Parse off the data path; the predictor only sees the finished manifest
+    auto loaded = std::make_shared<Manifest>();
+    if (!loaded->load(path)) {
+        return "ERR failed to load manifest: " + path;
+    }
+
+    if (action == "append") {
+        auto current = predictor_.get_manifest();
+        if (current) {
+            std::vector<std::string> entries = current->entries();
+            entries.insert(entries.end(), loaded->entries().begin(), loaded->entries().end());
+
+            // A shuffle declared by the appended file wins; otherwise keep the current one
+            auto shuffle = loaded->shuffle().has_value() ? loaded->shuffle() : current->shuffle();
+
+            auto merged = std::make_shared<Manifest>();
+            merged->assign(std::move(entries), shuffle);
+            loaded = merged;
+        }
+    }
+
+    size_t size = loaded->size();
+    predictor_.set_manifest(std::move(loaded));
+    return "OK manifest entries=" + std::to_string(size);
+}
+
+std::string ControlServer::handle_position(const std::string& target) {
+    if (target.empty()) {
+        return "ERR usage: position KEY | position #N";
+    }
+
+    if (target[0] == '#') {
+        size_t index;
+        try {
+            index = std::stoull(target.substr(1));
+        } catch (const std::exception&) {
+            return "ERR invalid position: " + target;
+        }
+
+        auto key = predictor_.manifest_entry_at(index);
+        if (!key.has_value()) {
+            return "ERR position out of range: " + target;
+        }
+
+        predictor_.set_position(*key);
+        return "OK position " + *key;
+    }
+
+    predictor_.set_position(target);
+    return "OK position " + target;
+}
+
+}  // namespace valkyrie
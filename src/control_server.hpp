@@ -0,0 +1,56 @@
+#pragma once
+
+#include "predictor.hpp"
+#include <string>
+#include <thread>
+#include <atomic>
+
+namespace valkyrie {
+
+// Runtime control over a Unix-domain socket. Clients send one command per
+// line and get one "OK ..." / "ERR ..." line back:
+//
+//   manifest load PATH      Replace the manifest
+//   manifest append PATH    Append PATH's entries to the current manifest
+//   manifest clear          Drop the manifest (pattern/Markov prediction only)
+//   position KEY            Continue predicting from KEY
+//   position #N             Continue from entry N of the current (epoch) order
+//   epoch N                 Jump a shuffled manifest to epoch N
+//   lookahead N             Change the prefetch lookahead
+//   status                  Report manifest size, lookahead and epoch
+//
+// New manifests are parsed on the control thread and swapped in atomically,
+// so readers and the predictor never wait on a reload.
+class ControlServer {
+public:
+    ControlServer(const std::string& socket_path, Predictor& predictor);
+
+    ~ControlServer();
+
+    // Bind the socket and start the accept thread; false if binding fails
+    bool start();
+    void stop();
+
+    // Execute one command line and return the response line (without '\n')
+    std::string execute(const std::string& command);
+
+private:
+    void server_loop();
+    void handle_client(int client_fd);
+
+    std::string handle_manifest(const std::string& action, const std::string& path);
+    std::string handle_position(const std::string& target);
+
+    std::string socket_path_;
+    Predictor& predictor_;
+
+    int listen_fd_;
+    std::thread server_thread_;
+    std::atomic<bool> stop_flag_;
+
+    static constexpr int POLL_INTERVAL_MS = 200;
+    static constexpr int CLIENT_TIMEOUT_SEC = 5;
+    static constexpr size_t MAX_COMMAND_LENGTH = 4096;
+};
+
+}  // namespace valkyrie
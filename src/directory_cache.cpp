@@ -0,0 +1,159 @@
+#include "directory_cache.hpp"
+
+#include <algorithm>
+
+namespace valkyrie {
+
+namespace {
+
+void sort_listing(DirectoryListing& listing) {
+    std::sort(listing.files.begin(), listing.files.end(),
+              [](const ObjectInfo& a, const ObjectInfo& b) { return a.key < b.key; });
+    std::sort(listing.subdirs.begin(), listing.subdirs.end());
+    listing.subdirs.erase(std::unique(listing.subdirs.begin(), listing.subdirs.end()),
+                          listing.subdirs.end());
+}
+
+}  // namespace
+
+DirectoryListing group_directory(const std::vector<ObjectInfo>& objects, const std::string& dir) {
+    std::string prefix = dir.empty() ? "" : dir + "/";
+    DirectoryListing listing;
+
+    for (const auto& obj : objects) {
+        if (obj.key.size() <= prefix.size() || obj.key.compare(0, prefix.size(), prefix) != 0) {
+            continue;  // Outside dir, or its own "dir/" marker object
+        }
+        size_t slash = obj.key.find('/', prefix.size());
+        if (slash == std::string::npos) {
+            listing.files.push_back({obj.key.substr(prefix.size()), obj.size, obj.etag, obj.mtime});
+        } else {
+            listing.subdirs.push_back(obj.key.substr(prefix.size(), slash - prefix.size()));
+        }
+    }
+
+    sort_listing(listing);
+    return listing;
+}
+
+DirectoryCache::DirectoryCache(Lister lister, std::chrono::seconds ttl, size_t max_directories)
+    : lister_(std::move(lister)), ttl_(ttl), max_directories_(std::max<size_t>(max_directories, 1)) {}
+
+bool DirectoryCache::is_fresh(const Node& node) const {
+    return node.directory && std::chrono::steady_clock::now() - node.listed_at < ttl_;
+}
+
+void DirectoryCache::erase_locked(NodeMap::iterator it) {
+    lru_.erase(it->second->lru_pos);
+    nodes_.erase(it);
+}
+
+std::shared_ptr<const Directory> DirectoryCache::list(std::string_view dir) {
+    std::shared_ptr<Node> node;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = nodes_.find(dir);
+        if (it == nodes_.end()) {
+            it = nodes_.emplace(std::string(dir), std::make_shared<Node>()).first;
+            lru_.push_front(it->first);
+            it->second->lru_pos = lru_.begin();
+        } else {
+            lru_.splice(lru_.begin(), lru_, it->second->lru_pos);
+        }
+        node = it->second;
+        if (is_fresh(*node)) return node->directory;
+    }
+
+    // One lister call per directory; later arrivals wait and reuse its result
+    std::lock_guard<std::mutex> list_lock(node->list_mutex);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (is_fresh(*node)) return node->directory;
+    }
+
+    DirectoryListing listing = lister_(std::string(dir));  // No cache lock held
+    auto directory = std::make_shared<Directory>();
+    directory->files = MetadataStore(std::move(listing.files));
+    directory->subdirs = std::move(listing.subdirs);
+    std::sort(directory->subdirs.begin(), directory->subdirs.end());
+    directory->subdirs.erase(std::unique(directory->subdirs.begin(), directory->subdirs.end()),
+                             directory->subdirs.end());
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    node->directory = directory;  // Callers already waiting on the node reuse it
+    node->listed_at = std::chrono::steady_clock::now();
+    ++listings_;
+
+    // Every missing path lists as empty; keeping those would let lookups of
+    // nonexistent paths evict real directories
+    if (directory->files.size() == 0 && directory->subdirs.empty()) {
+        auto it = nodes_.find(dir);
+        if (it != nodes_.end() && it->second == node) erase_locked(it);
+        return directory;
+    }
+
+    // Trimmed once a listing is known to be worth keeping. A dropped node that
+    // is still being listed serves the callers waiting on it, it is just not kept.
+    while (nodes_.size() > max_directories_) {
+        erase_locked(nodes_.find(lru_.back()));
+    }
+    return directory;
+}
+
+DirectoryCache::Entry DirectoryCache::find(const Directory& directory, std::string_view name) {
+    Entry entry;
+    if (auto index = directory.files.find(name)) {
+        entry.type = EntryType::FILE;
+        entry.size = directory.files.size_at(*index);
+        entry.mtime = directory.files.mtime_at(*index);
+    } else if (std::binary_search(directory.subdirs.begin(), directory.subdirs.end(), name)) {
+        entry.type = EntryType::DIR;
+    }
+    return entry;
+}
+
+DirectoryCache::Entry DirectoryCache::lookup(std::string_view path) {
+    if (path.empty()) {
+        return Entry{EntryType::DIR};
+    }
+    auto directory = list(parent_of(path));
+    return find(*directory, name_of(path));
+}
+
+DirectoryCache::Entry DirectoryCache::cached_lookup(std::string_view path) const {
+    std::shared_ptr<const Directory> directory;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = nodes_.find(parent_of(path));
+        if (it != nodes_.end()) directory = it->second->directory;
+    }
+    return directory ? find(*directory, name_of(path)) : Entry{};
+}
+
+void DirectoryCache::invalidate(std::string_view dir) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = nodes_.find(dir);
+    if (it != nodes_.end()) erase_locked(it);
+}
+
+size_t DirectoryCache::cached_directories() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return nodes_.size();
+}
+
+uint64_t DirectoryCache::listings() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return listings_;
+}
+
+std::string_view DirectoryCache::parent_of(std::string_view path) {
+    size_t slash = path.rfind('/');
+    return slash == std::string_view::npos ? std::string_view() : path.substr(0, slash);
+}
+
+std::string_view DirectoryCache::name_of(std::string_view path) {
+    size_t slash = path.rfind('/');
+    return slash == std::string_view::npos ? path : path.substr(slash + 1);
+}
+
+}  // namespace valkyrie
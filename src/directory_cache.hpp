@@ -0,0 +1,110 @@
+#pragma once
+
+#include "types.hpp"
+#include "metadata_store.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace valkyrie {
+
+// One level of the bucket, as ListObjectsV2 with Delimiter="/" returns it.
+// Names are relative to the directory.
+struct DirectoryListing {
+    std::vector<ObjectInfo> files;       // key = file name
+    std::vector<std::string> subdirs;    // Common prefixes, without the '/'
+};
+
+// Listing of `dir` grouped from a flat key list, for stores that cannot
+// list by delimiter (the mock object store, tests)
+DirectoryListing group_directory(const std::vector<ObjectInfo>& objects, const std::string& dir);
+
+// A cached directory: its files in a compact store keyed by name
+struct Directory {
+    MetadataStore files;
+    std::vector<std::string> subdirs;  // Sorted
+};
+
+// Lazily listed directories. A directory is listed on first access and
+// again once its own TTL has passed; concurrent requests for it share one
+// listing and never block other directories. At most `max_directories`
+// are kept, least recently used dropped first, and empty listings (what a
+// path that does not exist lists as) are not kept at all. Directory paths
+// are keys relative to the prefix without a trailing '/': "" is the root.
+class DirectoryCache {
+public:
+    // Lists one directory; throws on failure
+    using Lister = std::function<DirectoryListing(const std::string& dir)>;
+
+    explicit DirectoryCache(Lister lister,
+                            std::chrono::seconds ttl = std::chrono::seconds(DEFAULT_DIRECTORY_TTL_SEC),
+                            size_t max_directories = DEFAULT_MAX_CACHED_DIRECTORIES);
+
+    // Cached listing of `dir`, listed now if absent or expired
+    std::shared_ptr<const Directory> list(std::string_view dir);
+
+    enum class EntryType { NONE, FILE, DIR };
+    struct Entry {
+        EntryType type = EntryType::NONE;
+        uint64_t size = 0;   // Files only
+        int64_t mtime = 0;   // Files only; 0 if unknown
+    };
+
+    // What `path` is, from the listing of its parent directory only. Does
+    // not allocate when that listing is cached and fresh.
+    Entry lookup(std::string_view path);
+
+    // As lookup, from whatever listing is already cached (even expired); never lists
+    Entry cached_lookup(std::string_view path) const;
+
+    // Drop a directory so its next access lists it again
+    void invalidate(std::string_view dir);
+
+    size_t cached_directories() const;
+    uint64_t listings() const;  // Lister calls so far
+
+    // "a/b/c" -> "a/b" and "c"; top-level names have parent ""
+    static std::string_view parent_of(std::string_view path);
+    static std::string_view name_of(std::string_view path);
+
+    // `name` in `directory`
+    static Entry find(const Directory& directory, std::string_view name);
+
+private:
+    struct Node {
+        std::mutex list_mutex;  // Held while listing, so one listing per directory
+        std::shared_ptr<const Directory> directory;
+        std::chrono::steady_clock::time_point listed_at;
+        std::list<std::string>::iterator lru_pos;  // Position in lru_
+    };
+
+    // Heterogeneous lookup: finding a node needs no std::string
+    struct NameHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view name) const { return std::hash<std::string_view>{}(name); }
+    };
+
+    using NodeMap = std::unordered_map<std::string, std::shared_ptr<Node>, NameHash, std::equal_to<>>;
+
+    bool is_fresh(const Node& node) const;
+    void erase_locked(NodeMap::iterator it);
+
+    Lister lister_;
+    std::chrono::seconds ttl_;
+    size_t max_directories_;
+
+    mutable std::mutex mutex_;  // Guards nodes_, lru_ and the fields of every node
+    NodeMap nodes_;
+    std::list<std::string> lru_;  // Directory paths, most recently used first
+    uint64_t listings_ = 0;
+};
+
+}  // namespace valkyrie
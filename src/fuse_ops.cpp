@@ -1,4 +1,7 @@
 #include "fuse_ops.hpp"
+#include "inventory.hpp"
+#include "logger.hpp"
+#include "probes.hpp"
 #include <iostream>
 #include <cstring>
 #include <fcntl.h>
@@ -11,6 +14,7 @@ FuseContext::FuseContext(const Config& cfg)
     : config(cfg) {
 
     std::cout << "Initializing Valkyrie-FS...\n";
+    Logger::set_level(config.log_level);
 
     try {
         // Create cache
@@ -23,12 +27,87 @@ FuseContext::FuseContext(const Config& cfg)
         );
         std::cout << "S3 worker pool created: " << config.num_workers << " workers\n";
 
+        if (config.mock_objects > 0) {
+            for (size_t i = 0; i < config.mock_objects; ++i) {
+                mock_object_sizes[Config::mock_object_key(i)] = config.mock_object_size;
+            }
+            SimulatedBackend::Options options;
+            options.latency_ms = config.mock_latency_ms;
+            options.latency_sigma = config.mock_latency_ms > 0 ? 0.5 : 0.0;
+            options.bandwidth = static_cast<double>(config.mock_bandwidth);
+            mock_store = std::make_unique<SimulatedBackend>(options, mock_object_sizes);
+
+            worker_pool->set_range_fetcher([this](const std::string& s3_key, size_t offset,
+                                                  size_t size, std::vector<char>& data) {
+                return mock_store->fetch(s3_key, offset, size, data);
+            });
+            worker_pool->set_object_lister([this] {
+                std::vector<ObjectInfo> objects;
+                objects.reserve(mock_object_sizes.size());
+                for (const auto& [key, size] : mock_object_sizes) {
+                    objects.push_back({key, size});
+                }
+                return objects;
+            });
+            std::cout << "Mock S3: " << config.mock_objects << " x "
+                      << (config.mock_object_size / (1024*1024)) << "MB objects, "
+                      << config.mock_latency_ms << "ms latency\n";
+        }
+
+        // Directories are listed one level at a time, on first access
+        directories = std::make_unique<DirectoryCache>(
+            [this](const std::string& dir) {
+                auto* pool = get_worker_pool();
+                if (!pool) {
+                    throw std::runtime_error("worker pool not available");
+                }
+                return pool->list_directory(dir);
+            },
+            std::chrono::seconds(config.dir_ttl));
+
+        if (config.enable_tracing) {
+            tracer = std::make_unique<Tracer>(config.trace_output);
+            cache->set_tracer(tracer.get());
+            worker_pool->set_tracer(tracer.get());
+        }
+
+        // Index ".tar" members from chunks as they arrive, and keep fetching
+        // the headers of archives whose sidecar was opened
+        tar_indexer = std::make_unique<TarIndexer>(*cache);
+        worker_pool->set_chunk_listener(
+            [this](const std::string& s3_key, size_t offset, const std::vector<char>& data) {
+                tar_indexer->on_chunk(s3_key, offset, data);
+                if (tar_indexer->requested(s3_key)) {
+                    index_tar_archive(s3_key);
+                }
+            });
+
         // Create predictor
         predictor = std::make_unique<Predictor>(
             *cache, *worker_pool, config.lookahead
         );
         std::cout << "Predictor created: lookahead=" << config.lookahead << "\n";
 
+        predictor->set_prefetch_budget(config.prefetch_budget);
+        predictor->set_tar_indexer(tar_indexer.get());
+        predictor->set_parquet_columns(config.parquet_columns);
+
+        if (config.record_index) {
+            record_indexes = std::make_unique<RecordIndexStore>();
+            predictor->set_record_indexes(record_indexes.get());
+            std::cout << "Record index prefetch enabled\n";
+        }
+
+        // Readahead stops at the known object size; Parquet footers are found from it
+        predictor->set_size_lookup([this](const std::string& s3_key) {
+            return known_size(s3_key);
+        });
+
+        if (config.adaptive_lookahead) {
+            predictor->enable_adaptive_lookahead();
+            std::cout << "Adaptive lookahead enabled (max " << config.lookahead << " files)\n";
+        }
+
         // Load manifest if specified
         if (!config.manifest_path.empty()) {
             if (predictor->load_manifest(config.manifest_path)) {
@@ -37,6 +116,31 @@ FuseContext::FuseContext(const Config& cfg)
                 std::cerr << "WARNING: Failed to load manifest\n";
             }
         }
+
+        if (config.metrics_port != 0) {
+            metrics_server = std::make_unique<MetricsServer>(
+                config.metrics_port, *cache, *worker_pool, *predictor
+            );
+            metrics_server->set_bind_address(config.metrics_address);
+            metrics_server->set_read_stats(&read_stats);
+            metrics_server->set_tar_indexer(tar_indexer.get());
+        }
+
+        // In-mount /.valkyrie/ stats and control files
+        virtual_files = std::make_unique<VirtualFiles>(
+            *cache, *worker_pool, *predictor, read_stats,
+            [this](const std::string& s3_key) { return known_size(s3_key); });
+
+        if (!config.control_socket_path.empty()) {
+            control_server = std::make_unique<ControlServer>(
+                config.control_socket_path, *predictor
+            );
+        }
+
+        // Train the learned predictor from the previous run, if any
+        if (!config.access_history_path.empty()) {
+            predictor->load_access_trace(config.access_history_path);
+        }
     } catch (const std::exception& e) {
         std::cerr << "FATAL: Failed to initialize Valkyrie-FS: " << e.what() << "\n";
         throw;  // Re-throw to allow caller to handle
@@ -57,8 +161,43 @@ void FuseContext::start() {
     // Expose worker pool for directory listing
     worker_pool_ptr = worker_pool.get();
 
+    Logger::start();
+
+    if (tracer && !tracer->start()) {
+        std::cerr << "WARNING: Tracing disabled\n";
+    }
+
     worker_pool->start();
     predictor->start();
+
+    // A fixed namespace (--inventory, or a manifest with sizes) replaces
+    // listing altogether; a snapshot serves it at once and a listing refreshes it
+    bool fixed_namespace = load_fixed_namespace();
+    if (fixed_namespace && config.list_bucket) {
+        std::cerr << "WARNING: Manifest declares the namespace; not listing the bucket\n";
+    }
+
+    if (!fixed_namespace && !config.metadata_snapshot.empty()) {
+        auto snapshot = MetadataStore::open_snapshot(config.metadata_snapshot, snapshot_source());
+        if (snapshot) {
+            set_metadata(snapshot);
+            std::cout << "Metadata: Mapped " << snapshot->size() << " objects from "
+                      << config.metadata_snapshot << "\n";
+        }
+    }
+
+    if (!fixed_namespace && config.list_bucket) {
+        bucket_lister_ = std::thread(&FuseContext::list_bucket, this);
+    }
+
+    if (control_server && !control_server->start()) {
+        std::cerr << "WARNING: Control socket unavailable\n";
+    }
+
+    if (metrics_server && !metrics_server->start()) {
+        std::cerr << "WARNING: Metrics endpoint unavailable\n";
+    }
+
     std::cout << "Valkyrie-FS started successfully\n";
 }
 
@@ -70,20 +209,274 @@ void FuseContext::stop() {
 
     std::cout << "Shutting down Valkyrie-FS...\n";
 
+    if (control_server) {
+        control_server->stop();
+    }
+
+    if (metrics_server) {
+        metrics_server->stop();
+    }
+
     if (predictor) {
         predictor->stop();
+
+        if (!config.access_history_path.empty()) {
+            predictor->save_access_trace(config.access_history_path);
+        }
     }
 
     if (worker_pool) {
         worker_pool->shutdown();
     }
 
+    // Shutdown cancels a listing still in progress
+    if (bucket_lister_.joinable()) {
+        bucket_lister_.join();
+    }
+
+    // After the workers, so their last downloads are in the trace
+    if (tracer) {
+        tracer->stop();
+    }
+
     // Clear raw pointer to prevent use-after-shutdown
     worker_pool_ptr = nullptr;
 
+    // Last: components log while they shut down
+    Logger::stop();
+
     std::cout << "Valkyrie-FS stopped\n";
 }
 
+void FuseContext::list_bucket() {
+    try {
+        auto store = std::make_shared<const MetadataStore>(worker_pool->list_objects());
+        auto previous = get_metadata();
+        set_metadata(store);
+        Logger::info("fuse", "Bucket listing complete: ", store->size(), " objects, ",
+                     store->memory_bytes() / (1024 * 1024), "MB of metadata");
+
+        if (config.metadata_snapshot.empty()) {
+            return;
+        }
+        if (previous) {
+            auto changes = MetadataStore::compare(*previous, *store);
+            Logger::info("fuse", "Snapshot refreshed: ", changes.added, " added, ",
+                         changes.removed, " removed, ", changes.changed, " changed");
+            if (changes.added + changes.removed + changes.changed == 0) {
+                return;  // Snapshot still current
+            }
+        }
+        if (!store->save(config.metadata_snapshot, snapshot_source())) {
+            Logger::warn("fuse", "Metadata snapshot not written: ", config.metadata_snapshot);
+        }
+    } catch (const std::exception& e) {
+        Logger::warn("fuse", "Bucket listing failed: ", e.what());
+    }
+}
+
+bool FuseContext::load_fixed_namespace() {
+    std::vector<ObjectInfo> objects;
+    std::string source;
+
+    if (!config.inventory_path.empty()) {
+        InventoryReader reader(config.inventory_schema, config.s3_config.bucket,
+                               config.s3_config.prefix);
+        if (!reader.load(config.inventory_path, objects)) {
+            std::cerr << "WARNING: Inventory not loaded; serving directories by lazy listing\n";
+            return false;
+        }
+        source = config.inventory_path;
+    } else if (auto manifest = predictor->get_manifest(); manifest && manifest->has_sizes()) {
+        objects = manifest->objects();
+        source = config.manifest_path;
+    } else {
+        return false;
+    }
+
+    auto store = std::make_shared<const MetadataStore>(std::move(objects));
+    set_metadata(store);
+    std::cout << "Metadata: " << store->size() << " objects from " << source
+              << " (no bucket listing)\n";
+    return true;
+}
+
+std::string FuseContext::snapshot_source() const {
+    return "s3://" + config.s3_config.bucket + "/" + config.s3_config.prefix;
+}
+
+std::shared_ptr<const MetadataStore> FuseContext::get_metadata() const {
+    std::lock_guard<std::mutex> lock(metadata_mutex_);
+    return metadata_;
+}
+
+void FuseContext::set_metadata(std::shared_ptr<const MetadataStore> store) {
+    std::lock_guard<std::mutex> lock(metadata_mutex_);
+    metadata_ = std::move(store);
+}
+
+DirectoryCache::Entry FuseContext::resolve(std::string_view s3_key) {
+    auto store = get_metadata();
+    if (!store) {
+        return directories->lookup(s3_key);
+    }
+
+    DirectoryCache::Entry entry;
+    if (auto index = store->find(s3_key)) {
+        entry.type = DirectoryCache::EntryType::FILE;
+        entry.size = store->size_at(*index);
+        entry.mtime = store->mtime_at(*index);
+    } else if (s3_key.empty() || store->has_prefix(s3_key, "/")) {
+        entry.type = DirectoryCache::EntryType::DIR;
+    }
+    return entry;
+}
+
+std::optional<size_t> FuseContext::known_size(std::string_view s3_key) const {
+    if (auto store = get_metadata()) {
+        auto index = store->find(s3_key);
+        if (!index) return std::nullopt;
+        return store->size_at(*index);
+    }
+    auto entry = directories->cached_lookup(s3_key);
+    if (entry.type != DirectoryCache::EntryType::FILE) return std::nullopt;
+    return entry.size;
+}
+
+int FuseContext::read_object(const std::string& s3_key, char* buf, size_t size, off_t offset,
+                             pid_t pid) {
+    auto read_start = std::chrono::steady_clock::now();
+    VALKYRIE_PROBE3(read__entry, s3_key.c_str(), offset, size);
+
+    // One chunk at a time; a read crossing a chunk boundary takes several
+    uint64_t stall_us = 0;
+    bool hit = true;
+    int result = 0;
+    size_t copied = 0;
+    while (copied < size) {
+        int piece = read_chunk(s3_key, buf + copied, size - copied, offset + copied, stall_us, hit);
+        if (piece < 0) {
+            // Short read; the next read at that offset reports the error
+            result = copied > 0 ? static_cast<int>(copied) : piece;
+            break;
+        }
+        if (piece == 0) break;  // End of the object
+        copied += piece;
+        result = static_cast<int>(copied);
+    }
+
+    // Accounted once per FUSE read, however many chunks it spanned
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - read_start).count();
+    if (result < 0) {
+        if (!hit) read_stats.stalls.record(pid, s3_key, 0, elapsed, stall_us, true);
+        return result;
+    }
+
+    if (copied > 0) {
+        // Feed the consumption rate used to size the prefetch window
+        predictor->on_bytes_read(s3_key, copied, offset + copied);
+    }
+
+    (hit ? read_stats.hit_latency_us : read_stats.miss_latency_us).record(elapsed);
+    read_stats.bytes_read += copied;
+    read_stats.stalls.record(pid, s3_key, copied, elapsed, stall_us, !hit);
+    VALKYRIE_PROBE5(read__return, s3_key.c_str(), offset, copied, elapsed, hit);
+
+    if (tracer) {
+        tracer->record(TraceEventType::READ, s3_key, offset, copied, elapsed,
+                       std::nullopt, hit);
+    }
+    return result;
+}
+
+int FuseContext::read_chunk(const std::string& s3_key, char* buf, size_t size, off_t offset,
+                            uint64_t& stall_us, bool& hit) {
+    if (auto object_size = known_size(s3_key); object_size && static_cast<size_t>(offset) >= *object_size) {
+        return 0;  // At or past the end of the object
+    }
+
+    // Fixed-size chunk the offset falls in, fetched on a miss
+    size_t chunk_offset = (offset / DEFAULT_CHUNK_SIZE) * DEFAULT_CHUNK_SIZE;
+    size_t fetch_size = DEFAULT_CHUNK_SIZE;
+
+    // Any cached chunk whose bytes cover the offset: fixed-size, or starting
+    // at a record boundary (which may also sit at an aligned offset)
+    auto cached = cache->get_chunk_containing(s3_key, offset);
+
+    // Indexed record files fetch just the record on a miss
+    if (record_indexes) {
+        auto index = record_indexes->get(s3_key);
+        auto record = index ? index->find(offset) : std::nullopt;
+        if (record.has_value()) {
+            predictor->on_record_read(s3_key, *record);
+
+            if (!cached.has_value()) {
+                chunk_offset = index->record(*record).offset;
+                fetch_size = index->record(*record).length;
+            }
+        }
+    }
+
+    if (cached.has_value()) {
+        VALKYRIE_PROBE2(cache__hit, s3_key.c_str(), cached->first);
+    } else {
+        // CACHE MISS - Block and download with URGENT priority
+        hit = false;
+        VALKYRIE_PROBE3(cache__miss, s3_key.c_str(), chunk_offset, fetch_size);
+        Logger::debug("fuse", "Cache miss: ", s3_key, " at offset ", offset);
+
+        // Submit URGENT download request
+        auto stall_start = std::chrono::steady_clock::now();
+        auto future = worker_pool->submit(s3_key, chunk_offset, fetch_size, Priority::URGENT);
+
+        // Wait for download (blocks FUSE thread)
+        bool success = future.get();
+        uint64_t waited = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - stall_start).count();
+        stall_us += waited;
+
+        if (!success) {
+            Logger::error("fuse", "Failed to download chunk: ", s3_key, " offset ", chunk_offset);
+            return -EIO;  // I/O error
+        }
+
+        cached = cache->get_chunk_containing(s3_key, offset);
+        if (!cached.has_value()) {
+            // A short chunk ending before the offset: the object ends there
+            auto fetched = cache->get_chunk(s3_key, chunk_offset);
+            if (fetched.has_value() && fetched->data.size() < fetch_size) {
+                return 0;
+            }
+            Logger::error("fuse", "Chunk missing after download: ", s3_key, " offset ", offset);
+            return -EIO;
+        }
+
+        if (tracer) {
+            tracer->record(TraceEventType::MISS, s3_key, chunk_offset, fetch_size,
+                           waited, Priority::URGENT);
+        }
+    }
+
+    // Mark as accessed BEFORE dereferencing to minimize race window
+    // While the chunk data is copied (safe even if evicted), we must ensure
+    // access() is called as close to the lookup as possible to maintain
+    // accurate LRU statistics and prevent accessing stale cache entries.
+    chunk_offset = cached->first;
+    cache->access(s3_key, chunk_offset);
+
+    const auto& chunk = cached->second;
+
+    // The chunk covers the offset, so at least one byte is available
+    size_t offset_in_chunk = offset - chunk_offset;
+    size_t available = chunk.data.size() - offset_in_chunk;
+    size_t to_copy = std::min(size, available);
+
+    // Copy data to FUSE buffer
+    std::memcpy(buf, chunk.data.data() + offset_in_chunk, to_copy);
+    return static_cast<int>(to_copy);
+}
+
 FuseContext* get_valkyrie_context() {
     auto* fuse_ctx = fuse_get_context();
     if (!fuse_ctx || !fuse_ctx->private_data) {
@@ -101,6 +494,162 @@ std::string path_to_s3_key(const char* path) {
     return key;
 }
 
+void FuseContext::index_tar_archive(const std::string& archive) {
+    std::optional<size_t> next;
+    while ((next = tar_indexer->next_chunk(archive)).has_value()) {
+        auto chunk = cache->get_chunk(archive, *next);
+        if (!chunk.has_value()) {
+            // A download already in flight is shared; its listener call continues
+            try {
+                worker_pool->submit(archive, *next, DEFAULT_CHUNK_SIZE, Priority::NORMAL);
+            } catch (const std::exception& e) {
+                Logger::warn("fuse", "Tar index fetch failed: ", archive, ": ", e.what());
+            }
+            return;
+        }
+
+        tar_indexer->on_chunk(archive, *next, chunk->data);
+        if (tar_indexer->next_chunk(archive) == next) {
+            return;  // No progress
+        }
+    }
+}
+
+int FuseContext::wait_tar_index(const std::string& archive, std::string& rendered) {
+    auto deadline = std::chrono::steady_clock::now() + TAR_INDEX_OPEN_TIMEOUT;
+    tar_indexer->request(archive);
+    while (true) {
+        if (auto text = tar_indexer->render(archive); text.has_value()) {
+            rendered = std::move(*text);
+            return 0;
+        }
+        if (!tar_indexer->next_chunk(archive).has_value()) {
+            Logger::error("fuse", "Not a tar archive: ", archive);
+            return -EIO;
+        }
+        if (std::chrono::steady_clock::now() >= deadline) {
+            Logger::warn("fuse", "Archive still indexing after ", TAR_INDEX_OPEN_TIMEOUT.count(),
+                         "s: ", archive);
+            return -ETIMEDOUT;
+        }
+
+        // Queued already (shared) unless the last download failed
+        index_tar_archive(archive);
+        tar_indexer->wait_indexed(archive, TAR_INDEX_POLL);
+    }
+}
+
+// Attributes of a virtual "<archive>.tar.idx" sidecar. The size is only known
+// once the archive is indexed; until then it is reported as 0 and served with
+// direct_io so readers still see the full content.
+static int getattr_tar_sidecar(FuseContext* ctx, const std::string& index_key,
+                               struct stat* stbuf) {
+    std::string archive = TarIndexer::archive_for_index(index_key);
+    if (ctx->resolve(archive).type != DirectoryCache::EntryType::FILE) {
+        return -ENOENT;
+    }
+
+    auto rendered_size = ctx->tar_indexer->rendered_size(archive);
+    stbuf->st_mode = S_IFREG | 0444;  // Read-only
+    stbuf->st_nlink = 1;
+    stbuf->st_size = rendered_size.value_or(0);
+    return 0;
+}
+
+// allow_other opens the mount to every local user, and the kernel does not
+// check modes (no default_permissions): only the mounting user or root may
+// use /.valkyrie/control
+static bool may_use_control() {
+    uid_t uid = fuse_get_context()->uid;
+    return uid == 0 || uid == getuid();
+}
+
+// Attributes of the /.valkyrie/ directory and its files. Their content is
+// rendered at open, so files report size 0 and are served with direct_io.
+static int getattr_virtual(VirtualFiles::Node node, struct stat* stbuf) {
+    stbuf->st_uid = getuid();
+    stbuf->st_gid = getgid();
+    switch (node) {
+        case VirtualFiles::Node::DIR:
+            stbuf->st_mode = S_IFDIR | 0555;
+            stbuf->st_nlink = 2;
+            return 0;
+        case VirtualFiles::Node::CONTROL:
+            stbuf->st_mode = S_IFREG | 0600;
+            stbuf->st_nlink = 1;
+            return 0;
+        case VirtualFiles::Node::STATS:
+        case VirtualFiles::Node::CACHE_MAP:
+            stbuf->st_mode = S_IFREG | 0444;
+            stbuf->st_nlink = 1;
+            return 0;
+        default:
+            return -ENOENT;
+    }
+}
+
+// Attributes of a bucket path, from the namespace or its parent directory's listing
+static int getattr_object(FuseContext* ctx, std::string_view s3_key, struct stat* stbuf) {
+    auto entry = ctx->resolve(s3_key);
+    switch (entry.type) {
+        case DirectoryCache::EntryType::FILE:
+            stbuf->st_mode = S_IFREG | 0444;  // Read-only
+            stbuf->st_nlink = 1;
+            stbuf->st_size = entry.size;
+            stbuf->st_mtime = entry.mtime;
+            return 0;
+        case DirectoryCache::EntryType::DIR:
+            stbuf->st_mode = S_IFDIR | 0755;
+            stbuf->st_nlink = 2;
+            return 0;
+        case DirectoryCache::EntryType::NONE:
+            break;
+    }
+    return -ENOENT;
+}
+
+static void add_file_entry(std::string_view name, std::vector<std::string>& names) {
+    names.emplace_back(name);
+    if (TarIndexer::is_tar_key(names.back())) {
+        names.push_back(names.back() + ".idx");
+    }
+}
+
+// Names in a bucket directory ("" is the root), each tar archive followed
+// by its ".idx" member index sidecar
+static int directory_entries(FuseContext* ctx, const std::string& dir,
+                             std::vector<std::string>& names) {
+    if (dir.empty()) {
+        names.push_back(VirtualFiles::DIR);
+    }
+
+    if (auto store = ctx->get_metadata()) {
+        if (!dir.empty() && !store->has_prefix(dir, "/")) {
+            return -ENOENT;
+        }
+        std::vector<ObjectInfo> files;
+        store->list_directory(dir, files, names);
+        for (const auto& file : files) {
+            add_file_entry(file.key, names);
+        }
+        return 0;
+    }
+
+    std::shared_ptr<const Directory> directory;
+    try {
+        directory = ctx->directories->list(dir);
+    } catch (const std::exception& e) {
+        Logger::error("fuse", "readdir: ListObjects failed for '", dir, "': ", e.what());
+        return -EIO;
+    }
+
+    names.insert(names.end(), directory->subdirs.begin(), directory->subdirs.end());
+    for (MetadataStore::Cursor cursor(directory->files, 0); cursor.valid(); cursor.next()) {
+        add_file_entry(cursor.key(), names);
+    }
+    return 0;
+}
+
 namespace fuse_ops {
 
 #ifdef __APPLE__
@@ -160,6 +709,42 @@ void destroy(void* private_data) {
             std::cout << "  Files cached: " << cache_stats.num_files << "\n";
             std::cout << "  Chunks cached: " << cache_stats.num_chunks << "\n";
 
+            const auto& outcomes = ctx->cache->get_prefetch_outcomes();
+            std::cout << "Prefetch outcomes (chunks useful/wasted/late, lead p50):\n";
+            for (size_t i = 0; i < NUM_PREDICTION_SOURCES; ++i) {
+                auto source = static_cast<PredictionSource>(i);
+                const auto& o = outcomes.source(source);
+                if (o.inserted.count.load() == 0 && o.late.count.load() == 0) continue;
+
+                std::cout << "  " << to_string(source) << ": "
+                          << o.useful.count.load() << "/" << o.wasted.count.load()
+                          << "/" << o.late.count.load()
+                          << " (" << (o.wasted.bytes.load() / (1024*1024)) << "MB wasted, "
+                          << (o.lead_time_us.percentile(50) / 1000) << "ms lead)\n";
+            }
+
+            auto stalls = ctx->read_stats.stalls.snapshot(3);
+            std::cout << "Reader stalls: " << (stalls.total.stall_us / 1000) << "ms of "
+                      << (stalls.total.read_us / 1000) << "ms in reads blocked on S3 ("
+                      << static_cast<int>(stalls.stall_ratio() * 100) << "% of active time)\n";
+            for (const auto& [pid, totals] : stalls.readers) {
+                std::cout << "  pid " << pid << ": " << (totals.stall_us / 1000) << "ms stalled, "
+                          << totals.misses << "/" << totals.reads << " reads missed, "
+                          << static_cast<int>(totals.stall_ratio() * 100) << "% stall ratio, "
+                          << (static_cast<uint64_t>(totals.throughput_bytes_per_sec()) / (1024*1024))
+                          << "MB/s\n";
+            }
+            for (const auto& [key, totals] : stalls.files) {
+                if (totals.stall_us == 0) break;
+                std::cout << "  " << key << ": " << (totals.stall_us / 1000) << "ms stalled\n";
+            }
+
+            const auto& tar_stats = ctx->tar_indexer->get_stats();
+            std::cout << "Tar Index:\n";
+            std::cout << "  Archives indexed: " << tar_stats.archives_indexed.load() << "\n";
+            std::cout << "  Members indexed: " << tar_stats.members_indexed.load() << "\n";
+            std::cout << "  Invalid archives: " << tar_stats.invalid_archives.load() << "\n";
+
             std::cout << "S3 Downloads:\n";
             std::cout << "  Total: " << worker_stats.total_downloads.load() << "\n";
             std::cout << "  Successful: " << worker_stats.successful_downloads.load() << "\n";
@@ -171,6 +756,31 @@ void destroy(void* private_data) {
             std::cout << "  Prefetches issued: " << predictor_stats.prefetches_issued.load() << "\n";
             std::cout << "  Pattern hits: " << predictor_stats.pattern_hits.load() << "\n";
             std::cout << "  Manifest hits: " << predictor_stats.manifest_hits.load() << "\n";
+            std::cout << "  Markov hits: " << predictor_stats.markov_hits.load() << "\n";
+            std::cout << "  Shuffle hits: " << predictor_stats.shuffle_hits.load()
+                      << " (epoch " << predictor_stats.shuffle_epoch.load()
+                      << ", " << predictor_stats.epoch_rollovers.load() << " rollovers)\n";
+            std::cout << "  Readahead chunks: " << predictor_stats.readahead_issued.load() << "\n";
+            std::cout << "  Tar member chunks: " << predictor_stats.member_readahead_issued.load() << "\n";
+            std::cout << "  Parquet footers: " << predictor_stats.parquet_footers_parsed.load()
+                      << " (" << predictor_stats.parquet_footer_errors.load() << " invalid), "
+                      << predictor_stats.parquet_chunks_issued.load() << " column chunks\n";
+            uint64_t record_prefetches = predictor_stats.record_prefetches.load();
+            std::cout << "  Record prefetches: " << record_prefetches << " from "
+                      << predictor_stats.record_indexes_loaded.load() << " indexes (avg "
+                      << (record_prefetches == 0 ? 0
+                          : predictor_stats.record_prefetch_bytes.load() / record_prefetches / 1024)
+                      << "KB vs " << (DEFAULT_CHUNK_SIZE / 1024) << "KB chunks)\n";
+            std::cout << "  Deferred by budget: " << predictor_stats.prefetches_deferred.load() << "\n";
+            std::cout << "  Window: " << (predictor_stats.window_bytes.load() / (1024*1024)) << "MB, "
+                      << predictor_stats.window_files.load() << " files\n";
+            for (size_t i = 0; i < NUM_PREDICTION_SOURCES; ++i) {
+                auto source = static_cast<PredictionSource>(i);
+                const auto& src = predictor_stats.source(source);
+                std::cout << "  Accuracy (" << to_string(source) << "): "
+                          << src.correct.load() << "/" << src.predicted.load()
+                          << " (" << static_cast<int>(predictor_stats.accuracy(source) * 100) << "%)\n";
+            }
 
             ctx->stop();
         }
@@ -199,28 +809,23 @@ int getattr(const char* path, struct stat* stbuf) {
             return 0;
         }
 
-        // Regular file - assume all non-root paths are files in S3
-        std::string s3_key = path_to_s3_key(path);
+        std::string_view s3_key = path[0] == '/' ? path + 1 : path;
 
-        // Check if we have size metadata
-        {
-            std::shared_lock<std::shared_mutex> lock(ctx->metadata_mutex);
-            auto it = ctx->file_sizes.find(s3_key);
-            if (it != ctx->file_sizes.end()) {
-                stbuf->st_mode = S_IFREG | 0444;  // Read-only
-                stbuf->st_nlink = 1;
-                stbuf->st_size = it->second;
-                return 0;
-            }
+        auto node = VirtualFiles::lookup(s3_key);
+        if (node != VirtualFiles::Node::NONE) {
+            return getattr_virtual(node, stbuf);
         }
 
-        // File not in metadata cache - doesn't exist yet
-        // TODO Phase 6.6: open() callback will populate metadata cache on first access
-        // TODO Future: Add HeadObject request to verify existence in S3
-        return -ENOENT;
+        if (TarIndexer::is_index_key(s3_key)) {
+            return getattr_tar_sidecar(ctx, std::string(s3_key), stbuf);
+        }
+
+        // File or directory: no allocation once the namespace or the
+        // parent directory's listing is cached
+        return getattr_object(ctx, s3_key, stbuf);
 
     } catch (const std::exception& e) {
-        std::cerr << "getattr error: " << e.what() << "\n";
+        Logger::error("fuse", "getattr error: ", e.what());
         return -EIO;
     }
 }
@@ -239,28 +844,23 @@ int getattr(const char* path, struct stat* stbuf, struct fuse_file_info* fi) {
             return 0;
         }
 
-        // Regular file - assume all non-root paths are files in S3
-        std::string s3_key = path_to_s3_key(path);
+        std::string_view s3_key = path[0] == '/' ? path + 1 : path;
 
-        // Check if we have size metadata
-        {
-            std::shared_lock<std::shared_mutex> lock(ctx->metadata_mutex);
-            auto it = ctx->file_sizes.find(s3_key);
-            if (it != ctx->file_sizes.end()) {
-                stbuf->st_mode = S_IFREG | 0444;  // Read-only
-                stbuf->st_nlink = 1;
-                stbuf->st_size = it->second;
-                return 0;
-            }
+        auto node = VirtualFiles::lookup(s3_key);
+        if (node != VirtualFiles::Node::NONE) {
+            return getattr_virtual(node, stbuf);
         }
 
-        // File not in metadata cache - doesn't exist yet
-        // TODO Phase 6.6: open() callback will populate metadata cache on first access
-        // TODO Future: Add HeadObject request to verify existence in S3
-        return -ENOENT;
+        if (TarIndexer::is_index_key(s3_key)) {
+            return getattr_tar_sidecar(ctx, std::string(s3_key), stbuf);
+        }
+
+        // File or directory: no allocation once the namespace or the
+        // parent directory's listing is cached
+        return getattr_object(ctx, s3_key, stbuf);
 
     } catch (const std::exception& e) {
-        std::cerr << "getattr error: " << e.what() << "\n";
+        Logger::error("fuse", "getattr error: ", e.what());
         return -EIO;
     }
 }
@@ -273,70 +873,33 @@ int readdir(const char* path, void* buf, fuse_fill_dir_t filler,
     (void) fi;
 
     try {
-        // Only support root directory listing
-        if (std::strcmp(path, "/") != 0) {
-            return -ENOENT;
+        if (VirtualFiles::lookup(path_to_s3_key(path)) == VirtualFiles::Node::DIR) {
+            filler(buf, ".", NULL, 0);
+            filler(buf, "..", NULL, 0);
+            for (const auto& name : VirtualFiles::entries()) {
+                filler(buf, name.c_str(), NULL, 0);
+            }
+            return 0;
         }
 
         FuseContext* ctx = get_valkyrie_context();
 
-        // Check if refresh needed (with lock)
-        bool needs_refresh = false;
-        {
-            std::lock_guard<std::mutex> lock(ctx->dir_cache_mutex_);
-            needs_refresh = !ctx->dir_cache_.populated || ctx->dir_cache_.is_expired();
+        std::vector<std::string> names;
+        int result = directory_entries(ctx, path_to_s3_key(path), names);
+        if (result != 0) {
+            return result;
         }
 
-        // Call S3 WITHOUT lock
-        if (needs_refresh) {
-            auto* pool = ctx->get_worker_pool();
-            if (!pool) {
-                std::cerr << "readdir: worker pool not available\n";
-                return -EIO;
-            }
-
-            try {
-                auto objects = pool->list_objects();  // No lock held!
-
-                // Update cache (with lock)
-                std::lock_guard<std::mutex> lock(ctx->dir_cache_mutex_);
-
-                // Double-check in case another thread refreshed
-                if (!ctx->dir_cache_.populated || ctx->dir_cache_.is_expired()) {
-                    ctx->dir_cache_.file_list.clear();
-
-                    std::unique_lock<std::shared_mutex> meta_lock(ctx->metadata_mutex);
-                    for (const auto& obj : objects) {
-                        ctx->file_sizes[obj.key] = obj.size;
-                        ctx->dir_cache_.file_list.push_back(obj.key);
-                    }
-                    meta_lock.unlock();
-
-                    ctx->dir_cache_.timestamp = std::chrono::steady_clock::now();
-                    ctx->dir_cache_.populated = true;
-                }
-
-            } catch (const std::exception& e) {
-                std::cerr << "readdir: ListObjects failed: " << e.what() << "\n";
-                return -EIO;
-            }
-        }
-
-        // Return cached results (with lock)
         filler(buf, ".", NULL, 0);
         filler(buf, "..", NULL, 0);
-
-        {
-            std::lock_guard<std::mutex> lock(ctx->dir_cache_mutex_);
-            for (const auto& key : ctx->dir_cache_.file_list) {
-                filler(buf, key.c_str(), NULL, 0);
-            }
+        for (const auto& name : names) {
+            filler(buf, name.c_str(), NULL, 0);
         }
 
         return 0;
 
     } catch (const std::exception& e) {
-        std::cerr << "readdir error: " << e.what() << "\n";
+        Logger::error("fuse", "readdir error: ", e.what());
         return -EIO;
     }
 }
@@ -349,70 +912,33 @@ int readdir(const char* path, void* buf, fuse_fill_dir_t filler,
     (void) flags;
 
     try {
-        // Only support root directory listing
-        if (std::strcmp(path, "/") != 0) {
-            return -ENOENT;
+        if (VirtualFiles::lookup(path_to_s3_key(path)) == VirtualFiles::Node::DIR) {
+            filler(buf, ".", NULL, 0, (fuse_fill_dir_flags)0);
+            filler(buf, "..", NULL, 0, (fuse_fill_dir_flags)0);
+            for (const auto& name : VirtualFiles::entries()) {
+                filler(buf, name.c_str(), NULL, 0, (fuse_fill_dir_flags)0);
+            }
+            return 0;
         }
 
         FuseContext* ctx = get_valkyrie_context();
 
-        // Check if cache needs refresh (with lock)
-        bool needs_refresh = false;
-        {
-            std::lock_guard<std::mutex> lock(ctx->dir_cache_mutex_);
-            needs_refresh = !ctx->dir_cache_.populated || ctx->dir_cache_.is_expired();
+        std::vector<std::string> names;
+        int result = directory_entries(ctx, path_to_s3_key(path), names);
+        if (result != 0) {
+            return result;
         }
 
-        // Refresh from S3 if needed (WITHOUT lock)
-        if (needs_refresh) {
-            auto* pool = ctx->get_worker_pool();
-            if (!pool) {
-                std::cerr << "readdir: worker pool not available\n";
-                return -EIO;
-            }
-
-            try {
-                auto objects = pool->list_objects();
-
-                // Update cache (with lock)
-                std::lock_guard<std::mutex> lock(ctx->dir_cache_mutex_);
-
-                // Double-check in case another thread refreshed
-                if (!ctx->dir_cache_.populated || ctx->dir_cache_.is_expired()) {
-                    ctx->dir_cache_.file_list.clear();
-
-                    std::unique_lock<std::shared_mutex> meta_lock(ctx->metadata_mutex);
-                    for (const auto& obj : objects) {
-                        ctx->file_sizes[obj.key] = obj.size;
-                        ctx->dir_cache_.file_list.push_back(obj.key);
-                    }
-                    meta_lock.unlock();
-
-                    ctx->dir_cache_.timestamp = std::chrono::steady_clock::now();
-                    ctx->dir_cache_.populated = true;
-                }
-
-            } catch (const std::exception& e) {
-                std::cerr << "readdir: ListObjects failed: " << e.what() << "\n";
-                return -EIO;
-            }
-        }
-
-        // Return cached results
         filler(buf, ".", NULL, 0, (fuse_fill_dir_flags)0);
         filler(buf, "..", NULL, 0, (fuse_fill_dir_flags)0);
-
-        {
-            std::lock_guard<std::mutex> lock(ctx->dir_cache_mutex_);
-            for (const auto& key : ctx->dir_cache_.file_list) {
-                filler(buf, key.c_str(), NULL, 0, (fuse_fill_dir_flags)0);
-            }
+        for (const auto& name : names) {
+            filler(buf, name.c_str(), NULL, 0, (fuse_fill_dir_flags)0);
         }
 
         return 0;
 
     } catch (const std::exception& e) {
-        std::cerr << "readdir error: " << e.what() << "\n";
+        Logger::error("fuse", "readdir error: ", e.what());
         return -EIO;
     }
 }
@@ -420,29 +946,58 @@ int readdir(const char* path, void* buf, fuse_fill_dir_t filler,
 
 int open(const char* path, struct fuse_file_info* fi) {
     try {
-        // Only allow read-only access
+        FuseContext* ctx = get_valkyrie_context();
+        std::string s3_key = path_to_s3_key(path);
+
+        // /.valkyrie/ files: snapshot the rendered content for this handle
+        auto node = VirtualFiles::lookup(s3_key);
+        if (node != VirtualFiles::Node::NONE) {
+            if (node == VirtualFiles::Node::DIR) {
+                return -EISDIR;
+            }
+            if (node == VirtualFiles::Node::CONTROL && !may_use_control()) {
+                return -EACCES;
+            }
+            if (node != VirtualFiles::Node::CONTROL && (fi->flags & O_ACCMODE) != O_RDONLY) {
+                return -EROFS;
+            }
+            fi->fh = reinterpret_cast<uint64_t>(new std::string(ctx->virtual_files->render(node)));
+            fi->direct_io = 1;  // Reported size is 0
+            return 0;
+        }
+
+        // Only allow read-only access. The mount is not `ro` (control
+        // accepts writes), so the kernel does not reject these for us.
         if ((fi->flags & O_ACCMODE) != O_RDONLY) {
-            return -EACCES;
+            return -EROFS;
         }
 
-        FuseContext* ctx = get_valkyrie_context();
-        std::string s3_key = path_to_s3_key(path);
+        // Member index sidecar: index the archive now and serve a snapshot
+        if (TarIndexer::is_index_key(s3_key)) {
+            std::string archive = TarIndexer::archive_for_index(s3_key);
+            if (ctx->resolve(archive).type != DirectoryCache::EntryType::FILE) {
+                return -ENOENT;
+            }
+
+            std::string rendered;
+            if (int error = ctx->wait_tar_index(archive, rendered); error != 0) {
+                return error;
+            }
+            fi->fh = reinterpret_cast<uint64_t>(new std::string(std::move(rendered)));
+            fi->direct_io = 1;  // Size may have been reported as 0 before indexing
+            return 0;
+        }
 
         // Notify predictor of file access
         ctx->predictor->on_file_accessed(s3_key);
 
-        // Update metadata cache
-        {
-            std::unique_lock<std::shared_mutex> lock(ctx->metadata_mutex);
-            if (ctx->file_sizes.find(s3_key) == ctx->file_sizes.end()) {
-                // Add with default size (will be updated on first read)
-                ctx->file_sizes[s3_key] = 1024 * 1024 * 1024;  // 1GB default
-            }
+        if (ctx->tracer) {
+            ctx->tracer->record(TraceEventType::OPEN, s3_key, 0, 0);
         }
 
         return 0;
     } catch (const std::exception& e) {
-        std::cerr << "open error: " << e.what() << "\n";
+        Logger::error("fuse", "open error: ", e.what());
         return -EIO;
     }
 }
@@ -450,11 +1005,15 @@ int open(const char* path, struct fuse_file_info* fi) {
 int release(const char* path, struct fuse_file_info* fi) {
     try {
         (void) path;
-        (void) fi;
-        // No cleanup needed for read-only files
+
+        // Sidecar and /.valkyrie/ snapshots are the only per-handle state
+        if (fi && fi->fh != 0) {
+            delete reinterpret_cast<std::string*>(fi->fh);
+            fi->fh = 0;
+        }
         return 0;
     } catch (const std::exception& e) {
-        std::cerr << "release error: " << e.what() << "\n";
+        Logger::error("fuse", "release error: ", e.what());
         return -EIO;
     }
 }
@@ -462,76 +1021,66 @@ int release(const char* path, struct fuse_file_info* fi) {
 int read(const char* path, char* buf, size_t size, off_t offset,
          struct fuse_file_info* fi) {
     try {
-        (void) fi;
-
-        FuseContext* ctx = get_valkyrie_context();
-        std::string s3_key = path_to_s3_key(path);
-
-        // Determine chunk offset
-        size_t chunk_offset = (offset / DEFAULT_CHUNK_SIZE) * DEFAULT_CHUNK_SIZE;
-        size_t offset_in_chunk = offset % DEFAULT_CHUNK_SIZE;
-
-        // Try to get chunk from cache
-        auto chunk_opt = ctx->cache->get_chunk(s3_key, chunk_offset);
-
-        if (!chunk_opt.has_value()) {
-            // CACHE MISS - Block and download with URGENT priority
-            std::cout << "Cache miss: " << s3_key << " at offset " << offset << "\n";
-
-            // Submit URGENT download request
-            auto future = ctx->worker_pool->submit(
-                s3_key, chunk_offset, DEFAULT_CHUNK_SIZE, Priority::URGENT
-            );
-
-            // Wait for download (blocks FUSE thread)
-            bool success = future.get();
-
-            if (!success) {
-                std::cerr << "Failed to download chunk: " << s3_key << " offset " << chunk_offset << "\n";
-                return -EIO;  // I/O error
-            }
-
-            // Retrieve from cache (should be present now)
-            chunk_opt = ctx->cache->get_chunk(s3_key, chunk_offset);
-            if (!chunk_opt.has_value()) {
-                std::cerr << "Chunk missing after download: " << s3_key << "\n";
-                return -EIO;
+        // Member index sidecar or /.valkyrie/ file: serve the snapshot taken at open
+        if (fi && fi->fh != 0) {
+            const auto* snapshot = reinterpret_cast<const std::string*>(fi->fh);
+            if (offset < 0 || static_cast<size_t>(offset) >= snapshot->size()) {
+                return 0;
             }
+            size_t to_copy = std::min(size, snapshot->size() - offset);
+            std::memcpy(buf, snapshot->data() + offset, to_copy);
+            return to_copy;
         }
 
-        // Mark as accessed BEFORE dereferencing to minimize race window
-        // While the chunk data is copied (safe even if evicted), we must ensure
-        // access() is called as close to get_chunk() as possible to maintain
-        // accurate LRU statistics and prevent accessing stale cache entries.
-        ctx->cache->access(s3_key, chunk_offset);
-
-        const auto& chunk = *chunk_opt;
-
-        // Calculate how much to copy from this chunk
-        size_t available = chunk.data.size() - offset_in_chunk;
-        size_t to_copy = std::min(size, available);
+        FuseContext* ctx = get_valkyrie_context();
+        return ctx->read_object(path_to_s3_key(path), buf, size, offset, fuse_get_context()->pid);
+    } catch (const std::exception& e) {
+        Logger::error("fuse", "read error: ", e.what());
+        return -EIO;
+    }
+}
 
-        // Copy data to FUSE buffer
-        std::memcpy(buf, chunk.data.data() + offset_in_chunk, to_copy);
+int write(const char* path, const char* buf, size_t size, off_t offset,
+          struct fuse_file_info* fi) {
+    (void) offset;  // Each write is a batch of command lines
+    (void) fi;
 
-        // If we need more data (crossing chunk boundary), recursively read next chunk
-        if (to_copy < size) {
-            // Read from next chunk
-            int bytes_read = read(path, buf + to_copy, size - to_copy,
-                                 offset + to_copy, fi);
-            if (bytes_read < 0) {
-                return bytes_read;  // Propagate error
-            }
-            to_copy += bytes_read;
+    try {
+        FuseContext* ctx = get_valkyrie_context();
+        if (VirtualFiles::lookup(path_to_s3_key(path)) != VirtualFiles::Node::CONTROL) {
+            return -EROFS;
+        }
+        if (!may_use_control()) {
+            return -EACCES;
         }
 
-        return to_copy;
+        if (!ctx->virtual_files->write_control(std::string(buf, size))) {
+            return -EINVAL;  // Responses (with the reason) read back from control
+        }
+        return static_cast<int>(size);
     } catch (const std::exception& e) {
-        std::cerr << "read error: " << e.what() << "\n";
+        Logger::error("fuse", "write error: ", e.what());
         return -EIO;
     }
 }
 
+// Only the control file accepts O_TRUNC (e.g. `echo evict KEY > control`)
+#ifdef __APPLE__
+int truncate(const char* path, off_t size) {
+#else
+int truncate(const char* path, off_t size, struct fuse_file_info* fi) {
+    (void) fi;
+#endif
+    (void) size;
+    if (VirtualFiles::lookup(path_to_s3_key(path)) != VirtualFiles::Node::CONTROL) {
+        return -EROFS;
+    }
+    if (!may_use_control()) {
+        return -EACCES;
+    }
+    return 0;
+}
+
 }  // namespace fuse_ops
 
 }  // namespace valkyrie
@@ -13,47 +13,82 @@
 #include "cache_manager.hpp"
 #include "s3_worker_pool.hpp"
 #include "predictor.hpp"
+#include "control_server.hpp"
+#include "metrics_server.hpp"
+#include "read_stats.hpp"
+#include "tar_index.hpp"
+#include "record_index.hpp"
+#include "tracer.hpp"
+#include "virtual_files.hpp"
+#include "simulated_backend.hpp"
+#include "directory_cache.hpp"
 
 #include <memory>
 #include <string>
+#include <optional>
 #include <unordered_map>
-#include <shared_mutex>
+#include <string_view>
 #include <atomic>
 #include <chrono>
 #include <vector>
 #include <mutex>
+#include <thread>
 
 namespace valkyrie {
 
-// Directory listing cache with TTL expiration
-struct DirectoryCache {
-    std::vector<std::string> file_list;  // Cached S3 keys (without prefix)
-    std::chrono::steady_clock::time_point timestamp{};  // Initialize to epoch
-    bool populated = false;
-
-    bool is_expired(std::chrono::seconds ttl = std::chrono::seconds(300)) const {
-        if (!populated) return true;  // Unpopulated cache is always expired
-        auto now = std::chrono::steady_clock::now();
-        auto age = std::chrono::duration_cast<std::chrono::seconds>(now - timestamp);
-        return age >= ttl;  // Use >= for correct TTL boundary
-    }
-};
-
 // Global context passed to FUSE callbacks
 struct FuseContext {
+    // --mock-s3 object store; declared first so it outlives the worker pool
+    std::unordered_map<std::string, size_t> mock_object_sizes;
+    std::unique_ptr<SimulatedBackend> mock_store;  // Null unless --mock-s3
+
     std::unique_ptr<CacheManager> cache;
     std::unique_ptr<S3WorkerPool> worker_pool;
     std::unique_ptr<Predictor> predictor;
+    std::unique_ptr<ControlServer> control_server;
+    std::unique_ptr<MetricsServer> metrics_server;
+    std::unique_ptr<VirtualFiles> virtual_files;       // The /.valkyrie/ directory
+    std::unique_ptr<TarIndexer> tar_indexer;
+    std::unique_ptr<RecordIndexStore> record_indexes;  // Null unless --record-index
+    std::unique_ptr<Tracer> tracer;                    // Null unless --enable-tracing
 
     Config config;
+    ReadStats read_stats;
+
+    // Per-directory listings, filled on first access
+    std::unique_ptr<DirectoryCache> directories;
+
+    // Whole-namespace metadata (--inventory, a manifest with sizes,
+    // --metadata-snapshot, --list-bucket); null until loaded. Once set,
+    // paths are resolved from it alone, with no S3 requests.
+    std::shared_ptr<const MetadataStore> get_metadata() const;
+    void set_metadata(std::shared_ptr<const MetadataStore> store);
+
+    // File or directory at `s3_key`: from the namespace if built, else from
+    // its parent directory's listing (listed now if needed)
+    DirectoryCache::Entry resolve(std::string_view s3_key);
+
+    // Size of an object already known, without listing anything
+    std::optional<size_t> known_size(std::string_view s3_key) const;
+
+    // Up to `size` bytes of an object from the cache, downloading on a
+    // miss; 0 at the end of the object, -EIO on failure. `pid` is the reader.
+    int read_object(const std::string& s3_key, char* buf, size_t size, off_t offset, pid_t pid);
+
+    // Queue the next header-bearing chunk of a requested archive at NORMAL
+    // priority, feeding the indexer from the cache first. The chunk listener
+    // calls back after each download, so the index completes in the
+    // background; never blocks on S3.
+    void index_tar_archive(const std::string& archive);
 
-    // File metadata cache (s3_key -> size)
-    std::unordered_map<std::string, size_t> file_sizes;
-    mutable std::shared_mutex metadata_mutex;
+    // Member index of `archive` for its sidecar: indexed in the background
+    // (above) while this waits up to TAR_INDEX_OPEN_TIMEOUT, re-queueing a
+    // failed download every TAR_INDEX_POLL. 0, -EIO if it is not a tar
+    // archive, or -ETIMEDOUT (indexing goes on; a later open finds it).
+    int wait_tar_index(const std::string& archive, std::string& rendered);
 
-    // Directory listing cache
-    DirectoryCache dir_cache_;
-    std::mutex dir_cache_mutex_;
+    static constexpr std::chrono::seconds TAR_INDEX_OPEN_TIMEOUT{60};
+    static constexpr std::chrono::milliseconds TAR_INDEX_POLL{200};
 
     FuseContext(const Config& cfg);
     ~FuseContext();
@@ -73,7 +108,28 @@ struct FuseContext {
     }
 
 private:
+    // --list-bucket: full parallel listing, swapped in as the namespace and
+    // written to --metadata-snapshot if it changed
+    void list_bucket();
+
+    // Namespace from --inventory or a manifest with a size on every entry;
+    // false if neither applies
+    bool load_fixed_namespace();
+
+    // Bucket and prefix a snapshot must have been taken of
+    std::string snapshot_source() const;
+
+    // One piece of read_object(): up to `size` bytes from the chunk covering
+    // `offset`, downloading it on a miss. Adds the wait to `stall_us` and
+    // clears `hit` on a miss; 0 at the end of the object, -EIO on failure.
+    int read_chunk(const std::string& s3_key, char* buf, size_t size, off_t offset,
+                   uint64_t& stall_us, bool& hit);
+
     std::atomic<bool> is_started{false};
+    std::thread bucket_lister_;
+
+    std::shared_ptr<const MetadataStore> metadata_;
+    mutable std::mutex metadata_mutex_;  // Guards the pointer only
 };
 
 // FUSE operation callbacks
@@ -105,6 +161,15 @@ int read(const char* path, char* buf, size_t size, off_t offset,
 
 int release(const char* path, struct fuse_file_info* fi);
 
+// Only /.valkyrie/control is writable
+int write(const char* path, const char* buf, size_t size, off_t offset,
+          struct fuse_file_info* fi);
+#ifdef __APPLE__
+int truncate(const char* path, off_t size);
+#else
+int truncate(const char* path, off_t size, struct fuse_file_info* fi);
+#endif
+
 }  // namespace fuse_ops
 
 // Helper to get FuseContext from fuse_get_context()
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "sharded_counter.hpp"
+
+namespace valkyrie {
+
+// Lock-free log-linear histogram over uint64 values (typically microseconds).
+// Each power-of-two range is split into SUB_BUCKETS linear buckets, giving a
+// bounded relative error (25% with 4 sub-buckets) over the full uint64 range.
+// record() is three relaxed fetch_adds on the calling thread's own shard
+// (buckets, as ShardedCounter does for count and sum), so concurrent readers
+// and workers never share a cache line; queries sum the shards.
+class LogLinearHistogram {
+public:
+    static constexpr int SUB_BUCKET_BITS = 2;
+    static constexpr size_t SUB_BUCKETS = 1u << SUB_BUCKET_BITS;
+    static constexpr size_t NUM_BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    // Fewer than ShardedCounter: each shard holds every bucket
+    static constexpr size_t NUM_SHARDS = 8;
+
+    void record(uint64_t value) {
+        shards_[ShardedCounter::shard_index() % NUM_SHARDS].buckets[bucket_index(value)]
+            .fetch_add(1, std::memory_order_relaxed);
+        count_.add(1);
+        sum_.add(value);
+    }
+
+    uint64_t count() const { return count_.load(); }
+    uint64_t sum() const { return sum_.load(); }
+
+    uint64_t bucket_count(size_t index) const {
+        uint64_t total = 0;
+        for (const auto& shard : shards_) {
+            total += shard.buckets[index].load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    // Smallest value that maps to bucket `index`
+    static uint64_t bucket_lower_bound(size_t index) {
+        if (index < SUB_BUCKETS) return index;
+        size_t group = index / SUB_BUCKETS;
+        uint64_t sub = index % SUB_BUCKETS;
+        return (SUB_BUCKETS + sub) << (group - 1);
+    }
+
+    // Largest value that maps to bucket `index` (inclusive)
+    static uint64_t bucket_upper_bound(size_t index) {
+        return index + 1 < NUM_BUCKETS ? bucket_lower_bound(index + 1) - 1 : UINT64_MAX;
+    }
+
+    static size_t bucket_index(uint64_t value) {
+        if (value < SUB_BUCKETS) return static_cast<size_t>(value);
+        int msb = 63 - __builtin_clzll(value);
+        int shift = msb - SUB_BUCKET_BITS;
+        size_t sub = static_cast<size_t>(value >> shift) & (SUB_BUCKETS - 1);
+        return static_cast<size_t>(shift + 1) * SUB_BUCKETS + sub;
+    }
+
+    // Upper bound of the bucket holding the p-th percentile (0 < p <= 100)
+    uint64_t percentile(double p) const {
+        uint64_t total = count();
+        if (total == 0) return 0;
+
+        uint64_t rank = static_cast<uint64_t>(total * p / 100.0);
+        if (rank == 0) rank = 1;
+
+        uint64_t seen = 0;
+        for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+            seen += bucket_count(i);
+            if (seen >= rank) return bucket_upper_bound(i);
+        }
+        return bucket_upper_bound(NUM_BUCKETS - 1);
+    }
+
+private:
+    struct alignas(64) Shard {
+        std::array<std::atomic<uint64_t>, NUM_BUCKETS> buckets{};
+    };
+
+    std::array<Shard, NUM_SHARDS> shards_{};
+    ShardedCounter count_;
+    ShardedCounter sum_;
+};
+
+}  // namespace valkyrie
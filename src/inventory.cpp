@@ -0,0 +1,205 @@
+#include "inventory.hpp"
+
+#include <algorithm>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace valkyrie {
+
+namespace {
+
+int hex_digit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+}  // namespace
+
+InventoryReader::InventoryReader(const std::string& schema, const std::string& bucket,
+                                 const std::string& prefix)
+    : bucket_(bucket), key_prefix_(prefix.empty() ? "" : prefix + "/") {
+    std::istringstream fields(schema);
+    std::string field;
+    int column = 0;
+    while (std::getline(fields, field, ',')) {
+        field.erase(0, field.find_first_not_of(" \t"));
+        field.erase(field.find_last_not_of(" \t") + 1);
+
+        if (field == "Bucket") bucket_column_ = column;
+        else if (field == "Key") key_column_ = column;
+        else if (field == "Size") size_column_ = column;
+        else if (field == "LastModifiedDate") mtime_column_ = column;
+        else if (field == "ETag") etag_column_ = column;
+        else if (field == "IsLatest") latest_column_ = column;
+        else if (field == "IsDeleteMarker") delete_marker_column_ = column;
+        ++column;
+    }
+    columns_ = static_cast<size_t>(column);
+}
+
+bool InventoryReader::load(const std::string& path, std::vector<ObjectInfo>& objects) {
+    namespace fs = std::filesystem;
+    size_t loaded_before = objects.size();
+    std::error_code ec;
+    if (!fs::is_directory(path, ec)) {
+        if (!load_file(path, objects)) return false;
+    } else {
+        // Report data files, in a stable order
+        std::vector<std::string> files;
+        size_t compressed = 0;
+        for (const auto& entry : fs::directory_iterator(path, ec)) {
+            if (!entry.is_regular_file()) continue;
+            if (entry.path().extension() == ".csv") {
+                files.push_back(entry.path().string());
+            } else if (entry.path().extension() == ".gz") {
+                ++compressed;
+            }
+        }
+        if (ec) {
+            std::cerr << "Inventory: Failed to read directory " << path << "\n";
+            return false;
+        }
+        if (files.empty()) {
+            std::cerr << "Inventory: No *.csv data files in " << path;
+            if (compressed > 0) {
+                std::cerr << " (" << compressed << " *.csv.gz files: decompress them first)";
+            }
+            std::cerr << "\n";
+            return false;
+        }
+        std::sort(files.begin(), files.end());
+
+        for (const auto& file : files) {
+            if (!load_file(file, objects)) return false;
+        }
+    }
+
+    // An empty namespace would fail every lookup with ENOENT
+    if (objects.size() == loaded_before) {
+        std::cerr << "Inventory: No objects of bucket '" << bucket_ << "' under '" << key_prefix_
+                  << "' in " << path << "\n";
+        return false;
+    }
+    return true;
+}
+
+bool InventoryReader::load_file(const std::string& path, std::vector<ObjectInfo>& objects) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Inventory: Failed to open " << path << "\n";
+        return false;
+    }
+
+    std::string line;
+    std::vector<std::string> fields;
+    size_t line_number = 0;
+    while (std::getline(file, line)) {
+        ++line_number;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty()) continue;
+
+        if (!split_row(line, fields) || fields.size() != columns_) {
+            std::cerr << "Inventory: Malformed row at " << path << ":" << line_number
+                      << " (expected " << columns_ << " fields)\n";
+            return false;
+        }
+
+        if (bucket_column_ >= 0 && !bucket_.empty() && fields[bucket_column_] != bucket_) continue;
+        if (latest_column_ >= 0 && fields[latest_column_] != "true") continue;
+        if (delete_marker_column_ >= 0 && fields[delete_marker_column_] == "true") continue;
+
+        std::string key;
+        if (!url_decode(fields[key_column_], key)) {
+            std::cerr << "Inventory: Malformed key at " << path << ":" << line_number << "\n";
+            return false;
+        }
+        if (key.size() <= key_prefix_.size() || key.compare(0, key_prefix_.size(), key_prefix_) != 0) {
+            continue;  // Outside the mounted prefix, or its "prefix/" marker
+        }
+
+        ObjectInfo obj{key.substr(key_prefix_.size()), 0};
+        try {
+            obj.size = static_cast<size_t>(std::stoull(fields[size_column_]));
+        } catch (const std::exception&) {
+            std::cerr << "Inventory: Malformed size at " << path << ":" << line_number << "\n";
+            return false;
+        }
+        if (mtime_column_ >= 0) obj.mtime = parse_timestamp(fields[mtime_column_]);
+        if (etag_column_ >= 0 && !fields[etag_column_].empty()) {
+            obj.etag = "\"" + fields[etag_column_] + "\"";  // Quoted, as S3 returns it
+        }
+        objects.push_back(std::move(obj));
+    }
+    return true;
+}
+
+bool InventoryReader::split_row(const std::string& line, std::vector<std::string>& fields) {
+    fields.clear();
+    std::string field;
+    size_t i = 0;
+    while (true) {
+        field.clear();
+        if (i < line.size() && line[i] == '"') {
+            // Quoted: up to the closing quote, "" is a literal quote
+            for (++i;; ++i) {
+                if (i >= line.size()) return false;  // Unterminated
+                if (line[i] == '"') {
+                    if (i + 1 < line.size() && line[i + 1] == '"') {
+                        field += '"';
+                        ++i;
+                    } else {
+                        ++i;
+                        break;
+                    }
+                } else {
+                    field += line[i];
+                }
+            }
+            if (i < line.size() && line[i] != ',') return false;
+        } else {
+            size_t comma = line.find(',', i);
+            field = line.substr(i, comma == std::string::npos ? std::string::npos : comma - i);
+            i = comma == std::string::npos ? line.size() : comma;
+        }
+        fields.push_back(field);
+        if (i >= line.size()) return true;
+        ++i;  // Past the comma
+    }
+}
+
+bool InventoryReader::url_decode(const std::string& encoded, std::string& decoded) {
+    decoded.clear();
+    decoded.reserve(encoded.size());
+    for (size_t i = 0; i < encoded.size(); ++i) {
+        char c = encoded[i];
+        if (c == '+') {
+            decoded += ' ';
+        } else if (c == '%') {
+            if (i + 2 >= encoded.size()) return false;
+            int high = hex_digit(encoded[i + 1]);
+            int low = hex_digit(encoded[i + 2]);
+            if (high < 0 || low < 0) return false;
+            decoded += static_cast<char>(high * 16 + low);
+            i += 2;
+        } else {
+            decoded += c;
+        }
+    }
+    return true;
+}
+
+int64_t InventoryReader::parse_timestamp(const std::string& value) {
+    std::tm tm{};
+    std::istringstream in(value);
+    in >> std::get_time(&tm, "%Y-%m-%dT%H:%M:%S");
+    if (in.fail()) return 0;
+    return static_cast<int64_t>(timegm(&tm));
+}
+
+}  // namespace valkyrie
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <string>
+#include <vector>
+
+namespace valkyrie {
+
+// S3 Inventory report in CSV format (decompressed). Rows are quoted
+// fields in the order of the report's fileSchema; keys are URL-encoded.
+class InventoryReader {
+public:
+    // `schema` as in the report's manifest.json, e.g.
+    // "Bucket, Key, VersionId, IsLatest, IsDeleteMarker, Size, ETag"
+    InventoryReader(const std::string& schema, const std::string& bucket, const std::string& prefix);
+
+    // False if the schema has no Key or Size field
+    bool valid() const { return key_column_ >= 0 && size_column_ >= 0; }
+
+    // Append the objects of `bucket` under `prefix`, keyed relative to the
+    // prefix. `path` is one CSV file or a directory of them (*.csv).
+    // Returns false if a file cannot be read, a row is malformed, or no
+    // objects were found (e.g. a directory of *.csv.gz files only).
+    bool load(const std::string& path, std::vector<ObjectInfo>& objects);
+
+    // Split one CSV row: comma-separated, optionally double-quoted with "" escapes
+    static bool split_row(const std::string& line, std::vector<std::string>& fields);
+
+    // "%2F" and '+' decoding as used for inventory keys
+    static bool url_decode(const std::string& encoded, std::string& decoded);
+
+    // "2024-03-01T12:00:00.000Z" -> seconds since the epoch (0 if malformed)
+    static int64_t parse_timestamp(const std::string& value);
+
+private:
+    bool load_file(const std::string& path, std::vector<ObjectInfo>& objects);
+
+    std::string bucket_;
+    std::string key_prefix_;  // prefix + "/", or "" for the whole bucket
+    int bucket_column_ = -1;
+    int key_column_ = -1;
+    int size_column_ = -1;
+    int mtime_column_ = -1;
+    int etag_column_ = -1;
+    int latest_column_ = -1;        // IsLatest (versioned reports)
+    int delete_marker_column_ = -1; // IsDeleteMarker (versioned reports)
+    size_t columns_ = 0;
+};
+
+}  // namespace valkyrie
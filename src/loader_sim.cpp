@@ -0,0 +1,211 @@
+#include "loader_sim.hpp"
+#include "shuffle.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace valkyrie {
+
+namespace {
+
+constexpr size_t RANDOM_ALIGNMENT = 4096;
+
+uint64_t now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void read_whole_file(std::vector<LoaderRead>& plan, uint32_t file, size_t file_size,
+                     size_t read_size) {
+    for (size_t offset = 0; offset < file_size; offset += read_size) {
+        plan.push_back({file, offset,
+                        static_cast<uint32_t>(std::min(read_size, file_size - offset))});
+    }
+}
+
+}  // namespace
+
+std::optional<LoadPattern> parse_load_pattern(const std::string& name) {
+    if (name == "sequential") return LoadPattern::SEQUENTIAL;
+    if (name == "shuffled") return LoadPattern::SHUFFLED;
+    if (name == "ddp") return LoadPattern::DDP;
+    if (name == "random") return LoadPattern::RANDOM;
+    return std::nullopt;
+}
+
+const char* to_string(LoadPattern pattern) {
+    switch (pattern) {
+        case LoadPattern::SEQUENTIAL: return "sequential";
+        case LoadPattern::SHUFFLED: return "shuffled";
+        case LoadPattern::DDP: return "ddp";
+        case LoadPattern::RANDOM: return "random";
+    }
+    return "unknown";
+}
+
+std::vector<LoaderRead> plan_loader_reads(const LoaderOptions& options,
+                                          const std::vector<size_t>& file_sizes,
+                                          int rank) {
+    std::vector<LoaderRead> plan;
+    size_t processes = static_cast<size_t>(std::max(options.processes, 1));
+    size_t read_size = std::max<size_t>(options.read_size, 1);
+    size_t num_files = file_sizes.size();
+    if (num_files == 0 || rank < 0 || static_cast<size_t>(rank) >= processes) {
+        return plan;
+    }
+
+    for (int epoch = 0; epoch < options.epochs; ++epoch) {
+        switch (options.pattern) {
+            case LoadPattern::SEQUENTIAL:
+                for (size_t file = rank; file < num_files; file += processes) {
+                    read_whole_file(plan, static_cast<uint32_t>(file), file_sizes[file], read_size);
+                }
+                break;
+
+            case LoadPattern::SHUFFLED: {
+                auto order = shuffled_order(num_files, options.seed, epoch);
+                for (size_t pos = rank; pos < num_files; pos += processes) {
+                    read_whole_file(plan, order[pos], file_sizes[order[pos]], read_size);
+                }
+                break;
+            }
+
+            case LoadPattern::DDP: {
+                // Records numbered across the epoch's file order; rank r takes every Nth
+                auto order = shuffled_order(num_files, options.seed, epoch);
+                size_t record = 0;
+                for (uint32_t file : order) {
+                    for (size_t offset = 0; offset < file_sizes[file]; offset += read_size, ++record) {
+                        if (record % processes == static_cast<size_t>(rank)) {
+                            plan.push_back({file, offset, static_cast<uint32_t>(
+                                std::min(read_size, file_sizes[file] - offset))});
+                        }
+                    }
+                }
+                break;
+            }
+
+            case LoadPattern::RANDOM: {
+                Pcg32 rng(options.seed + epoch, static_cast<uint64_t>(rank));
+                for (size_t i = 0; i < options.random_reads; ++i) {
+                    uint32_t file = rng.bounded(static_cast<uint32_t>(num_files));
+                    size_t file_size = file_sizes[file];
+                    if (file_size == 0) continue;
+
+                    size_t blocks = file_size > read_size
+                        ? (file_size - read_size) / RANDOM_ALIGNMENT + 1 : 1;
+                    blocks = std::min<size_t>(blocks, UINT32_MAX);
+                    size_t offset = rng.bounded(static_cast<uint32_t>(blocks)) * RANDOM_ALIGNMENT;
+                    plan.push_back({file, offset, static_cast<uint32_t>(
+                        std::min(read_size, file_size - offset))});
+                }
+                break;
+            }
+        }
+    }
+    return plan;
+}
+
+void LoaderResult::record_read(uint64_t latency_us, size_t bytes_read) {
+    reads++;
+    bytes += bytes_read;
+    max_latency_us = std::max(max_latency_us, latency_us);
+    latency_buckets[LogLinearHistogram::bucket_index(latency_us)]++;
+}
+
+void LoaderResult::merge(const LoaderResult& other) {
+    reads += other.reads;
+    bytes += other.bytes;
+    errors += other.errors;
+    io_us += other.io_us;
+    wall_us = std::max(wall_us, other.wall_us);
+    max_latency_us = std::max(max_latency_us, other.max_latency_us);
+    for (size_t i = 0; i < latency_buckets.size(); ++i) {
+        latency_buckets[i] += other.latency_buckets[i];
+    }
+}
+
+uint64_t LoaderResult::latency_percentile(double p) const {
+    if (reads == 0) return 0;
+
+    uint64_t rank = static_cast<uint64_t>(reads * p / 100.0);
+    if (rank == 0) rank = 1;
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < latency_buckets.size(); ++i) {
+        seen += latency_buckets[i];
+        if (seen >= rank) {
+            return std::min(LogLinearHistogram::bucket_upper_bound(i), max_latency_us);
+        }
+    }
+    return max_latency_us;
+}
+
+double LoaderResult::io_fraction(int processes) const {
+    double total_us = static_cast<double>(wall_us) * std::max(processes, 1);
+    return total_us == 0 ? 0.0 : std::min(1.0, io_us / total_us);
+}
+
+bool run_loader(const std::string& root,
+                const std::vector<std::string>& files,
+                const std::vector<LoaderRead>& plan,
+                uint64_t compute_us_per_mb,
+                bool keep_page_cache,
+                LoaderResult& result) {
+    uint64_t start_us = now_us();
+    std::vector<char> buffer;
+    int fd = -1;
+    uint32_t current = UINT32_MAX;
+
+    auto close_current = [&] {
+        if (fd < 0) return;
+#ifdef POSIX_FADV_DONTNEED
+        if (!keep_page_cache) {
+            posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        }
+#endif
+        close(fd);
+        fd = -1;
+    };
+
+    for (const auto& read : plan) {
+        uint64_t read_start = now_us();
+
+        if (read.file != current) {
+            close_current();
+            current = read.file;
+            fd = open((root + "/" + files.at(read.file)).c_str(), O_RDONLY);
+            if (fd < 0) {
+                result.errors++;
+                current = UINT32_MAX;
+                continue;
+            }
+        }
+
+        buffer.resize(read.size);
+        ssize_t n = pread(fd, buffer.data(), read.size, static_cast<off_t>(read.offset));
+        uint64_t latency_us = now_us() - read_start;
+        result.io_us += latency_us;
+        if (n < 0) {
+            result.errors++;
+            continue;
+        }
+        result.record_read(latency_us, static_cast<size_t>(n));
+
+        // Model the training step that consumes the batch
+        if (compute_us_per_mb > 0 && n > 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(
+                static_cast<uint64_t>(n) * compute_us_per_mb / (1024 * 1024)));
+        }
+    }
+    close_current();
+
+    result.wall_us = now_us() - start_us;
+    return result.errors == 0;
+}
+
+}  // namespace valkyrie
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "histogram.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace valkyrie {
+
+// Access patterns of common training-data loaders
+enum class LoadPattern {
+    SEQUENTIAL,  // Shards dealt round-robin to processes, each read front to back
+    SHUFFLED,    // Shard order reshuffled every epoch, then dealt round-robin
+    DDP,         // DistributedSampler-style: rank r reads records r, r+N, r+2N, ...
+    RANDOM,      // Small reads at random offsets of random files
+};
+
+std::optional<LoadPattern> parse_load_pattern(const std::string& name);
+const char* to_string(LoadPattern pattern);
+
+struct LoaderOptions {
+    LoadPattern pattern = LoadPattern::SEQUENTIAL;
+    int processes = 4;
+    int epochs = 1;
+    size_t read_size = 1024 * 1024;  // Bytes per read() (DDP: the record size)
+    size_t random_reads = 2000;      // Per process per epoch (RANDOM)
+    uint64_t seed = 1;               // SHUFFLED/DDP epoch order, RANDOM offsets
+};
+
+// One read() a loader process issues
+struct LoaderRead {
+    uint32_t file;     // Index into the file list
+    uint64_t offset;
+    uint32_t size;
+};
+
+// Every read process `rank` issues over all epochs, in order. File order
+// per epoch is shuffled_order(files, seed, epoch), as a "#@shuffle" manifest
+// would declare it.
+std::vector<LoaderRead> plan_loader_reads(const LoaderOptions& options,
+                                          const std::vector<size_t>& file_sizes,
+                                          int rank);
+
+// What one or more loader processes saw. Trivially copyable, so a forked
+// loader can hand it to its parent through a pipe.
+struct LoaderResult {
+    uint64_t reads = 0;
+    uint64_t bytes = 0;
+    uint64_t errors = 0;          // Failed open() or read()
+    uint64_t io_us = 0;           // Time inside open() and read()
+    uint64_t wall_us = 0;         // Loader lifetime (merged: longest loader)
+    uint64_t max_latency_us = 0;
+    std::array<uint64_t, LogLinearHistogram::NUM_BUCKETS> latency_buckets{};
+
+    void record_read(uint64_t latency_us, size_t bytes_read);
+    void merge(const LoaderResult& other);
+
+    // Upper bound of the bucket holding the p-th percentile read latency
+    uint64_t latency_percentile(double p) const;
+
+    // Fraction of loader time spent waiting on I/O rather than "computing"
+    double io_fraction(int processes) const;
+};
+
+// Execute `plan` against files under `root`, sleeping compute_us_per_mb per
+// MiB delivered to model a training step. Unless keep_page_cache, each file's
+// pages are dropped when the loader moves on, so later epochs reach the
+// filesystem instead of the kernel page cache. False if any read failed.
+bool run_loader(const std::string& root,
+                const std::vector<std::string>& files,
+                const std::vector<LoaderRead>& plan,
+                uint64_t compute_us_per_mb,
+                bool keep_page_cache,
+                LoaderResult& result);
+
+}  // namespace valkyrie
@@ -1,43 +1,292 @@
 #include "logger.hpp"
-#include <iomanip>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 
 namespace valkyrie {
 
-void Logger::log(LogLevel level, const std::string& component, const std::string& message) {
-    static std::mutex log_mutex;
-    std::lock_guard<std::mutex> lock(log_mutex);
+std::atomic<int> Logger::min_level_{static_cast<int>(LogLevel::INFO)};
+std::atomic<uint32_t> Logger::rate_limit_{Logger::DEFAULT_RATE_LIMIT};
 
-    std::cout << get_timestamp() << " "
-              << "[" << level_to_string(level) << "] "
-              << component << ": "
-              << message << "\n";
+namespace {
+
+constexpr size_t RING_CAPACITY = 256;     // Records per thread (power of two)
+constexpr size_t RATE_SLOTS = 1024;       // Call sites hash into these
+constexpr std::chrono::milliseconds FLUSH_INTERVAL{50};
+
+// Single-producer (owning thread) / single-consumer (flusher) ring
+struct ThreadRing {
+    std::vector<LogRecord> records{RING_CAPACITY};
+    alignas(64) std::atomic<uint64_t> head{0};   // Written by the producer
+    alignas(64) std::atomic<uint64_t> tail{0};   // Written by the flusher
+
+    // Set when the owning thread exits; the flusher drains the ring once
+    // more and keeps it for reuse by the next new thread
+    std::atomic<bool> retired{false};
+};
+
+// Lines admitted in the current one-second window, per call site
+struct RateSlot {
+    std::atomic<uint64_t> window{0};
+    std::atomic<uint32_t> count{0};
+    std::atomic<uint32_t> suppressed{0};
+};
+
+struct LoggerState {
+    // Rings of live threads (and exited ones until drained), and drained
+    // rings for reuse; only registration and the flusher take the lock
+    std::vector<std::unique_ptr<ThreadRing>> rings;
+    std::vector<std::unique_ptr<ThreadRing>> free_rings;
+    std::mutex rings_mutex;
+
+    std::array<RateSlot, RATE_SLOTS> rate_slots;
+    std::atomic<uint64_t> dropped{0};
+
+    std::thread flusher;
+    std::atomic<bool> running{false};
+    std::atomic<bool> stop_flag{false};
+    std::mutex lifecycle_mutex;
+
+    // Serializes writers (flusher, synchronous fallback) and the fields below
+    std::mutex write_mutex;
+    uint64_t dropped_reported = 0;
+    int64_t cached_second = -1;
+    char cached_time[32] = {};
+};
+
+// Never destroyed: threads may still log during static destruction
+LoggerState& state() {
+    static LoggerState* instance = new LoggerState();
+    return *instance;
 }
 
-const char* Logger::level_to_string(LogLevel level) {
+const char* level_to_string(LogLevel level) {
     switch (level) {
         case LogLevel::DEBUG: return "DEBUG";
         case LogLevel::INFO: return "INFO";
         case LogLevel::WARN: return "WARN";
         case LogLevel::ERROR: return "ERROR";
-        default: return "UNKNOWN";
     }
+    return "UNKNOWN";
+}
+
+// Caller holds write_mutex
+void write_record(LoggerState& s, const LogRecord& record) {
+    // localtime_r is the expensive part; lines mostly share a second
+    int64_t second = record.timestamp_us / 1000000;
+    if (second != s.cached_second) {
+        std::time_t t = static_cast<std::time_t>(second);
+        std::tm tm_buf;
+        localtime_r(&t, &tm_buf);
+        std::strftime(s.cached_time, sizeof(s.cached_time), "%Y-%m-%d %H:%M:%S", &tm_buf);
+        s.cached_second = second;
+    }
+
+    char millis[8];
+    std::snprintf(millis, sizeof(millis), ".%03d",
+                  static_cast<int>(record.timestamp_us / 1000 % 1000));
+
+    std::string line;
+    line.reserve(64 + record.length);
+    line.append(s.cached_time).append(millis).append(" [")
+        .append(level_to_string(record.level)).append("] ")
+        .append(record.component).append(": ")
+        .append(record.text, record.length);
+    if (record.suppressed > 0) {
+        line.append(" (").append(std::to_string(record.suppressed))
+            .append(" similar lines suppressed)");
+    }
+    line.push_back('\n');
+
+    std::ostream& out = record.level >= LogLevel::WARN ? std::cerr : std::cout;
+    out.write(line.data(), static_cast<std::streamsize>(line.size()));
+}
+
+// nullptr once the thread's thread_locals are being destroyed
+ThreadRing* ring_for_this_thread(LoggerState& s) {
+    // Trivially destructible, so still readable after the owner is destroyed
+    thread_local ThreadRing* ring = nullptr;
+    thread_local bool exited = false;
+
+    // Retires the ring at thread exit (the state, and so the ring, is never destroyed)
+    struct Owner {
+        ~Owner() {
+            if (ring) ring->retired.store(true, std::memory_order_release);
+            ring = nullptr;
+            exited = true;
+        }
+    };
+    thread_local Owner owner;
+    (void) owner;
+
+    if (!ring && !exited) {
+        std::lock_guard<std::mutex> lock(s.rings_mutex);
+        if (s.free_rings.empty()) {
+            s.rings.push_back(std::make_unique<ThreadRing>());
+        } else {
+            s.rings.push_back(std::move(s.free_rings.back()));
+            s.free_rings.pop_back();
+            s.rings.back()->retired.store(false, std::memory_order_relaxed);
+        }
+        ring = s.rings.back().get();
+    }
+    return ring;
+}
+
+// Write everything queued so far, in timestamp order across threads
+void drain(LoggerState& s) {
+    std::vector<LogRecord> batch;
+    {
+        std::lock_guard<std::mutex> lock(s.rings_mutex);
+        for (auto it = s.rings.begin(); it != s.rings.end();) {
+            ThreadRing& ring = **it;
+            // Read before head: a retired ring has published all its records
+            bool retired = ring.retired.load(std::memory_order_acquire);
+            uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+            uint64_t head = ring.head.load(std::memory_order_acquire);
+            for (; tail < head; ++tail) {
+                batch.push_back(ring.records[tail & (RING_CAPACITY - 1)]);
+            }
+            ring.tail.store(tail, std::memory_order_release);
+
+            if (retired) {
+                s.free_rings.push_back(std::move(*it));
+                it = s.rings.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(s.write_mutex);
+    if (batch.empty() && s.dropped.load() == s.dropped_reported) {
+        return;
+    }
+
+    std::stable_sort(batch.begin(), batch.end(),
+        [](const LogRecord& a, const LogRecord& b) { return a.timestamp_us < b.timestamp_us; });
+    for (const auto& record : batch) {
+        write_record(s, record);
+    }
+
+    uint64_t dropped = s.dropped.load();
+    if (dropped != s.dropped_reported) {
+        std::cerr << "Logger: " << (dropped - s.dropped_reported)
+                  << " lines dropped (log ring full)\n";
+        s.dropped_reported = dropped;
+    }
+
+    std::cout.flush();
+    std::cerr.flush();
+}
+
+void flusher_loop(LoggerState& s) {
+    while (!s.stop_flag.load()) {
+        std::this_thread::sleep_for(FLUSH_INTERVAL);
+        drain(s);
+    }
+}
+
+}  // namespace
+
+bool Logger::admit(uint32_t site, uint32_t& suppressed) {
+    suppressed = 0;
+    uint32_t limit = rate_limit_.load(std::memory_order_relaxed);
+    if (limit == 0) return true;
+
+    RateSlot& slot = state().rate_slots[site % RATE_SLOTS];
+    uint64_t second = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+
+    uint64_t window = slot.window.load(std::memory_order_relaxed);
+    if (window != second &&
+        slot.window.compare_exchange_strong(window, second, std::memory_order_relaxed)) {
+        slot.count.store(0, std::memory_order_relaxed);
+    }
+
+    if (slot.count.fetch_add(1, std::memory_order_relaxed) < limit) {
+        suppressed = slot.suppressed.exchange(0, std::memory_order_relaxed);
+        return true;
+    }
+    slot.suppressed.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void Logger::submit(LogRecord& record) {
+    record.timestamp_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    LoggerState& s = state();
+    if (!s.running.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(s.write_mutex);
+        write_record(s, record);
+        return;
+    }
+
+    ThreadRing* ring = ring_for_this_thread(s);
+    if (!ring) {
+        std::lock_guard<std::mutex> lock(s.write_mutex);
+        write_record(s, record);
+        return;
+    }
+
+    uint64_t head = ring->head.load(std::memory_order_relaxed);
+    if (head - ring->tail.load(std::memory_order_acquire) >= RING_CAPACITY) {
+        s.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    ring->records[head & (RING_CAPACITY - 1)] = record;
+    ring->head.store(head + 1, std::memory_order_release);
 }
 
-std::string Logger::get_timestamp() {
-    auto now = std::chrono::system_clock::now();
-    auto time_t_now = std::chrono::system_clock::to_time_t(now);
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now.time_since_epoch()
-    ) % 1000;
+void Logger::start() {
+    LoggerState& s = state();
+    std::lock_guard<std::mutex> lock(s.lifecycle_mutex);
+    if (s.running.load()) return;
 
-    std::tm tm_buf;
-    localtime_r(&time_t_now, &tm_buf);
+    s.stop_flag.store(false);
+    s.flusher = std::thread(flusher_loop, std::ref(s));
+    s.running.store(true, std::memory_order_release);
+}
 
-    std::ostringstream oss;
-    oss << std::put_time(&tm_buf, "%Y-%m-%d %H:%M:%S")
-        << '.' << std::setfill('0') << std::setw(3) << ms.count();
+void Logger::stop() {
+    LoggerState& s = state();
+    std::lock_guard<std::mutex> lock(s.lifecycle_mutex);
+    if (!s.running.load()) return;
+
+    s.running.store(false);
+    s.stop_flag.store(true);
+    if (s.flusher.joinable()) {
+        s.flusher.join();
+    }
+    drain(s);
+}
+
+std::optional<LogLevel> Logger::parse_level(const std::string& name) {
+    if (name == "debug") return LogLevel::DEBUG;
+    if (name == "info") return LogLevel::INFO;
+    if (name == "warn" || name == "warning") return LogLevel::WARN;
+    if (name == "error") return LogLevel::ERROR;
+    return std::nullopt;
+}
+
+uint64_t Logger::dropped() {
+    return state().dropped.load();
+}
 
-    return oss.str();
+size_t Logger::thread_rings() {
+    LoggerState& s = state();
+    std::lock_guard<std::mutex> lock(s.rings_mutex);
+    return s.rings.size() + s.free_rings.size();
 }
 
 }  // namespace valkyrie
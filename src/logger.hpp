@@ -1,10 +1,15 @@
 #pragma once
 
+#include <algorithm>
 #include <string>
-#include <chrono>
-#include <iostream>
-#include <sstream>
-#include <mutex>
+#include <string_view>
+#include <optional>
+#include <source_location>
+#include <type_traits>
+#include <charconv>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
 
 namespace valkyrie {
 
@@ -15,29 +20,124 @@ enum class LogLevel {
     ERROR
 };
 
+// Component name plus the calling line, which keys the per-call-site rate
+// limit. Built implicitly from the component literal at each call, e.g.
+// Logger::warn("fuse", "read failed: ", key). `component` must be a literal.
+struct LogSite {
+    const char* component;
+    uint32_t site;
+
+    LogSite(const char* name, std::source_location loc = std::source_location::current())
+        : component(name)
+        , site(static_cast<uint32_t>(reinterpret_cast<uintptr_t>(loc.file_name())) ^
+               (loc.line() * 0x9E3779B1u)) {}
+};
+
+// One captured log line: raw arguments rendered into a fixed buffer. The
+// timestamp, level and prefix are formatted later by the flush thread.
+struct LogRecord {
+    static constexpr size_t MAX_TEXT = 224;   // Longer messages are truncated
+
+    int64_t timestamp_us;     // system_clock since the epoch
+    const char* component;
+    uint32_t suppressed;      // Lines this call site dropped since its last one
+    uint16_t length;
+    LogLevel level;
+    char text[MAX_TEXT];
+};
+
+// Asynchronous logger for the data path. Callers render their arguments into
+// a record (no allocation, no locale, no lock) and push it onto a per-thread
+// lock-free ring; a background thread formats and writes the lines every
+// 50ms, DEBUG/INFO to stdout and WARN/ERROR to stderr. Lines below the level
+// are discarded before any work, each call site is limited to a burst of
+// lines per second, and a full ring drops lines rather than block a reader.
+//
+// Until start() (and after stop()) lines are written synchronously, so tools
+// and tests that never start the flusher still see their output.
 class Logger {
 public:
-    static void log(LogLevel level, const std::string& component, const std::string& message);
+    template <typename... Args>
+    static void log(LogLevel level, LogSite site, const Args&... args) {
+        if (!enabled(level)) return;
+
+        uint32_t suppressed;
+        if (!admit(site.site, suppressed)) return;
 
-    static void debug(const std::string& component, const std::string& message) {
-        log(LogLevel::DEBUG, component, message);
+        LogRecord record;
+        record.component = site.component;
+        record.suppressed = suppressed;
+        record.length = 0;
+        record.level = level;
+        (append(record, args), ...);
+        submit(record);
     }
 
-    static void info(const std::string& component, const std::string& message) {
-        log(LogLevel::INFO, component, message);
+    template <typename... Args>
+    static void debug(LogSite site, const Args&... args) { log(LogLevel::DEBUG, site, args...); }
+
+    template <typename... Args>
+    static void info(LogSite site, const Args&... args) { log(LogLevel::INFO, site, args...); }
+
+    template <typename... Args>
+    static void warn(LogSite site, const Args&... args) { log(LogLevel::WARN, site, args...); }
+
+    template <typename... Args>
+    static void error(LogSite site, const Args&... args) { log(LogLevel::ERROR, site, args...); }
+
+    // Start/stop the background flusher; stop() writes everything pending
+    static void start();
+    static void stop();
+
+    static void set_level(LogLevel level) { min_level_.store(static_cast<int>(level)); }
+    static bool enabled(LogLevel level) {
+        return static_cast<int>(level) >= min_level_.load(std::memory_order_relaxed);
     }
 
-    static void warn(const std::string& component, const std::string& message) {
-        log(LogLevel::WARN, component, message);
+    // Lines per second each call site may emit (0 = unlimited)
+    static void set_rate_limit(uint32_t lines_per_sec) { rate_limit_.store(lines_per_sec); }
+
+    // "debug", "info", "warn"/"warning", "error"
+    static std::optional<LogLevel> parse_level(const std::string& name);
+
+    // Lines dropped because a thread's ring was full
+    static uint64_t dropped();
+
+    // Per-thread rings allocated; rings of exited threads are reused, so this
+    // stays at the peak number of threads logging at once
+    static size_t thread_rings();
+
+    static constexpr uint32_t DEFAULT_RATE_LIMIT = 20;
+
+private:
+    static bool admit(uint32_t site, uint32_t& suppressed);
+    static void submit(LogRecord& record);
+
+    static void append_text(LogRecord& record, std::string_view text) {
+        size_t n = std::min(text.size(), LogRecord::MAX_TEXT - record.length);
+        std::memcpy(record.text + record.length, text.data(), n);
+        record.length += static_cast<uint16_t>(n);
     }
 
-    static void error(const std::string& component, const std::string& message) {
-        log(LogLevel::ERROR, component, message);
+    template <typename T>
+    static void append(LogRecord& record, const T& value) {
+        if constexpr (std::is_same_v<T, bool>) {
+            append_text(record, value ? "true" : "false");
+        } else if constexpr (std::is_same_v<T, char>) {
+            append_text(record, std::string_view(&value, 1));
+        } else if constexpr (std::is_arithmetic_v<T>) {
+            char buf[32];
+            auto result = std::to_chars(buf, buf + sizeof(buf), value);
+            append_text(record, std::string_view(buf, result.ptr - buf));
+        } else {
+            static_assert(std::is_convertible_v<const T&, std::string_view>,
+                          "Logger arguments must be strings, characters or numbers");
+            append_text(record, std::string_view(value));
+        }
     }
 
-private:
-    static const char* level_to_string(LogLevel level);
-    static std::string get_timestamp();
+    static std::atomic<int> min_level_;
+    static std::atomic<uint32_t> rate_limit_;
 };
 
 }  // namespace valkyrie
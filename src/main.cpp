@@ -47,6 +47,8 @@ int main(int argc, char* argv[]) {
     ops.open = fuse_ops::open;
     ops.read = fuse_ops::read;
     ops.release = fuse_ops::release;
+    ops.write = fuse_ops::write;        // /.valkyrie/control only
+    ops.truncate = fuse_ops::truncate;
 
     // Build FUSE args
     struct fuse_args fuse_argv = FUSE_ARGS_INIT(0, NULL);
@@ -54,7 +56,10 @@ int main(int argc, char* argv[]) {
     fuse_opt_add_arg(&fuse_argv, config.mount_point.c_str());
     fuse_opt_add_arg(&fuse_argv, "-f");  // Foreground mode
     fuse_opt_add_arg(&fuse_argv, "-o");
-    fuse_opt_add_arg(&fuse_argv, "ro,allow_other,defer_permissions");  // Read-only, allow all users, defer permissions
+    // Not mounted "ro": /.valkyrie/control takes writes. Every other file
+    // rejects them in open(). Allow all users, defer permissions; open()
+    // and write() restrict the control file to the mounting user and root.
+    fuse_opt_add_arg(&fuse_argv, "allow_other,defer_permissions");
 
     // Run FUSE main loop
     int ret = fuse_main(fuse_argv.argc, fuse_argv.argv, &ops, g_context.get());
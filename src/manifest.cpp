@@ -0,0 +1,151 @@
+#include "manifest.hpp"
+#include "shuffle.hpp"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace valkyrie {
+
+bool Manifest::load(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Manifest: Failed to open " << path << "\n";
+        return false;
+    }
+
+    entries_.clear();
+    objects_.clear();
+    index_.clear();
+    shuffle_.reset();
+
+    std::string line;
+    while (std::getline(file, line)) {
+        // Trim whitespace
+        line.erase(0, line.find_first_not_of(" \t\r\n"));
+        line.erase(line.find_last_not_of(" \t\r\n") + 1);
+
+        if (line.empty()) continue;
+
+        if (line.rfind("#@", 0) == 0) {
+            if (!parse_directive(line.substr(2))) {
+                std::cerr << "Manifest: Invalid directive in " << path << ": " << line << "\n";
+                return false;
+            }
+            continue;
+        }
+
+        if (line[0] == '#') continue;  // Comment
+
+        if (!parse_columns(line)) {
+            std::cerr << "Manifest: Invalid size or ETag in " << path << ": " << line << "\n";
+            return false;
+        }
+        entries_.push_back(line);
+    }
+
+    build_index();
+    return true;
+}
+
+void Manifest::assign(std::vector<std::string> entries, std::optional<ShuffleSpec> shuffle) {
+    entries_ = std::move(entries);
+    objects_.clear();
+    shuffle_ = std::move(shuffle);
+    build_index();
+}
+
+void Manifest::build_index() {
+    // Index after the vector stops growing so the views stay valid
+    index_.clear();
+    index_.reserve(entries_.size());
+    for (size_t i = 0; i < entries_.size(); ++i) {
+        index_.emplace(entries_[i], i);  // First occurrence wins
+    }
+}
+
+bool Manifest::parse_columns(std::string& line) {
+    size_t tab = line.find('\t');
+    if (tab == std::string::npos) {
+        return true;  // Key only
+    }
+
+    std::istringstream columns(line.substr(tab + 1));
+    ObjectInfo obj{line.substr(0, tab), 0};
+
+    std::string size;
+    std::getline(columns, size, '\t');
+    if (size.empty() || size.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+    try {
+        obj.size = static_cast<size_t>(std::stoull(size));
+    } catch (const std::exception&) {
+        return false;
+    }
+
+    std::getline(columns, obj.etag, '\t');
+    if (!obj.etag.empty() && obj.etag.front() != '"') {
+        obj.etag = "\"" + obj.etag + "\"";  // Quoted, as S3 returns it
+    }
+    if (columns.peek() != std::char_traits<char>::eof()) {
+        return false;  // More than three columns
+    }
+
+    line.erase(tab);  // The entry is the key alone
+    objects_.push_back(std::move(obj));
+    return true;
+}
+
+bool Manifest::parse_directive(const std::string& line) {
+    std::istringstream iss(line);
+    std::string name;
+    iss >> name;
+
+    if (name != "shuffle") {
+        return false;
+    }
+
+    ShuffleSpec spec;
+    iss >> spec.algorithm;
+    if (spec.algorithm != SHUFFLE_PCG32_FISHER_YATES) {
+        return false;
+    }
+
+    bool has_seed = false;
+    std::string param;
+    while (iss >> param) {
+        auto eq = param.find('=');
+        if (eq == std::string::npos) return false;
+
+        std::string key = param.substr(0, eq);
+        std::string value = param.substr(eq + 1);
+
+        try {
+            if (key == "seed") {
+                spec.seed = std::stoull(value);
+                has_seed = true;
+            } else if (key == "epoch") {
+                spec.epoch = std::stoull(value);
+            } else {
+                return false;
+            }
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+
+    if (!has_seed) return false;
+
+    shuffle_ = spec;
+    return true;
+}
+
+std::optional<size_t> Manifest::find(const std::string& s3_key) const {
+    auto it = index_.find(s3_key);
+    if (it == index_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+}  // namespace valkyrie
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+#include <unordered_map>
+#include <cstdint>
+
+namespace valkyrie {
+
+// Shuffle declared by a "#@shuffle" manifest directive:
+//   #@shuffle pcg32-fisher-yates seed=1234 epoch=0
+// Epoch e reads the entries in shuffled_order(size, seed, e) (see shuffle.hpp).
+struct ShuffleSpec {
+    std::string algorithm;
+    uint64_t seed = 0;
+    uint64_t epoch = 0;  // Epoch the job starts at (for resumed runs)
+};
+
+// Training-order manifest: one S3 key per line, '#' comments, "#@" directives.
+// A line may add tab-separated size and ETag columns: "key\tsize[\tetag]".
+// Non-copyable because the key index views into the entry strings.
+class Manifest {
+public:
+    Manifest() = default;
+    Manifest(const Manifest&) = delete;
+    Manifest& operator=(const Manifest&) = delete;
+    Manifest(Manifest&&) = default;
+    Manifest& operator=(Manifest&&) = default;
+
+    // Parse a manifest file. Returns false (with a message on stderr) if the
+    // file cannot be opened or a directive is malformed.
+    bool load(const std::string& path);
+
+    // Build from an in-memory key list (e.g. to append to a live manifest)
+    void assign(std::vector<std::string> entries, std::optional<ShuffleSpec> shuffle);
+
+    const std::vector<std::string>& entries() const { return entries_; }
+    size_t size() const { return entries_.size(); }
+    bool empty() const { return entries_.empty(); }
+
+    // Position of a key in file order (O(1))
+    std::optional<size_t> find(const std::string& s3_key) const;
+
+    const std::optional<ShuffleSpec>& shuffle() const { return shuffle_; }
+
+    // Entries that have a size column, with their ETag if given
+    const std::vector<ObjectInfo>& objects() const { return objects_; }
+
+    // Every entry has a size, so the manifest can stand in for a listing
+    bool has_sizes() const { return !entries_.empty() && objects_.size() == entries_.size(); }
+
+private:
+    bool parse_directive(const std::string& line);
+    bool parse_columns(std::string& line);  // Moves "\tsize[\tetag]" into objects_
+    void build_index();
+
+    std::vector<std::string> entries_;
+    std::vector<ObjectInfo> objects_;
+    std::unordered_map<std::string_view, size_t> index_;
+    std::optional<ShuffleSpec> shuffle_;
+};
+
+}  // namespace valkyrie
@@ -0,0 +1,257 @@
+#include "markov_model.hpp"
+#include <algorithm>
+#include <fstream>
+#include <unordered_set>
+
+namespace valkyrie {
+
+void MarkovModel::SuccessorList::add(KeyId key, uint32_t gen, size_t max_entries) {
+    total++;
+
+    Successor* stale = nullptr;
+    for (auto& entry : entries) {
+        if (entry.key == key && entry.gen == gen) {
+            entry.count++;
+            return;
+        }
+        if (entry.key == key) {
+            stale = &entry;  // Same slot, earlier key
+        }
+    }
+
+    if (stale != nullptr) {
+        *stale = {key, gen, 1};
+        return;
+    }
+
+    if (entries.size() < max_entries) {
+        entries.push_back({key, gen, 1});
+        return;
+    }
+
+    // Full: replace the least frequent successor, inheriting its count so a
+    // new key must keep recurring to displace established ones
+    auto weakest = std::min_element(entries.begin(), entries.end(),
+        [](const Successor& a, const Successor& b) { return a.count < b.count; });
+    weakest->key = key;
+    weakest->gen = gen;
+    weakest->count++;
+}
+
+std::optional<MarkovModel::KeyId> MarkovModel::SuccessorList::best(const std::vector<Slot>& slots) const {
+    const Successor* result = nullptr;
+    for (const auto& entry : entries) {
+        if (slots[entry.key].gen != entry.gen) continue;  // Evicted since
+        if (result == nullptr || entry.count > result->count) {
+            result = &entry;
+        }
+    }
+
+    if (result == nullptr) return std::nullopt;
+    return result->key;
+}
+
+MarkovModel::MarkovModel(size_t max_successors, size_t max_keys)
+    : max_successors_(max_successors == 0 ? 1 : max_successors),
+      max_keys_(max_keys < 3 ? 3 : max_keys) {
+}
+
+MarkovModel::KeyId MarkovModel::intern(const std::string& s3_key) {
+    auto it = ids_.find(s3_key);
+    if (it != ids_.end()) {
+        slots_[it->second].referenced = true;
+        return it->second;
+    }
+
+    if (slots_.size() < max_keys_) {
+        KeyId id = static_cast<KeyId>(slots_.size());
+        slots_.emplace_back().key = s3_key;
+        ids_.emplace(s3_key, id);
+        return id;
+    }
+
+    // Reuse a slot: its transitions go with it, and references to it from
+    // other states go stale with the generation bump
+    KeyId id = evict_locked();
+    Slot& slot = slots_[id];
+    ids_.erase(slot.key);
+    slot.key = s3_key;
+    slot.gen++;
+    slot.referenced = true;
+    slot.next = SuccessorList{};
+    slot.after = {};
+    ids_.emplace(s3_key, id);
+    return id;
+}
+
+MarkovModel::KeyId MarkovModel::evict_locked() {
+    // Every pass clears the bits it skips, so this ends within two sweeps;
+    // the live state is never evicted (max_keys_ >= 3)
+    for (;;) {
+        KeyId id = static_cast<KeyId>(clock_hand_);
+        clock_hand_ = (clock_hand_ + 1) % slots_.size();
+
+        if (id == prev_ || id == current_) continue;
+
+        Slot& slot = slots_[id];
+        if (slot.referenced) {
+            slot.referenced = false;
+            continue;
+        }
+        return id;
+    }
+}
+
+void MarkovModel::observe(const std::string& s3_key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    KeyId id = intern(s3_key);
+    if (id == current_) return;  // Re-open of the same file
+
+    observe_locked(id);
+    record_history_locked(id);
+}
+
+void MarkovModel::record_history_locked(KeyId id) {
+    if (history_.size() >= MAX_HISTORY) {
+        history_.pop_front();
+    }
+    history_.push_back({id, slots_[id].gen});
+}
+
+void MarkovModel::observe_locked(KeyId id) {
+    uint32_t gen = slots_[id].gen;
+
+    if (current_ != NO_KEY) {
+        Slot& current = slots_[current_];
+        current.next.add(id, gen, max_successors_);
+
+        if (prev_ != NO_KEY) {
+            uint32_t prev_gen = slots_[prev_].gen;
+            auto [it, inserted] = current.after.try_emplace(prev_, PairState{prev_gen, {}});
+            if (!inserted && it->second.prev_gen != prev_gen) {
+                it->second = PairState{prev_gen, {}};  // Prev slot was reused
+            }
+            it->second.next.add(id, gen, max_successors_);
+        }
+    }
+
+    prev_ = current_;
+    current_ = id;
+}
+
+std::optional<MarkovModel::KeyId> MarkovModel::next_locked(KeyId prev, KeyId current) const {
+    const Slot& slot = slots_[current];
+
+    if (prev != NO_KEY) {
+        auto it = slot.after.find(prev);
+        if (it != slot.after.end() && it->second.prev_gen == slots_[prev].gen &&
+            it->second.next.total >= MIN_SECOND_ORDER_SUPPORT) {
+            auto next = it->second.next.best(slots_);
+            if (next.has_value()) return next;
+        }
+    }
+
+    return slot.next.best(slots_);
+}
+
+std::vector<std::string> MarkovModel::predict(size_t count) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::vector<std::string> result;
+    if (current_ == NO_KEY) return result;
+
+    // Walk the chain, stopping on cycles back into the predicted window
+    std::unordered_set<KeyId> seen{current_};
+    KeyId prev = prev_;
+    KeyId current = current_;
+
+    while (result.size() < count) {
+        auto next = next_locked(prev, current);
+        if (!next.has_value() || !seen.insert(*next).second) break;
+
+        result.push_back(slots_[*next].key);
+        prev = current;
+        current = *next;
+    }
+
+    return result;
+}
+
+bool MarkovModel::load_trace(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Learn the recorded run as its own stream, then restore live state (by
+    // key: the live keys' slots may be reused meanwhile)
+    std::string saved_prev = prev_ == NO_KEY ? "" : slots_[prev_].key;
+    std::string saved_current = current_ == NO_KEY ? "" : slots_[current_].key;
+    prev_ = current_ = NO_KEY;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        line.erase(0, line.find_first_not_of(" \t\r\n"));
+        line.erase(line.find_last_not_of(" \t\r\n") + 1);
+
+        if (line.empty() || line[0] == '#') continue;
+
+        KeyId id = intern(line);
+        if (id != current_) {
+            observe_locked(id);
+            record_history_locked(id);
+        }
+    }
+
+    auto restore = [this](const std::string& key) {
+        auto it = ids_.find(key);
+        return it == ids_.end() ? NO_KEY : it->second;
+    };
+    prev_ = restore(saved_prev);
+    current_ = restore(saved_current);
+    return true;
+}
+
+bool MarkovModel::save_trace(const std::string& path) const {
+    std::ofstream file(path, std::ios::trunc);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    file << "# Valkyrie-FS access trace\n";
+    for (const auto& entry : history_) {
+        const Slot& slot = slots_[entry.id];
+        if (slot.gen == entry.gen) {
+            file << slot.key << "\n";
+        }
+    }
+
+    return file.good();
+}
+
+size_t MarkovModel::num_keys() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return slots_.size();
+}
+
+size_t MarkovModel::num_first_order_states() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return std::count_if(slots_.begin(), slots_.end(),
+                         [](const Slot& slot) { return !slot.next.entries.empty(); });
+}
+
+size_t MarkovModel::num_second_order_states() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t states = 0;
+    for (const auto& slot : slots_) {
+        states += slot.after.size();
+    }
+    return states;
+}
+
+}  // namespace valkyrie
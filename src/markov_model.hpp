@@ -0,0 +1,124 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <optional>
+#include <unordered_map>
+#include <deque>
+#include <mutex>
+#include <cstdint>
+
+namespace valkyrie {
+
+// Online first/second-order transition model over S3 keys.
+// Learns "after A (and B), the reader opens C" from the access stream so that
+// orders which repeat across runs but follow no numeric pattern can be prefetched.
+// Thread-safe: observe() is called from FUSE threads, predict() from the predictor.
+class MarkovModel {
+public:
+    // max_successors bounds how many candidate next keys each state keeps,
+    // max_keys the distinct keys interned (see evict_locked)
+    explicit MarkovModel(size_t max_successors = 4, size_t max_keys = DEFAULT_MAX_KEYS);
+
+    // Record an access (consecutive repeats of the same key are ignored)
+    void observe(const std::string& s3_key);
+
+    // Predict up to `count` keys following the current state, most likely first.
+    // Uses the second-order table when it has enough support, else first-order.
+    std::vector<std::string> predict(size_t count) const;
+
+    // Load a trace (one key per line, '#' comments) and learn from it. Its
+    // keys join the history, so save_trace() carries them into the next run.
+    // Returns false if the file cannot be opened.
+    bool load_trace(const std::string& path);
+
+    // Write the loaded trace and the accesses observed since, one key per line
+    bool save_trace(const std::string& path) const;
+
+    // Number of distinct keys seen
+    size_t num_keys() const;
+
+    // Number of first-order / second-order states with at least one successor
+    size_t num_first_order_states() const;
+    size_t num_second_order_states() const;
+
+    // Minimum observations before a second-order state overrides first-order
+    static constexpr uint32_t MIN_SECOND_ORDER_SUPPORT = 2;
+
+    // History kept for save_trace() (oldest entries dropped beyond this)
+    static constexpr size_t MAX_HISTORY = 1 << 20;
+
+    static constexpr size_t DEFAULT_MAX_KEYS = 1 << 20;
+
+private:
+    using KeyId = uint32_t;
+    static constexpr KeyId NO_KEY = UINT32_MAX;
+
+    struct Slot;
+
+    // A key slot is reused once its key is evicted; references into it carry
+    // the slot's generation so they read as absent after reuse
+    struct Successor {
+        KeyId key;
+        uint32_t gen;
+        uint32_t count;
+    };
+
+    // Small bounded successor list. When full, a stale entry or else the
+    // least frequent one is replaced (space-saving), so the table stays
+    // compact for huge key sets.
+    struct SuccessorList {
+        std::vector<Successor> entries;
+        uint32_t total = 0;
+
+        void add(KeyId key, uint32_t gen, size_t max_entries);
+        std::optional<KeyId> best(const std::vector<Slot>& slots) const;
+    };
+
+    // Second-order state (prev, this slot's key), keyed by prev
+    struct PairState {
+        uint32_t prev_gen;
+        SuccessorList next;
+    };
+
+    struct Slot {
+        std::string key;
+        uint32_t gen = 0;
+        bool referenced = true;                        // Clock bit
+        SuccessorList next;                            // First-order successors
+        std::unordered_map<KeyId, PairState> after;    // Second-order, by prev
+    };
+
+    struct HistoryEntry {
+        KeyId id;
+        uint32_t gen;
+    };
+
+    KeyId intern(const std::string& s3_key);
+
+    // Key table full: pick a slot to reuse with a clock sweep (keys looked up
+    // since the last pass survive), so eviction is O(1) amortized and the
+    // model stays bounded even when every access is a new key
+    KeyId evict_locked();
+    void observe_locked(KeyId id);
+    void record_history_locked(KeyId id);
+    std::optional<KeyId> next_locked(KeyId prev, KeyId current) const;
+
+    size_t max_successors_;
+    size_t max_keys_;
+
+    std::vector<Slot> slots_;                       // id -> key and its transitions
+    std::unordered_map<std::string, KeyId> ids_;    // key -> id
+    size_t clock_hand_ = 0;
+
+    // Current state (last two distinct keys)
+    KeyId prev_ = NO_KEY;
+    KeyId current_ = NO_KEY;
+
+    // Loaded trace, then this session (entries of evicted keys are skipped)
+    std::deque<HistoryEntry> history_;
+
+    mutable std::mutex mutex_;
+};
+
+}  // namespace valkyrie
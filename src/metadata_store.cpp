@@ -0,0 +1,488 @@
+#include "metadata_store.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace valkyrie {
+
+namespace {
+
+constexpr uint32_t NO_ETAG = UINT32_MAX;
+constexpr uint32_t OTHER_ETAG = UINT32_MAX - 1;
+
+// Snapshot layout, native byte order: header, source, then each array at
+// an 8-byte aligned offset so it can be used in place from the mapping,
+// then the ETags that are not packed as (index, length, bytes)
+constexpr char SNAPSHOT_MAGIC[8] = {'V', 'K', 'M', 'E', 'T', 'A', 'S', '1'};
+constexpr uint32_t SNAPSHOT_VERSION = 1;
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t source_length;
+    uint64_t count;
+    uint64_t key_bytes;
+    uint64_t blocks;
+    uint64_t other_etags;
+    uint64_t dropped_keys;
+    uint64_t reserved;
+};
+static_assert(sizeof(SnapshotHeader) == 64);
+
+size_t align8(size_t n) {
+    return (n + 7) & ~size_t(7);
+}
+
+template <typename T>
+void write_pod(std::ofstream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+void write_array(std::ofstream& out, std::span<const T> values) {
+    size_t bytes = values.size_bytes();
+    out.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(bytes));
+    static const char padding[8] = {};
+    out.write(padding, static_cast<std::streamsize>(align8(bytes) - bytes));
+}
+
+void put_varint(std::vector<char>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+uint64_t get_varint(std::span<const char> in, size_t& pos) {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64 && pos < in.size(); shift += 7) {
+        auto byte = static_cast<uint8_t>(in[pos++]);
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) break;
+    }
+    return value;
+}
+
+// Three-way comparison of `key` with the concatenation a + b
+int compare_concat(std::string_view key, std::string_view a, std::string_view b) {
+    size_t n = std::min(key.size(), a.size());
+    int c = key.compare(0, n, a.substr(0, n));
+    if (c != 0) return c;
+    if (key.size() < a.size()) return -1;
+    return key.substr(a.size()).compare(b);
+}
+
+int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+}  // namespace
+
+MetadataStore::MetadataStore(std::vector<ObjectInfo> objects) {
+    std::stable_sort(objects.begin(), objects.end(),
+                     [](const ObjectInfo& a, const ObjectInfo& b) { return a.key < b.key; });
+
+    auto buffers = std::make_shared<Buffers>();
+    size_t total_bytes = 0;
+    for (const auto& obj : objects) total_bytes += obj.key.size();
+    buffers->keys.reserve(total_bytes / 2);  // Typical front-coding ratio; grows if needed
+    buffers->sizes.reserve(objects.size());
+    buffers->mtimes.reserve(objects.size());
+    buffers->etag_md5.reserve(objects.size());
+    buffers->etag_parts.reserve(objects.size());
+
+    const std::string* previous = nullptr;
+    for (size_t i = 0; i < objects.size(); ++i) {
+        const ObjectInfo& obj = objects[i];
+        if (i + 1 < objects.size() && objects[i + 1].key == obj.key) continue;  // Last one wins
+        if (obj.key.size() > MAX_KEY_BYTES) {
+            ++dropped_keys_;
+            continue;
+        }
+
+        size_t shared = 0;
+        if (buffers->sizes.size() % BLOCK_KEYS == 0) {
+            buffers->block_offsets.push_back(buffers->keys.size());
+        } else {
+            size_t limit = std::min(previous->size(), obj.key.size());
+            while (shared < limit && (*previous)[shared] == obj.key[shared]) ++shared;
+        }
+        put_varint(buffers->keys, shared);
+        put_varint(buffers->keys, obj.key.size() - shared);
+        buffers->keys.insert(buffers->keys.end(), obj.key.begin() + shared, obj.key.end());
+
+        buffers->sizes.push_back(obj.size);
+        buffers->mtimes.push_back(obj.mtime);
+        add_etag(*buffers, obj.etag);
+        previous = &obj.key;
+    }
+
+    buffers->keys.shrink_to_fit();
+    buffers->block_offsets.shrink_to_fit();
+    buffers->sizes.shrink_to_fit();
+    buffers->mtimes.shrink_to_fit();
+    buffers->etag_md5.shrink_to_fit();
+    buffers->etag_parts.shrink_to_fit();
+
+    keys_ = buffers->keys;
+    block_offsets_ = buffers->block_offsets;
+    sizes_ = buffers->sizes;
+    mtimes_ = buffers->mtimes;
+    etag_md5_ = buffers->etag_md5;
+    etag_parts_ = buffers->etag_parts;
+    heap_bytes_ = keys_.size() + (block_offsets_.size() + sizes_.size() + mtimes_.size()) * 8 +
+                  etag_md5_.size() * 16 + etag_parts_.size() * sizeof(uint32_t);
+    storage_ = std::move(buffers);
+}
+
+void MetadataStore::add_etag(Buffers& buffers, const std::string& etag) {
+    std::array<uint8_t, 16> md5{};
+    if (etag.empty()) {
+        buffers.etag_md5.push_back(md5);
+        buffers.etag_parts.push_back(NO_ETAG);
+        return;
+    }
+
+    // "\"" + 32 lowercase hex digits + optional "-<parts>" + "\""
+    bool packed = etag.size() >= 34 && etag.front() == '"' && etag.back() == '"';
+    for (size_t i = 0; packed && i < 16; ++i) {
+        int high = hex_value(etag[1 + 2 * i]);
+        int low = hex_value(etag[2 + 2 * i]);
+        packed = high >= 0 && low >= 0;
+        md5[i] = static_cast<uint8_t>(high * 16 + low);
+    }
+    uint32_t parts = 0;
+    if (packed && etag.size() > 34) {
+        packed = etag[33] == '-' && etag.size() > 35 && etag.size() <= 44;  // Up to 9 digits
+        for (size_t i = 34; packed && i + 1 < etag.size(); ++i) {
+            packed = etag[i] >= '0' && etag[i] <= '9';
+            parts = parts * 10 + static_cast<uint32_t>(etag[i] - '0');
+        }
+        packed = packed && parts > 0 && parts < OTHER_ETAG;
+    }
+
+    if (!packed) {
+        etag_other_[buffers.etag_md5.size()] = etag;
+        md5 = {};
+        parts = OTHER_ETAG;
+    }
+    buffers.etag_md5.push_back(md5);
+    buffers.etag_parts.push_back(parts);
+}
+
+std::string MetadataStore::etag_at(size_t index) const {
+    uint32_t parts = etag_parts_[index];
+    if (parts == NO_ETAG) return "";
+    if (parts == OTHER_ETAG) {
+        auto it = etag_other_.find(index);
+        return it == etag_other_.end() ? "" : it->second;
+    }
+
+    static const char* digits = "0123456789abcdef";
+    std::string etag = "\"";
+    for (uint8_t byte : etag_md5_[index]) {
+        etag += digits[byte >> 4];
+        etag += digits[byte & 0x0f];
+    }
+    if (parts > 0) etag += "-" + std::to_string(parts);
+    return etag + "\"";
+}
+
+std::string MetadataStore::key_at(size_t index) const {
+    return std::string(Cursor(*this, index).key());
+}
+
+std::string_view MetadataStore::block_first_key(size_t block) const {
+    size_t pos = block_offsets_[block];
+    get_varint(keys_, pos);  // Shared length, 0 for a block's first key
+    size_t length = std::min<size_t>(get_varint(keys_, pos), keys_.size() - std::min(pos, keys_.size()));
+    return std::string_view(keys_.data() + pos, length);
+}
+
+size_t MetadataStore::lower_bound(std::string_view prefix, std::string_view suffix) const {
+    // First block whose first key is >= the target; the answer is in the block before it
+    size_t low = 0;
+    size_t high = block_offsets_.size();
+    while (low < high) {
+        size_t mid = (low + high) / 2;
+        if (compare_concat(block_first_key(mid), prefix, suffix) < 0) low = mid + 1;
+        else high = mid;
+    }
+    if (low == 0) return 0;
+
+    size_t block_end = std::min(low * BLOCK_KEYS, size());
+    for (Cursor cursor(*this, (low - 1) * BLOCK_KEYS); cursor.index() < block_end; cursor.next()) {
+        if (compare_concat(cursor.key(), prefix, suffix) >= 0) return cursor.index();
+    }
+    return block_end;
+}
+
+std::optional<size_t> MetadataStore::find(std::string_view key) const {
+    size_t index = lower_bound(key);
+    if (index < size() && Cursor(*this, index).key() == key) return index;
+    return std::nullopt;
+}
+
+bool MetadataStore::has_prefix(std::string_view prefix, std::string_view suffix) const {
+    size_t index = lower_bound(prefix, suffix);
+    if (index >= size()) return false;
+    Cursor cursor(*this, index);
+    std::string_view key = cursor.key();
+    return key.size() >= prefix.size() + suffix.size() &&
+           key.substr(0, prefix.size()) == prefix &&
+           key.substr(prefix.size(), suffix.size()) == suffix;
+}
+
+void MetadataStore::list_directory(std::string_view dir, std::vector<ObjectInfo>& files,
+                                   std::vector<std::string>& subdirs) const {
+    std::string prefix(dir);
+    if (!prefix.empty()) prefix += '/';
+
+    size_t index = lower_bound(prefix);
+    while (index < size()) {
+        size_t next = size();
+        for (Cursor cursor(*this, index); cursor.valid(); cursor.next()) {
+            std::string_view key = cursor.key();
+            if (key.compare(0, prefix.size(), prefix) != 0) break;
+
+            std::string_view rest = key.substr(prefix.size());
+            size_t slash = rest.find('/');
+            if (slash == std::string_view::npos) {
+                if (!rest.empty()) {  // Not the directory's own "dir/" marker
+                    size_t i = cursor.index();
+                    files.push_back({std::string(rest), sizes_[i], etag_at(i), mtimes_[i]});
+                }
+                continue;
+            }
+
+            // '0' follows '/': seek past every key under this subdirectory
+            subdirs.emplace_back(rest.substr(0, slash));
+            next = lower_bound(prefix + subdirs.back(), "0");
+            break;
+        }
+        index = next;
+    }
+}
+
+size_t MetadataStore::memory_bytes() const {
+    size_t bytes = heap_bytes_;
+    for (const auto& [index, etag] : etag_other_) {
+        bytes += sizeof(index) + sizeof(etag) + etag.capacity();
+    }
+    return bytes;
+}
+
+bool MetadataStore::same_etag(size_t index, const MetadataStore& other, size_t other_index) const {
+    if (etag_parts_[index] == OTHER_ETAG || other.etag_parts_[other_index] == OTHER_ETAG) {
+        return etag_at(index) == other.etag_at(other_index);
+    }
+    return etag_parts_[index] == other.etag_parts_[other_index] &&
+           etag_md5_[index] == other.etag_md5_[other_index];
+}
+
+MetadataStore::Changes MetadataStore::compare(const MetadataStore& before, const MetadataStore& now) {
+    Changes changes;
+    Cursor old_cursor(before, 0);
+    Cursor new_cursor(now, 0);
+    while (old_cursor.valid() && new_cursor.valid()) {
+        int c = old_cursor.key().compare(new_cursor.key());
+        if (c < 0) {
+            ++changes.removed;
+            old_cursor.next();
+        } else if (c > 0) {
+            ++changes.added;
+            new_cursor.next();
+        } else {
+            size_t i = old_cursor.index();
+            size_t j = new_cursor.index();
+            if (before.sizes_[i] != now.sizes_[j] || !before.same_etag(i, now, j)) {
+                ++changes.changed;
+            }
+            old_cursor.next();
+            new_cursor.next();
+        }
+    }
+    changes.removed += before.size() - std::min(before.size(), old_cursor.index());
+    changes.added += now.size() - std::min(now.size(), new_cursor.index());
+    return changes;
+}
+
+bool MetadataStore::save(const std::string& path, const std::string& source) const {
+    std::string temp_path = path + ".tmp";
+    std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        std::cerr << "MetadataStore: Cannot write snapshot: " << temp_path << "\n";
+        return false;
+    }
+
+    SnapshotHeader header{};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.version = SNAPSHOT_VERSION;
+    header.source_length = static_cast<uint32_t>(source.size());
+    header.count = size();
+    header.key_bytes = keys_.size();
+    header.blocks = block_offsets_.size();
+    header.other_etags = etag_other_.size();
+    header.dropped_keys = dropped_keys_;
+    write_pod(out, header);
+
+    write_array(out, std::span<const char>(source));
+    write_array(out, keys_);
+    write_array(out, block_offsets_);
+    write_array(out, sizes_);
+    write_array(out, mtimes_);
+    write_array(out, etag_md5_);
+    write_array(out, etag_parts_);
+    for (const auto& [index, etag] : etag_other_) {
+        write_pod(out, static_cast<uint64_t>(index));
+        write_pod(out, static_cast<uint32_t>(etag.size()));
+        out.write(etag.data(), static_cast<std::streamsize>(etag.size()));
+    }
+
+    out.close();
+    if (!out || std::rename(temp_path.c_str(), path.c_str()) != 0) {
+        std::cerr << "MetadataStore: Failed to write snapshot: " << path << "\n";
+        std::remove(temp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+std::shared_ptr<const MetadataStore> MetadataStore::open_snapshot(const std::string& path,
+                                                                  const std::string& source) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;  // No snapshot yet
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(SnapshotHeader)) {
+        ::close(fd);
+        std::cerr << "MetadataStore: Ignoring truncated snapshot: " << path << "\n";
+        return nullptr;
+    }
+    size_t file_size = static_cast<size_t>(st.st_size);
+    void* addr = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        std::cerr << "MetadataStore: Cannot map snapshot: " << path << "\n";
+        return nullptr;
+    }
+    std::shared_ptr<const void> mapping(addr, [file_size](const void* p) {
+        munmap(const_cast<void*>(p), file_size);
+    });
+
+    const char* base = static_cast<const char*>(addr);
+    SnapshotHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 ||
+        header.version != SNAPSHOT_VERSION) {
+        std::cerr << "MetadataStore: Ignoring snapshot of unknown format: " << path << "\n";
+        return nullptr;
+    }
+
+    // Every section must fit the file before any is used
+    size_t offset = sizeof(SnapshotHeader);
+    auto section = [&](size_t bytes) -> const char* {
+        if (offset > file_size || align8(bytes) > file_size - offset) return nullptr;
+        const char* start = base + offset;
+        offset += align8(bytes);
+        return start;
+    };
+    size_t count = header.count;
+    bool sane = header.blocks == (count + BLOCK_KEYS - 1) / BLOCK_KEYS &&
+                count < file_size && header.key_bytes < file_size &&
+                header.other_etags <= count;
+    const char* source_data = sane ? section(header.source_length) : nullptr;
+    const char* keys = source_data ? section(header.key_bytes) : nullptr;
+    const char* blocks = keys ? section(header.blocks * sizeof(uint64_t)) : nullptr;
+    const char* sizes = blocks ? section(count * sizeof(uint64_t)) : nullptr;
+    const char* mtimes = sizes ? section(count * sizeof(int64_t)) : nullptr;
+    const char* md5 = mtimes ? section(count * 16) : nullptr;
+    const char* parts = md5 ? section(count * sizeof(uint32_t)) : nullptr;
+    if (!parts) {
+        std::cerr << "MetadataStore: Ignoring truncated snapshot: " << path << "\n";
+        return nullptr;
+    }
+    if (std::string_view(source_data, header.source_length) != source) {
+        std::cerr << "MetadataStore: Ignoring snapshot of " << std::string_view(source_data, header.source_length)
+                  << " (mounting " << source << "): " << path << "\n";
+        return nullptr;
+    }
+
+    auto store = std::make_shared<MetadataStore>();
+    store->keys_ = {keys, header.key_bytes};
+    store->block_offsets_ = {reinterpret_cast<const uint64_t*>(blocks), header.blocks};
+    store->sizes_ = {reinterpret_cast<const uint64_t*>(sizes), count};
+    store->mtimes_ = {reinterpret_cast<const int64_t*>(mtimes), count};
+    store->etag_md5_ = {reinterpret_cast<const std::array<uint8_t, 16>*>(md5), count};
+    store->etag_parts_ = {reinterpret_cast<const uint32_t*>(parts), count};
+    store->dropped_keys_ = header.dropped_keys;
+
+    for (uint64_t offset_in_block : store->block_offsets_) {
+        if (offset_in_block >= header.key_bytes) {
+            std::cerr << "MetadataStore: Ignoring corrupt snapshot: " << path << "\n";
+            return nullptr;
+        }
+    }
+
+    for (uint64_t i = 0; i < header.other_etags; ++i) {
+        uint64_t index;
+        uint32_t length;
+        if (file_size - offset < sizeof(index) + sizeof(length)) break;
+        std::memcpy(&index, base + offset, sizeof(index));
+        std::memcpy(&length, base + offset + sizeof(index), sizeof(length));
+        offset += sizeof(index) + sizeof(length);
+        if (length > file_size - offset) break;
+        store->etag_other_[index] = std::string(base + offset, length);
+        offset += length;
+    }
+    if (store->etag_other_.size() != header.other_etags) {
+        std::cerr << "MetadataStore: Ignoring truncated snapshot: " << path << "\n";
+        return nullptr;
+    }
+
+    store->storage_ = std::move(mapping);
+    store->mapped_ = true;
+    return store;
+}
+
+MetadataStore::Cursor::Cursor(const MetadataStore& store, size_t index)
+    : store_(store), index_(index) {
+    if (!valid()) return;
+    size_t block = index / BLOCK_KEYS;
+    index_ = block * BLOCK_KEYS;
+    offset_ = store_.block_offsets_[block];
+    decode();
+    while (index_ < index) {
+        ++index_;
+        decode();
+    }
+}
+
+void MetadataStore::Cursor::next() {
+    ++index_;
+    if (valid()) decode();
+}
+
+void MetadataStore::Cursor::decode() {
+    // Clamped so a corrupt snapshot yields wrong keys, never an overrun
+    size_t shared = std::min<size_t>(get_varint(store_.keys_, offset_), length_);
+    size_t suffix = std::min<size_t>(get_varint(store_.keys_, offset_), MAX_KEY_BYTES - shared);
+    suffix = std::min(suffix, store_.keys_.size() - std::min(offset_, store_.keys_.size()));
+    std::memcpy(buffer_.data() + shared, store_.keys_.data() + offset_, suffix);
+    offset_ += suffix;
+    length_ = shared + suffix;
+}
+
+}  // namespace valkyrie
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace valkyrie {
+
+// Immutable object metadata for tens of millions of keys. Keys are sorted
+// and front-coded in blocks of BLOCK_KEYS (each key stores only the suffix
+// it does not share with the previous one); size, mtime and ETag live in
+// parallel arrays indexed like the keys. Built in bulk from a listing and
+// replaced whole, never updated, so readers need no locking. Lookups
+// binary-search the blocks' first keys and decode one block into a stack
+// buffer: they do not allocate. The arrays are views over either the
+// store's own buffers or a mapped snapshot file, shared between copies.
+class MetadataStore {
+public:
+    static constexpr size_t BLOCK_KEYS = 16;
+    static constexpr size_t MAX_KEY_BYTES = 1024;  // S3 key limit; longer keys are dropped
+
+    MetadataStore() = default;
+
+    // Sorts `objects`; for duplicate keys the last one wins
+    explicit MetadataStore(std::vector<ObjectInfo> objects);
+
+    size_t size() const { return sizes_.size(); }
+    bool empty() const { return sizes_.empty(); }
+
+    // Index of `key`, if present
+    std::optional<size_t> find(std::string_view key) const;
+
+    // First index whose key is >= prefix + suffix (size() if none)
+    size_t lower_bound(std::string_view prefix, std::string_view suffix = {}) const;
+
+    // Any key starting with prefix + suffix
+    bool has_prefix(std::string_view prefix, std::string_view suffix = {}) const;
+
+    // Files and subdirectories directly under `dir` ("" is the root), as a
+    // Delimiter="/" listing returns them; one seek skips each subdirectory
+    void list_directory(std::string_view dir, std::vector<ObjectInfo>& files,
+                        std::vector<std::string>& subdirs) const;
+
+    uint64_t size_at(size_t index) const { return sizes_[index]; }
+    int64_t mtime_at(size_t index) const { return mtimes_[index]; }
+    std::string etag_at(size_t index) const;  // As S3 returns it, quotes included
+    std::string key_at(size_t index) const;
+
+    // Sequential decoding from any index; the key view is valid until next()
+    class Cursor {
+    public:
+        Cursor(const MetadataStore& store, size_t index);
+
+        bool valid() const { return index_ < store_.size(); }
+        size_t index() const { return index_; }
+        std::string_view key() const { return std::string_view(buffer_.data(), length_); }
+        void next();
+
+    private:
+        void decode();
+
+        const MetadataStore& store_;
+        size_t index_;
+        size_t offset_ = 0;  // Next entry in keys_
+        size_t length_ = 0;
+        std::array<char, MAX_KEY_BYTES> buffer_;
+    };
+
+    size_t memory_bytes() const;  // Heap held by the store (a mapped snapshot holds none)
+    size_t dropped_keys() const { return dropped_keys_; }
+
+    // Snapshot file of the store, tagged with `source` (the bucket and
+    // prefix it lists). Written to a temporary file and renamed into place,
+    // so readers never see a partial snapshot.
+    bool save(const std::string& path, const std::string& source) const;
+
+    // Memory-maps a snapshot written by save(); null if it is missing,
+    // malformed, or was taken of a different source
+    static std::shared_ptr<const MetadataStore> open_snapshot(const std::string& path,
+                                                              const std::string& source);
+    bool mapped() const { return mapped_; }
+
+    // Keys only in `now`, only in `before`, and in both with another size or ETag
+    struct Changes {
+        size_t added = 0;
+        size_t removed = 0;
+        size_t changed = 0;
+    };
+    static Changes compare(const MetadataStore& before, const MetadataStore& now);
+
+private:
+    // Arrays of a store built in memory
+    struct Buffers {
+        std::vector<char> keys;
+        std::vector<uint64_t> block_offsets;
+        std::vector<uint64_t> sizes;
+        std::vector<int64_t> mtimes;
+        std::vector<std::array<uint8_t, 16>> etag_md5;
+        std::vector<uint32_t> etag_parts;
+    };
+
+    // "\"<32 hex>\"" or "\"<32 hex>-<parts>\"" (multipart) is stored as 16
+    // bytes + parts; anything else verbatim in etag_other_
+    void add_etag(Buffers& buffers, const std::string& etag);
+
+    std::string_view block_first_key(size_t block) const;
+
+    bool same_etag(size_t index, const MetadataStore& other, size_t other_index) const;
+
+    std::span<const char> keys_;              // Front-coded entries: shared, suffix length, suffix
+    std::span<const uint64_t> block_offsets_; // Offset in keys_ of every BLOCK_KEYS-th entry
+    std::span<const uint64_t> sizes_;
+    std::span<const int64_t> mtimes_;         // Seconds since the epoch (0 if unknown)
+    std::span<const std::array<uint8_t, 16>> etag_md5_;
+    std::span<const uint32_t> etag_parts_;    // 0: single-part ETag
+    std::unordered_map<size_t, std::string> etag_other_;
+    size_t dropped_keys_ = 0;
+
+    std::shared_ptr<const void> storage_;  // Owns what the views point into
+    size_t heap_bytes_ = 0;
+    bool mapped_ = false;
+};
+
+}  // namespace valkyrie
@@ -1,9 +1,108 @@
 #include "metrics_server.hpp"
+#include <cerrno>
+#include <cstring>
 #include <iostream>
 #include <sstream>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0  // macOS: SO_NOSIGPIPE is set per socket instead
+#endif
 
 namespace valkyrie {
 
+namespace {
+
+// Prometheus histogram from a log-linear one. Buckets are merged to powers of
+// two (le = inclusive upper bound / scale) up to the highest non-empty one.
+void write_histogram(std::ostringstream& oss, const std::string& name,
+                     const std::string& labels, const LogLinearHistogram& hist, double scale) {
+    constexpr size_t SUB = LogLinearHistogram::SUB_BUCKETS;
+    constexpr size_t GROUPS = LogLinearHistogram::NUM_BUCKETS / SUB;
+
+    uint64_t counts[GROUPS] = {};
+    size_t last_group = 0;
+    for (size_t g = 0; g < GROUPS; ++g) {
+        for (size_t i = g * SUB; i < (g + 1) * SUB; ++i) {
+            counts[g] += hist.bucket_count(i);
+        }
+        if (counts[g] > 0) last_group = g;
+    }
+
+    std::string prefix = labels.empty() ? "" : labels + ",";
+    auto saved_precision = oss.precision(12);
+
+    uint64_t cumulative = 0;
+    for (size_t g = 0; g <= last_group && g + 1 < GROUPS; ++g) {
+        cumulative += counts[g];
+        uint64_t upper = LogLinearHistogram::bucket_upper_bound((g + 1) * SUB - 1);
+        oss << name << "_bucket{" << prefix << "le=\"" << upper / scale << "\"} "
+            << cumulative << "\n";
+    }
+    for (size_t g = last_group + 1; g < GROUPS; ++g) {
+        cumulative += counts[g];  // Raced in since the scan above
+    }
+
+    // Count from the buckets so it matches +Inf under concurrent records
+    oss << name << "_bucket{" << prefix << "le=\"+Inf\"} " << cumulative << "\n";
+    std::string braces = labels.empty() ? "" : "{" + labels + "}";
+    oss << name << "_sum" << braces << " " << hist.sum() / scale << "\n";
+    oss << name << "_count" << braces << " " << cumulative << "\n";
+
+    oss.precision(saved_precision);
+}
+
+void write_header(std::ostringstream& oss, const char* name, const char* type,
+                  const char* help) {
+    oss << "# HELP " << name << " " << help << "\n";
+    oss << "# TYPE " << name << " " << type << "\n";
+}
+
+// Label values are quoted; backslash, quote and newline must be escaped
+std::string escape_label(const std::string& value) {
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (char c : value) {
+        if (c == '\\' || c == '"') escaped += '\\';
+        if (c == '\n') {
+            escaped += "\\n";
+            continue;
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+std::string seconds(uint64_t us) {
+    return std::to_string(us / 1e6);
+}
+
+const char* priority_label(Priority priority) {
+    switch (priority) {
+        case Priority::URGENT: return "urgent";
+        case Priority::NORMAL: return "normal";
+        case Priority::BACKGROUND: return "background";
+    }
+    return "unknown";
+}
+
+bool send_all(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        sent += n;
+    }
+    return true;
+}
+
+}  // namespace
+
 MetricsServer::MetricsServer(int port,
                              CacheManager& cache,
                              S3WorkerPool& worker_pool,
@@ -12,6 +111,7 @@ MetricsServer::MetricsServer(int port,
     , cache_(cache)
     , worker_pool_(worker_pool)
     , predictor_(predictor)
+    , listen_fd_(-1)
     , stop_flag_(false) {
 }
 
@@ -19,40 +119,407 @@ MetricsServer::~MetricsServer() {
     stop();
 }
 
-void MetricsServer::start() {
-    std::cout << "Metrics server: Disabled (not implemented in MVP)\n";
-    std::cout << "To view metrics, check statistics at shutdown or use Logger\n";
-    // server_thread_ = std::thread(&MetricsServer::server_loop, this);
+bool MetricsServer::start() {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port_));
+    if (::inet_pton(AF_INET, bind_address_.c_str(), &addr.sin_addr) != 1) {
+        std::cerr << "MetricsServer: Invalid bind address: " << bind_address_ << "\n";
+        return false;
+    }
+
+    listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd_ < 0) {
+        std::cerr << "MetricsServer: socket() failed: " << std::strerror(errno) << "\n";
+        return false;
+    }
+
+    // Remounts must not wait out TIME_WAIT from the previous process
+    int one = 1;
+    ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    socklen_t addr_len = sizeof(addr);
+    if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        ::listen(listen_fd_, 16) < 0 ||
+        ::getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &addr_len) < 0) {
+        std::cerr << "MetricsServer: Failed to listen on " << bind_address_ << ":" << port_
+                  << ": " << std::strerror(errno) << "\n";
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+    port_ = ntohs(addr.sin_port);
+
+    server_thread_ = std::thread(&MetricsServer::server_loop, this);
+    std::cout << "MetricsServer: Serving http://" << bind_address_ << ":" << port_ << "/metrics\n";
+    return true;
 }
 
 void MetricsServer::stop() {
-    stop_flag_ = true;
+    if (stop_flag_.exchange(true)) {
+        return;  // Already stopped
+    }
+
     if (server_thread_.joinable()) {
         server_thread_.join();
     }
+
+    if (listen_fd_ >= 0) {
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+    }
 }
 
 void MetricsServer::server_loop() {
-    // TODO: Implement HTTP server using cpp-httplib
-    // For now, this is a no-op stub
+    while (!stop_flag_) {
+        pollfd pfd{listen_fd_, POLLIN, 0};
+        int ready = ::poll(&pfd, 1, POLL_INTERVAL_MS);
+        if (ready <= 0) continue;  // Timeout or EINTR: re-check stop flag
+
+        int client_fd = ::accept(listen_fd_, nullptr, nullptr);
+        if (client_fd < 0) continue;
+
+        // A stuck scraper must not wedge the metrics thread
+        timeval timeout{CLIENT_TIMEOUT_SEC, 0};
+        ::setsockopt(client_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        ::setsockopt(client_fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+#ifdef SO_NOSIGPIPE
+        int one = 1;
+        ::setsockopt(client_fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+
+        handle_client(client_fd);
+        ::close(client_fd);
+    }
+}
+
+void MetricsServer::handle_client(int client_fd) {
+    // One request per connection; only the request line matters
+    std::string request;
+    char buf[1024];
+    while (request.find("\r\n\r\n") == std::string::npos &&
+           request.find("\n\n") == std::string::npos) {
+        ssize_t n = ::recv(client_fd, buf, sizeof(buf), 0);
+        if (n <= 0) break;  // EOF, timeout or error
+        request.append(buf, n);
+        if (request.size() > MAX_REQUEST_LENGTH) break;
+    }
+
+    std::istringstream line(request.substr(0, request.find('\n')));
+    std::string method, target;
+    line >> method >> target;
+    std::string path = target.substr(0, target.find('?'));
+
+    std::string status, content_type = "text/plain; charset=utf-8", body;
+    if (method != "GET" && method != "HEAD") {
+        status = "405 Method Not Allowed";
+        body = "Method not allowed\n";
+    } else if (path != "/metrics") {
+        status = "404 Not Found";
+        body = "Not found (try /metrics)\n";
+    } else {
+        status = "200 OK";
+        content_type = "text/plain; version=0.0.4; charset=utf-8";
+        body = generate_prometheus_metrics();
+    }
+
+    std::string response = "HTTP/1.0 " + status + "\r\n"
+                           "Content-Type: " + content_type + "\r\n"
+                           "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                           "Connection: close\r\n\r\n";
+    if (method != "HEAD") {
+        response += body;
+    }
+    send_all(client_fd, response);
+}
+
+// Reader stall accounting. rate() of the stalled seconds of one reader is
+// the fraction of its time spent waiting on S3.
+void MetricsServer::write_stalls(std::ostringstream& oss) const {
+    auto stalls = read_stats_->stalls.snapshot(StallTracker::TOP_FILES);
+
+    write_header(oss, "valkyrie_read_seconds_total", "counter",
+                 "Time FUSE reads took, blocked on S3 (stalled) or served from cache");
+    oss << "valkyrie_read_seconds_total{state=\"stalled\"} " << seconds(stalls.total.stall_us) << "\n";
+    oss << "valkyrie_read_seconds_total{state=\"served\"} " << seconds(stalls.total.served_us()) << "\n\n";
+
+    write_header(oss, "valkyrie_data_stall_ratio", "gauge",
+                 "Share of readers' active time spent blocked on S3");
+    oss << "valkyrie_data_stall_ratio " << stalls.stall_ratio() << "\n\n";
+
+    write_header(oss, "valkyrie_reader_stall_seconds_total", "counter",
+                 "Time each reader process spent blocked on S3");
+    for (const auto& [pid, totals] : stalls.readers) {
+        oss << "valkyrie_reader_stall_seconds_total{pid=\"" << pid << "\"} "
+            << seconds(totals.stall_us) << "\n";
+    }
+    oss << "\n";
+
+    write_header(oss, "valkyrie_reader_read_bytes_total", "counter",
+                 "Bytes delivered to each reader process");
+    for (const auto& [pid, totals] : stalls.readers) {
+        oss << "valkyrie_reader_read_bytes_total{pid=\"" << pid << "\"} " << totals.bytes << "\n";
+    }
+    oss << "\n";
+
+    write_header(oss, "valkyrie_reader_data_stall_ratio", "gauge",
+                 "Share of each reader's time since its first read spent blocked on S3");
+    for (const auto& [pid, totals] : stalls.readers) {
+        oss << "valkyrie_reader_data_stall_ratio{pid=\"" << pid << "\"} "
+            << totals.stall_ratio() << "\n";
+    }
+    oss << "\n";
+
+    write_header(oss, "valkyrie_file_stall_seconds_total", "counter",
+                 "Time reads of the most stalled files spent blocked on S3");
+    for (const auto& [key, totals] : stalls.files) {
+        if (totals.stall_us == 0) break;  // Most stalled first
+        oss << "valkyrie_file_stall_seconds_total{key=\"" << escape_label(key) << "\"} "
+            << seconds(totals.stall_us) << "\n";
+    }
+    oss << "\n";
 }
 
 std::string MetricsServer::generate_prometheus_metrics() {
-    const auto& cache_stats = cache_.get_stats();
     const auto& worker_stats = worker_pool_.get_stats();
-    // predictor_stats not needed for MVP metrics
+    const auto& predictor_stats = predictor_.get_stats();
 
     std::ostringstream oss;
 
     // Prometheus format
     oss << "# HELP valkyrie_cache_size_bytes Current cache size in bytes\n";
     oss << "# TYPE valkyrie_cache_size_bytes gauge\n";
-    oss << "valkyrie_cache_size_bytes " << cache_stats.current_size << "\n\n";
+    oss << "valkyrie_cache_size_bytes " << cache_.get_size() << "\n\n";
+
+    write_header(oss, "valkyrie_cache_capacity_bytes", "gauge", "Configured cache size in bytes");
+    oss << "valkyrie_cache_capacity_bytes " << cache_.get_max_size() << "\n\n";
+
+    write_header(oss, "valkyrie_cache_files", "gauge", "Files with cached chunks");
+    oss << "valkyrie_cache_files " << cache_.get_num_files() << "\n\n";
+
+    write_header(oss, "valkyrie_cache_chunks", "gauge", "Cached chunks");
+    oss << "valkyrie_cache_chunks " << cache_.get_num_chunks() << "\n\n";
+
+    write_header(oss, "valkyrie_cache_zone_bytes", "gauge", "Cached bytes by zone");
+    oss << "valkyrie_cache_zone_bytes{zone=\"hot\"} " << cache_.get_hot_zone_size() << "\n";
+    oss << "valkyrie_cache_zone_bytes{zone=\"prefetch\"} " << cache_.get_prefetch_zone_size() << "\n\n";
+
+    write_header(oss, "valkyrie_cache_pinned_bytes", "gauge", "Bytes reserved by pinned files");
+    oss << "valkyrie_cache_pinned_bytes " << cache_.get_pinned_bytes() << "\n\n";
 
     oss << "# HELP valkyrie_downloads_total Total S3 downloads\n";
     oss << "# TYPE valkyrie_downloads_total counter\n";
     oss << "valkyrie_downloads_total " << worker_stats.total_downloads << "\n\n";
 
+    write_header(oss, "valkyrie_downloads_succeeded_total", "counter", "Successful S3 downloads");
+    oss << "valkyrie_downloads_succeeded_total " << worker_stats.successful_downloads << "\n\n";
+
+    write_header(oss, "valkyrie_downloads_failed_total", "counter", "Failed S3 downloads");
+    oss << "valkyrie_downloads_failed_total " << worker_stats.failed_downloads << "\n\n";
+
+    write_header(oss, "valkyrie_downloaded_bytes_total", "counter", "Bytes downloaded from S3");
+    oss << "valkyrie_downloaded_bytes_total " << worker_stats.bytes_downloaded << "\n\n";
+
+    write_header(oss, "valkyrie_prefetches_skipped_total", "counter",
+                 "Queued prefetches already cached when a worker picked them up");
+    oss << "valkyrie_prefetches_skipped_total " << worker_stats.prefetches_skipped << "\n\n";
+
+    write_header(oss, "valkyrie_workers", "gauge", "S3 worker threads");
+    oss << "valkyrie_workers " << worker_pool_.get_num_workers() << "\n\n";
+
+    if (read_stats_) {
+        write_header(oss, "valkyrie_read_latency_seconds", "histogram",
+                     "FUSE read latency by cache outcome");
+        write_histogram(oss, "valkyrie_read_latency_seconds", "result=\"hit\"",
+                        read_stats_->hit_latency_us, 1e6);
+        write_histogram(oss, "valkyrie_read_latency_seconds", "result=\"miss\"",
+                        read_stats_->miss_latency_us, 1e6);
+        oss << "\n";
+
+        write_header(oss, "valkyrie_read_bytes_total", "counter", "Bytes delivered to readers");
+        oss << "valkyrie_read_bytes_total " << read_stats_->bytes_read << "\n\n";
+
+        write_stalls(oss);
+    }
+
+    write_header(oss, "valkyrie_s3_ttfb_seconds", "histogram",
+                 "S3 GET time to first byte");
+    write_histogram(oss, "valkyrie_s3_ttfb_seconds", "", worker_stats.ttfb_us, 1e6);
+    oss << "\n";
+
+    write_header(oss, "valkyrie_s3_throughput_bytes_per_second", "histogram",
+                 "S3 GET body transfer rate per download");
+    write_histogram(oss, "valkyrie_s3_throughput_bytes_per_second", "",
+                    worker_stats.throughput_bytes_per_sec, 1);
+    oss << "\n";
+
+    write_header(oss, "valkyrie_queue_wait_seconds", "histogram",
+                 "Time downloads wait in the worker queue, by priority");
+    for (size_t i = 0; i < NUM_PRIORITIES; ++i) {
+        auto priority = static_cast<Priority>(i);
+        write_histogram(oss, "valkyrie_queue_wait_seconds",
+                        std::string("priority=\"") + priority_label(priority) + "\"",
+                        worker_stats.queue_wait(priority), 1e6);
+    }
+    oss << "\n";
+
+    write_header(oss, "valkyrie_predictions_made_total", "counter", "Prediction rounds run");
+    oss << "valkyrie_predictions_made_total " << predictor_stats.predictions_made << "\n\n";
+
+    write_header(oss, "valkyrie_prefetches_issued_total", "counter", "Prefetch downloads submitted");
+    oss << "valkyrie_prefetches_issued_total " << predictor_stats.prefetches_issued << "\n\n";
+
+    write_header(oss, "valkyrie_prediction_rounds_total", "counter",
+                 "Prediction rounds answered, by predictor");
+    oss << "valkyrie_prediction_rounds_total{predictor=\"pattern\"} " << predictor_stats.pattern_hits << "\n";
+    oss << "valkyrie_prediction_rounds_total{predictor=\"manifest\"} " << predictor_stats.manifest_hits << "\n";
+    oss << "valkyrie_prediction_rounds_total{predictor=\"markov\"} " << predictor_stats.markov_hits << "\n";
+    oss << "valkyrie_prediction_rounds_total{predictor=\"shuffle\"} " << predictor_stats.shuffle_hits << "\n\n";
+
+    write_header(oss, "valkyrie_readahead_chunks_total", "counter",
+                 "Chunks prefetched ahead of the reader within a file");
+    oss << "valkyrie_readahead_chunks_total " << predictor_stats.readahead_issued << "\n\n";
+
+    write_header(oss, "valkyrie_tar_member_chunks_total", "counter",
+                 "Chunks prefetched for the next tar archive members");
+    oss << "valkyrie_tar_member_chunks_total " << predictor_stats.member_readahead_issued << "\n\n";
+
+    write_header(oss, "valkyrie_epoch_rollovers_total", "counter",
+                 "Epoch boundaries detected from the access stream");
+    oss << "valkyrie_epoch_rollovers_total " << predictor_stats.epoch_rollovers << "\n\n";
+
+    oss << "# HELP valkyrie_read_bytes_per_second Reader consumption rate\n";
+    oss << "# TYPE valkyrie_read_bytes_per_second gauge\n";
+    oss << "valkyrie_read_bytes_per_second " << predictor_stats.consumption_bytes_per_sec << "\n\n";
+
+    oss << "# HELP valkyrie_s3_bandwidth_bytes_per_second Achieved S3 bandwidth across workers\n";
+    oss << "# TYPE valkyrie_s3_bandwidth_bytes_per_second gauge\n";
+    oss << "valkyrie_s3_bandwidth_bytes_per_second " << predictor_stats.download_bytes_per_sec << "\n\n";
+
+    write_header(oss, "valkyrie_s3_latency_seconds", "gauge",
+                 "Recent S3 time to first byte seen by the adaptive window");
+    oss << "valkyrie_s3_latency_seconds " << seconds(predictor_stats.download_latency_us) << "\n\n";
+
+    oss << "# HELP valkyrie_prefetch_window_bytes Adaptive prefetch window in bytes\n";
+    oss << "# TYPE valkyrie_prefetch_window_bytes gauge\n";
+    oss << "valkyrie_prefetch_window_bytes " << predictor_stats.window_bytes << "\n\n";
+
+    oss << "# HELP valkyrie_prefetch_window_files Adaptive prefetch window in files\n";
+    oss << "# TYPE valkyrie_prefetch_window_files gauge\n";
+    oss << "valkyrie_prefetch_window_files " << predictor_stats.window_files << "\n\n";
+
+    oss << "# HELP valkyrie_prefetch_unread_bytes Prefetched bytes in cache not yet read\n";
+    oss << "# TYPE valkyrie_prefetch_unread_bytes gauge\n";
+    oss << "valkyrie_prefetch_unread_bytes " << cache_.get_unread_prefetch_bytes() << "\n\n";
+
+    oss << "# HELP valkyrie_prefetch_deferred_total Prefetches held back by the cache budget\n";
+    oss << "# TYPE valkyrie_prefetch_deferred_total counter\n";
+    oss << "valkyrie_prefetch_deferred_total " << predictor_stats.prefetches_deferred << "\n\n";
+
+    write_header(oss, "valkyrie_parquet_footers_total", "counter",
+                 "Parquet footers fetched, by outcome");
+    oss << "valkyrie_parquet_footers_total{result=\"parsed\"} " << predictor_stats.parquet_footers_parsed << "\n";
+    oss << "valkyrie_parquet_footers_total{result=\"error\"} " << predictor_stats.parquet_footer_errors << "\n\n";
+
+    oss << "# HELP valkyrie_parquet_column_chunks_total Chunks prefetched from Parquet footer layouts\n";
+    oss << "# TYPE valkyrie_parquet_column_chunks_total counter\n";
+    oss << "valkyrie_parquet_column_chunks_total " << predictor_stats.parquet_chunks_issued << "\n\n";
+
+    write_header(oss, "valkyrie_record_indexes_loaded_total", "counter",
+                 "Record index sidecars loaded");
+    oss << "valkyrie_record_indexes_loaded_total " << predictor_stats.record_indexes_loaded << "\n\n";
+
+    oss << "# HELP valkyrie_record_prefetches_total Record-aligned prefetch requests\n";
+    oss << "# TYPE valkyrie_record_prefetches_total counter\n";
+    oss << "valkyrie_record_prefetches_total " << predictor_stats.record_prefetches << "\n\n";
+
+    oss << "# HELP valkyrie_record_prefetch_bytes_total Bytes requested by record-aligned prefetches\n";
+    oss << "# TYPE valkyrie_record_prefetch_bytes_total counter\n";
+    oss << "valkyrie_record_prefetch_bytes_total " << predictor_stats.record_prefetch_bytes << "\n\n";
+
+    if (tar_indexer_) {
+        const auto& tar_stats = tar_indexer_->get_stats();
+
+        write_header(oss, "valkyrie_tar_archives_indexed_total", "counter",
+                     "Tar archives indexed to the end");
+        oss << "valkyrie_tar_archives_indexed_total " << tar_stats.archives_indexed << "\n\n";
+
+        write_header(oss, "valkyrie_tar_members_indexed_total", "counter", "Tar members indexed");
+        oss << "valkyrie_tar_members_indexed_total " << tar_stats.members_indexed << "\n\n";
+
+        write_header(oss, "valkyrie_tar_archives_invalid_total", "counter",
+                     "Objects named .tar that did not parse as tar");
+        oss << "valkyrie_tar_archives_invalid_total " << tar_stats.invalid_archives << "\n\n";
+    }
+
+    oss << "# HELP valkyrie_shuffle_epoch Epoch of the shuffled manifest the reader is in\n";
+    oss << "# TYPE valkyrie_shuffle_epoch gauge\n";
+    oss << "valkyrie_shuffle_epoch " << predictor_stats.shuffle_epoch << "\n\n";
+
+    const auto& outcomes = cache_.get_prefetch_outcomes();
+    auto write_outcome = [&](const char* name, const char* help, const char* unit,
+                             auto field) {
+        oss << "# HELP valkyrie_prefetch_" << name << "_" << unit << "_total " << help << "\n";
+        oss << "# TYPE valkyrie_prefetch_" << name << "_" << unit << "_total counter\n";
+        for (size_t i = 0; i < NUM_PREDICTION_SOURCES; ++i) {
+            auto source = static_cast<PredictionSource>(i);
+            oss << "valkyrie_prefetch_" << name << "_" << unit << "_total{source=\""
+                << to_string(source) << "\"} " << field(outcomes.source(source)) << "\n";
+        }
+        oss << "\n";
+    };
+
+    using Outcome = PrefetchOutcomes::PerSource;
+    write_outcome("useful", "Prefetched chunks read before eviction", "chunks",
+                  [](const Outcome& o) { return o.useful.count.load(); });
+    write_outcome("useful", "Prefetched bytes read before eviction", "bytes",
+                  [](const Outcome& o) { return o.useful.bytes.load(); });
+    write_outcome("wasted", "Prefetched chunks evicted unread", "chunks",
+                  [](const Outcome& o) { return o.wasted.count.load(); });
+    write_outcome("wasted", "Prefetched bytes evicted unread", "bytes",
+                  [](const Outcome& o) { return o.wasted.bytes.load(); });
+    write_outcome("late", "Prefetches the reader waited on while in flight", "chunks",
+                  [](const Outcome& o) { return o.late.count.load(); });
+    write_outcome("late", "Bytes of prefetches the reader waited on", "bytes",
+                  [](const Outcome& o) { return o.late.bytes.load(); });
+
+    write_header(oss, "valkyrie_prefetch_lead_time_seconds", "histogram",
+                 "Time from prefetch landing to first read, by source");
+    for (size_t i = 0; i < NUM_PREDICTION_SOURCES; ++i) {
+        auto source = static_cast<PredictionSource>(i);
+        write_histogram(oss, "valkyrie_prefetch_lead_time_seconds",
+                        std::string("source=\"") + to_string(source) + "\"",
+                        outcomes.source(source).lead_time_us, 1e6);
+    }
+    oss << "\n";
+
+    oss << "# HELP valkyrie_predictions_total Distinct keys predicted, by source\n";
+    oss << "# TYPE valkyrie_predictions_total counter\n";
+    for (size_t i = 0; i < NUM_PREDICTION_SOURCES; ++i) {
+        auto source = static_cast<PredictionSource>(i);
+        oss << "valkyrie_predictions_total{source=\"" << to_string(source) << "\"} "
+            << predictor_stats.source(source).predicted << "\n";
+    }
+    oss << "\n";
+
+    oss << "# HELP valkyrie_predictions_correct_total Predicted keys later opened, by source\n";
+    oss << "# TYPE valkyrie_predictions_correct_total counter\n";
+    for (size_t i = 0; i < NUM_PREDICTION_SOURCES; ++i) {
+        auto source = static_cast<PredictionSource>(i);
+        oss << "valkyrie_predictions_correct_total{source=\"" << to_string(source) << "\"} "
+            << predictor_stats.source(source).correct << "\n";
+    }
+    oss << "\n";
+
+    oss << "# HELP valkyrie_prediction_accuracy Fraction of predicted keys later opened, by source\n";
+    oss << "# TYPE valkyrie_prediction_accuracy gauge\n";
+    for (size_t i = 0; i < NUM_PREDICTION_SOURCES; ++i) {
+        auto source = static_cast<PredictionSource>(i);
+        oss << "valkyrie_prediction_accuracy{source=\"" << to_string(source) << "\"} "
+            << predictor_stats.accuracy(source) << "\n";
+    }
+    oss << "\n";
+
     return oss.str();
 }
 
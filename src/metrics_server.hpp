@@ -3,12 +3,21 @@
 #include "cache_manager.hpp"
 #include "s3_worker_pool.hpp"
 #include "predictor.hpp"
+#include "read_stats.hpp"
+#include "tar_index.hpp"
 #include <memory>
 #include <atomic>
 #include <thread>
+#include <string>
+#include <sstream>
 
 namespace valkyrie {
 
+// Prometheus endpoint: a minimal HTTP/1.0 server answering GET /metrics on
+// one background thread. It has no authentication and exports object keys,
+// so it listens on loopback unless told otherwise. Every value is read from atomics or lock-free
+// histograms, so a scrape never waits on (or stalls) the data path. Stall
+// accounting is the exception: it briefly locks each per-thread shard.
 class MetricsServer {
 public:
     MetricsServer(int port,
@@ -18,20 +27,46 @@ public:
 
     ~MetricsServer();
 
-    void start();
+    // Bind the port and start serving; false if binding fails.
+    // Port 0 binds an ephemeral port (see get_port()).
+    bool start();
     void stop();
 
+    // Export FUSE read latency (nullptr omits it). Call before start().
+    void set_read_stats(const ReadStats* read_stats) { read_stats_ = read_stats; }
+
+    // IPv4 address to listen on (default loopback only). Call before start().
+    void set_bind_address(const std::string& address) { bind_address_ = address; }
+
+    // Export tar indexing counts (nullptr omits them). Call before start().
+    void set_tar_indexer(const TarIndexer* tar_indexer) { tar_indexer_ = tar_indexer; }
+
+    // Port actually bound (after start())
+    int get_port() const { return port_; }
+
+    // Metrics in the Prometheus text exposition format
+    std::string generate_prometheus_metrics();
+
 private:
     void server_loop();
-    std::string generate_prometheus_metrics();
+    void handle_client(int client_fd);
+    void write_stalls(std::ostringstream& oss) const;
 
     int port_;
+    std::string bind_address_ = "127.0.0.1";
     CacheManager& cache_;
     S3WorkerPool& worker_pool_;
     Predictor& predictor_;
+    const ReadStats* read_stats_ = nullptr;
+    const TarIndexer* tar_indexer_ = nullptr;
 
+    int listen_fd_;
     std::thread server_thread_;
     std::atomic<bool> stop_flag_;
+
+    static constexpr int POLL_INTERVAL_MS = 200;
+    static constexpr int CLIENT_TIMEOUT_SEC = 5;
+    static constexpr size_t MAX_REQUEST_LENGTH = 8192;
 };
 
 }  // namespace valkyrie
@@ -0,0 +1,183 @@
+#include "parallel_lister.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace valkyrie {
+
+namespace {
+
+// Keys are compared as fixed-point numbers of MIDPOINT_DIGITS base-95
+// digits (' ' = 0 ... '~' = 94) after their common prefix
+constexpr size_t MIDPOINT_DIGITS = 8;
+constexpr uint64_t KEY_BASE = 95;
+
+bool to_digit(char c, uint64_t& digit) {
+    if (c < ' ' || c > '~') return false;
+    digit = static_cast<uint64_t>(c - ' ');
+    return true;
+}
+
+// Keys `after` < k <= `upto`; "" upto is unbounded
+struct KeyRange {
+    std::string after;
+    std::string upto;
+};
+
+}  // namespace
+
+std::string key_midpoint(const std::string& lo, const std::string& hi) {
+    size_t common = 0;
+    if (!hi.empty()) {
+        while (common < lo.size() && common < hi.size() && lo[common] == hi[common]) ++common;
+    }
+
+    uint64_t lo_value = 0;
+    uint64_t hi_value = 0;
+    for (size_t i = 0; i < MIDPOINT_DIGITS; ++i) {
+        uint64_t lo_digit = 0;
+        uint64_t hi_digit = 0;
+        if (common + i < lo.size() && !to_digit(lo[common + i], lo_digit)) return "";
+        if (common + i < hi.size() && !to_digit(hi[common + i], hi_digit)) return "";
+        lo_value = lo_value * KEY_BASE + lo_digit;
+        hi_value = hi_value * KEY_BASE + hi_digit;
+    }
+    if (hi.empty()) {
+        hi_value = 1;  // One past the largest window: KEY_BASE^MIDPOINT_DIGITS
+        for (size_t i = 0; i < MIDPOINT_DIGITS; ++i) hi_value *= KEY_BASE;
+    }
+
+    uint64_t mid = lo_value + (hi_value - lo_value) / 2;
+    if (hi_value <= lo_value || mid == lo_value) return "";
+
+    std::string digits(MIDPOINT_DIGITS, ' ');
+    for (size_t i = MIDPOINT_DIGITS; i-- > 0;) {
+        digits[i] = static_cast<char>(' ' + mid % KEY_BASE);
+        mid /= KEY_BASE;
+    }
+    // Trailing zero digits only lengthen the key
+    digits.erase(digits.find_last_not_of(' ') + 1);
+    return lo.substr(0, common) + digits;
+}
+
+std::vector<ObjectInfo> list_partitioned(const PageFetcher& fetch,
+                                         const std::vector<std::string>& split_points,
+                                         int threads,
+                                         ListStats* stats,
+                                         const std::atomic<bool>* cancel) {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<KeyRange> pending;
+    int idle = 0;
+    bool done = false;  // Every lister idle with nothing pending
+    int running = std::max(threads, 1);
+    std::exception_ptr error;
+    ListStats totals;
+
+    std::string previous;
+    for (const auto& point : split_points) {
+        if (point.empty() || point <= previous) continue;
+        pending.push_back({previous, point});
+        previous = point;
+    }
+    pending.push_back({previous, ""});
+    totals.partitions = pending.size();
+
+    auto cancelled = [&] { return cancel != nullptr && cancel->load(); };
+
+    // Each lister keeps its own results; ranges are disjoint
+    std::vector<std::vector<ObjectInfo>> results(running);
+
+    auto lister = [&](size_t index) {
+        std::vector<ObjectInfo>& out = results[index];
+        std::unique_lock<std::mutex> lock(mutex);
+
+        while (true) {
+            ++idle;
+            if (idle == running && pending.empty()) {
+                done = true;
+                cv.notify_all();
+            }
+            // Timed, so an external cancel is noticed
+            while (pending.empty() && !done && !error && !cancelled()) {
+                cv.wait_for(lock, std::chrono::milliseconds(100));
+            }
+            if (done || error || cancelled()) {
+                cv.notify_all();
+                return;
+            }
+            --idle;
+            KeyRange range = std::move(pending.front());
+            pending.pop_front();
+
+            std::string after = range.after;
+            while (true) {
+                lock.unlock();
+                ListPage page;
+                try {
+                    page = fetch(after);
+                } catch (...) {
+                    lock.lock();
+                    if (!error) error = std::current_exception();
+                    cv.notify_all();
+                    return;
+                }
+
+                bool past_end = false;
+                for (auto& obj : page.objects) {
+                    if (!range.upto.empty() && obj.key > range.upto) {
+                        past_end = true;  // Belongs to the next range
+                        break;
+                    }
+                    out.push_back(std::move(obj));
+                }
+                lock.lock();
+                ++totals.requests;
+
+                if (past_end || !page.truncated || page.objects.empty() || error || cancelled()) break;
+                after = out.back().key;
+
+                // Hand the upper half of what is left to an idle lister
+                if (idle > 0 && pending.empty()) {
+                    std::string mid = key_midpoint(after, range.upto);
+                    if (!mid.empty()) {
+                        pending.push_back({mid, range.upto});
+                        range.upto = mid;
+                        ++totals.partitions;
+                        cv.notify_one();
+                    }
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int i = 1; i < running; ++i) {
+        workers.emplace_back(lister, static_cast<size_t>(i));
+    }
+    lister(0);
+    for (auto& worker : workers) worker.join();
+
+    if (error) std::rethrow_exception(error);
+
+    size_t total = 0;
+    for (const auto& part : results) total += part.size();
+    std::vector<ObjectInfo> objects;
+    objects.reserve(total);
+    for (auto& part : results) {
+        std::move(part.begin(), part.end(), std::back_inserter(objects));
+    }
+    std::sort(objects.begin(), objects.end(),
+              [](const ObjectInfo& a, const ObjectInfo& b) { return a.key < b.key; });
+
+    if (stats != nullptr) *stats = totals;
+    return objects;
+}
+
+}  // namespace valkyrie
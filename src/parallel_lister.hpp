@@ -0,0 +1,43 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace valkyrie {
+
+// One ListObjectsV2 page: the first keys after `start_after`, in key order
+struct ListPage {
+    std::vector<ObjectInfo> objects;
+    bool truncated = false;  // More keys follow the last one
+};
+
+using PageFetcher = std::function<ListPage(const std::string& start_after)>;
+
+// A key strictly between `lo` and `hi` (hi "" is unbounded), near the middle
+// of the printable-ASCII keyspace between them. "" when there is none at
+// this resolution or the keys are not printable ASCII where they differ.
+std::string key_midpoint(const std::string& lo, const std::string& hi);
+
+struct ListStats {
+    size_t partitions = 0;  // Key ranges listed, including ranges split off
+    size_t requests = 0;    // Pages fetched
+};
+
+// List every key with `threads` concurrent listers and no object cap.
+// The keyspace starts as the ranges between `split_points` (sorted keys,
+// e.g. the top-level common prefixes); a range still truncated after a
+// page hands the upper half of what is left to any idle lister, so a flat
+// namespace spreads over all threads too. Result sorted by key. The first
+// fetch error is rethrown; `cancel` stops early with a partial result.
+std::vector<ObjectInfo> list_partitioned(const PageFetcher& fetch,
+                                         const std::vector<std::string>& split_points,
+                                         int threads,
+                                         ListStats* stats = nullptr,
+                                         const std::atomic<bool>* cancel = nullptr);
+
+}  // namespace valkyrie
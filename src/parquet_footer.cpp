@@ -0,0 +1,351 @@
+#include "parquet_footer.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace valkyrie {
+
+namespace {
+
+// Thrift compact protocol type ids
+enum CompactType : uint8_t {
+    T_STOP = 0,
+    T_BOOL_TRUE = 1,
+    T_BOOL_FALSE = 2,
+    T_BYTE = 3,
+    T_I16 = 4,
+    T_I32 = 5,
+    T_I64 = 6,
+    T_DOUBLE = 7,
+    T_BINARY = 8,
+    T_LIST = 9,
+    T_SET = 10,
+    T_MAP = 11,
+    T_STRUCT = 12
+};
+
+// Bounds-checked Thrift compact reader. Any overrun or malformed header
+// clears ok(); subsequent reads return zero values.
+class CompactReader {
+public:
+    CompactReader(const char* data, size_t size)
+        : pos_(reinterpret_cast<const uint8_t*>(data))
+        , end_(pos_ + size) {}
+
+    bool ok() const { return ok_; }
+
+    uint8_t byte() {
+        if (pos_ >= end_) return fail();
+        return *pos_++;
+    }
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t b = byte();
+            value |= static_cast<uint64_t>(b & 0x7f) << shift;
+            if (!(b & 0x80)) return value;
+        }
+        return fail();
+    }
+
+    int64_t zigzag() {
+        uint64_t n = varint();
+        return static_cast<int64_t>(n >> 1) ^ -static_cast<int64_t>(n & 1);
+    }
+
+    std::string binary() {
+        uint64_t length = varint();
+        if (length > static_cast<uint64_t>(end_ - pos_)) {
+            fail();
+            return {};
+        }
+        std::string value(reinterpret_cast<const char*>(pos_), length);
+        pos_ += length;
+        return value;
+    }
+
+    // Next field of a struct; false at STOP (or on error)
+    bool field(int16_t& id, uint8_t& type) {
+        uint8_t header = byte();
+        type = header & 0x0f;
+        if (!ok_ || type == T_STOP) return false;
+
+        uint8_t delta = header >> 4;
+        id = delta != 0 ? static_cast<int16_t>(id + delta)
+                        : static_cast<int16_t>(zigzag());
+        return ok_;
+    }
+
+    void list_header(uint64_t& size, uint8_t& elem_type) {
+        uint8_t header = byte();
+        size = header >> 4;
+        elem_type = header & 0x0f;
+        if (size == 15) {
+            size = varint();
+        }
+        // Every element takes at least one byte
+        if (size > static_cast<uint64_t>(end_ - pos_)) {
+            fail();
+            size = 0;
+        }
+    }
+
+    void skip(uint8_t type, int depth = 0) {
+        if (depth > MAX_DEPTH) {
+            fail();
+            return;
+        }
+
+        switch (type) {
+            case T_BOOL_TRUE:
+            case T_BOOL_FALSE:
+                break;  // Value is in the field header
+            case T_BYTE:
+                byte();
+                break;
+            case T_I16:
+            case T_I32:
+            case T_I64:
+                varint();
+                break;
+            case T_DOUBLE:
+                advance(8);
+                break;
+            case T_BINARY:
+                advance(varint());
+                break;
+            case T_LIST:
+            case T_SET: {
+                uint64_t size;
+                uint8_t elem_type;
+                list_header(size, elem_type);
+                for (uint64_t i = 0; i < size && ok_; ++i) {
+                    if (elem_type == T_BOOL_TRUE || elem_type == T_BOOL_FALSE) {
+                        byte();  // List bools take a byte each
+                    } else {
+                        skip(elem_type, depth + 1);
+                    }
+                }
+                break;
+            }
+            case T_MAP: {
+                uint64_t size = varint();
+                if (size == 0) break;
+                uint8_t types = byte();
+                for (uint64_t i = 0; i < size && ok_; ++i) {
+                    skip(types >> 4, depth + 1);
+                    skip(types & 0x0f, depth + 1);
+                }
+                break;
+            }
+            case T_STRUCT: {
+                int16_t id = 0;
+                uint8_t field_type;
+                while (field(id, field_type)) {
+                    skip(field_type, depth + 1);
+                }
+                break;
+            }
+            default:
+                fail();
+        }
+    }
+
+private:
+    uint8_t fail() {
+        ok_ = false;
+        pos_ = end_;
+        return 0;
+    }
+
+    void advance(uint64_t n) {
+        if (n > static_cast<uint64_t>(end_ - pos_)) {
+            fail();
+            return;
+        }
+        pos_ += n;
+    }
+
+    const uint8_t* pos_;
+    const uint8_t* end_;
+    bool ok_ = true;
+
+    static constexpr int MAX_DEPTH = 64;
+};
+
+// parquet.thrift field ids used below
+constexpr int16_t FILE_META_NUM_ROWS = 3;
+constexpr int16_t FILE_META_ROW_GROUPS = 4;
+constexpr int16_t ROW_GROUP_COLUMNS = 1;
+constexpr int16_t COLUMN_CHUNK_FILE_PATH = 1;
+constexpr int16_t COLUMN_CHUNK_META_DATA = 3;
+constexpr int16_t COLUMN_META_PATH_IN_SCHEMA = 3;
+constexpr int16_t COLUMN_META_TOTAL_COMPRESSED_SIZE = 7;
+constexpr int16_t COLUMN_META_DATA_PAGE_OFFSET = 9;
+constexpr int16_t COLUMN_META_DICTIONARY_PAGE_OFFSET = 11;
+
+// ColumnMetaData -> chunk range; false if required fields are missing
+bool parse_column_meta(CompactReader& reader, ParquetColumnChunk& chunk) {
+    std::optional<int64_t> data_page_offset, dictionary_page_offset, compressed_size;
+
+    int16_t id = 0;
+    uint8_t type;
+    while (reader.field(id, type)) {
+        if (id == COLUMN_META_PATH_IN_SCHEMA && type == T_LIST) {
+            uint64_t size;
+            uint8_t elem_type;
+            reader.list_header(size, elem_type);
+            for (uint64_t i = 0; i < size && reader.ok(); ++i) {
+                if (i > 0) chunk.path += ".";
+                chunk.path += reader.binary();
+            }
+        } else if (id == COLUMN_META_TOTAL_COMPRESSED_SIZE && type == T_I64) {
+            compressed_size = reader.zigzag();
+        } else if (id == COLUMN_META_DATA_PAGE_OFFSET && type == T_I64) {
+            data_page_offset = reader.zigzag();
+        } else if (id == COLUMN_META_DICTIONARY_PAGE_OFFSET && type == T_I64) {
+            dictionary_page_offset = reader.zigzag();
+        } else {
+            reader.skip(type);
+        }
+    }
+
+    if (!reader.ok() || !data_page_offset || !compressed_size ||
+        *data_page_offset < 0 || *compressed_size < 0) {
+        return false;
+    }
+
+    // The dictionary page, when present, precedes the data pages
+    int64_t start = *data_page_offset;
+    if (dictionary_page_offset && *dictionary_page_offset > 0 &&
+        *dictionary_page_offset < start) {
+        start = *dictionary_page_offset;
+    }
+
+    chunk.offset = static_cast<uint64_t>(start);
+    chunk.length = static_cast<uint64_t>(*compressed_size);
+    return true;
+}
+
+}  // namespace
+
+bool ParquetFooter::is_parquet_key(const std::string& s3_key) {
+    static const std::string suffix = ".parquet";
+    return s3_key.size() > suffix.size() &&
+           s3_key.compare(s3_key.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+std::optional<uint32_t> ParquetFooter::metadata_length(const char* tail, size_t size) {
+    if (size < TAIL_SIZE || std::memcmp(tail + size - 4, "PAR1", 4) != 0) {
+        return std::nullopt;
+    }
+
+    const auto* bytes = reinterpret_cast<const uint8_t*>(tail + size - TAIL_SIZE);
+    uint32_t length = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) |
+                      (static_cast<uint32_t>(bytes[3]) << 24);
+    if (length == 0 || length > MAX_METADATA_LENGTH) {
+        return std::nullopt;
+    }
+    return length;
+}
+
+bool ParquetFooter::parse(const char* metadata, size_t size) {
+    column_chunks_.clear();
+    num_row_groups_ = 0;
+    num_rows_ = 0;
+
+    CompactReader reader(metadata, size);
+
+    int16_t id = 0;
+    uint8_t type;
+    while (reader.field(id, type)) {
+        if (id == FILE_META_NUM_ROWS && type == T_I64) {
+            num_rows_ = reader.zigzag();
+            continue;
+        }
+
+        if (id != FILE_META_ROW_GROUPS || type != T_LIST) {
+            reader.skip(type);
+            continue;
+        }
+
+        uint64_t num_groups;
+        uint8_t group_type;
+        reader.list_header(num_groups, group_type);
+
+        for (uint64_t g = 0; g < num_groups && reader.ok(); ++g) {
+            int16_t group_field = 0;
+            uint8_t group_field_type;
+            while (reader.field(group_field, group_field_type)) {
+                if (group_field != ROW_GROUP_COLUMNS || group_field_type != T_LIST) {
+                    reader.skip(group_field_type);
+                    continue;
+                }
+
+                uint64_t num_columns;
+                uint8_t column_type;
+                reader.list_header(num_columns, column_type);
+
+                for (uint64_t c = 0; c < num_columns && reader.ok(); ++c) {
+                    ParquetColumnChunk chunk;
+                    chunk.row_group = num_row_groups_;
+                    bool has_meta = false;
+                    bool external = false;  // Data lives in another file
+
+                    int16_t chunk_field = 0;
+                    uint8_t chunk_field_type;
+                    while (reader.field(chunk_field, chunk_field_type)) {
+                        if (chunk_field == COLUMN_CHUNK_FILE_PATH && chunk_field_type == T_BINARY) {
+                            external = !reader.binary().empty();
+                        } else if (chunk_field == COLUMN_CHUNK_META_DATA &&
+                                   chunk_field_type == T_STRUCT) {
+                            has_meta = parse_column_meta(reader, chunk);
+                        } else {
+                            reader.skip(chunk_field_type);
+                        }
+                    }
+
+                    if (has_meta && !external) {
+                        column_chunks_.push_back(std::move(chunk));
+                    }
+                }
+            }
+            num_row_groups_++;
+        }
+    }
+
+    if (!reader.ok()) {
+        column_chunks_.clear();
+        return false;
+    }
+
+    // Row groups are normally laid out in order already; make it explicit
+    std::stable_sort(column_chunks_.begin(), column_chunks_.end(),
+        [](const ParquetColumnChunk& a, const ParquetColumnChunk& b) {
+            return a.offset < b.offset;
+        });
+    return true;
+}
+
+std::vector<ParquetColumnChunk> ParquetFooter::select(const std::vector<std::string>& columns) const {
+    if (columns.empty()) {
+        return column_chunks_;
+    }
+
+    std::vector<ParquetColumnChunk> selected;
+    for (const auto& chunk : column_chunks_) {
+        for (const auto& column : columns) {
+            bool match = chunk.path == column ||
+                (chunk.path.size() > column.size() &&
+                 chunk.path.compare(0, column.size(), column) == 0 &&
+                 chunk.path[column.size()] == '.');
+            if (match) {
+                selected.push_back(chunk);
+                break;
+            }
+        }
+    }
+    return selected;
+}
+
+}  // namespace valkyrie
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <optional>
+#include <cstdint>
+#include <cstddef>
+
+namespace valkyrie {
+
+// Byte range of one column in one row group
+struct ParquetColumnChunk {
+    std::string path;   // Dotted column path ("a.b.c")
+    size_t row_group;
+    uint64_t offset;    // First page (dictionary page if present)
+    uint64_t length;    // Compressed size of all pages
+};
+
+// Layout read from a Parquet footer. A Parquet file ends with
+//   <FileMetaData (Thrift compact)> <4-byte LE metadata length> "PAR1"
+// Only the fields needed to locate column chunks are decoded; the rest is skipped.
+class ParquetFooter {
+public:
+    static bool is_parquet_key(const std::string& s3_key);
+
+    // Length of the FileMetaData given the file's last TAIL_SIZE bytes;
+    // nullopt if the magic is missing
+    static std::optional<uint32_t> metadata_length(const char* tail, size_t size);
+
+    // Decode FileMetaData. Returns false on malformed input.
+    bool parse(const char* metadata, size_t size);
+
+    const std::vector<ParquetColumnChunk>& column_chunks() const { return column_chunks_; }
+    size_t num_row_groups() const { return num_row_groups_; }
+    int64_t num_rows() const { return num_rows_; }
+
+    // Column chunks in file order, restricted to `columns` if non-empty. A
+    // column name selects itself and every nested field below it.
+    std::vector<ParquetColumnChunk> select(const std::vector<std::string>& columns) const;
+
+    static constexpr size_t TAIL_SIZE = 8;  // Length + magic
+    static constexpr uint32_t MAX_METADATA_LENGTH = 64 * 1024 * 1024;
+
+private:
+    std::vector<ParquetColumnChunk> column_chunks_;
+    size_t num_row_groups_ = 0;
+    int64_t num_rows_ = 0;
+};
+
+}  // namespace valkyrie
@@ -0,0 +1,348 @@
+#include "perf_compare.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+
+namespace valkyrie {
+
+namespace {
+
+// Recursive-descent reader for the JSON our benchmark tools write
+class JsonFlattener {
+public:
+    JsonFlattener(const std::string& text, std::map<std::string, double>& out)
+        : text_(text), out_(out) {}
+
+    bool run() {
+        skip_space();
+        if (!value("")) return false;
+        skip_space();
+        return pos_ == text_.size();
+    }
+
+private:
+    void skip_space() {
+        while (pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_]))) ++pos_;
+    }
+
+    bool consume(char c) {
+        skip_space();
+        if (pos_ < text_.size() && text_[pos_] == c) {
+            ++pos_;
+            return true;
+        }
+        return false;
+    }
+
+    static std::string join(const std::string& path, const std::string& key) {
+        return path.empty() ? key : path + "." + key;
+    }
+
+    bool string(std::string& result) {
+        if (!consume('"')) return false;
+        result.clear();
+        while (pos_ < text_.size() && text_[pos_] != '"') {
+            char c = text_[pos_++];
+            if (c == '\\') {
+                if (pos_ >= text_.size()) return false;
+                char escaped = text_[pos_++];
+                switch (escaped) {
+                    case 'n': c = '\n'; break;
+                    case 't': c = '\t'; break;
+                    case 'r': c = '\r'; break;
+                    case 'b': c = '\b'; break;
+                    case 'f': c = '\f'; break;
+                    case 'u':
+                        // Keys and ids are ASCII; keep other code points as '?'
+                        if (pos_ + 4 > text_.size()) return false;
+                        c = static_cast<char>(std::strtol(text_.substr(pos_, 4).c_str(), nullptr, 16));
+                        if (static_cast<unsigned char>(c) >= 0x80) c = '?';
+                        pos_ += 4;
+                        break;
+                    default: c = escaped; break;
+                }
+            }
+            result += c;
+        }
+        return consume('"');
+    }
+
+    // `id` receives an object's "id" string member, if it has one
+    bool value(const std::string& path, std::string* id = nullptr) {
+        skip_space();
+        if (pos_ >= text_.size()) return false;
+
+        char c = text_[pos_];
+        if (c == '{') return object(path, id);
+        if (c == '[') return array(path);
+        if (c == '"') {
+            std::string ignored;
+            return string(ignored);
+        }
+        for (const char* word : {"true", "false", "null"}) {
+            size_t length = std::char_traits<char>::length(word);
+            if (text_.compare(pos_, length, word) == 0) {
+                pos_ += length;
+                return true;
+            }
+        }
+
+        const char* start = text_.c_str() + pos_;
+        char* end = nullptr;
+        double number = std::strtod(start, &end);
+        if (end == start) return false;
+        pos_ += end - start;
+        out_[path] = number;
+        return true;
+    }
+
+    bool object(const std::string& path, std::string* id) {
+        consume('{');
+        if (consume('}')) return true;
+        do {
+            std::string key;
+            if (!string(key) || !consume(':')) return false;
+            skip_space();
+            if (key == "id" && id != nullptr && pos_ < text_.size() && text_[pos_] == '"') {
+                if (!string(*id)) return false;
+            } else if (!value(join(path, key))) {
+                return false;
+            }
+        } while (consume(','));
+        return consume('}');
+    }
+
+    bool array(const std::string& path) {
+        consume('[');
+        if (consume(']')) return true;
+        size_t index = 0;
+        do {
+            std::string element = join(path, std::to_string(index++));
+            std::string id;
+            if (!value(element, &id)) return false;
+
+            // Re-key an object element by its "id"
+            if (!id.empty()) {
+                std::string prefix = element + ".";
+                auto it = out_.lower_bound(prefix);
+                while (it != out_.end() && it->first.compare(0, prefix.size(), prefix) == 0) {
+                    out_[join(path, id) + it->first.substr(element.size())] = it->second;
+                    it = out_.erase(it);
+                }
+            }
+        } while (consume(','));
+        return consume(']');
+    }
+
+    const std::string& text_;
+    std::map<std::string, double>& out_;
+    size_t pos_ = 0;
+};
+
+// P(X <= k) for X ~ Binomial(n, 1/2)
+double binomial_cdf_half(size_t n, size_t k) {
+    double total = 0;
+    double term = std::pow(0.5, static_cast<double>(n));  // C(n, 0) / 2^n
+    for (size_t i = 0; i <= k && i <= n; ++i) {
+        total += term;
+        term = term * (n - i) / (i + 1);
+    }
+    return total;
+}
+
+const char* verdict_name(Comparison::Verdict verdict) {
+    switch (verdict) {
+        case Comparison::Verdict::OK: return "ok";
+        case Comparison::Verdict::IMPROVED: return "improved";
+        case Comparison::Verdict::REGRESSED: return "REGRESSED";
+        case Comparison::Verdict::NEW: return "NO BASELINE";
+        case Comparison::Verdict::MISSING: return "MISSING";
+    }
+    return "?";
+}
+
+std::string format_summary(const MetricSummary& summary) {
+    if (summary.samples == 0) return "-";
+    std::ostringstream oss;
+    // Plain digits for large values; 4 significant digits for small ones
+    auto number = [&oss](double value) {
+        if (std::abs(value) >= 1000) oss << std::fixed << std::setprecision(0) << value;
+        else oss << std::defaultfloat << std::setprecision(4) << value;
+    };
+    number(summary.median);
+    oss << " [";
+    number(summary.ci_low);
+    oss << ", ";
+    number(summary.ci_high);
+    oss << "]";
+    return oss.str();
+}
+
+}  // namespace
+
+bool flatten_json_numbers(const std::string& json, std::map<std::string, double>& out) {
+    return JsonFlattener(json, out).run();
+}
+
+MetricSummary summarize(std::vector<double> samples, double confidence) {
+    MetricSummary summary;
+    summary.samples = samples.size();
+    if (samples.empty()) return summary;
+
+    std::sort(samples.begin(), samples.end());
+    size_t n = samples.size();
+    summary.median = n % 2 == 1 ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+
+    // Largest k with P(X < k) <= alpha / 2: the interval is [x_k, x_(n-k+1)]
+    double alpha = 1.0 - confidence;
+    size_t k = 1;
+    while (k < (n + 1) / 2 && binomial_cdf_half(n, k) <= alpha / 2) {
+        ++k;
+    }
+    summary.ci_low = samples[k - 1];
+    summary.ci_high = samples[n - k];
+    return summary;
+}
+
+const MetricRule* find_rule(const std::vector<MetricRule>& rules, const std::string& metric) {
+    for (const auto& rule : rules) {
+        if (metric.size() >= rule.suffix.size() &&
+            metric.compare(metric.size() - rule.suffix.size(), rule.suffix.size(), rule.suffix) == 0) {
+            return &rule;
+        }
+    }
+    return nullptr;
+}
+
+std::vector<Comparison> compare(const std::map<std::string, MetricSummary>& baseline,
+                                const std::map<std::string, MetricSummary>& current,
+                                const std::vector<MetricRule>& rules,
+                                double tolerance) {
+    std::vector<Comparison> comparisons;
+
+    for (const auto& [metric, now] : current) {
+        const MetricRule* rule = find_rule(rules, metric);
+        if (rule == nullptr) continue;
+
+        Comparison comparison;
+        comparison.metric = metric;
+        comparison.current = now;
+
+        auto it = baseline.find(metric);
+        if (it == baseline.end()) {
+            comparison.verdict = Comparison::Verdict::NEW;
+            comparisons.push_back(comparison);
+            continue;
+        }
+        const MetricSummary& before = it->second;
+        comparison.baseline = before;
+
+        // Positive = worse, whichever direction is better
+        double worse = rule->higher_is_better ? before.median - now.median
+                                              : now.median - before.median;
+        comparison.change = before.median == 0 ? 0.0 : worse / std::abs(before.median);
+
+        bool separated = rule->higher_is_better
+            ? (worse > 0 ? now.ci_high < before.ci_low : now.ci_low > before.ci_high)
+            : (worse > 0 ? now.ci_low > before.ci_high : now.ci_high < before.ci_low);
+        bool significant = separated && std::abs(worse) > rule->min_abs_change &&
+                           std::abs(comparison.change) > tolerance;
+
+        if (significant) {
+            comparison.verdict = worse > 0 ? Comparison::Verdict::REGRESSED
+                                           : Comparison::Verdict::IMPROVED;
+        }
+        comparisons.push_back(comparison);
+    }
+
+    for (const auto& [metric, before] : baseline) {
+        if (current.count(metric) == 0 && find_rule(rules, metric) != nullptr) {
+            Comparison comparison;
+            comparison.metric = metric;
+            comparison.baseline = before;
+            comparison.verdict = Comparison::Verdict::MISSING;
+            comparisons.push_back(comparison);
+        }
+    }
+
+    std::sort(comparisons.begin(), comparisons.end(),
+              [](const Comparison& a, const Comparison& b) { return a.metric < b.metric; });
+    return comparisons;
+}
+
+std::string format_report(const std::vector<Comparison>& comparisons) {
+    size_t width = 6;
+    for (const auto& c : comparisons) width = std::max(width, c.metric.size());
+
+    std::ostringstream oss;
+    oss << std::left << std::setw(width) << "metric" << "  " << std::setw(34) << "baseline median [CI]"
+        << std::setw(34) << "current median [CI]" << std::right << std::setw(9) << "change"
+        << "  verdict\n";
+
+    // Failures first, so they are not lost in a long table
+    auto fails = [](const Comparison& c) {
+        return c.verdict == Comparison::Verdict::REGRESSED || c.verdict == Comparison::Verdict::NEW;
+    };
+    std::vector<const Comparison*> ordered;
+    for (const auto& c : comparisons) {
+        if (fails(c)) ordered.push_back(&c);
+    }
+    for (const auto& c : comparisons) {
+        if (!fails(c)) ordered.push_back(&c);
+    }
+
+    for (const Comparison* c : ordered) {
+        std::ostringstream change;
+        if (c->baseline.samples > 0 && c->current.samples > 0) {
+            change << std::showpos << std::fixed << std::setprecision(1) << c->change * 100 << "%";
+        } else {
+            change << "-";
+        }
+        oss << std::left << std::setw(width) << c->metric << "  "
+            << std::setw(34) << format_summary(c->baseline)
+            << std::setw(34) << format_summary(c->current)
+            << std::right << std::setw(9) << change.str() << "  " << verdict_name(c->verdict) << "\n";
+    }
+    return oss.str();
+}
+
+std::string to_baseline_json(const std::map<std::string, MetricSummary>& metrics) {
+    std::ostringstream oss;
+    oss << std::setprecision(10);
+    oss << "{\n  \"metrics\": {";
+    bool first = true;
+    for (const auto& [metric, summary] : metrics) {
+        oss << (first ? "\n" : ",\n") << "    \"" << metric << "\": {\"samples\": " << summary.samples
+            << ", \"median\": " << summary.median << ", \"ci_low\": " << summary.ci_low
+            << ", \"ci_high\": " << summary.ci_high << "}";
+        first = false;
+    }
+    oss << "\n  }\n}\n";
+    return oss.str();
+}
+
+bool parse_baseline_json(const std::string& json, std::map<std::string, MetricSummary>& out) {
+    std::map<std::string, double> numbers;
+    if (!flatten_json_numbers(json, numbers)) return false;
+
+    const std::string prefix = "metrics.";
+    for (const auto& [path, value] : numbers) {
+        if (path.compare(0, prefix.size(), prefix) != 0) continue;
+        size_t dot = path.rfind('.');
+        std::string metric = path.substr(prefix.size(), dot - prefix.size());
+        std::string field = path.substr(dot + 1);
+
+        auto& summary = out[metric];
+        if (field == "samples") summary.samples = static_cast<size_t>(value);
+        else if (field == "median") summary.median = value;
+        else if (field == "ci_low") summary.ci_low = value;
+        else if (field == "ci_high") summary.ci_high = value;
+    }
+    return true;
+}
+
+}  // namespace valkyrie
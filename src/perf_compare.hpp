@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace valkyrie {
+
+// Every number in a JSON document, by path. Object members join with '.';
+// array elements use their "id" string member when they have one (so
+// benchmark results keep their key when the list changes), else their index.
+// False on malformed JSON.
+bool flatten_json_numbers(const std::string& json, std::map<std::string, double>& out);
+
+// Median of repeated runs with a distribution-free confidence interval: the
+// order statistics whose ranks a Binomial(n, 1/2) puts outside the interval
+// with probability at most 1 - confidence. Fewer than 6 runs cannot reach
+// 95%, so their interval is the min-max range.
+struct MetricSummary {
+    size_t samples = 0;
+    double median = 0;
+    double ci_low = 0;
+    double ci_high = 0;
+};
+
+MetricSummary summarize(std::vector<double> samples, double confidence = 0.95);
+
+// Which metrics are compared, and which way is better. Metrics with no rule
+// (counts, durations of the run itself) are not compared.
+struct MetricRule {
+    std::string suffix;        // Matches metric paths ending in this
+    bool higher_is_better;
+    double min_abs_change;     // Smaller differences are noise whatever the ratio
+};
+
+const MetricRule* find_rule(const std::vector<MetricRule>& rules, const std::string& metric);
+
+struct Comparison {
+    // NEW: measured but absent from the baseline, so nothing guards it.
+    // MISSING: in the baseline but not measured by this run.
+    enum class Verdict { OK, IMPROVED, REGRESSED, NEW, MISSING };
+
+    std::string metric;
+    MetricSummary baseline;
+    MetricSummary current;
+    double change = 0;  // Relative change of the median; positive is worse
+    Verdict verdict = Verdict::OK;
+};
+
+// A metric regresses when its median is worse by more than `tolerance`
+// (relative) and min_abs_change, and the two confidence intervals do not
+// overlap. Sorted by metric name.
+std::vector<Comparison> compare(const std::map<std::string, MetricSummary>& baseline,
+                                const std::map<std::string, MetricSummary>& current,
+                                const std::vector<MetricRule>& rules,
+                                double tolerance);
+
+// Table of every compared metric, regressions and unbaselined metrics first
+std::string format_report(const std::vector<Comparison>& comparisons);
+
+// Baseline files: {"metrics": {"<metric>": {"samples", "median", "ci_low", "ci_high"}}}
+std::string to_baseline_json(const std::map<std::string, MetricSummary>& metrics);
+bool parse_baseline_json(const std::string& json, std::map<std::string, MetricSummary>& out);
+
+}  // namespace valkyrie
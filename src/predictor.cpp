@@ -1,4 +1,10 @@
 #include "predictor.hpp"
+#include "shuffle.hpp"
+#include "logger.hpp"
+#include "probes.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
 #include <fstream>
 #include <iostream>
 #include <iomanip>
@@ -46,7 +52,7 @@ Predictor::Predictor(CacheManager& cache,
     , lookahead_(lookahead)
     , manifest_mode_(false)
     , stop_flag_(false) {
-    if (lookahead_ < 0 || lookahead_ > 100) {
+    if (lookahead < 0 || lookahead > 100) {
         throw std::invalid_argument("lookahead must be between 0 and 100");
     }
 }
@@ -57,7 +63,7 @@ Predictor::~Predictor() {
 
 void Predictor::start() {
     predictor_thread_ = std::thread(&Predictor::predictor_loop, this);
-    std::cout << "Predictor: Started with lookahead=" << lookahead_ << "\n";
+    std::cout << "Predictor: Started with lookahead=" << lookahead_.load() << "\n";
 }
 
 void Predictor::stop() {
@@ -73,35 +79,300 @@ void Predictor::stop() {
 }
 
 void Predictor::on_file_accessed(const std::string& s3_key) {
+    record_access_outcome(s3_key);
+    markov_.observe(s3_key);
+    track_epoch(s3_key);
+
     std::lock_guard<std::mutex> lock(access_mutex_);
+    if (s3_key != last_accessed_) {
+        // Bytes consumed from the previous file feed the average file size
+        uint64_t consumed = bytes_consumed_.load();
+        if (!last_accessed_.empty() && consumed > bytes_at_file_switch_) {
+            file_bytes_.add(static_cast<double>(consumed - bytes_at_file_switch_));
+        }
+        bytes_at_file_switch_ = consumed;
+        set_read_position(s3_key, 0);
+    }
     last_accessed_ = s3_key;
 }
 
+void Predictor::on_bytes_read(const std::string& s3_key, size_t bytes, size_t end_offset) {
+    bytes_consumed_.add(bytes);
+    set_read_position(s3_key, end_offset);
+}
+
+// Slot from the low bits of the key's hash; the high bits tag the slot's
+// value so a file sharing the slot reads as position 0, not another's offset
+void Predictor::set_read_position(const std::string& s3_key, size_t position) {
+    size_t hash = std::hash<std::string>{}(s3_key);
+    uint64_t tag = (static_cast<uint64_t>(hash) >> 40) << READ_POSITION_BITS;
+    uint64_t value = std::min<uint64_t>(position, READ_POSITION_MASK);
+    read_positions_[hash % READ_POSITION_SLOTS].store(tag | value, std::memory_order_relaxed);
+}
+
+size_t Predictor::get_read_position(const std::string& s3_key) const {
+    size_t hash = std::hash<std::string>{}(s3_key);
+    uint64_t tag = (static_cast<uint64_t>(hash) >> 40) << READ_POSITION_BITS;
+    uint64_t value = read_positions_[hash % READ_POSITION_SLOTS].load(std::memory_order_relaxed);
+    return (value & ~READ_POSITION_MASK) == tag ? value & READ_POSITION_MASK : 0;
+}
+
+void Predictor::enable_adaptive_lookahead() {
+    last_sample_time_ = std::chrono::steady_clock::now();
+    adaptive_.store(true);
+}
+
+void Predictor::set_size_lookup(SizeLookup lookup) {
+    size_lookup_ = std::move(lookup);
+}
+
+void Predictor::set_tar_indexer(const TarIndexer* indexer) {
+    tar_indexer_ = indexer;
+}
+
+void Predictor::set_parquet_columns(std::vector<std::string> columns) {
+    parquet_columns_ = std::move(columns);
+}
+
+void Predictor::set_record_indexes(RecordIndexStore* indexes) {
+    record_indexes_ = indexes;
+}
+
+void Predictor::on_record_read(const std::string& s3_key, size_t record) {
+    std::lock_guard<std::mutex> lock(record_mutex_);
+    auto& cursor = record_cursor_;
+
+    if (cursor.s3_key != s3_key) {
+        cursor = RecordCursor{s3_key, record, 0, 0};
+    } else if (cursor.record != record) {
+        int64_t stride = static_cast<int64_t>(record) - static_cast<int64_t>(cursor.record);
+        cursor.stride_run = stride == cursor.stride ? cursor.stride_run + 1 : 1;
+        cursor.stride = stride;
+        cursor.record = record;
+    } else {
+        return;  // Still inside the same record
+    }
+
+    record_markov_.observe(s3_key + "#" + std::to_string(record));
+}
+
+bool Predictor::load_access_trace(const std::string& trace_path) {
+    if (!markov_.load_trace(trace_path)) {
+        std::cerr << "Predictor: No access trace at " << trace_path << "\n";
+        return false;
+    }
+
+    std::cout << "Predictor: Markov model trained from " << trace_path
+              << " (" << markov_.num_keys() << " keys, "
+              << markov_.num_first_order_states() << " transitions)\n";
+    return true;
+}
+
+bool Predictor::save_access_trace(const std::string& trace_path) const {
+    if (!markov_.save_trace(trace_path)) {
+        std::cerr << "Predictor: Failed to write access trace: " << trace_path << "\n";
+        return false;
+    }
+    return true;
+}
+
 bool Predictor::load_manifest(const std::string& manifest_path) {
-    std::ifstream file(manifest_path);
-    if (!file.is_open()) {
-        std::cerr << "Predictor: Failed to open manifest: " << manifest_path << "\n";
+    auto manifest = std::make_shared<Manifest>();
+    if (!manifest->load(manifest_path)) {
+        std::cerr << "Predictor: Failed to load manifest: " << manifest_path << "\n";
         return false;
     }
 
-    manifest_.clear();
-    std::string line;
-    while (std::getline(file, line)) {
-        // Trim whitespace
-        line.erase(0, line.find_first_not_of(" \t\r\n"));
-        line.erase(line.find_last_not_of(" \t\r\n") + 1);
+    set_manifest(manifest);
 
-        if (!line.empty() && line[0] != '#') {  // Skip empty and comments
-            manifest_.push_back(line);
-        }
+    std::cout << "Predictor: Loaded manifest with " << manifest->size() << " entries";
+    if (manifest->shuffle().has_value()) {
+        std::cout << " (shuffled, seed=" << manifest->shuffle()->seed
+                  << ", start epoch=" << manifest->shuffle()->epoch << ")";
+    }
+    std::cout << "\n";
+    return true;
+}
+
+void Predictor::set_manifest(std::shared_ptr<const Manifest> manifest) {
+    // Epoch orders are built before the swap so the new manifest is usable at once
+    auto state = std::make_shared<ManifestState>();
+    state->manifest = manifest;
+    if (manifest && manifest->shuffle().has_value()) {
+        state->current = make_epoch_order(manifest->size(), manifest->shuffle()->seed,
+                                          manifest->shuffle()->epoch);
+        stats_.shuffle_epoch.store(state->current->epoch);
+    }
+
+    bool has_entries = manifest && !manifest->empty();
+    {
+        std::lock_guard<std::mutex> lock(manifest_mutex_);
+        manifest_state_ = std::move(state);
+    }
+    manifest_mode_.store(has_entries);
+
+    // Have the following epoch ready before the reader gets there
+    prepare_next_epoch();
+}
+
+std::shared_ptr<const Manifest> Predictor::get_manifest() const {
+    auto state = get_manifest_state();
+    return state ? state->manifest : nullptr;
+}
+
+std::shared_ptr<const Predictor::ManifestState> Predictor::get_manifest_state() const {
+    std::lock_guard<std::mutex> lock(manifest_mutex_);
+    return manifest_state_;
+}
+
+bool Predictor::replace_manifest_state(const std::shared_ptr<const ManifestState>& expected,
+                                       std::shared_ptr<const ManifestState> next) {
+    std::lock_guard<std::mutex> lock(manifest_mutex_);
+    if (manifest_state_ != expected) return false;
+    manifest_state_ = std::move(next);
+    return true;
+}
+
+size_t Predictor::get_manifest_size() const {
+    auto manifest = get_manifest();
+    return manifest ? manifest->size() : 0;
+}
+
+void Predictor::set_position(const std::string& s3_key) {
+    std::lock_guard<std::mutex> lock(access_mutex_);
+    last_accessed_ = s3_key;
+    set_read_position(s3_key, 0);
+}
+
+bool Predictor::set_shuffle_epoch(uint64_t epoch) {
+    // Retried if a new manifest or a rollover lands while the order is built
+    while (true) {
+        auto state = get_manifest_state();
+        if (!state || !state->manifest || !state->manifest->shuffle().has_value()) return false;
+
+        auto next = std::make_shared<ManifestState>();
+        next->manifest = state->manifest;
+        next->current = make_epoch_order(state->manifest->size(),
+                                         state->manifest->shuffle()->seed, epoch);
+        if (replace_manifest_state(state, std::move(next))) break;
     }
 
-    manifest_mode_.store(!manifest_.empty());
+    stats_.shuffle_epoch.store(epoch);
+    prepare_next_epoch();
+    return true;
+}
 
-    std::cout << "Predictor: Loaded manifest with " << manifest_.size() << " entries\n";
+bool Predictor::set_lookahead(int lookahead) {
+    if (lookahead < 0 || lookahead > 100) {
+        return false;
+    }
+    lookahead_.store(lookahead);
     return true;
 }
 
+std::optional<std::string> Predictor::manifest_entry_at(size_t position) const {
+    auto state = get_manifest_state();
+    if (!state || !state->manifest || position >= state->manifest->size()) return std::nullopt;
+
+    if (state->current) {
+        return state->manifest->entries()[state->current->order[position]];
+    }
+    return state->manifest->entries()[position];
+}
+
+std::shared_ptr<const Predictor::EpochOrder> Predictor::make_epoch_order(size_t n, uint64_t seed,
+                                                                         uint64_t epoch) {
+    auto order = std::make_shared<EpochOrder>();
+    order->epoch = epoch;
+    order->order = shuffled_order(n, seed, epoch);
+    order->position.resize(n);
+    for (size_t pos = 0; pos < n; ++pos) {
+        order->position[order->order[pos]] = static_cast<uint32_t>(pos);
+    }
+    return order;
+}
+
+void Predictor::prepare_next_epoch() {
+    auto state = get_manifest_state();
+    if (!state || !state->current || state->next) return;
+
+    // O(n) permutation built outside the lock so readers never wait on it
+    auto next = std::make_shared<ManifestState>(*state);
+    next->next = make_epoch_order(state->manifest->size(), state->manifest->shuffle()->seed,
+                                  state->current->epoch + 1);
+    replace_manifest_state(state, std::move(next));  // Superseded: the next call retries
+}
+
+void Predictor::track_epoch(const std::string& s3_key) {
+    auto state = get_manifest_state();
+    if (!state || !state->current) return;
+
+    auto index = state->manifest->find(s3_key);
+    if (!index.has_value()) return;
+
+    std::lock_guard<std::mutex> lock(epoch_progress_mutex_);
+    auto& progress = epoch_progress_;
+    size_t n = state->current->order.size();
+    if (progress.epoch != state->current) {
+        progress.epoch = state->current;
+        progress.seen.assign(n, false);
+        progress.seen_count = 0;
+    }
+    if (*index >= n) return;
+
+    if (!progress.seen[*index]) {
+        progress.seen[*index] = true;
+        progress.seen_count++;
+        return;
+    }
+
+    // A file already read this epoch is opened again. If the epoch is (nearly)
+    // exhausted and the file sits at the head of the next epoch, roll over.
+    size_t window = std::min(n, std::max(SHUFFLE_ROLLOVER_WINDOW,
+                                         static_cast<size_t>(lookahead_.load())));
+
+    if (!state->next || state->next->position[*index] >= window ||
+        progress.seen_count + window < n) {
+        return;
+    }
+
+    auto next = std::make_shared<ManifestState>();
+    next->manifest = state->manifest;
+    next->current = state->next;
+    if (!replace_manifest_state(state, next)) return;  // A new manifest or epoch was set
+
+    progress.epoch = next->current;
+    progress.seen.assign(n, false);
+    progress.seen[*index] = true;
+    progress.seen_count = 1;
+
+    stats_.shuffle_epoch.store(next->current->epoch);
+    stats_.epoch_rollovers++;
+}
+
+std::vector<std::string> Predictor::predict_shuffled(const ManifestState& state, size_t index,
+                                                     int lookahead) {
+    std::vector<std::string> result;
+
+    const auto& entries = state.manifest->entries();
+    const auto& order = state.current->order;
+    size_t n = order.size();
+    if (index >= n) return result;
+
+    // Continue into the next epoch's order across the boundary
+    size_t pos = state.current->position[index];
+    for (int i = 1; i <= lookahead; ++i) {
+        size_t next_pos = pos + i;
+        if (next_pos < n) {
+            result.push_back(entries[order[next_pos]]);
+        } else if (state.next && next_pos - n < state.next->order.size()) {
+            result.push_back(entries[state.next->order[next_pos - n]]);
+        }
+    }
+
+    return result;
+}
+
 void Predictor::predictor_loop() {
     while (!stop_flag_) {
         std::this_thread::sleep_for(std::chrono::milliseconds(50));
@@ -109,6 +380,10 @@ void Predictor::predictor_loop() {
         // Clean up completed downloads to prevent memory leak
         cleanup_completed_downloads();
 
+        if (adaptive_.load()) {
+            update_window();
+        }
+
         std::string current;
         {
             std::lock_guard<std::mutex> lock(access_mutex_);
@@ -120,32 +395,172 @@ void Predictor::predictor_loop() {
     }
 }
 
+void Predictor::update_window() {
+    auto now = std::chrono::steady_clock::now();
+    auto elapsed = now - last_sample_time_;
+    if (elapsed < RATE_SAMPLE_INTERVAL) return;
+
+    double dt = std::chrono::duration<double>(elapsed).count();
+    last_sample_time_ = now;
+
+    // Reader consumption rate
+    uint64_t consumed = bytes_consumed_.load();
+    consumption_rate_.add((consumed - last_consumed_) / dt);
+    last_consumed_ = consumed;
+
+    // Aggregate bandwidth: bytes all workers downloaded over the wall-clock
+    // interval (idle intervals say nothing about it)
+    const auto& pool_stats = worker_pool_.get_stats();
+    uint64_t downloaded = pool_stats.bytes_downloaded.load();
+    if (downloaded > last_downloaded_) {
+        bandwidth_.add((downloaded - last_downloaded_) / dt);
+    }
+    last_downloaded_ = downloaded;
+
+    // Request latency: time to first byte, so the transfer is not counted
+    // twice. Range fetchers do not report it; their whole request time is used.
+    uint64_t ttfb_count = pool_stats.ttfb_us.count();
+    uint64_t ttfb_sum_us = pool_stats.ttfb_us.sum();
+    uint64_t download_time_us = pool_stats.download_time_us.load();
+    uint64_t download_count = pool_stats.successful_downloads.load();
+    if (ttfb_count > last_ttfb_count_) {
+        chunk_latency_.add((ttfb_sum_us - last_ttfb_sum_us_) / 1e6 /
+                           (ttfb_count - last_ttfb_count_));
+    } else if (download_count > last_download_count_) {
+        chunk_latency_.add((download_time_us - last_download_time_us_) / 1e6 /
+                           (download_count - last_download_count_));
+    }
+    last_ttfb_count_ = ttfb_count;
+    last_ttfb_sum_us_ = ttfb_sum_us;
+    last_download_time_us_ = download_time_us;
+    last_download_count_ = download_count;
+
+    double avg_file_bytes;
+    {
+        std::lock_guard<std::mutex> lock(access_mutex_);
+        avg_file_bytes = file_bytes_.initialized ? file_bytes_.value : DEFAULT_CHUNK_SIZE;
+    }
+    avg_file_bytes = std::max(avg_file_bytes, 1.0);
+
+    // Time to fetch the next file: request latency plus transfer at the
+    // aggregate bandwidth all workers achieve together
+    double latency = chunk_latency_.initialized ? chunk_latency_.value : DEFAULT_CHUNK_LATENCY_SEC;
+    double bandwidth = bandwidth_.value;
+    double fetch_time = latency + (bandwidth > 0 ? avg_file_bytes / bandwidth : 0.0);
+
+    // Stay WINDOW_LATENCY_MULTIPLE x fetch time ahead of the reader
+    double window = consumption_rate_.value * WINDOW_LATENCY_MULTIPLE * fetch_time;
+
+    // Bound by cache headroom: space not held by HOT data, at most a fraction of
+    // the cache. Read lock-free, so sizing never contends with readers.
+    size_t max_size = cache_.get_max_size();
+    size_t hot_bytes = cache_.get_hot_zone_size();
+    size_t headroom = max_size > hot_bytes ? max_size - hot_bytes : 0;
+    headroom = std::min(headroom, static_cast<size_t>(max_size * MAX_WINDOW_CACHE_FRACTION));
+
+    size_t window_bytes = std::clamp(static_cast<size_t>(window), DEFAULT_CHUNK_SIZE,
+                                     std::max(headroom, DEFAULT_CHUNK_SIZE));
+
+    stats_.consumption_bytes_per_sec.store(static_cast<uint64_t>(consumption_rate_.value));
+    stats_.download_bytes_per_sec.store(static_cast<uint64_t>(bandwidth));
+    stats_.download_latency_us.store(static_cast<uint64_t>(latency * 1e6));
+    stats_.window_bytes.store(window_bytes);
+}
+
 void Predictor::predict_and_prefetch(const std::string& s3_key) {
+    // Fixed file count, or the adaptive byte window split between the rest of
+    // the current file and the head of the next files. Zero turns off all
+    // prefetching, readahead included.
+    int lookahead = lookahead_.load();
+    if (lookahead == 0) return;
+    bool adaptive = adaptive_.load();
+
     stats_.predictions_made++;
 
+    // Members of an indexed archive come first: within the adaptive window,
+    // or lookahead chunks past the reader otherwise
+    size_t member_covered = 0;
+    if (tar_indexer_) {
+        size_t member_window = adaptive ? stats_.window_bytes.load()
+            : static_cast<size_t>(lookahead) * DEFAULT_CHUNK_SIZE;
+        member_covered = issue_member_readahead(s3_key, member_window);
+    }
+
+    // A Parquet reader seeks footer -> column chunks; fetch them in that order
+    if (ParquetFooter::is_parquet_key(s3_key)) {
+        issue_parquet_prefetch(s3_key, PredictionSource::READAHEAD, Priority::NORMAL);
+    }
+
+    // Indexed record files are prefetched record by record in visit order
+    size_t record_covered = 0;
+    if (record_indexes_) {
+        size_t record_window = adaptive ? stats_.window_bytes.load()
+            : static_cast<size_t>(lookahead) * DEFAULT_CHUNK_SIZE;
+        record_covered = issue_record_prefetch(s3_key, record_window);
+    }
+
+    if (adaptive) {
+        size_t window_bytes = stats_.window_bytes.load();
+        // Plain readahead continues past the indexed part of a partially parsed
+        // archive; record files are read out of chunk order, so skip it for them
+        size_t covered = record_covered > 0 ? record_covered
+            : std::max(member_covered, issue_readahead(s3_key, window_bytes));
+        size_t remaining = window_bytes > covered ? window_bytes - covered : 0;
+
+        double avg_file_bytes;
+        {
+            std::lock_guard<std::mutex> lock(access_mutex_);
+            avg_file_bytes = file_bytes_.initialized ? file_bytes_.value : DEFAULT_CHUNK_SIZE;
+        }
+
+        int files = static_cast<int>(std::ceil(remaining / std::max(avg_file_bytes, 1.0)));
+        lookahead = std::clamp(files, 1, lookahead);
+        stats_.window_files.store(lookahead);
+    }
+
     std::vector<std::string> to_prefetch;
+    PredictionSource source = PredictionSource::SEQUENTIAL;
 
-    if (manifest_mode_.load()) {
+    // One snapshot: the manifest and its epoch orders always match
+    auto manifest_state = manifest_mode_.load() ? get_manifest_state() : nullptr;
+    auto manifest = manifest_state ? manifest_state->manifest : nullptr;
+
+    if (manifest && manifest_state->current) {
+        // Seeded per-epoch permutation of the manifest
+        prepare_next_epoch();
+
+        auto index = manifest->find(s3_key);
+        if (index.has_value()) {
+            to_prefetch = predict_shuffled(*manifest_state, *index, lookahead);
+        }
+
+        if (!to_prefetch.empty()) {
+            source = PredictionSource::SHUFFLE;
+            stats_.shuffle_hits++;
+        }
+
+    } else if (manifest) {
         // Manifest-driven prediction
-        auto pos_opt = find_in_manifest(s3_key);
-        if (!pos_opt.has_value()) return;
-
-        int pos = *pos_opt;
-        for (int i = 1; i <= lookahead_; ++i) {
-            int next_pos = pos + i;
-            if (next_pos < static_cast<int>(manifest_.size())) {
-                to_prefetch.push_back(manifest_[next_pos]);
+        auto pos_opt = manifest->find(s3_key);
+        if (pos_opt.has_value()) {
+            size_t pos = *pos_opt;
+            for (int i = 1; i <= lookahead; ++i) {
+                size_t next_pos = pos + i;
+                if (next_pos < manifest->size()) {
+                    to_prefetch.push_back(manifest->entries()[next_pos]);
+                }
             }
         }
 
         if (!to_prefetch.empty()) {
+            source = PredictionSource::MANIFEST;
             stats_.manifest_hits++;
         }
 
     } else {
         // Sequential pattern prediction
         std::string current = s3_key;
-        for (int i = 0; i < lookahead_; ++i) {
+        for (int i = 0; i < lookahead; ++i) {
             auto next_opt = predict_next_sequential(current);
             if (!next_opt.has_value()) break;
 
@@ -154,33 +569,450 @@ void Predictor::predict_and_prefetch(const std::string& s3_key) {
         }
 
         if (!to_prefetch.empty()) {
+            source = PredictionSource::SEQUENTIAL;
             stats_.pattern_hits++;
         }
     }
 
-    // Issue prefetch tasks
+    // Fall back to the learned transition model
+    if (to_prefetch.empty()) {
+        to_prefetch = markov_.predict(lookahead);
+
+        if (to_prefetch.empty()) return;
+
+        source = PredictionSource::MARKOV;
+        stats_.markov_hits++;
+    }
+
+    record_predictions(to_prefetch, source);
+
+    // Next files queue behind the member chunks of the archive being read
+    Priority priority = member_covered > 0 ? Priority::BACKGROUND : Priority::NORMAL;
+
+    // Issue prefetch tasks, nearest first so the budget keeps the most urgent
     for (const auto& file_key : to_prefetch) {
+        if (ParquetFooter::is_parquet_key(file_key) &&
+            issue_parquet_prefetch(file_key, source, priority)) {
+            continue;
+        }
+
         // Skip if already in cache
         if (cache_.contains(file_key)) continue;
 
-        // Skip if already in flight
-        {
-            std::lock_guard<std::mutex> lock(in_flight_mutex_);
-            if (in_flight_.count(file_key)) continue;
+        if (!admit_prefetch()) break;
+
+        if (submit_prefetch(file_key, 0, source, priority)) {
+            stats_.prefetches_issued++;
+        }
+    }
+}
+
+size_t Predictor::issue_readahead(const std::string& s3_key, size_t window_bytes) {
+    size_t position = get_read_position(s3_key);
+
+    std::optional<size_t> file_size;
+    if (size_lookup_) {
+        file_size = size_lookup_(s3_key);
+    }
+
+    // The reader fetches the chunk it is in; start with the one after it
+    size_t offset = (position / DEFAULT_CHUNK_SIZE + 1) * DEFAULT_CHUNK_SIZE;
+    size_t end = position + window_bytes;
+    if (file_size.has_value()) {
+        end = std::min(end, *file_size);
+    }
+
+    size_t covered = 0;
+    for (; offset < end; offset += DEFAULT_CHUNK_SIZE) {
+        covered += DEFAULT_CHUNK_SIZE;
+
+        if (cache_.contains_chunk(s3_key, offset)) continue;
+
+        if (!admit_prefetch()) break;
+
+        if (submit_prefetch(s3_key, offset, PredictionSource::READAHEAD)) {
+            stats_.readahead_issued++;
         }
+    }
 
-        // Submit prefetch (may throw)
-        auto future = worker_pool_.submit(file_key, 0, DEFAULT_CHUNK_SIZE, Priority::NORMAL);
+    return covered;
+}
 
-        // Only track if submit succeeded
-        {
-            std::lock_guard<std::mutex> lock(in_flight_mutex_);
-            in_flight_.insert(file_key);
-            in_flight_futures_.emplace_back(file_key, future);
+size_t Predictor::issue_member_readahead(const std::string& s3_key, size_t window_bytes) {
+    size_t position = get_read_position(s3_key);
+
+    auto members = tar_indexer_->members_in_range(s3_key, position, window_bytes);
+    if (members.empty()) return 0;
+
+    // Whole members: a sample split across the window edge is fetched entirely
+    uint64_t end = members.back().offset + members.back().size;
+
+    size_t offset = (position / DEFAULT_CHUNK_SIZE + 1) * DEFAULT_CHUNK_SIZE;
+    size_t covered = end > position ? end - position : 0;
+    for (; offset < end; offset += DEFAULT_CHUNK_SIZE) {
+        if (cache_.contains_chunk(s3_key, offset)) continue;
+
+        if (!admit_prefetch()) break;
+
+        if (submit_prefetch(s3_key, offset, PredictionSource::READAHEAD)) {
+            stats_.member_readahead_issued++;
+        }
+    }
+
+    return covered;
+}
+
+bool Predictor::issue_parquet_prefetch(const std::string& s3_key, PredictionSource source,
+                                       Priority priority) {
+    std::optional<size_t> file_size;
+    if (size_lookup_) {
+        file_size = size_lookup_(s3_key);
+    }
+    if (!file_size.has_value() || *file_size < ParquetFooter::TAIL_SIZE) {
+        return false;
+    }
+
+    const ParquetLayout* layout = parquet_layout(s3_key, *file_size, source, priority);
+    if (!layout) {
+        return true;  // Footer chunks requested; column chunks follow next tick
+    }
+    if (!layout->valid) {
+        return false;
+    }
+
+    // Column chunks in file order, cut short by the prefetch budget
+    for (const auto& column : layout->chunks) {
+        size_t first = column.offset / DEFAULT_CHUNK_SIZE * DEFAULT_CHUNK_SIZE;
+        size_t end = std::min<uint64_t>(column.offset + column.length, *file_size);
+
+        for (size_t offset = first; offset < end; offset += DEFAULT_CHUNK_SIZE) {
+            if (cache_.contains_chunk(s3_key, offset)) continue;
+
+            if (!admit_prefetch()) return true;
+
+            if (submit_prefetch(s3_key, offset, source, priority)) {
+                stats_.parquet_chunks_issued++;
+            }
+        }
+    }
+
+    return true;
+}
+
+const Predictor::ParquetLayout* Predictor::parquet_layout(const std::string& s3_key,
+                                                          size_t file_size,
+                                                          PredictionSource source,
+                                                          Priority priority) {
+    auto it = parquet_layouts_.find(s3_key);
+    if (it == parquet_layouts_.end()) {
+        // Bounded: forget the oldest layouts (re-read from cache or S3 if needed)
+        while (parquet_layout_order_.size() >= MAX_PARQUET_LAYOUTS) {
+            parquet_layouts_.erase(parquet_layout_order_.front());
+            parquet_layout_order_.pop_front();
+        }
+        parquet_layout_order_.push_back(s3_key);
+        it = parquet_layouts_.emplace(s3_key, ParquetLayout{}).first;
+    }
+
+    ParquetLayout& layout = it->second;
+    if (layout.ready) {
+        return &layout;
+    }
+
+    auto fail = [&]() {
+        layout.ready = true;
+        stats_.parquet_footer_errors++;
+        Logger::warn("predictor", "Invalid Parquet footer: ", s3_key);
+        return &layout;
+    };
+
+    // Fetch a footer chunk; give up on objects whose footer never lands
+    // (e.g. a placeholder size pointing past the end of the object)
+    bool gave_up = false;
+    auto request = [&](size_t offset) {
+        if (layout.footer_requests >= MAX_FOOTER_REQUESTS) {
+            gave_up = true;
+        } else if (admit_prefetch() && submit_prefetch(s3_key, offset, source, priority)) {
+            layout.footer_requests++;
+        }
+    };
+
+    // The metadata length sits in the last 8 bytes
+    size_t tail_chunk = (file_size - 1) / DEFAULT_CHUNK_SIZE * DEFAULT_CHUNK_SIZE;
+    auto tail = cache_.get_chunk(s3_key, tail_chunk);
+    if (!tail.has_value()) {
+        request(tail_chunk);
+        return gave_up ? fail() : nullptr;
+    }
+
+    auto metadata_length = ParquetFooter::metadata_length(tail->data.data(), tail->data.size());
+    if (!metadata_length.has_value() ||
+        *metadata_length + ParquetFooter::TAIL_SIZE > file_size) {
+        return fail();
+    }
+
+    // Large footers can start in earlier chunks; gather them all first
+    size_t metadata_start = file_size - ParquetFooter::TAIL_SIZE - *metadata_length;
+    std::string metadata;
+    metadata.reserve(*metadata_length);
+    bool missing = false;
+
+    for (size_t offset = metadata_start / DEFAULT_CHUNK_SIZE * DEFAULT_CHUNK_SIZE;
+         offset <= tail_chunk; offset += DEFAULT_CHUNK_SIZE) {
+        auto chunk = offset == tail_chunk ? tail : cache_.get_chunk(s3_key, offset);
+        if (!chunk.has_value()) {
+            request(offset);
+            missing = true;
+            continue;
+        }
+
+        size_t from = std::max(metadata_start, offset) - offset;
+        size_t to = std::min(metadata_start + *metadata_length, offset + chunk->data.size());
+        if (offset + from < to) {
+            metadata.append(chunk->data.data() + from, to - offset - from);
+        }
+    }
+
+    if (gave_up) {
+        return fail();
+    }
+    if (missing) {
+        return nullptr;
+    }
+
+    ParquetFooter footer;
+    if (metadata.size() != *metadata_length || !footer.parse(metadata.data(), metadata.size())) {
+        return fail();
+    }
+
+    layout.ready = true;
+    layout.valid = true;
+    layout.chunks = footer.select(parquet_columns_);
+    stats_.parquet_footers_parsed++;
+    return &layout;
+}
+
+std::shared_ptr<const RecordIndex> Predictor::load_record_index(const std::string& s3_key) {
+    if (RecordIndex::is_index_key(s3_key)) return nullptr;
+
+    if (record_indexes_->attempted(s3_key)) {
+        return record_indexes_->get(s3_key);
+    }
+
+    // Read the sidecar chunk by chunk up to its listed size. Each tick takes
+    // what has landed and queues the next GET without waiting on it; a load
+    // left for another file (the reader moved on) starts over.
+    std::string index_key = RecordIndex::index_key_for(s3_key);
+
+    // Listed beside a file whose size is known: a sidecar not listed is absent.
+    // Neither known (no listing of that directory): read until a short chunk.
+    std::optional<size_t> index_size;
+    if (size_lookup_) {
+        index_size = size_lookup_(index_key);
+        if (!index_size.has_value() && size_lookup_(s3_key).has_value()) {
+            record_indexes_->mark_missing(s3_key);
+            return nullptr;
+        }
+    }
+
+    RecordIndexLoad& load = record_index_load_;
+    if (load.s3_key != s3_key) {
+        load = RecordIndexLoad{};
+        load.s3_key = s3_key;
+    }
+
+    bool truncated = false;
+    while (!index_size.has_value() || load.offset < *index_size) {
+        auto chunk = cache_.get_chunk(index_key, load.offset);
+        if (!chunk.has_value()) {
+            if (!load.pending.valid()) {
+                if (std::chrono::steady_clock::now() < load.retry_at) {
+                    return nullptr;  // Backing off after a failed GET
+                }
+                try {
+                    load.pending = worker_pool_.submit(index_key, load.offset, DEFAULT_CHUNK_SIZE,
+                                                       Priority::NORMAL);
+                } catch (const std::exception& e) {
+                    Logger::warn("predictor", "Record index fetch failed: ", e.what());
+                    load.pending = {};
+                }
+            }
+            if (load.pending.valid() &&
+                load.pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                return nullptr;  // Look again next tick
+            }
+
+            bool ok = load.pending.valid() && load.pending.get();
+            load.pending = {};
+            if (ok) {
+                load.failures = 0;
+                continue;  // Landed (or already evicted: fetch it again)
+            }
+
+            // Transient (503, timeout) or permanent (404, past the end): a
+            // known size tells them apart, otherwise persistence does
+            load.failures++;
+            if (!index_size.has_value() && load.failures >= RECORD_INDEX_MAX_FAILURES) {
+                truncated = load.offset > 0;
+                break;
+            }
+            auto backoff = std::min(RECORD_INDEX_RETRY_MIN * (1 << std::min(load.failures - 1, 10)),
+                                    RECORD_INDEX_RETRY_MAX);
+            load.retry_at = std::chrono::steady_clock::now() + backoff;
+            return nullptr;
+        }
+
+        load.text.append(chunk->data.data(), chunk->data.size());
+        if (chunk->data.size() < DEFAULT_CHUNK_SIZE) break;
+        load.offset += DEFAULT_CHUNK_SIZE;
+    }
+
+    std::string text = std::move(load.text);
+    load = RecordIndexLoad{};
+
+    // Ended on a chunk boundary by failures alone: a line cut there would
+    // parse with a wrong length, so keep whole lines only
+    if (truncated && !text.empty() && text.back() != '\n') {
+        size_t last_line = text.rfind('\n');
+        text.erase(last_line == std::string::npos ? 0 : last_line + 1);
+    }
+
+    auto index = std::make_shared<RecordIndex>();
+    if (text.empty() || !index->parse(text)) {
+        if (!text.empty()) {
+            Logger::warn("predictor", "Invalid record index: ", index_key);
+        }
+        record_indexes_->mark_missing(s3_key);
+        return nullptr;
+    }
+
+    record_indexes_->put(s3_key, index);
+    stats_.record_indexes_loaded++;
+    Logger::info("predictor", "Loaded record index ", index_key,
+                 " (", index->size(), " records)");
+    return index;
+}
+
+std::vector<size_t> Predictor::predict_records(const std::string& s3_key,
+                                               const RecordIndex& index) {
+    std::vector<size_t> result;
+
+    RecordCursor cursor;
+    {
+        std::lock_guard<std::mutex> lock(record_mutex_);
+        if (record_cursor_.s3_key != s3_key) return result;
+        cursor = record_cursor_;
+    }
+
+    // A stride seen twice in a row (sequential scan, fixed-step sharding)
+    if (cursor.stride != 0 && cursor.stride_run >= 2) {
+        int64_t next = static_cast<int64_t>(cursor.record);
+        while (result.size() < MAX_RECORD_PREDICTIONS) {
+            next += cursor.stride;
+            if (next < 0 || static_cast<size_t>(next) >= index.size()) break;
+            result.push_back(static_cast<size_t>(next));
+        }
+        return result;
+    }
+
+    // Otherwise the order learned from earlier visits (e.g. a repeated epoch)
+    std::string prefix = s3_key + "#";
+    for (const auto& id : record_markov_.predict(MAX_RECORD_PREDICTIONS)) {
+        if (id.compare(0, prefix.size(), prefix) != 0) break;  // Crosses into another file
+
+        // A key that itself contains '#' ("a#b" vs "a#b#3") leaves a non-numeric tail
+        size_t record = 0;
+        const char* first = id.data() + prefix.size();
+        const char* last = id.data() + id.size();
+        auto [end, error] = std::from_chars(first, last, record);
+        if (error != std::errc() || end != last || first == last) continue;
+
+        if (record < index.size()) {
+            result.push_back(record);
+        }
+    }
+    return result;
+}
+
+size_t Predictor::issue_record_prefetch(const std::string& s3_key, size_t window_bytes) {
+    auto index = load_record_index(s3_key);
+    if (!index) return 0;
+
+    size_t covered = 0;
+    for (size_t record : predict_records(s3_key, *index)) {
+        if (covered >= window_bytes) break;
+
+        const auto& range = index->record(record);
+        covered += range.length;
+
+        if (cache_.contains_range(s3_key, range.offset, range.length)) continue;
+
+        if (!admit_prefetch(range.length)) break;
+
+        if (submit_prefetch(s3_key, range.offset, PredictionSource::RECORD,
+                            Priority::NORMAL, range.length)) {
+            stats_.record_prefetches++;
+            stats_.record_prefetch_bytes += range.length;
+        }
+    }
+
+    return covered;
+}
+
+bool Predictor::submit_prefetch(const std::string& s3_key, size_t offset,
+                                PredictionSource source, Priority priority, size_t size) {
+    // In-flight entries are per range, keyed like S3WorkerPool: a record and
+    // a chunk at the same offset are different downloads
+    std::string range_id = s3_key + "@" + std::to_string(offset) + "+" + std::to_string(size);
+
+    // Skip if already in flight
+    {
+        std::lock_guard<std::mutex> lock(in_flight_mutex_);
+        if (in_flight_.count(range_id)) return false;
+    }
+
+    // Submit prefetch (may throw)
+    auto future = worker_pool_.submit(s3_key, offset, size, priority, source);
+    VALKYRIE_PROBE5(predict__issue, s3_key.c_str(), offset, size,
+                    static_cast<int>(source), static_cast<int>(priority));
+
+    // Only track if submit succeeded
+    {
+        std::lock_guard<std::mutex> lock(in_flight_mutex_);
+        if (in_flight_.emplace(range_id, size).second) {
+            in_flight_bytes_ += size;
         }
+        in_flight_futures_.emplace_back(range_id, future);
+    }
+
+    return true;
+}
+
+bool Predictor::set_prefetch_budget(double fraction) {
+    if (!(fraction > 0.0 && fraction <= 1.0)) {
+        return false;
+    }
+    prefetch_budget_.store(fraction);
+    return true;
+}
 
-        stats_.prefetches_issued++;
+bool Predictor::admit_prefetch(size_t bytes) {
+    size_t budget = static_cast<size_t>(cache_.get_max_size() * prefetch_budget_.load());
+
+    // Bytes already committed to prefetching: landed but unread, plus downloading
+    size_t committed = cache_.get_unread_prefetch_bytes();
+    {
+        std::lock_guard<std::mutex> lock(in_flight_mutex_);
+        committed += in_flight_bytes_;
     }
+
+    if (committed + bytes > budget) {
+        // Retried on the next predictor tick once readers consume what landed
+        stats_.prefetches_deferred++;
+        VALKYRIE_PROBE3(predict__defer, bytes, committed, budget);
+        return false;
+    }
+    return true;
 }
 
 void Predictor::cleanup_completed_downloads() {
@@ -193,8 +1025,12 @@ void Predictor::cleanup_completed_downloads() {
 
         // Check if future is ready (completed or failed)
         if (future.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
-            // Remove from in_flight_ set
-            in_flight_.erase(file_key);
+            // Remove from in_flight_ map
+            auto entry = in_flight_.find(file_key);
+            if (entry != in_flight_.end()) {
+                in_flight_bytes_ -= entry->second;
+                in_flight_.erase(entry);
+            }
             // Remove from futures vector
             it = in_flight_futures_.erase(it);
         } else {
@@ -203,13 +1039,43 @@ void Predictor::cleanup_completed_downloads() {
     }
 }
 
-std::optional<int> Predictor::find_in_manifest(const std::string& s3_key) {
-    for (size_t i = 0; i < manifest_.size(); ++i) {
-        if (manifest_[i] == s3_key) {
-            return static_cast<int>(i);
+void Predictor::record_predictions(const std::vector<std::string>& keys,
+                                   PredictionSource source) {
+    std::lock_guard<std::mutex> lock(outstanding_mutex_);
+
+    for (const auto& key : keys) {
+        uint64_t sequence = next_prediction_sequence_;
+        if (!outstanding_predictions_.emplace(key, OutstandingPrediction{source, sequence}).second) {
+            continue;
+        }
+
+        ++next_prediction_sequence_;
+        outstanding_order_.emplace_back(sequence, key);
+        stats_.sources[static_cast<size_t>(source)].predicted++;
+    }
+
+    // Forget the oldest predictions; they count as misses. Stale entries
+    // (keys opened since) count towards the queue bound, not the map's.
+    while (!outstanding_order_.empty() &&
+           (outstanding_predictions_.size() > MAX_OUTSTANDING_PREDICTIONS ||
+            outstanding_order_.size() > 2 * MAX_OUTSTANDING_PREDICTIONS)) {
+        const auto& [sequence, key] = outstanding_order_.front();
+        auto it = outstanding_predictions_.find(key);
+        if (it != outstanding_predictions_.end() && it->second.sequence == sequence) {
+            outstanding_predictions_.erase(it);
         }
+        outstanding_order_.pop_front();
     }
-    return std::nullopt;
+}
+
+void Predictor::record_access_outcome(const std::string& s3_key) {
+    std::lock_guard<std::mutex> lock(outstanding_mutex_);
+
+    auto it = outstanding_predictions_.find(s3_key);
+    if (it == outstanding_predictions_.end()) return;
+
+    stats_.sources[static_cast<size_t>(it->second.source)].correct++;
+    outstanding_predictions_.erase(it);  // Its queue entry is now stale
 }
 
 }  // namespace valkyrie
@@ -3,7 +3,14 @@
 #include "types.hpp"
 #include "cache_manager.hpp"
 #include "s3_worker_pool.hpp"
+#include "markov_model.hpp"
+#include "manifest.hpp"
+#include "tar_index.hpp"
+#include "parquet_footer.hpp"
+#include "record_index.hpp"
+#include "sharded_counter.hpp"
 
+#include <array>
 #include <string>
 #include <vector>
 #include <optional>
@@ -13,6 +20,10 @@
 #include <unordered_set>
 #include <unordered_map>
 #include <mutex>
+#include <deque>
+#include <functional>
+#include <chrono>
+#include <memory>
 
 namespace valkyrie {
 
@@ -33,42 +44,339 @@ public:
     // Notify predictor of file access
     void on_file_accessed(const std::string& s3_key);
 
-    // Load manifest file
+    // Notify predictor of bytes delivered to the reader (hot path: lock-free).
+    // end_offset is where the read of s3_key finished.
+    void on_bytes_read(const std::string& s3_key, size_t bytes, size_t end_offset);
+
+    // Size the prefetch window from consumption rate and S3 bandwidth instead
+    // of a fixed file count; lookahead then acts as the upper bound in files.
+    // Call before start().
+    void enable_adaptive_lookahead();
+
+    // Cap unread prefetched plus in-flight prefetch bytes at `fraction` of the
+    // cache; predictions past the cap are deferred until readers catch up.
+    // False if fraction is not in (0, 1].
+    bool set_prefetch_budget(double fraction);
+    double get_prefetch_budget() const { return prefetch_budget_.load(); }
+
+    // Object size resolver used to stop readahead at end of file
+    using SizeLookup = std::function<std::optional<size_t>(const std::string&)>;
+    void set_size_lookup(SizeLookup lookup);
+
+    // Prefetch the chunks holding the next members of ".tar" archives in read
+    // order, ahead of other files. Call before start().
+    void set_tar_indexer(const TarIndexer* indexer);
+
+    // Restrict Parquet prefetch to these columns (all columns if empty).
+    // Call before start().
+    void set_parquet_columns(std::vector<std::string> columns);
+
+    // Load "<key>.index" sidecars into `indexes` and prefetch whole records in
+    // the order the reader visits them instead of fixed chunks. Call before start().
+    void set_record_indexes(RecordIndexStore* indexes);
+
+    // Notify predictor that the reader moved to record `record` of s3_key
+    void on_record_read(const std::string& s3_key, size_t record);
+
+    // Load manifest file (including "#@shuffle" epoch directives)
     bool load_manifest(const std::string& manifest_path);
 
+    // Atomically replace the manifest (nullptr clears it). The caller builds
+    // the new manifest; readers and the predictor only see a pointer swap.
+    void set_manifest(std::shared_ptr<const Manifest> manifest);
+
+    // Current manifest (may be null)
+    std::shared_ptr<const Manifest> get_manifest() const;
+
+    // Treat s3_key as the reader's current position (as if just opened)
+    void set_position(const std::string& s3_key);
+
+    // Jump a shuffled manifest to the given epoch; false if not shuffled
+    bool set_shuffle_epoch(uint64_t epoch);
+
+    // Change lookahead at runtime; false if out of range. 0 stops prefetching.
+    bool set_lookahead(int lookahead);
+    int get_lookahead() const { return lookahead_.load(); }
+
+    // Manifest entry read at `position` of the current epoch (file order if not shuffled)
+    std::optional<std::string> manifest_entry_at(size_t position) const;
+
+    // Train the Markov model from a previous run's access trace
+    bool load_access_trace(const std::string& trace_path);
+
+    // Save this run's access sequence for the next run's Markov model
+    bool save_access_trace(const std::string& trace_path) const;
+
     // Static pattern detection (for testing)
     static std::optional<std::string> predict_next_sequential(const std::string& filename);
 
+    // Counters are sharded per thread; gauges are atomics set by the predictor thread
     struct Stats {
-        std::atomic<uint64_t> predictions_made{0};
-        std::atomic<uint64_t> prefetches_issued{0};
-        std::atomic<uint64_t> pattern_hits{0};
-        std::atomic<uint64_t> manifest_hits{0};
+        ShardedCounter predictions_made;
+        ShardedCounter prefetches_issued;
+        ShardedCounter pattern_hits;
+        ShardedCounter manifest_hits;
+        ShardedCounter markov_hits;
+        ShardedCounter shuffle_hits;
+        std::atomic<uint64_t> shuffle_epoch{0};       // Current epoch (gauge)
+        ShardedCounter epoch_rollovers;               // Detected from the access stream
+
+        // Per-source accuracy: distinct keys predicted vs. later opened
+        struct SourceStats {
+            ShardedCounter predicted;
+            ShardedCounter correct;
+        };
+        SourceStats sources[NUM_PREDICTION_SOURCES];
+
+        // Adaptive window gauges (updated by the predictor thread)
+        std::atomic<uint64_t> consumption_bytes_per_sec{0};
+        std::atomic<uint64_t> download_bytes_per_sec{0};  // Aggregate across workers
+        std::atomic<uint64_t> download_latency_us{0};     // Time to first byte per request
+        std::atomic<uint64_t> window_bytes{0};
+        std::atomic<uint64_t> window_files{0};
+        ShardedCounter readahead_issued;
+        ShardedCounter member_readahead_issued;           // Tar member chunks
+
+        // Parquet footer-driven prefetch
+        ShardedCounter parquet_footers_parsed;
+        ShardedCounter parquet_footer_errors;
+        ShardedCounter parquet_chunks_issued;
+
+        // Record-aligned prefetch of indexed TFRecord/ArrayRecord files
+        ShardedCounter record_indexes_loaded;
+        ShardedCounter record_prefetches;
+        ShardedCounter record_prefetch_bytes;
+
+        // Prefetch admission
+        ShardedCounter prefetches_deferred;               // Held back by the budget
+
+        const SourceStats& source(PredictionSource src) const {
+            return sources[static_cast<size_t>(src)];
+        }
+
+        // Fraction of predicted keys that were opened (0 if none predicted)
+        double accuracy(PredictionSource src) const {
+            uint64_t predicted = source(src).predicted.load();
+            return predicted == 0 ? 0.0
+                : static_cast<double>(source(src).correct.load()) / predicted;
+        }
     };
 
     const Stats& get_stats() const { return stats_; }
 
-    size_t get_manifest_size() const { return manifest_.size(); }
+    const MarkovModel& get_markov_model() const { return markov_; }
+
+    size_t get_manifest_size() const;
+
+    // Epoch the shuffled-manifest tracker believes the reader is in
+    uint64_t get_shuffle_epoch() const { return stats_.shuffle_epoch.load(); }
+
+    // Accesses to the last/first this many shuffled positions can roll the epoch over
+    static constexpr size_t SHUFFLE_ROLLOVER_WINDOW = 16;
 
 private:
     void predictor_loop();
     void predict_and_prefetch(const std::string& s3_key);
-    std::optional<int> find_in_manifest(const std::string& s3_key);
+    // Shuffled-epoch tracking
+    struct ManifestState;
+    std::shared_ptr<const ManifestState> get_manifest_state() const;
+    // Publish `next` if `expected` is still current; false if it was replaced
+    bool replace_manifest_state(const std::shared_ptr<const ManifestState>& expected,
+                                std::shared_ptr<const ManifestState> next);
+    void track_epoch(const std::string& s3_key);
+    void prepare_next_epoch();
+    std::vector<std::string> predict_shuffled(const ManifestState& state, size_t index,
+                                              int lookahead);
+
+    // Recompute rates and the adaptive window (predictor thread only)
+    void update_window();
+
+    // Prefetch chunks of the current file ahead of the reader; returns bytes covered
+    size_t issue_readahead(const std::string& s3_key, size_t window_bytes);
+
+    // Prefetch chunks through the end of the archive members the window
+    // touches; returns bytes covered (0 if the archive is not indexed there)
+    size_t issue_member_readahead(const std::string& s3_key, size_t window_bytes);
+
+    // Prefetch a Parquet object's footer, then its column chunks in file order.
+    // False if the object cannot be planned (unknown size, bad footer), in
+    // which case the caller falls back to plain chunk prefetch.
+    bool issue_parquet_prefetch(const std::string& s3_key, PredictionSource source,
+                                Priority priority);
+
+    // Column chunks of a Parquet object once its footer is cached; nullptr
+    // while footer chunks are still being fetched. Predictor thread only.
+    struct ParquetLayout {
+        bool ready = false;     // Footer parsed (or given up on)
+        bool valid = false;
+        int footer_requests = 0;
+        std::vector<ParquetColumnChunk> chunks;  // Selected columns, file order
+    };
+    static constexpr int MAX_FOOTER_REQUESTS = 3;
+    const ParquetLayout* parquet_layout(const std::string& s3_key, size_t file_size,
+                                        PredictionSource source, Priority priority);
+
+    // Fetch and parse the record index sidecar of s3_key once, without
+    // waiting on its GETs; nullptr while it loads or if the file has none
+    std::shared_ptr<const RecordIndex> load_record_index(const std::string& s3_key);
+
+    // Prefetch the records predicted to follow the reader's current record,
+    // up to window_bytes; returns bytes covered (0 if not indexed)
+    size_t issue_record_prefetch(const std::string& s3_key, size_t window_bytes);
+
+    // Next records of s3_key by repeated stride, else by the learned order
+    std::vector<size_t> predict_records(const std::string& s3_key, const RecordIndex& index);
+
+    // Submit one range unless cached or already in flight; true if submitted
+    bool submit_prefetch(const std::string& s3_key, size_t offset, PredictionSource source,
+                         Priority priority = Priority::NORMAL,
+                         size_t size = DEFAULT_CHUNK_SIZE);
+
+    // True if `bytes` more fit in the prefetch budget; counts a deferral otherwise
+    bool admit_prefetch(size_t bytes = DEFAULT_CHUNK_SIZE);
+
+    // Remember which source predicted each key so hits can be attributed
+    void record_predictions(const std::vector<std::string>& keys, PredictionSource source);
+    void record_access_outcome(const std::string& s3_key);
 
     CacheManager& cache_;
     S3WorkerPool& worker_pool_;
-    int lookahead_;
+    std::atomic<int> lookahead_;
+    std::atomic<double> prefetch_budget_{DEFAULT_PREFETCH_BUDGET};
+
+    // Adaptive window state
+    struct Ewma {
+        double value = 0.0;
+        bool initialized = false;
+
+        void add(double sample, double alpha = 0.3) {
+            value = initialized ? alpha * sample + (1.0 - alpha) * value : sample;
+            initialized = true;
+        }
+    };
+
+    std::atomic<bool> adaptive_{false};
+    SizeLookup size_lookup_;
+    const TarIndexer* tar_indexer_ = nullptr;
+
+    // Parsed Parquet footers (predictor thread only), oldest dropped first
+    std::vector<std::string> parquet_columns_;
+    std::unordered_map<std::string, ParquetLayout> parquet_layouts_;
+    std::deque<std::string> parquet_layout_order_;
+    static constexpr size_t MAX_PARQUET_LAYOUTS = 1024;
+
+    // Reader's position in an indexed record file
+    RecordIndexStore* record_indexes_ = nullptr;
+
+    // Sidecar being read for the current file (predictor thread only)
+    struct RecordIndexLoad {
+        std::string s3_key;
+        size_t offset = 0;                 // Chunk being fetched
+        std::shared_future<bool> pending;  // Its GET, if queued
+        std::string text;                  // Chunks read so far
+        int failures = 0;                  // Consecutive failed GETs of this chunk
+        std::chrono::steady_clock::time_point retry_at;
+    };
+    RecordIndexLoad record_index_load_;
+    struct RecordCursor {
+        std::string s3_key;
+        size_t record = 0;
+        int64_t stride = 0;     // Last record-to-record step
+        int stride_run = 0;     // Consecutive steps with that stride
+    };
+    RecordCursor record_cursor_;
+    MarkovModel record_markov_;   // Over "key#record" ids
+    std::mutex record_mutex_;
+    static constexpr size_t MAX_RECORD_PREDICTIONS = 256;   // Per tick
+
+    // Failed sidecar GETs are retried after 100ms, doubling up to 30s. With
+    // the sidecar's size unknown, a chunk failing this many times in a row
+    // is taken as past its end (or, at offset 0, as no sidecar).
+    static constexpr std::chrono::milliseconds RECORD_INDEX_RETRY_MIN{100};
+    static constexpr std::chrono::milliseconds RECORD_INDEX_RETRY_MAX{30000};
+    static constexpr int RECORD_INDEX_MAX_FAILURES = 4;
+    ShardedCounter bytes_consumed_;             // Total bytes delivered to readers
+
+    // End of the last read in each file, lock-free: one slot per key hash,
+    // holding a tag of the hash above a 40-bit offset
+    void set_read_position(const std::string& s3_key, size_t position);
+    size_t get_read_position(const std::string& s3_key) const;
+    static constexpr size_t READ_POSITION_SLOTS = 256;
+    static constexpr int READ_POSITION_BITS = 40;
+    static constexpr uint64_t READ_POSITION_MASK = (uint64_t{1} << READ_POSITION_BITS) - 1;
+    std::array<std::atomic<uint64_t>, READ_POSITION_SLOTS> read_positions_{};
+
+    Ewma consumption_rate_;   // bytes/s
+    Ewma bandwidth_;          // bytes/s downloaded by all workers together
+    Ewma chunk_latency_;      // seconds to first byte per chunk request
+    Ewma file_bytes_;         // bytes consumed per opened file
+    uint64_t bytes_at_file_switch_ = 0;         // Guarded by access_mutex_
+
+    std::chrono::steady_clock::time_point last_sample_time_;
+    uint64_t last_consumed_ = 0;
+    uint64_t last_downloaded_ = 0;
+    uint64_t last_download_time_us_ = 0;
+    uint64_t last_download_count_ = 0;
+    uint64_t last_ttfb_count_ = 0;
+    uint64_t last_ttfb_sum_us_ = 0;
+
+    static constexpr std::chrono::milliseconds RATE_SAMPLE_INTERVAL{500};
+    static constexpr double DEFAULT_CHUNK_LATENCY_SEC = 0.1;  // Before first download
 
     // Manifest mode
     std::atomic<bool> manifest_mode_;
-    std::vector<std::string> manifest_;
+
+    // Shuffled order of one epoch (position <-> manifest index)
+    struct EpochOrder {
+        uint64_t epoch = 0;
+        std::vector<uint32_t> order;     // Position -> index
+        std::vector<uint32_t> position;  // Index -> position
+    };
+    static std::shared_ptr<const EpochOrder> make_epoch_order(size_t n, uint64_t seed,
+                                                              uint64_t epoch);
+
+    // The manifest and its epoch orders, published together as one immutable
+    // snapshot: epoch changes build a new one and swap the pointer
+    struct ManifestState {
+        std::shared_ptr<const Manifest> manifest;
+        std::shared_ptr<const EpochOrder> current;  // Null unless shuffled
+        std::shared_ptr<const EpochOrder> next;     // Epoch + 1, null until prepared
+    };
+    std::shared_ptr<const ManifestState> manifest_state_;
+    mutable std::mutex manifest_mutex_;  // Guards the pointer only
+
+    // Files opened in the current epoch (access path; not part of the snapshot)
+    struct EpochProgress {
+        std::shared_ptr<const EpochOrder> epoch;  // Epoch counted below
+        std::vector<bool> seen;
+        size_t seen_count = 0;
+    };
+    EpochProgress epoch_progress_;
+    std::mutex epoch_progress_mutex_;
 
     // Recent access tracking
     std::string last_accessed_;
     std::mutex access_mutex_;
 
-    // In-flight tracking (prevent duplicate prefetches)
-    std::unordered_set<std::string> in_flight_;
+    // Learned transition model (fallback when pattern and manifest fail)
+    MarkovModel markov_;
+
+    // Predicted-but-not-yet-opened keys (bounded). The order queue is not
+    // touched when a key is opened; its entry goes stale (sequence mismatch)
+    // and is dropped when it reaches the front.
+    struct OutstandingPrediction {
+        PredictionSource source;
+        uint64_t sequence;
+    };
+    std::unordered_map<std::string, OutstandingPrediction> outstanding_predictions_;
+    std::deque<std::pair<uint64_t, std::string>> outstanding_order_;  // Oldest first
+    uint64_t next_prediction_sequence_ = 0;
+    std::mutex outstanding_mutex_;
+    static constexpr size_t MAX_OUTSTANDING_PREDICTIONS = 4096;
+
+    // In-flight tracking (prevent duplicate prefetches): range id -> bytes
+    std::unordered_map<std::string, size_t> in_flight_;
+    size_t in_flight_bytes_ = 0;
     std::mutex in_flight_mutex_;
 
     // Track futures to clean up completed downloads
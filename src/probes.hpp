@@ -0,0 +1,42 @@
+#pragma once
+
+// USDT (user-level statically defined tracing) probes for live tracing with
+// bpftrace or perf, e.g. `bpftrace -p $(pidof valkyrie) scripts/bpftrace/...`.
+// Each probe compiles to a single nop plus an ELF note; arguments are values
+// the caller already has, so an unattached probe costs nothing measurable.
+// Built without <sys/sdt.h> (or with -DVALKYRIE_NO_USDT) they vanish.
+//
+// Provider "valkyrie". Keys are NUL-terminated strings (bpftrace: str(argN)),
+// latencies are microseconds, priorities and sources are the enum values.
+//
+//   read__entry      key, offset, size
+//   read__return     key, offset, bytes, latency_us, hit
+//   cache__hit       key, chunk_offset
+//   cache__miss      key, chunk_offset, fetch_size
+//   cache__evict     key, bytes
+//   task__enqueue    key, offset, size, priority
+//   task__dequeue    key, offset, priority, queue_wait_us
+//   s3__start        key, offset, size, priority
+//   s3__first__byte  key, offset, ttfb_us          (S3 only, at completion)
+//   s3__done         key, offset, bytes, latency_us, ok
+//   predict__issue   key, offset, size, source, priority
+//   predict__defer   bytes, committed_bytes, budget_bytes
+
+#if defined(__has_include)
+#if __has_include(<sys/sdt.h>) && !defined(VALKYRIE_NO_USDT)
+#include <sys/sdt.h>
+#define VALKYRIE_HAVE_USDT 1
+#endif
+#endif
+
+#ifdef VALKYRIE_HAVE_USDT
+#define VALKYRIE_PROBE2(name, a, b) DTRACE_PROBE2(valkyrie, name, a, b)
+#define VALKYRIE_PROBE3(name, a, b, c) DTRACE_PROBE3(valkyrie, name, a, b, c)
+#define VALKYRIE_PROBE4(name, a, b, c, d) DTRACE_PROBE4(valkyrie, name, a, b, c, d)
+#define VALKYRIE_PROBE5(name, a, b, c, d, e) DTRACE_PROBE5(valkyrie, name, a, b, c, d, e)
+#else
+#define VALKYRIE_PROBE2(name, a, b) do {} while (0)
+#define VALKYRIE_PROBE3(name, a, b, c) do {} while (0)
+#define VALKYRIE_PROBE4(name, a, b, c, d) do {} while (0)
+#define VALKYRIE_PROBE5(name, a, b, c, d, e) do {} while (0)
+#endif
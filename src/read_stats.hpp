@@ -0,0 +1,17 @@
+#pragma once
+
+#include "histogram.hpp"
+#include "sharded_counter.hpp"
+#include "stall_tracker.hpp"
+
+namespace valkyrie {
+
+// Latency of FUSE reads as the reader sees it, split by cache outcome
+struct ReadStats {
+    LogLinearHistogram hit_latency_us;    // Served from the cache
+    LogLinearHistogram miss_latency_us;   // Waited on an URGENT download
+    ShardedCounter bytes_read;            // Delivered to readers
+    StallTracker stalls;                  // Time blocked on S3, per reader and file
+};
+
+}  // namespace valkyrie
@@ -0,0 +1,73 @@
+#include "record_index.hpp"
+#include <algorithm>
+#include <sstream>
+
+namespace valkyrie {
+
+bool RecordIndex::parse(const std::string& text) {
+    records_.clear();
+
+    std::istringstream iss(text);
+    std::string line;
+    while (std::getline(iss, line)) {
+        line.erase(0, line.find_first_not_of(" \t\r\n"));
+        if (line.empty() || line[0] == '#') continue;
+
+        std::istringstream fields(line);
+        RecordRange range;
+        if (!(fields >> range.offset >> range.length) || range.length == 0) {
+            records_.clear();
+            return false;
+        }
+        records_.push_back(range);
+    }
+
+    std::sort(records_.begin(), records_.end(),
+        [](const RecordRange& a, const RecordRange& b) { return a.offset < b.offset; });
+
+    return !records_.empty();
+}
+
+std::optional<size_t> RecordIndex::find(uint64_t offset) const {
+    // Last record starting at or before offset
+    auto it = std::upper_bound(records_.begin(), records_.end(), offset,
+        [](uint64_t value, const RecordRange& r) { return value < r.offset; });
+    if (it == records_.begin()) {
+        return std::nullopt;
+    }
+    --it;
+
+    if (offset >= it->offset + it->length) {
+        return std::nullopt;  // In a gap between records
+    }
+    return static_cast<size_t>(it - records_.begin());
+}
+
+bool RecordIndex::is_index_key(const std::string& key) {
+    static const std::string suffix = ".index";
+    return key.size() > suffix.size() &&
+           key.compare(key.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+std::shared_ptr<const RecordIndex> RecordIndexStore::get(const std::string& s3_key) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = indexes_.find(s3_key);
+    return it == indexes_.end() ? nullptr : it->second;
+}
+
+void RecordIndexStore::put(const std::string& s3_key, std::shared_ptr<const RecordIndex> index) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    indexes_[s3_key] = std::move(index);
+}
+
+void RecordIndexStore::mark_missing(const std::string& s3_key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    indexes_.emplace(s3_key, nullptr);
+}
+
+bool RecordIndexStore::attempted(const std::string& s3_key) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return indexes_.count(s3_key) > 0;
+}
+
+}  // namespace valkyrie
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <optional>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+
+namespace valkyrie {
+
+// Byte range of one record in a record-oriented file
+struct RecordRange {
+    uint64_t offset;
+    uint64_t length;
+};
+
+// Record offsets of an indexed TFRecord/ArrayRecord file, read from a sidecar
+// "<key>.index" with one "offset length" line per record (the tfrecord2idx
+// format used by DALI). Immutable once loaded.
+class RecordIndex {
+public:
+    // Parse sidecar text. Returns false on a malformed line or if empty.
+    bool parse(const std::string& text);
+
+    size_t size() const { return records_.size(); }
+    const RecordRange& record(size_t index) const { return records_[index]; }
+
+    // Record whose bytes contain `offset`
+    std::optional<size_t> find(uint64_t offset) const;
+
+    static std::string index_key_for(const std::string& s3_key) { return s3_key + ".index"; }
+    static bool is_index_key(const std::string& key);
+
+private:
+    std::vector<RecordRange> records_;  // Sorted by offset
+};
+
+// Record indexes by S3 key. Thread-safe: loaded by the predictor thread,
+// queried by FUSE reads.
+class RecordIndexStore {
+public:
+    // Index for s3_key, or nullptr if none (yet)
+    std::shared_ptr<const RecordIndex> get(const std::string& s3_key) const;
+
+    void put(const std::string& s3_key, std::shared_ptr<const RecordIndex> index);
+
+    // Remember that s3_key has no usable sidecar
+    void mark_missing(const std::string& s3_key);
+
+    // True if a load was already attempted (found or missing)
+    bool attempted(const std::string& s3_key) const;
+
+private:
+    std::unordered_map<std::string, std::shared_ptr<const RecordIndex>> indexes_;
+    mutable std::mutex mutex_;
+};
+
+}  // namespace valkyrie
@@ -1,7 +1,10 @@
 #include "s3_worker_pool.hpp"
+#include "logger.hpp"
+#include "probes.hpp"
 #include <aws/core/auth/AWSCredentialsProvider.h>
 #include <aws/s3/model/HeadObjectRequest.h>
 #include <aws/s3/model/ListObjectsV2Request.h>
+#include <chrono>
 #include <iostream>
 
 namespace valkyrie {
@@ -37,6 +40,18 @@ void S3WorkerPool::start() {
     std::cout << "S3WorkerPool: Started " << num_workers_ << " workers\n";
 }
 
+void S3WorkerPool::set_chunk_listener(ChunkListener listener) {
+    chunk_listener_ = std::move(listener);
+}
+
+void S3WorkerPool::set_range_fetcher(RangeFetcher fetcher) {
+    range_fetcher_ = std::move(fetcher);
+}
+
+void S3WorkerPool::set_object_lister(ObjectLister lister) {
+    object_lister_ = std::move(lister);
+}
+
 void S3WorkerPool::shutdown() {
     if (shutdown_flag_.exchange(true)) {
         return;  // Already shutdown
@@ -58,11 +73,48 @@ void S3WorkerPool::shutdown() {
 std::shared_future<bool> S3WorkerPool::submit(const std::string& s3_key,
                                               size_t offset,
                                               size_t size,
-                                              Priority priority) {
-    PrefetchTask task(s3_key, offset, size, priority);
-    auto future = task.completion->get_future().share();
+                                              Priority priority,
+                                              std::optional<PredictionSource> source) {
+    std::optional<PrefetchTask> task;
+    std::shared_future<bool> future;
+    {
+        std::lock_guard<std::mutex> lock(in_flight_mutex_);
+        auto it = in_flight_.find({s3_key, offset, size});
+        if (it != in_flight_.end()) {
+            InFlight& existing = it->second;
+
+            // Prefetches, and readers racing another reader's miss, share the download
+            if (priority != Priority::URGENT || !existing.source.has_value()) {
+                return existing.future;
+            }
 
-    task_queue_.push(std::move(task), priority);
+            // Landed between the reader's miss and now: nothing to wait for
+            if (cache_.contains_range(s3_key, offset, size)) {
+                std::promise<bool> done;
+                done.set_value(true);
+                return done.get_future().share();
+            }
+
+            // The reader caught up with a prefetch
+            cache_.record_late_prefetch(*existing.source, size);
+
+            // Already downloading: wait on it. Still queued at prefetch
+            // priority: fetch URGENT below; the queued copy is skipped later.
+            if (existing.started) {
+                existing.late = true;
+                return existing.future;
+            }
+        }
+
+        // Registered under the same lock as the lookup, so concurrent misses
+        // on one chunk join a single download
+        task.emplace(s3_key, offset, size, priority, source);
+        future = task->completion->get_future().share();
+        in_flight_[{s3_key, offset, size}] = InFlight{future, source, task->completion.get(), false, false};
+    }
+
+    VALKYRIE_PROBE4(task__enqueue, s3_key.c_str(), offset, size, static_cast<int>(priority));
+    task_queue_.push(std::move(*task), priority);
 
     return future;
 }
@@ -77,22 +129,130 @@ void S3WorkerPool::worker_loop(int worker_id) {
 
         auto& task = task_opt->data;
 
-        // Attempt download
-        bool success = download_chunk(task);
+        uint64_t wait_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - task.enqueued_at).count();
+        stats_.queue_wait_us[static_cast<size_t>(task.priority)].record(wait_us);
+        VALKYRIE_PROBE4(task__dequeue, task.s3_key.c_str(), task.offset,
+                        static_cast<int>(task.priority), wait_us);
+
+        bool success;
+        if (task.source.has_value() && cache_.contains_range(task.s3_key, task.offset, task.size)) {
+            // Superseded by an URGENT fetch (or an earlier prefetch) while queued
+            stats_.prefetches_skipped++;
+            success = true;
+        } else {
+            mark_started(task);
+
+            // Attempt download
+            success = download_chunk(task);
+        }
+
+        finish_in_flight(task);
 
         // Fulfill promise
         try {
             task.completion->set_value(success);
         } catch (const std::future_error& e) {
             // Promise already set (shouldn't happen, but handle gracefully)
-            std::cerr << "Worker " << worker_id << ": Promise error: " << e.what() << "\n";
+            Logger::error("s3", "Worker ", worker_id, ": Promise error: ", e.what());
         }
     }
 }
 
+void S3WorkerPool::mark_started(const PrefetchTask& task) {
+    std::lock_guard<std::mutex> lock(in_flight_mutex_);
+    auto it = in_flight_.find({task.s3_key, task.offset, task.size});
+    if (it != in_flight_.end() && it->second.owner == task.completion.get()) {
+        it->second.started = true;
+    }
+}
+
+bool S3WorkerPool::is_late(const PrefetchTask& task) {
+    std::lock_guard<std::mutex> lock(in_flight_mutex_);
+    auto it = in_flight_.find({task.s3_key, task.offset, task.size});
+    return it != in_flight_.end() && it->second.owner == task.completion.get() &&
+           it->second.late;
+}
+
+void S3WorkerPool::finish_in_flight(const PrefetchTask& task) {
+    // Only the owning task removes the entry; a newer URGENT task may have replaced it
+    std::lock_guard<std::mutex> lock(in_flight_mutex_);
+    auto it = in_flight_.find({task.s3_key, task.offset, task.size});
+    if (it != in_flight_.end() && it->second.owner == task.completion.get()) {
+        in_flight_.erase(it);
+    }
+}
+
 bool S3WorkerPool::download_chunk(const PrefetchTask& task) {
     stats_.total_downloads++;
 
+    VALKYRIE_PROBE4(s3__start, task.s3_key.c_str(), task.offset, task.size,
+                    static_cast<int>(task.priority));
+    auto start_time = std::chrono::steady_clock::now();
+    std::optional<std::chrono::steady_clock::time_point> first_byte;
+    std::vector<char> data;
+    bool fetched = range_fetcher_ ? range_fetcher_(task.s3_key, task.offset, task.size, data)
+                                  : fetch_from_s3(task, data, first_byte);
+    size_t bytes_read = data.size();
+    auto end_time = std::chrono::steady_clock::now();
+    auto elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        end_time - start_time).count();
+
+    VALKYRIE_PROBE5(s3__done, task.s3_key.c_str(), task.offset, bytes_read, elapsed_us,
+                    fetched && bytes_read > 0);
+
+    if (!fetched || bytes_read == 0) {
+        stats_.failed_downloads++;
+        return false;
+    }
+
+    // Split into time to first byte and body transfer (whole request when
+    // the first byte was not observed, e.g. a range fetcher)
+    auto transfer_start = first_byte.value_or(start_time);
+    if (first_byte.has_value()) {
+        uint64_t ttfb_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            transfer_start - start_time).count();
+        stats_.ttfb_us.record(ttfb_us);
+        VALKYRIE_PROBE3(s3__first__byte, task.s3_key.c_str(), task.offset, ttfb_us);
+    }
+    auto transfer_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        end_time - transfer_start).count();
+    if (transfer_us > 0) {
+        stats_.throughput_bytes_per_sec.record(bytes_read * 1000000ULL / transfer_us);
+    }
+
+    // Store in cache (promote to HOT if URGENT, otherwise PREFETCH)
+    CacheZone zone = (task.priority == Priority::URGENT)
+                     ? CacheZone::HOT
+                     : CacheZone::PREFETCH;
+
+    // Prefetches keep their source for useful/wasted accounting, unless a
+    // reader already waited on this one (counted as late instead)
+    std::optional<PredictionSource> prefetched_by = task.source;
+    if (prefetched_by.has_value() && is_late(task)) {
+        prefetched_by.reset();
+    }
+
+    cache_.insert_chunk(task.s3_key, task.offset, data, zone, prefetched_by);
+
+    if (chunk_listener_) {
+        chunk_listener_(task.s3_key, task.offset, data);
+    }
+
+    stats_.successful_downloads++;
+    stats_.bytes_downloaded += bytes_read;
+    stats_.download_time_us += elapsed_us;
+
+    if (tracer_) {
+        tracer_->record(TraceEventType::DOWNLOAD, task.s3_key, task.offset, bytes_read,
+                        elapsed_us, task.priority);
+    }
+
+    return true;
+}
+
+bool S3WorkerPool::fetch_from_s3(const PrefetchTask& task, std::vector<char>& data,
+                                 std::optional<std::chrono::steady_clock::time_point>& first_byte) {
     // Build full S3 key
     std::string full_key = config_.get_full_key(task.s3_key);
 
@@ -106,6 +266,14 @@ bool S3WorkerPool::download_chunk(const PrefetchTask& task) {
                         std::to_string(task.offset + task.size - 1);
     request.SetRange(range);
 
+    // GetObject buffers the whole body, so catch the first bytes as they arrive
+    request.SetDataReceivedEventHandler(
+        [&first_byte](const Aws::Http::HttpRequest*, Aws::Http::HttpResponse*, long long) {
+            if (!first_byte.has_value()) {
+                first_byte = std::chrono::steady_clock::now();
+            }
+        });
+
     // Configure timeout based on priority
     int timeout_ms = (task.priority == Priority::URGENT)
                      ? URGENT_TIMEOUT_MS
@@ -118,69 +286,130 @@ bool S3WorkerPool::download_chunk(const PrefetchTask& task) {
         const auto& error = outcome.GetError();
 
         if (task.priority == Priority::URGENT) {
-            std::cerr << "S3 GetObject failed (URGENT): " << full_key
-                      << " at offset " << task.offset
-                      << " - " << error.GetMessage() << "\n";
+            Logger::error("s3", "GetObject failed (URGENT): ", full_key,
+                          " at offset ", task.offset, " - ", error.GetMessage());
         }
-
-        stats_.failed_downloads++;
         return false;
     }
 
     // Read response body
     auto& stream = outcome.GetResult().GetBody();
-    std::vector<char> data(task.size);
+    data.resize(task.size);
     stream.read(data.data(), task.size);
     size_t bytes_read = stream.gcount();
 
     if (bytes_read == 0) {
-        std::cerr << "S3 GetObject returned 0 bytes: " << full_key << "\n";
-        stats_.failed_downloads++;
-        return false;
+        Logger::warn("s3", "GetObject returned 0 bytes: ", full_key);
     }
 
     // Resize if we read less than expected (end of file)
-    if (bytes_read < task.size) {
-        data.resize(bytes_read);
+    data.resize(bytes_read);
+    return true;
+}
+
+std::vector<ObjectInfo> S3WorkerPool::list_objects() {
+    static constexpr int S3_LIST_MAX_KEYS = 1000;
+
+    if (object_lister_) {
+        return object_lister_();
     }
 
-    // Store in cache (promote to HOT if URGENT, otherwise PREFETCH)
-    CacheZone zone = (task.priority == Priority::URGENT)
-                     ? CacheZone::HOT
-                     : CacheZone::PREFETCH;
+    std::string list_prefix = config_.prefix.empty() ? "" : config_.prefix + "/";
+    auto start_time = std::chrono::steady_clock::now();
+
+    // Top-level common prefixes from the first delimiter page seed the
+    // partitions; ranges that are still large split themselves while listing
+    std::vector<std::string> split_points;
+    {
+        Aws::S3::Model::ListObjectsV2Request request;
+        request.SetBucket(config_.bucket);
+        if (!list_prefix.empty()) {
+            request.SetPrefix(list_prefix);
+        }
+        request.SetDelimiter("/");
+        request.SetMaxKeys(S3_LIST_MAX_KEYS);
 
-    cache_.insert_chunk(task.s3_key, task.offset, data, zone);
+        auto outcome = s3_client_->ListObjectsV2(request);
+        if (!outcome.IsSuccess()) {
+            throw std::runtime_error("ListObjectsV2 failed: " +
+                std::string(outcome.GetError().GetMessage()));
+        }
+        for (const auto& common : outcome.GetResult().GetCommonPrefixes()) {
+            split_points.push_back(common.GetPrefix());
+        }
+    }
 
-    stats_.successful_downloads++;
-    stats_.bytes_downloaded += bytes_read;
+    PageFetcher fetch = [this, &list_prefix](const std::string& start_after) {
+        Aws::S3::Model::ListObjectsV2Request request;
+        request.SetBucket(config_.bucket);
+        if (!list_prefix.empty()) {
+            request.SetPrefix(list_prefix);
+        }
+        if (!start_after.empty()) {
+            request.SetStartAfter(start_after);
+        }
+        request.SetMaxKeys(S3_LIST_MAX_KEYS);
 
-    return true;
+        auto outcome = s3_client_->ListObjectsV2(request);
+        if (!outcome.IsSuccess()) {
+            throw std::runtime_error("ListObjectsV2 failed: " +
+                std::string(outcome.GetError().GetMessage()));
+        }
+
+        const auto& result = outcome.GetResult();
+        ListPage page;
+        page.objects.reserve(result.GetContents().size());
+        for (const auto& obj : result.GetContents()) {
+            page.objects.push_back({obj.GetKey(), static_cast<size_t>(obj.GetSize()),
+                                    obj.GetETag(), obj.GetLastModified().Seconds()});
+        }
+        page.truncated = result.GetIsTruncated();
+        return page;
+    };
+
+    ListStats list_stats;
+    auto results = list_partitioned(fetch, split_points, num_workers_, &list_stats, &shutdown_flag_);
+    if (shutdown_flag_.load()) {
+        throw std::runtime_error("listing cancelled by shutdown");
+    }
+
+    // Strip prefix to get relative keys
+    for (auto& obj : results) {
+        obj.key.erase(0, list_prefix.size());
+    }
+
+    auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start_time).count();
+    Logger::info("s3", "Listed ", results.size(), " objects in ", elapsed_ms, "ms (",
+                 list_stats.partitions, " partitions, ", list_stats.requests, " requests, ",
+                 num_workers_, " listers)");
+
+    return results;
 }
 
-std::vector<ObjectInfo> S3WorkerPool::list_objects() {
+DirectoryListing S3WorkerPool::list_directory(const std::string& dir) {
     static constexpr int S3_LIST_MAX_KEYS = 1000;
-    static constexpr int MAX_PAGINATION_ITERATIONS = 1000;  // Protects against infinite loops
 
-    std::vector<ObjectInfo> results;
-    results.reserve(S3_LIST_MAX_KEYS);
+    if (object_lister_) {
+        return group_directory(object_lister_(), dir);
+    }
+
+    std::string list_prefix = config_.prefix.empty() ? "" : config_.prefix + "/";
+    if (!dir.empty()) {
+        list_prefix += dir + "/";
+    }
 
     Aws::S3::Model::ListObjectsV2Request request;
     request.SetBucket(config_.bucket);
-
-    // Set prefix if configured
-    if (!config_.prefix.empty()) {
-        request.SetPrefix(config_.prefix + "/");
+    if (!list_prefix.empty()) {
+        request.SetPrefix(list_prefix);
     }
-
+    request.SetDelimiter("/");
     request.SetMaxKeys(S3_LIST_MAX_KEYS);
 
-    // Pagination loop
+    DirectoryListing listing;
     bool is_truncated = true;
-    int iteration_count = 0;
-
-    while (is_truncated && iteration_count < MAX_PAGINATION_ITERATIONS) {
-        iteration_count++;
-
+    while (is_truncated) {
         auto outcome = s3_client_->ListObjectsV2(request);
         if (!outcome.IsSuccess()) {
             const auto& error = outcome.GetError();
@@ -190,45 +419,35 @@ std::vector<ObjectInfo> S3WorkerPool::list_objects() {
 
         const auto& result = outcome.GetResult();
 
-        // Extract object info
         for (const auto& obj : result.GetContents()) {
-            std::string full_key = obj.GetKey();
-
-            // Strip prefix to get relative key
-            std::string relative_key = full_key;
-            if (!config_.prefix.empty()) {
-                size_t prefix_len = config_.prefix.length() + 1;  // +1 for "/"
-                if (full_key.length() >= prefix_len) {
-                    relative_key = full_key.substr(prefix_len);
-                }
-            }
+            const std::string& full_key = obj.GetKey();
+            // The "dir/" marker object some tools create is the directory itself
+            if (full_key.size() <= list_prefix.size()) continue;
+            listing.files.push_back({full_key.substr(list_prefix.size()),
+                                     static_cast<size_t>(obj.GetSize()),
+                                     obj.GetETag(), obj.GetLastModified().Seconds()});
+        }
 
-            results.push_back({relative_key, static_cast<size_t>(obj.GetSize())});
+        // "<list_prefix>name/" -> "name"
+        for (const auto& common : result.GetCommonPrefixes()) {
+            const std::string& sub = common.GetPrefix();
+            if (sub.size() <= list_prefix.size() + 1) continue;
+            listing.subdirs.push_back(sub.substr(list_prefix.size(),
+                                                 sub.size() - list_prefix.size() - 1));
         }
 
-        // Check if there are more results
         is_truncated = result.GetIsTruncated();
         if (is_truncated) {
             auto next_token = result.GetNextContinuationToken();
             if (next_token.empty()) {
-                std::cerr << "Warning: S3 returned IsTruncated=true with empty continuation token, stopping pagination\n";
+                Logger::warn("s3", "IsTruncated=true with empty continuation token, stopping pagination");
                 break;
             }
             request.SetContinuationToken(next_token);
         }
-
-        // Adaptive memory reservation after first full page
-        if (iteration_count == 1 && result.GetKeyCount() == S3_LIST_MAX_KEYS && is_truncated) {
-            results.reserve(S3_LIST_MAX_KEYS * 10);  // Reserve for ~10 pages
-        }
     }
 
-    if (iteration_count >= MAX_PAGINATION_ITERATIONS) {
-        std::cerr << "Warning: Reached maximum pagination limit ("
-                  << MAX_PAGINATION_ITERATIONS << " iterations), results may be incomplete\n";
-    }
-
-    return results;
+    return listing;
 }
 
 }  // namespace valkyrie
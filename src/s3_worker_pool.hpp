@@ -3,6 +3,10 @@
 #include "types.hpp"
 #include "cache_manager.hpp"
 #include "thread_safe_queue.hpp"
+#include "tracer.hpp"
+#include "sharded_counter.hpp"
+#include "directory_cache.hpp"
+#include "parallel_lister.hpp"
 
 #include <aws/core/Aws.h>
 #include <aws/s3/S3Client.h>
@@ -14,6 +18,12 @@
 #include <atomic>
 #include <memory>
 #include <future>
+#include <map>
+#include <tuple>
+#include <mutex>
+#include <optional>
+#include <functional>
+#include <chrono>
 
 namespace valkyrie {
 
@@ -23,20 +33,19 @@ struct PrefetchTask {
     size_t offset;                // Chunk offset
     size_t size;                  // Chunk size
     Priority priority;            // URGENT, NORMAL, BACKGROUND
+    std::optional<PredictionSource> source;  // Set for prefetches
     std::shared_ptr<std::promise<bool>> completion;  // Fulfill when done
+    std::chrono::steady_clock::time_point enqueued_at;  // For queue wait time
 
-    PrefetchTask(const std::string& key, size_t off, size_t sz, Priority prio)
+    PrefetchTask(const std::string& key, size_t off, size_t sz, Priority prio,
+                 std::optional<PredictionSource> src = std::nullopt)
         : s3_key(key)
         , offset(off)
         , size(sz)
         , priority(prio)
-        , completion(std::make_shared<std::promise<bool>>()) {}
-};
-
-// Information about an S3 object
-struct ObjectInfo {
-    std::string key;      // S3 key (relative to prefix)
-    size_t size;          // Object size in bytes
+        , source(src)
+        , completion(std::make_shared<std::promise<bool>>())
+        , enqueued_at(std::chrono::steady_clock::now()) {}
 };
 
 struct S3Config {
@@ -60,38 +69,104 @@ public:
     // Start worker threads
     void start();
 
-    // Submit task and get future
+    // Submit task and get future. Prefetches pass the predicting source.
+    // An URGENT request for a chunk a prefetch is already fetching waits on
+    // that download (counted as a late prefetch) instead of fetching twice.
     std::shared_future<bool> submit(const std::string& s3_key,
                                     size_t offset,
                                     size_t size,
-                                    Priority priority);
+                                    Priority priority,
+                                    std::optional<PredictionSource> source = std::nullopt);
 
     // Shutdown workers
     void shutdown();
 
-    // List all objects under configured prefix
-    // Handles pagination automatically (retrieves all objects, max 1M)
-    // WARNING: May block for tens of seconds on very large buckets (>10k objects)
-    // Throws std::runtime_error on S3 API failure
+    // Called on the worker thread after each chunk is inserted into the cache
+    // (e.g. to index archive members as they arrive). Call before start().
+    using ChunkListener = std::function<void(const std::string& s3_key, size_t offset,
+                                             const std::vector<char>& data)>;
+    void set_chunk_listener(ChunkListener listener);
+
+    // Record each completed download to `tracer` (nullptr disables). Call before start().
+    void set_tracer(Tracer* tracer) { tracer_ = tracer; }
+
+    // Serve range GETs from `fetcher` instead of S3 (simulation, tests).
+    // It fills `data` with up to `size` bytes; false on failure. Call before start().
+    using RangeFetcher = std::function<bool(const std::string& s3_key, size_t offset,
+                                            size_t size, std::vector<char>& data)>;
+    void set_range_fetcher(RangeFetcher fetcher);
+
+    // Answer list_objects() from `lister` instead of S3 (mock stores, tests)
+    using ObjectLister = std::function<std::vector<ObjectInfo>()>;
+    void set_object_lister(ObjectLister lister);
+
+    // List all objects under configured prefix, sorted, with no object cap.
+    // Key ranges are listed concurrently by one lister per worker (see
+    // list_partitioned); still minutes for tens of millions of objects.
+    // Throws std::runtime_error on S3 API failure or shutdown
     std::vector<ObjectInfo> list_objects();
 
+    // One directory level: ListObjectsV2 with Delimiter="/" under
+    // "<prefix>/<dir>/" ("" is the root). With an object lister set, the
+    // level is grouped from its flat list instead.
+    // Throws std::runtime_error on S3 API failure
+    DirectoryListing list_directory(const std::string& dir);
+
     // Statistics
     struct Stats {
-        std::atomic<uint64_t> total_downloads{0};
-        std::atomic<uint64_t> successful_downloads{0};
-        std::atomic<uint64_t> failed_downloads{0};
-        std::atomic<uint64_t> bytes_downloaded{0};
+        ShardedCounter total_downloads;
+        ShardedCounter successful_downloads;
+        ShardedCounter failed_downloads;
+        ShardedCounter bytes_downloaded;
+        ShardedCounter download_time_us;    // Summed over successful downloads
+        ShardedCounter prefetches_skipped;  // Chunk already cached when dequeued
+
+        LogLinearHistogram ttfb_us;                   // Request sent -> first body byte (S3 only)
+        LogLinearHistogram throughput_bytes_per_sec;  // Body transfer rate per download
+        LogLinearHistogram queue_wait_us[NUM_PRIORITIES];  // Submit -> dequeued, by priority
+
+        const LogLinearHistogram& queue_wait(Priority priority) const {
+            return queue_wait_us[static_cast<size_t>(priority)];
+        }
     };
 
     const Stats& get_stats() const { return stats_; }
 
+    int get_num_workers() const { return num_workers_; }
+
 private:
     void worker_loop(int worker_id);
     bool download_chunk(const PrefetchTask& task);
 
+    // Ranged GetObject into `data` (resized to the bytes received). Sets
+    // first_byte to when the first body bytes arrived.
+    bool fetch_from_s3(const PrefetchTask& task, std::vector<char>& data,
+                       std::optional<std::chrono::steady_clock::time_point>& first_byte);
+
+    // In-flight bookkeeping for the task a worker is processing
+    void mark_started(const PrefetchTask& task);
+    bool is_late(const PrefetchTask& task);
+    void finish_in_flight(const PrefetchTask& task);
+
     S3Config config_;
     CacheManager& cache_;
     int num_workers_;
+    ChunkListener chunk_listener_;
+    Tracer* tracer_ = nullptr;
+    RangeFetcher range_fetcher_;
+    ObjectLister object_lister_;
+
+    // Ranges queued or downloading, keyed by (s3_key, offset, size): a
+    // record fetch and a chunk fetch at the same offset are different downloads
+    struct InFlight {
+        std::shared_future<bool> future;
+        std::optional<PredictionSource> source;
+        const std::promise<bool>* owner;  // Task that owns this entry
+        bool started;
+        bool late;  // A reader is waiting on this prefetch
+    };
+    std::map<std::tuple<std::string, size_t, size_t>, InFlight> in_flight_;
+    std::mutex in_flight_mutex_;
 
     ThreadSafeQueue<PrefetchTask> task_queue_;
     std::vector<std::thread> workers_;
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace valkyrie {
+
+// Monotonic counter for hot paths. Each thread increments its own
+// cache-line-sized slot, so concurrent readers and workers never bounce a
+// shared line; load() sums the slots (scrapes and unmount statistics only).
+// Threads beyond NUM_SHARDS share slots, which stays correct, just slower.
+class ShardedCounter {
+public:
+    static constexpr size_t NUM_SHARDS = 32;
+
+    void add(uint64_t n) {
+        slots_[shard_index()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    void operator++() { add(1); }
+    void operator++(int) { add(1); }
+    void operator+=(uint64_t n) { add(n); }
+
+    uint64_t load() const {
+        uint64_t total = 0;
+        for (const auto& slot : slots_) {
+            total += slot.value.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    operator uint64_t() const { return load(); }
+
+    // Slot of the calling thread (assigned round-robin on first use)
+    static size_t shard_index() {
+        static std::atomic<size_t> next_shard{0};
+        thread_local size_t index = next_shard.fetch_add(1) % NUM_SHARDS;
+        return index;
+    }
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> value{0};
+    };
+
+    std::array<Slot, NUM_SHARDS> slots_{};
+};
+
+}  // namespace valkyrie
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace valkyrie {
+
+// Name used in manifest "#@shuffle" directives for the algorithm below
+constexpr const char* SHUFFLE_PCG32_FISHER_YATES = "pcg32-fisher-yates";
+
+// PCG32 (XSH-RR 64/32), identical to pcg32_random_r / pcg32_srandom_r from
+// the reference pcg-c-basic implementation, so loaders in any language can
+// reproduce the same stream.
+class Pcg32 {
+public:
+    Pcg32(uint64_t init_state, uint64_t init_seq) {
+        state_ = 0;
+        inc_ = (init_seq << 1u) | 1u;
+        next();
+        state_ += init_state;
+        next();
+    }
+
+    uint32_t next() {
+        uint64_t old_state = state_;
+        state_ = old_state * 6364136223846793005ULL + inc_;
+        uint32_t xorshifted = static_cast<uint32_t>(((old_state >> 18u) ^ old_state) >> 27u);
+        uint32_t rot = static_cast<uint32_t>(old_state >> 59u);
+        return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+    }
+
+    // Uniform in [0, bound), unbiased (pcg32_boundedrand_r)
+    uint32_t bounded(uint32_t bound) {
+        uint32_t threshold = -bound % bound;
+        for (;;) {
+            uint32_t r = next();
+            if (r >= threshold) {
+                return r % bound;
+            }
+        }
+    }
+
+private:
+    uint64_t state_;
+    uint64_t inc_;
+};
+
+// Epoch order for a manifest of n entries: Fisher-Yates over [0, n) driven by
+// Pcg32(seed, epoch). For i = n-1 down to 1: j = bounded(i + 1); swap(order[i], order[j]).
+// order[p] is the manifest index read at position p of the epoch.
+inline std::vector<uint32_t> shuffled_order(size_t n, uint64_t seed, uint64_t epoch) {
+    std::vector<uint32_t> order(n);
+    std::iota(order.begin(), order.end(), 0u);
+
+    Pcg32 rng(seed, epoch);
+    for (size_t i = n; i > 1; --i) {
+        uint32_t j = rng.bounded(static_cast<uint32_t>(i));
+        std::swap(order[i - 1], order[j]);
+    }
+
+    return order;
+}
+
+}  // namespace valkyrie
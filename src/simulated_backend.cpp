@@ -0,0 +1,44 @@
+#include "simulated_backend.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+namespace valkyrie {
+
+SimulatedBackend::SimulatedBackend(const Options& options,
+                                   const std::unordered_map<std::string, size_t>& object_sizes)
+    : options_(options)
+    , object_sizes_(object_sizes)
+    , rng_(options.seed)
+    , latency_(std::log(std::max(options.latency_ms, 1e-3)), options.latency_sigma) {}
+
+bool SimulatedBackend::fetch(const std::string& s3_key, size_t offset, size_t size,
+                             std::vector<char>& data) {
+    auto it = object_sizes_.find(s3_key);
+    if (it == object_sizes_.end() || offset >= it->second) {
+        return false;  // NoSuchKey / invalid range
+    }
+    size_t length = std::min(size, it->second - offset);
+
+    double latency_ms;
+    {
+        std::lock_guard<std::mutex> lock(rng_mutex_);
+        latency_ms = options_.latency_sigma > 0 ? latency_(rng_) : options_.latency_ms;
+    }
+
+    // Concurrent transfers split the aggregate bandwidth
+    int active = ++active_;
+    double transfer_sec = length / (options_.bandwidth / std::max(active, 1));
+    double total_sec = (latency_ms / 1000.0 + transfer_sec) / options_.time_scale;
+    std::this_thread::sleep_for(std::chrono::duration<double>(total_sec));
+    --active_;
+
+    data.assign(length, 0);
+    requests_++;
+    bytes_fetched_ += length;
+    return true;
+}
+
+}  // namespace valkyrie
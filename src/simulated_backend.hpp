@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace valkyrie {
+
+// Object store stand-in: each request pays a log-normal first-byte latency,
+// then transfers at an aggregate bandwidth shared by concurrent requests.
+// Returns zero-filled data clipped to the object size. Used by valkyrie-sim
+// and by --mock-s3 mounts.
+class SimulatedBackend {
+public:
+    struct Options {
+        double latency_ms = 30.0;       // Median time to first byte
+        double latency_sigma = 0.5;     // Log-normal shape (0 = fixed latency)
+        double bandwidth = 1e9;         // Aggregate bytes/s
+        double time_scale = 1.0;        // >1 compresses simulated time
+        uint64_t seed = 1;
+    };
+
+    SimulatedBackend(const Options& options,
+                     const std::unordered_map<std::string, size_t>& object_sizes);
+
+    bool fetch(const std::string& s3_key, size_t offset, size_t size, std::vector<char>& data);
+
+    uint64_t requests() const { return requests_.load(); }
+    uint64_t bytes_fetched() const { return bytes_fetched_.load(); }
+
+private:
+    Options options_;
+    const std::unordered_map<std::string, size_t>& object_sizes_;
+
+    std::mt19937_64 rng_;
+    std::lognormal_distribution<double> latency_;
+    std::mutex rng_mutex_;
+
+    std::atomic<int> active_{0};
+    std::atomic<uint64_t> requests_{0};
+    std::atomic<uint64_t> bytes_fetched_{0};
+};
+
+}  // namespace valkyrie
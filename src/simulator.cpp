@@ -0,0 +1,185 @@
+#include "simulator.hpp"
+#include "cache_manager.hpp"
+#include "s3_worker_pool.hpp"
+#include "predictor.hpp"
+#include "tracer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+namespace valkyrie {
+
+bool ReplayTrace::load_binary(const std::string& path) {
+    std::vector<std::string> names;
+    std::vector<TraceEvent> events;
+    if (!Tracer::read_file(path, names, events)) {
+        return false;
+    }
+
+    // Rings are flushed per thread; restore global time order
+    std::stable_sort(events.begin(), events.end(),
+        [](const TraceEvent& a, const TraceEvent& b) { return a.timestamp_ns < b.timestamp_ns; });
+
+    ops.clear();
+    object_sizes.clear();
+
+    // READ events are stamped when the read returns, after latency_us
+    uint64_t previous_end_us = 0;
+    for (const auto& event : events) {
+        if (event.type != TraceEventType::OPEN && event.type != TraceEventType::READ) continue;
+        if (event.file_id >= names.size()) return false;
+
+        uint64_t end_us = event.timestamp_ns / 1000;
+        uint64_t start_us = end_us > event.latency_us ? end_us - event.latency_us : 0;
+
+        ReplayOp op;
+        op.think_us = start_us > previous_end_us && !ops.empty() ? start_us - previous_end_us : 0;
+        op.s3_key = names[event.file_id];
+        op.open = event.type == TraceEventType::OPEN;
+        op.offset = event.offset;
+        op.size = event.size;
+        ops.push_back(std::move(op));
+        previous_end_us = std::max(previous_end_us, end_us);
+
+        size_t& size = object_sizes[names[event.file_id]];
+        size = std::max<size_t>(size, event.offset + event.size);
+    }
+
+    return !ops.empty();
+}
+
+bool ReplayTrace::load_key_list(const std::string& path, size_t file_size, size_t read_size,
+                                double read_rate) {
+    std::ifstream file(path);
+    if (!file.is_open() || file_size == 0 || read_size == 0 || read_rate <= 0) {
+        return false;
+    }
+
+    ops.clear();
+    object_sizes.clear();
+
+    uint64_t think_us = static_cast<uint64_t>(read_size / read_rate * 1e6);
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+
+        ops.push_back({0, line, true, 0, 0});
+        for (size_t offset = 0; offset < file_size; offset += read_size) {
+            ops.push_back({think_us, line, false, offset, std::min(read_size, file_size - offset)});
+        }
+        object_sizes[line] = file_size;
+    }
+
+    return !ops.empty();
+}
+
+bool Simulator::run(const SimConfig& config, SimResult& result) const {
+    if (config.policy != "none" && config.policy != "fixed" && config.policy != "adaptive") {
+        std::cerr << "Simulator: Unknown policy: " << config.policy << "\n";
+        return false;
+    }
+    if (config.lookahead < 0 || config.lookahead > 100 || config.workers < 1 ||
+        config.backend.time_scale <= 0 || config.backend.bandwidth <= 0) {
+        std::cerr << "Simulator: Invalid configuration\n";
+        return false;
+    }
+
+    result = SimResult{};
+    double scale = config.backend.time_scale;
+
+    CacheManager cache(config.cache_size);
+    SimulatedBackend backend(config.backend, trace_.object_sizes);
+
+    S3Config s3_config;
+    s3_config.bucket = "simulated";
+    s3_config.region = "us-east-1";
+    S3WorkerPool pool(s3_config, cache, config.workers);
+    pool.set_range_fetcher(
+        [&backend](const std::string& s3_key, size_t offset, size_t size, std::vector<char>& data) {
+            return backend.fetch(s3_key, offset, size, data);
+        });
+
+    Predictor predictor(cache, pool, config.lookahead);
+    predictor.set_prefetch_budget(config.prefetch_budget);
+    predictor.set_size_lookup([this](const std::string& s3_key) -> std::optional<size_t> {
+        auto it = trace_.object_sizes.find(s3_key);
+        if (it == trace_.object_sizes.end()) return std::nullopt;
+        return it->second;
+    });
+    if (config.policy == "adaptive") {
+        predictor.enable_adaptive_lookahead();
+    }
+
+    pool.start();
+    if (config.policy != "none") {
+        predictor.start();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::string current_key;
+
+    for (const auto& op : trace_.ops) {
+        if (op.think_us > 0) {
+            std::this_thread::sleep_for(std::chrono::duration<double, std::micro>(op.think_us / scale));
+        }
+
+        if (op.open || op.s3_key != current_key) {
+            predictor.on_file_accessed(op.s3_key);
+            current_key = op.s3_key;
+        }
+        if (op.open) continue;
+
+        // The FUSE read path, chunk by chunk
+        auto size_it = trace_.object_sizes.find(op.s3_key);
+        uint64_t end = std::min<uint64_t>(op.offset + op.size, size_it->second);
+
+        for (uint64_t offset = op.offset; offset < end;) {
+            size_t chunk_offset = offset / DEFAULT_CHUNK_SIZE * DEFAULT_CHUNK_SIZE;
+            result.chunk_reads++;
+
+            if (cache.contains_chunk(op.s3_key, chunk_offset)) {
+                result.chunk_hits++;
+            } else {
+                auto wait_start = std::chrono::steady_clock::now();
+                bool ok = pool.submit(op.s3_key, chunk_offset, DEFAULT_CHUNK_SIZE,
+                                      Priority::URGENT).get();
+                result.stall_us += std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - wait_start).count();
+                if (!ok) break;
+            }
+            cache.access(op.s3_key, chunk_offset);
+
+            uint64_t n = std::min<uint64_t>(end, chunk_offset + DEFAULT_CHUNK_SIZE) - offset;
+            predictor.on_bytes_read(op.s3_key, n, offset + n);
+            result.bytes_read += n;
+            offset += n;
+        }
+    }
+
+    result.elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+
+    predictor.stop();
+    pool.shutdown();
+
+    // Back to trace time
+    result.stall_us = static_cast<uint64_t>(result.stall_us * scale);
+    result.elapsed_us = static_cast<uint64_t>(result.elapsed_us * scale);
+    result.bytes_fetched = backend.bytes_fetched();
+
+    // Evicted unread, plus still unread when the trace ended
+    const auto& outcomes = cache.get_prefetch_outcomes();
+    for (size_t i = 0; i < NUM_PREDICTION_SOURCES; ++i) {
+        result.wasted_prefetch_bytes +=
+            outcomes.source(static_cast<PredictionSource>(i)).wasted.bytes.load();
+    }
+    result.wasted_prefetch_bytes += cache.get_unread_prefetch_bytes();
+
+    return true;
+}
+
+}  // namespace valkyrie
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "types.hpp"
+#include "simulated_backend.hpp"
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+namespace valkyrie {
+
+// One reader operation of a replayed trace
+struct ReplayOp {
+    uint64_t think_us;      // Reader idle time since the previous op finished
+    std::string s3_key;
+    bool open;              // Open (no bytes) or read
+    uint64_t offset;
+    uint64_t size;
+};
+
+// Reader operations plus the object sizes they imply
+struct ReplayTrace {
+    std::vector<ReplayOp> ops;
+    std::unordered_map<std::string, size_t> object_sizes;
+
+    // Binary trace from --enable-tracing (OPEN and READ events)
+    bool load_binary(const std::string& path);
+
+    // Access history (one key per line, as --access-history writes): each file
+    // is read sequentially in read_size requests at read_rate bytes/s
+    bool load_key_list(const std::string& path, size_t file_size, size_t read_size,
+                       double read_rate);
+};
+
+// Cache/prefetch settings for one replay
+struct SimConfig {
+    size_t cache_size = DEFAULT_CACHE_SIZE;
+    std::string policy = "fixed";   // none | fixed | adaptive
+    int lookahead = DEFAULT_LOOKAHEAD;
+    int workers = DEFAULT_WORKER_COUNT;
+    double prefetch_budget = DEFAULT_PREFETCH_BUDGET;
+    SimulatedBackend::Options backend;
+};
+
+struct SimResult {
+    uint64_t chunk_reads = 0;       // Chunk lookups by the reader
+    uint64_t chunk_hits = 0;
+    uint64_t stall_us = 0;          // Reader time blocked on downloads
+    uint64_t elapsed_us = 0;        // Replay wall time (simulated scale)
+    uint64_t bytes_read = 0;        // Delivered to the reader
+    uint64_t bytes_fetched = 0;     // Requested from the backend
+    uint64_t wasted_prefetch_bytes = 0;  // Prefetched, evicted or left unread
+
+    double hit_rate() const {
+        return chunk_reads == 0 ? 0.0 : static_cast<double>(chunk_hits) / chunk_reads;
+    }
+    double stall_ratio() const {
+        return elapsed_us == 0 ? 0.0 : static_cast<double>(stall_us) / elapsed_us;
+    }
+};
+
+// Replays a trace through the real CacheManager, S3WorkerPool and Predictor,
+// with S3 replaced by a SimulatedBackend. The reader waits out the trace's
+// think time between ops; time spent blocked on misses is the stall time.
+class Simulator {
+public:
+    explicit Simulator(const ReplayTrace& trace) : trace_(trace) {}
+
+    // False if the config is invalid (unknown policy, bad lookahead)
+    bool run(const SimConfig& config, SimResult& result) const;
+
+private:
+    const ReplayTrace& trace_;
+};
+
+}  // namespace valkyrie
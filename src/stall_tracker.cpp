@@ -0,0 +1,125 @@
+#include "stall_tracker.hpp"
+#include <algorithm>
+#include <chrono>
+
+namespace valkyrie {
+
+namespace {
+
+// Account one read into `totals`, stamping its activity window
+void add_read(StallTotals& totals, uint64_t now, size_t bytes, uint64_t read_us,
+              uint64_t stall_us, bool miss) {
+    if (totals.reads == 0) {
+        totals.first_us = now - read_us;
+    }
+    totals.reads++;
+    totals.misses += miss ? 1 : 0;
+    totals.bytes += bytes;
+    totals.read_us += read_us;
+    totals.stall_us += stall_us;
+    totals.last_us = std::max(totals.last_us, now);
+}
+
+// Totals of `key`, now the most recently active entry. A new key takes the
+// place of the least recently active one when the table is full.
+template <typename Table, typename Key>
+StallTotals& touch(Table& table, const Key& key, size_t max_entries) {
+    auto it = table.entries.find(key);
+    if (it != table.entries.end()) {
+        table.recency.splice(table.recency.begin(), table.recency, it->second.recency);
+        return it->second.totals;
+    }
+
+    if (table.entries.size() >= max_entries) {
+        table.entries.erase(table.entries.find(*table.recency.back()));
+        table.recency.pop_back();
+    }
+    it = table.entries.emplace(key, typename Table::Entry{}).first;
+    table.recency.push_front(&it->first);
+    it->second.recency = table.recency.begin();
+    return it->second.totals;
+}
+
+template <typename Key>
+std::vector<std::pair<Key, StallTotals>> most_stalled(std::unordered_map<Key, StallTotals>& merged,
+                                                      size_t limit) {
+    std::vector<std::pair<Key, StallTotals>> sorted(merged.begin(), merged.end());
+    std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+        return a.second.stall_us != b.second.stall_us ? a.second.stall_us > b.second.stall_us
+                                                       : a.first < b.first;
+    });
+    if (sorted.size() > limit) {
+        sorted.resize(limit);
+    }
+    return sorted;
+}
+
+}  // namespace
+
+void StallTotals::merge(const StallTotals& other) {
+    if (other.reads == 0) return;
+    first_us = reads == 0 ? other.first_us : std::min(first_us, other.first_us);
+    last_us = std::max(last_us, other.last_us);
+    reads += other.reads;
+    misses += other.misses;
+    bytes += other.bytes;
+    read_us += other.read_us;
+    stall_us += other.stall_us;
+}
+
+uint64_t StallTracker::now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void StallTracker::record(pid_t pid, const std::string& s3_key, size_t bytes,
+                          uint64_t read_us, uint64_t stall_us, bool miss) {
+    reads_++;
+    misses_ += miss ? 1 : 0;
+    bytes_ += bytes;
+    read_us_ += read_us;
+    stall_us_ += stall_us;
+
+    uint64_t now = now_us();
+    Shard& shard = shards_[ShardedCounter::shard_index() % NUM_SHARDS];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    add_read(touch(shard.readers, pid, MAX_READERS_PER_SHARD), now, bytes, read_us, stall_us, miss);
+    add_read(touch(shard.files, s3_key, MAX_FILES_PER_SHARD), now, bytes, read_us, stall_us, miss);
+}
+
+StallTracker::Snapshot StallTracker::snapshot(size_t max_files) const {
+    std::unordered_map<pid_t, StallTotals> readers;
+    std::unordered_map<std::string, StallTotals> files;
+
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (const auto& [pid, entry] : shard.readers.entries) {
+            readers[pid].merge(entry.totals);
+        }
+        for (const auto& [key, entry] : shard.files.entries) {
+            files[key].merge(entry.totals);
+        }
+    }
+
+    Snapshot snapshot;
+    for (const auto& [pid, totals] : readers) {
+        snapshot.total.merge(totals);
+        snapshot.total_active_us += totals.active_us();
+        snapshot.tracked_stall_us += totals.stall_us;
+    }
+
+    // Counters from the global totals: forgotten readers still count
+    snapshot.total.reads = reads_.load();
+    snapshot.total.misses = misses_.load();
+    snapshot.total.bytes = bytes_.load();
+    // Stall first: record() adds read time first, so this order rarely sees
+    // stall ahead of read time (relaxed shards order nothing; see served_us())
+    snapshot.total.stall_us = stall_us_.load();
+    snapshot.total.read_us = read_us_.load();
+    snapshot.readers = most_stalled(readers, SIZE_MAX);
+    snapshot.files = most_stalled(files, max_files);
+    return snapshot;
+}
+
+}  // namespace valkyrie
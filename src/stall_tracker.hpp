@@ -0,0 +1,117 @@
+#pragma once
+
+#include <sys/types.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "sharded_counter.hpp"
+
+namespace valkyrie {
+
+// Where one reader's (or one file's) read time went
+struct StallTotals {
+    uint64_t reads = 0;
+    uint64_t misses = 0;       // Reads that blocked on S3
+    uint64_t bytes = 0;
+    uint64_t read_us = 0;      // Wall time spent inside read()
+    uint64_t stall_us = 0;     // Of which blocked waiting on S3
+    uint64_t first_us = 0;     // Steady clock: start of the first read
+    uint64_t last_us = 0;      // Steady clock: end of the latest read
+
+    // Clamped: the global sums are loaded separately, so a concurrent record()
+    // can briefly show more stall than read time
+    uint64_t served_us() const { return read_us > stall_us ? read_us - stall_us : 0; }
+    uint64_t active_us() const { return last_us - first_us; }
+
+    // Fraction of the reader's active wall time spent blocked on S3. For a
+    // training process this is the data-stall ratio: 0 means I/O never held
+    // it up, 1 means it did nothing but wait. Reads from several threads of
+    // one process overlap, so the sum is capped at 1.
+    double stall_ratio() const {
+        return active_us() == 0 ? 0.0
+            : std::min(1.0, static_cast<double>(stall_us) / active_us());
+    }
+
+    // Bytes read per second of active time
+    double throughput_bytes_per_sec() const {
+        return active_us() == 0 ? 0.0 : bytes * 1e6 / active_us();
+    }
+
+    void merge(const StallTotals& other);
+};
+
+// Accounts the wall time each FUSE read spends blocked on S3 versus served
+// from the cache, per reader PID and per file. Entries live in per-thread
+// shards, so concurrent FUSE threads rarely share a lock. Each shard holds a
+// bounded number of readers and files, so the least recently active entry
+// is forgotten when a new one arrives. Totals since mount are counted apart
+// from those tables, so they never go down.
+class StallTracker {
+public:
+    static constexpr size_t NUM_SHARDS = 16;
+    static constexpr size_t MAX_READERS_PER_SHARD = 16;
+    static constexpr size_t MAX_FILES_PER_SHARD = 256;
+    static constexpr size_t TOP_FILES = 20;  // Exported by /metrics and stats.json
+
+    // One finished read of `bytes`: `read_us` inside read(), `stall_us` of it
+    // waiting on S3 (`miss` if it had to wait at all)
+    void record(pid_t pid, const std::string& s3_key, size_t bytes,
+                uint64_t read_us, uint64_t stall_us, bool miss);
+
+    struct Snapshot {
+        StallTotals total;              // Since mount (counters are monotonic)
+        uint64_t total_active_us = 0;   // Summed over tracked readers
+        uint64_t tracked_stall_us = 0;  // Summed over tracked readers
+        std::vector<std::pair<pid_t, StallTotals>> readers;       // Most stalled first
+        std::vector<std::pair<std::string, StallTotals>> files;   // Most stalled first
+
+        // Stall time over summed reader active time (readers overlap, so the
+        // merged total's own span would overstate it)
+        double stall_ratio() const {
+            return total_active_us == 0 ? 0.0
+                : std::min(1.0, static_cast<double>(tracked_stall_us) / total_active_us);
+        }
+    };
+
+    // Merge the shards; `max_files` keeps only the most stalled files
+    Snapshot snapshot(size_t max_files = SIZE_MAX) const;
+
+    static uint64_t now_us();
+
+private:
+    // Bounded map whose least recently active entry is found in O(1)
+    template <typename Key>
+    struct Table {
+        struct Entry {
+            StallTotals totals;
+            typename std::list<const Key*>::iterator recency;
+        };
+        std::unordered_map<Key, Entry> entries;
+        std::list<const Key*> recency;  // Keys in `entries`, most recently active first
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        Table<pid_t> readers;
+        Table<std::string> files;
+    };
+
+    std::array<Shard, NUM_SHARDS> shards_;
+
+    ShardedCounter reads_;
+    ShardedCounter misses_;
+    ShardedCounter bytes_;
+    ShardedCounter read_us_;
+    ShardedCounter stall_us_;
+};
+
+}  // namespace valkyrie
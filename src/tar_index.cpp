@@ -0,0 +1,417 @@
+#include "tar_index.hpp"
+#include <algorithm>
+#include <sstream>
+
+namespace valkyrie {
+
+namespace {
+
+// ustar header field offsets
+constexpr size_t NAME_OFFSET = 0, NAME_LENGTH = 100;
+constexpr size_t SIZE_OFFSET = 124, SIZE_LENGTH = 12;
+constexpr size_t CHECKSUM_OFFSET = 148, CHECKSUM_LENGTH = 8;
+constexpr size_t TYPEFLAG_OFFSET = 156;
+constexpr size_t MAGIC_OFFSET = 257;
+constexpr size_t PREFIX_OFFSET = 345, PREFIX_LENGTH = 155;
+
+uint64_t round_up_block(uint64_t size) {
+    return (size + TarIndex::BLOCK_SIZE - 1) / TarIndex::BLOCK_SIZE * TarIndex::BLOCK_SIZE;
+}
+
+// NUL-terminated (or full-width) string field
+std::string field_string(const char* block, size_t offset, size_t length) {
+    const char* start = block + offset;
+    return std::string(start, std::find(start, start + length, '\0'));
+}
+
+// Octal numeric field; GNU base-256 when the high bit of the first byte is set
+std::optional<uint64_t> field_number(const char* block, size_t offset, size_t length) {
+    const unsigned char* field = reinterpret_cast<const unsigned char*>(block + offset);
+
+    if (field[0] & 0x80) {
+        uint64_t value = field[0] & 0x7f;
+        for (size_t i = 1; i < length; ++i) {
+            if (value >> 56) return std::nullopt;  // Overflow
+            value = (value << 8) | field[i];
+        }
+        return value;
+    }
+
+    uint64_t value = 0;
+    size_t i = 0;
+    while (i < length && field[i] == ' ') ++i;
+    for (; i < length && field[i] >= '0' && field[i] <= '7'; ++i) {
+        value = value * 8 + (field[i] - '0');
+    }
+    return value;
+}
+
+bool checksum_valid(const char* block) {
+    auto expected = field_number(block, CHECKSUM_OFFSET, CHECKSUM_LENGTH);
+    if (!expected.has_value()) return false;
+
+    // The checksum field itself counts as spaces; old tars summed signed bytes
+    uint64_t unsigned_sum = 0;
+    int64_t signed_sum = 0;
+    for (size_t i = 0; i < TarIndex::BLOCK_SIZE; ++i) {
+        bool in_field = i >= CHECKSUM_OFFSET && i < CHECKSUM_OFFSET + CHECKSUM_LENGTH;
+        unsigned char c = in_field ? ' ' : static_cast<unsigned char>(block[i]);
+        unsigned_sum += c;
+        signed_sum += static_cast<signed char>(c);
+    }
+
+    return *expected == unsigned_sum || static_cast<int64_t>(*expected) == signed_sum;
+}
+
+}  // namespace
+
+bool TarIndex::feed(uint64_t offset, const char* data, size_t size, bool at_eof) {
+    uint64_t end = offset + size;
+    bool progress = false;
+
+    while (state_ == State::PARSING && cursor_ >= offset && cursor_ < end) {
+        // Gather the current step's bytes; a header or extended payload may span chunks
+        uint64_t take = std::min<uint64_t>(need_ - buffer_.size(), end - cursor_);
+        buffer_.append(data + (cursor_ - offset), take);
+        cursor_ += take;
+        progress = true;
+
+        if (buffer_.size() < need_) break;  // Rest is in the next chunk
+
+        std::string bytes;
+        bytes.swap(buffer_);
+
+        switch (step_) {
+            case Step::HEADER:
+                if (!parse_header(bytes.data())) {
+                    state_ = State::INVALID;
+                }
+                break;
+
+            case Step::LONG_NAME:
+                next_name_ = bytes.substr(0, bytes.find('\0'));
+                skip_payload(0);
+                cursor_ += round_up_block(payload_size_) - payload_size_;
+                break;
+
+            case Step::PAX:
+                parse_pax(bytes);
+                skip_payload(0);
+                cursor_ += round_up_block(payload_size_) - payload_size_;
+                break;
+        }
+    }
+
+    // Object ended without an end-of-archive marker (or truncated mid-member)
+    if (state_ == State::PARSING && at_eof && cursor_ >= end) {
+        state_ = State::COMPLETE;
+    }
+
+    return progress;
+}
+
+bool TarIndex::parse_header(const char* block) {
+    // Two zero blocks end the archive; the first one is enough to stop
+    if (std::all_of(block, block + BLOCK_SIZE, [](char c) { return c == '\0'; })) {
+        state_ = State::COMPLETE;
+        return true;
+    }
+
+    if (!checksum_valid(block)) {
+        return false;
+    }
+
+    auto size = field_number(block, SIZE_OFFSET, SIZE_LENGTH);
+    if (!size.has_value()) {
+        return false;
+    }
+
+    char type = block[TYPEFLAG_OFFSET];
+
+    if (type == 'L' || type == 'x') {
+        if (*size > MAX_EXTENDED_HEADER) {
+            return false;
+        }
+        if (*size == 0) {
+            skip_payload(0);
+            return true;
+        }
+
+        step_ = (type == 'L') ? Step::LONG_NAME : Step::PAX;
+        need_ = *size;
+        payload_size_ = *size;
+        return true;
+    }
+
+    if (type == '0' || type == '\0' || type == '7') {
+        TarMember member;
+        if (next_name_.has_value()) {
+            member.name = std::move(*next_name_);
+        } else {
+            member.name = field_string(block, NAME_OFFSET, NAME_LENGTH);
+
+            // ustar splits long paths into prefix + name
+            if (std::string(block + MAGIC_OFFSET, 5) == "ustar") {
+                std::string prefix = field_string(block, PREFIX_OFFSET, PREFIX_LENGTH);
+                if (!prefix.empty()) {
+                    member.name = prefix + "/" + member.name;
+                }
+            }
+        }
+        member.offset = cursor_;
+        member.size = next_size_.value_or(*size);
+
+        next_name_.reset();
+        next_size_.reset();
+
+        skip_payload(member.size);
+        members_.push_back(std::move(member));
+        return true;
+    }
+
+    // Directories, links, global pax headers, ...: skip their payload
+    next_name_.reset();
+    next_size_.reset();
+    skip_payload(*size);
+    return true;
+}
+
+void TarIndex::parse_pax(const std::string& records) {
+    // Records are "<length> <key>=<value>\n", length counting the whole record
+    size_t pos = 0;
+    while (pos < records.size()) {
+        size_t space = records.find(' ', pos);
+        if (space == std::string::npos) return;
+
+        size_t length;
+        try {
+            length = std::stoul(records.substr(pos, space - pos));
+        } catch (const std::exception&) {
+            return;
+        }
+        if (length == 0 || pos + length > records.size()) return;
+
+        std::string record = records.substr(space + 1, pos + length - space - 2);
+        size_t eq = record.find('=');
+        if (eq != std::string::npos) {
+            std::string key = record.substr(0, eq);
+            std::string value = record.substr(eq + 1);
+
+            if (key == "path") {
+                next_name_ = value;
+            } else if (key == "size") {
+                try {
+                    next_size_ = std::stoull(value);
+                } catch (const std::exception&) {
+                    // Keep the header's size field
+                }
+            }
+        }
+
+        pos += length;
+    }
+}
+
+void TarIndex::skip_payload(uint64_t size) {
+    cursor_ += round_up_block(size);
+    step_ = Step::HEADER;
+    need_ = BLOCK_SIZE;
+}
+
+std::optional<size_t> TarIndex::member_at(uint64_t offset) const {
+    auto it = std::partition_point(members_.begin(), members_.end(),
+        [offset](const TarMember& m) { return m.offset + m.size <= offset; });
+    if (it == members_.end()) {
+        return std::nullopt;
+    }
+    return static_cast<size_t>(it - members_.begin());
+}
+
+std::string TarIndex::render() const {
+    std::ostringstream oss;
+    for (const auto& member : members_) {
+        oss << member.offset << " " << member.size << " " << member.name << "\n";
+    }
+    return oss.str();
+}
+
+size_t TarIndex::rendered_size() const {
+    if (state_ != State::COMPLETE) return render().size();
+    if (!rendered_size_.has_value()) rendered_size_ = render().size();
+    return *rendered_size_;
+}
+
+TarIndexer::TarIndexer(CacheManager& cache)
+    : cache_(cache) {
+}
+
+bool TarIndexer::is_tar_key(std::string_view s3_key) {
+    static constexpr std::string_view suffix = ".tar";
+    return s3_key.size() > suffix.size() &&
+           s3_key.compare(s3_key.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+bool TarIndexer::is_index_key(std::string_view key) {
+    static constexpr std::string_view suffix = ".tar.idx";
+    return key.size() > suffix.size() &&
+           key.compare(key.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+std::string TarIndexer::archive_for_index(const std::string& index_key) {
+    return index_key.substr(0, index_key.size() - 4);  // Strip ".idx"
+}
+
+void TarIndexer::on_chunk(const std::string& s3_key, size_t offset,
+                          const std::vector<char>& data) {
+    if (!is_tar_key(s3_key)) return;
+
+    std::optional<size_t> next;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        next = feed_locked(s3_key, offset, data);
+    }
+
+    // Catch up on chunks that landed before the parser needed them
+    while (next.has_value()) {
+        auto chunk = cache_.get_chunk(s3_key, *next);
+        if (!chunk.has_value()) break;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto after = feed_locked(s3_key, *next, chunk->data);
+        if (after == next) break;  // No progress
+        next = after;
+    }
+
+    if (!next.has_value()) {
+        indexed_.notify_all();  // Complete or invalid: wake opens waiting on it
+    }
+}
+
+TarIndex& TarIndexer::index_locked(const std::string& s3_key) {
+    auto& index = indexes_[s3_key];
+    if (!index) {
+        index = std::make_unique<TarIndex>();
+        order_.push_back(s3_key);
+
+        // Forget the oldest archives; they are rebuilt from cache or S3 on demand
+        while (order_.size() > MAX_ARCHIVES) {
+            indexes_.erase(order_.front());
+            requested_.erase(order_.front());
+            order_.pop_front();
+        }
+    }
+    return *index;
+}
+
+std::optional<size_t> TarIndexer::feed_locked(const std::string& s3_key, size_t offset,
+                                              const std::vector<char>& data) {
+    TarIndex& index = index_locked(s3_key);
+    if (index.state() != TarIndex::State::PARSING) {
+        return std::nullopt;
+    }
+
+    size_t before = index.members().size();
+    bool at_eof = data.size() < DEFAULT_CHUNK_SIZE;
+    index.feed(offset, data.data(), data.size(), at_eof);
+    stats_.members_indexed += index.members().size() - before;
+
+    switch (index.state()) {
+        case TarIndex::State::PARSING:
+            return index.next_offset() / DEFAULT_CHUNK_SIZE * DEFAULT_CHUNK_SIZE;
+        case TarIndex::State::COMPLETE:
+            stats_.archives_indexed++;
+            return std::nullopt;
+        case TarIndex::State::INVALID:
+            stats_.invalid_archives++;
+            return std::nullopt;
+    }
+    return std::nullopt;
+}
+
+std::optional<size_t> TarIndexer::next_chunk(const std::string& s3_key) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = indexes_.find(s3_key);
+    if (it == indexes_.end()) {
+        return is_tar_key(s3_key) ? std::optional<size_t>(0) : std::nullopt;
+    }
+
+    if (it->second->state() != TarIndex::State::PARSING) {
+        return std::nullopt;
+    }
+    return it->second->next_offset() / DEFAULT_CHUNK_SIZE * DEFAULT_CHUNK_SIZE;
+}
+
+void TarIndexer::request(const std::string& s3_key) {
+    if (!is_tar_key(s3_key)) return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (index_locked(s3_key).state() == TarIndex::State::PARSING) {
+        requested_.insert(s3_key);
+    }
+}
+
+bool TarIndexer::requested(const std::string& s3_key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = requested_.find(s3_key);
+    if (it == requested_.end()) return false;
+
+    auto index = indexes_.find(s3_key);
+    if (index == indexes_.end() || index->second->state() != TarIndex::State::PARSING) {
+        requested_.erase(it);
+        return false;
+    }
+    return true;
+}
+
+std::optional<std::string> TarIndexer::render(const std::string& s3_key) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = indexes_.find(s3_key);
+    if (it == indexes_.end() || it->second->state() != TarIndex::State::COMPLETE) {
+        return std::nullopt;
+    }
+    return it->second->render();
+}
+
+std::optional<size_t> TarIndexer::rendered_size(const std::string& s3_key) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = indexes_.find(s3_key);
+    if (it == indexes_.end() || it->second->state() != TarIndex::State::COMPLETE) {
+        return std::nullopt;
+    }
+    return it->second->rendered_size();
+}
+
+bool TarIndexer::wait_indexed(const std::string& s3_key, std::chrono::milliseconds timeout) const {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    auto state = [this, &s3_key] {
+        auto it = indexes_.find(s3_key);
+        return it == indexes_.end() ? TarIndex::State::PARSING : it->second->state();
+    };
+    indexed_.wait_for(lock, timeout, [&state] { return state() != TarIndex::State::PARSING; });
+    return state() == TarIndex::State::COMPLETE;
+}
+
+std::vector<TarMember> TarIndexer::members_in_range(const std::string& s3_key,
+                                                    uint64_t offset, uint64_t length) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::vector<TarMember> result;
+    auto it = indexes_.find(s3_key);
+    if (it == indexes_.end()) return result;
+
+    const auto& members = it->second->members();
+    auto first = it->second->member_at(offset);
+    if (!first.has_value()) return result;
+
+    for (size_t i = *first; i < members.size() && members[i].offset < offset + length; ++i) {
+        result.push_back(members[i]);
+    }
+    return result;
+}
+
+}  // namespace valkyrie
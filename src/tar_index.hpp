@@ -0,0 +1,155 @@
+#pragma once
+
+#include "cache_manager.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+
+namespace valkyrie {
+
+// One regular file inside a tar archive
+struct TarMember {
+    std::string name;
+    uint64_t offset;  // Start of the member's data in the archive
+    uint64_t size;
+};
+
+// Incremental tar (ustar/GNU/pax) header parser. Chunks of the archive are
+// fed in any order; only the chunk holding the next header makes progress,
+// so an archive is indexed as the reader (or prefetcher) pulls it in.
+// Not thread-safe; TarIndexer serializes access.
+class TarIndex {
+public:
+    enum class State {
+        PARSING,   // Waiting for the chunk at next_offset()
+        COMPLETE,  // End-of-archive reached
+        INVALID    // Not a tar archive (bad header checksum)
+    };
+
+    // Parse what this chunk holds of the archive. at_eof marks the object's
+    // last chunk. Returns true if any header was consumed.
+    bool feed(uint64_t offset, const char* data, size_t size, bool at_eof);
+
+    State state() const { return state_; }
+
+    // Archive offset the parser needs next
+    uint64_t next_offset() const { return cursor_; }
+
+    const std::vector<TarMember>& members() const { return members_; }
+
+    // Index of the first member whose data ends after `offset`
+    std::optional<size_t> member_at(uint64_t offset) const;
+
+    // Sidecar text: one "offset size name" line per member
+    std::string render() const;
+
+    // Length of render(), computed once the index is complete
+    size_t rendered_size() const;
+
+    static constexpr size_t BLOCK_SIZE = 512;
+
+private:
+    enum class Step {
+        HEADER,      // 512-byte header block
+        LONG_NAME,   // GNU 'L' payload: name of the next member
+        PAX          // Pax 'x' payload: path/size overrides for the next member
+    };
+
+    bool parse_header(const char* block);
+    void parse_pax(const std::string& records);
+    void skip_payload(uint64_t size);
+
+    State state_ = State::PARSING;
+    Step step_ = Step::HEADER;
+    uint64_t cursor_ = 0;       // Next archive byte to consume
+    uint64_t need_ = BLOCK_SIZE;
+    uint64_t payload_size_ = 0;  // Of the current LONG_NAME/PAX step
+    std::string buffer_;        // Partial header/payload spanning chunks
+
+    // Overrides from extended headers, applied to the next member
+    std::optional<std::string> next_name_;
+    std::optional<uint64_t> next_size_;
+
+    std::vector<TarMember> members_;
+    mutable std::optional<size_t> rendered_size_;
+
+    // Extended header payloads larger than this are treated as corrupt
+    static constexpr uint64_t MAX_EXTENDED_HEADER = 1 << 20;
+};
+
+// Member indexes for every ".tar" object, built from chunks as they land in
+// the cache. Thread-safe: on_chunk() runs on S3 workers, queries on FUSE and
+// predictor threads.
+class TarIndexer {
+public:
+    explicit TarIndexer(CacheManager& cache);
+
+    static bool is_tar_key(std::string_view s3_key);
+
+    // Sidecar path for an archive ("shard.tar" -> "shard.tar.idx") and back
+    static bool is_index_key(std::string_view key);
+    static std::string archive_for_index(const std::string& index_key);
+
+    // Feed a chunk that was just downloaded (ignored for non-tar keys). Also
+    // catches up on later chunks that landed in the cache out of order.
+    void on_chunk(const std::string& s3_key, size_t offset, const std::vector<char>& data);
+
+    // Chunk offset the parser needs next; nullopt when complete or invalid
+    std::optional<size_t> next_chunk(const std::string& s3_key) const;
+
+    // Mark an archive to be indexed to the end (its sidecar was opened).
+    // requested() is true until it is complete or invalid.
+    void request(const std::string& s3_key);
+    bool requested(const std::string& s3_key);
+
+    // Rendered sidecar, once the archive is fully indexed
+    std::optional<std::string> render(const std::string& s3_key) const;
+    std::optional<size_t> rendered_size(const std::string& s3_key) const;
+
+    // Wait up to `timeout` for the archive's index to complete (or turn out
+    // invalid); true if it is complete
+    bool wait_indexed(const std::string& s3_key, std::chrono::milliseconds timeout) const;
+
+    // Indexed members overlapping [offset, offset + length), in archive order
+    std::vector<TarMember> members_in_range(const std::string& s3_key,
+                                            uint64_t offset, uint64_t length) const;
+
+    struct Stats {
+        std::atomic<uint64_t> archives_indexed{0};
+        std::atomic<uint64_t> members_indexed{0};
+        std::atomic<uint64_t> invalid_archives{0};
+    };
+    const Stats& get_stats() const { return stats_; }
+
+private:
+    // Index of an archive under mutex_, created (and the oldest forgotten) if new
+    TarIndex& index_locked(const std::string& s3_key);
+
+    // Feed under mutex_; returns the chunk the parser needs next, if any
+    std::optional<size_t> feed_locked(const std::string& s3_key, size_t offset,
+                                      const std::vector<char>& data);
+
+    CacheManager& cache_;
+
+    std::unordered_map<std::string, std::unique_ptr<TarIndex>> indexes_;
+    std::deque<std::string> order_;  // Creation order, for bounding memory
+    std::unordered_set<std::string> requested_;  // Subset of indexes_ keys
+    mutable std::mutex mutex_;
+    mutable std::condition_variable indexed_;  // An archive left PARSING
+
+    static constexpr size_t MAX_ARCHIVES = 4096;
+
+    Stats stats_;
+};
+
+}  // namespace valkyrie
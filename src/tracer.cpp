@@ -0,0 +1,367 @@
+#include "tracer.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <ostream>
+
+namespace valkyrie {
+
+namespace {
+
+constexpr char MAGIC[8] = {'V', 'K', 'T', 'R', 'A', 'C', 'E', '1'};
+constexpr char BLOCK_NAMES = 'N';
+constexpr char BLOCK_EVENTS = 'E';
+
+std::atomic<uint64_t> next_instance_id{1};
+
+template <typename T>
+void write_pod(std::ostream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+bool read_pod(std::istream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+void write_json_string(std::ostream& out, const std::string& value) {
+    out << '"';
+    for (char c : value) {
+        switch (c) {
+            case '"': out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\t': out << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out << buf;
+                } else {
+                    out << c;
+                }
+        }
+    }
+    out << '"';
+}
+
+}  // namespace
+
+const char* to_string(TraceEventType type) {
+    switch (type) {
+        case TraceEventType::OPEN: return "open";
+        case TraceEventType::READ: return "read";
+        case TraceEventType::MISS: return "miss";
+        case TraceEventType::DOWNLOAD: return "download";
+        case TraceEventType::EVICT: return "evict";
+    }
+    return "unknown";
+}
+
+// Single-producer (owning thread) / single-consumer (flusher) ring
+struct Tracer::ThreadRing {
+    std::vector<TraceEvent> events;
+    size_t mask;
+    uint16_t thread;
+
+    alignas(64) std::atomic<uint64_t> head{0};   // Written by the producer
+    alignas(64) std::atomic<uint64_t> tail{0};   // Written by the flusher
+
+    // Producer-only cache of the last key's id (readers stay in one file)
+    std::string last_key;
+    uint32_t last_id = 0;
+
+    // Set when the owning thread exits (or moves to another tracer); the
+    // flusher drains the ring once more and frees it
+    std::atomic<bool> retired{false};
+
+    ThreadRing(size_t capacity, uint16_t index)
+        : events(capacity), mask(capacity - 1), thread(index) {}
+};
+
+Tracer::Tracer(const std::string& output_path, size_t ring_capacity)
+    : output_path_(output_path)
+    , ring_capacity_(1)
+    , instance_id_(next_instance_id.fetch_add(1))
+    , start_time_(std::chrono::steady_clock::now()) {
+    // Power of two so positions wrap with a mask
+    while (ring_capacity_ < ring_capacity) {
+        ring_capacity_ <<= 1;
+    }
+}
+
+Tracer::~Tracer() {
+    stop();
+}
+
+bool Tracer::start() {
+    out_.open(output_path_, std::ios::binary | std::ios::trunc);
+    if (!out_.is_open()) {
+        std::cerr << "Tracer: Cannot write trace: " << output_path_ << "\n";
+        return false;
+    }
+
+    out_.write(MAGIC, sizeof(MAGIC));
+    write_pod(out_, FORMAT_VERSION);
+    write_pod(out_, static_cast<uint32_t>(sizeof(TraceEvent)));
+
+    started_ = true;
+    flusher_thread_ = std::thread(&Tracer::flusher_loop, this);
+    std::cout << "Tracer: Writing trace to " << output_path_ << "\n";
+    return true;
+}
+
+void Tracer::stop() {
+    if (!started_ || stop_flag_.exchange(true)) {
+        return;
+    }
+
+    if (flusher_thread_.joinable()) {
+        flusher_thread_.join();
+    }
+
+    flush();
+    out_.close();
+
+    std::cout << "Tracer: " << stats_.events_written.load() << " events written, "
+              << stats_.events_dropped.load() << " dropped\n";
+}
+
+void Tracer::record(TraceEventType type, const std::string& s3_key, uint64_t offset,
+                    uint64_t size, uint64_t latency_us, std::optional<Priority> priority,
+                    bool hit) {
+    ThreadRing* ring = ring_for_this_thread();
+
+    uint64_t head = ring->head.load(std::memory_order_relaxed);
+    if (head - ring->tail.load(std::memory_order_acquire) > ring->mask) {
+        stats_.events_dropped++;
+        return;
+    }
+
+    TraceEvent& event = ring->events[head & ring->mask];
+    event.timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start_time_).count();
+    event.offset = offset;
+    event.file_id = file_id(*ring, s3_key);
+    event.size = static_cast<uint32_t>(std::min<uint64_t>(size, UINT32_MAX));
+    event.latency_us = static_cast<uint32_t>(std::min<uint64_t>(latency_us, UINT32_MAX));
+    event.thread = ring->thread;
+    event.type = type;
+    event.flags = (hit ? TraceEvent::FLAG_HIT : 0) |
+                  (priority.has_value() ? static_cast<uint8_t>(*priority) + 1 : 0);
+
+    ring->head.store(head + 1, std::memory_order_release);
+    stats_.events_recorded++;
+}
+
+Tracer::ThreadRing* Tracer::ring_for_this_thread() {
+    // Keyed by instance id so a new tracer at a reused address gets new rings.
+    // Shared with rings_, so retiring at thread exit is safe after the tracer is gone.
+    struct Owner {
+        uint64_t instance = 0;
+        std::shared_ptr<ThreadRing> ring;
+        ~Owner() {
+            if (ring) ring->retired.store(true, std::memory_order_release);
+        }
+    };
+    thread_local Owner owner;
+
+    if (owner.instance == instance_id_) {
+        return owner.ring.get();
+    }
+
+    if (owner.ring) {
+        owner.ring->retired.store(true, std::memory_order_release);
+    }
+
+    std::lock_guard<std::mutex> lock(rings_mutex_);
+    auto ring = std::make_shared<ThreadRing>(ring_capacity_, next_thread_++);
+    rings_.push_back(ring);
+    owner.instance = instance_id_;
+    owner.ring = std::move(ring);
+    return owner.ring.get();
+}
+
+size_t Tracer::get_num_rings() const {
+    std::lock_guard<std::mutex> lock(rings_mutex_);
+    return rings_.size();
+}
+
+uint32_t Tracer::file_id(ThreadRing& ring, const std::string& s3_key) {
+    if (!ring.last_key.empty() && ring.last_key == s3_key) {
+        return ring.last_id;
+    }
+
+    uint32_t id;
+    {
+        std::shared_lock<std::shared_mutex> lock(names_mutex_);
+        auto it = file_ids_.find(s3_key);
+        if (it != file_ids_.end()) {
+            id = it->second;
+        } else {
+            lock.unlock();
+            std::unique_lock<std::shared_mutex> write_lock(names_mutex_);
+            auto [inserted, added] = file_ids_.emplace(
+                s3_key, static_cast<uint32_t>(file_names_.size()));
+            if (added) {
+                file_names_.push_back(s3_key);
+            }
+            id = inserted->second;
+        }
+    }
+
+    ring.last_key = s3_key;
+    ring.last_id = id;
+    return id;
+}
+
+void Tracer::flusher_loop() {
+    while (!stop_flag_) {
+        std::this_thread::sleep_for(FLUSH_INTERVAL);
+        flush();
+    }
+}
+
+void Tracer::flush() {
+    std::lock_guard<std::mutex> flush_lock(flush_mutex_);
+
+    // Drain rings first: every drained event's name was registered before it
+    // was published, so the name snapshot taken afterwards covers it
+    std::vector<TraceEvent> batch;
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        for (auto it = rings_.begin(); it != rings_.end();) {
+            ThreadRing& ring = **it;
+            // Read before head: a retired ring has published all its events
+            bool retired = ring.retired.load(std::memory_order_acquire);
+            uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+            uint64_t head = ring.head.load(std::memory_order_acquire);
+            for (; tail < head; ++tail) {
+                batch.push_back(ring.events[tail & ring.mask]);
+            }
+            ring.tail.store(tail, std::memory_order_release);
+
+            it = retired ? rings_.erase(it) : std::next(it);
+        }
+    }
+
+    std::vector<std::string> new_names;
+    {
+        std::shared_lock<std::shared_mutex> lock(names_mutex_);
+        new_names.assign(file_names_.begin() + names_written_, file_names_.end());
+    }
+
+    if (!new_names.empty()) {
+        out_.put(BLOCK_NAMES);
+        write_pod(out_, static_cast<uint32_t>(new_names.size()));
+        for (const auto& name : new_names) {
+            write_pod(out_, static_cast<uint32_t>(names_written_++));
+            uint16_t length = static_cast<uint16_t>(std::min<size_t>(name.size(), UINT16_MAX));
+            write_pod(out_, length);
+            out_.write(name.data(), length);
+        }
+    }
+
+    if (!batch.empty()) {
+        out_.put(BLOCK_EVENTS);
+        write_pod(out_, static_cast<uint32_t>(batch.size()));
+        out_.write(reinterpret_cast<const char*>(batch.data()),
+                   batch.size() * sizeof(TraceEvent));
+        stats_.events_written += batch.size();
+    }
+
+    out_.flush();
+}
+
+bool Tracer::read_file(const std::string& path, std::vector<std::string>& file_names,
+                       std::vector<TraceEvent>& events) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        return false;
+    }
+
+    char magic[sizeof(MAGIC)];
+    uint32_t version, event_size;
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        !read_pod(in, version) || version != FORMAT_VERSION ||
+        !read_pod(in, event_size) || event_size != sizeof(TraceEvent)) {
+        return false;
+    }
+
+    file_names.clear();
+    events.clear();
+
+    char block;
+    while (in.get(block)) {
+        uint32_t count;
+        if (!read_pod(in, count)) return false;
+
+        if (block == BLOCK_NAMES) {
+            for (uint32_t i = 0; i < count; ++i) {
+                uint32_t id;
+                uint16_t length;
+                if (!read_pod(in, id) || !read_pod(in, length) || id != file_names.size()) {
+                    return false;
+                }
+                std::string name(length, '\0');
+                if (!in.read(name.data(), length)) return false;
+                file_names.push_back(std::move(name));
+            }
+        } else if (block == BLOCK_EVENTS) {
+            size_t first = events.size();
+            events.resize(first + count);
+            if (!in.read(reinterpret_cast<char*>(events.data() + first),
+                         static_cast<std::streamsize>(count) * sizeof(TraceEvent))) {
+                return false;
+            }
+        } else {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool Tracer::write_chrome_json(const std::string& trace_path, std::ostream& out) {
+    std::vector<std::string> names;
+    std::vector<TraceEvent> events;
+    if (!read_file(trace_path, names, events)) {
+        return false;
+    }
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+    bool first = true;
+    for (const auto& event : events) {
+        // Events with a latency end at their timestamp; show them as slices
+        uint64_t end_us = event.timestamp_ns / 1000;
+        bool slice = event.latency_us > 0;
+        uint64_t ts = slice && end_us >= event.latency_us ? end_us - event.latency_us : end_us;
+
+        out << (first ? "" : ",\n") << "{\"name\":\"" << to_string(event.type)
+            << "\",\"cat\":\"valkyrie\",\"ph\":\"" << (slice ? "X" : "i") << "\"";
+        if (slice) {
+            out << ",\"dur\":" << event.latency_us;
+        } else {
+            out << ",\"s\":\"t\"";
+        }
+        out << ",\"ts\":" << ts << ",\"pid\":1,\"tid\":" << event.thread << ",\"args\":{\"file\":";
+        write_json_string(out, event.file_id < names.size() ? names[event.file_id] : "?");
+        out << ",\"offset\":" << event.offset << ",\"size\":" << event.size;
+        if (event.type == TraceEventType::READ) {
+            out << ",\"hit\":" << (event.hit() ? "true" : "false");
+        }
+        if (auto priority = event.priority()) {
+            out << ",\"priority\":\"" << (*priority == Priority::URGENT ? "urgent"
+                : *priority == Priority::NORMAL ? "normal" : "background") << "\"";
+        }
+        out << "}}";
+        first = false;
+    }
+
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+}
+
+}  // namespace valkyrie
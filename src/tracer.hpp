@@ -0,0 +1,134 @@
+#pragma once
+
+#include "types.hpp"
+#include "sharded_counter.hpp"
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <optional>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <memory>
+#include <fstream>
+#include <iosfwd>
+#include <chrono>
+#include <cstdint>
+
+namespace valkyrie {
+
+enum class TraceEventType : uint8_t {
+    OPEN = 0,       // File opened by a reader
+    READ = 1,       // FUSE read served (hit or after a miss)
+    MISS = 2,       // Reader blocked on an URGENT download
+    DOWNLOAD = 3,   // S3 range GET completed
+    EVICT = 4       // File dropped from the cache
+};
+
+const char* to_string(TraceEventType type);
+
+// One fixed-size trace record (32 bytes on disk, host byte order)
+struct TraceEvent {
+    uint64_t timestamp_ns;   // Since the tracer started
+    uint64_t offset;
+    uint32_t file_id;        // Index into the file name table
+    uint32_t size;
+    uint32_t latency_us;
+    uint16_t thread;         // Tracer-assigned thread index
+    TraceEventType type;
+    uint8_t flags;           // FLAG_HIT | (priority + 1) in the low bits, 0 if none
+
+    static constexpr uint8_t FLAG_HIT = 0x80;
+    static constexpr uint8_t PRIORITY_MASK = 0x03;
+
+    bool hit() const { return flags & FLAG_HIT; }
+    std::optional<Priority> priority() const {
+        uint8_t p = flags & PRIORITY_MASK;
+        return p == 0 ? std::nullopt : std::optional<Priority>(static_cast<Priority>(p - 1));
+    }
+};
+static_assert(sizeof(TraceEvent) == 32, "trace records are 32 bytes on disk");
+
+// Low-overhead event recorder. Each thread appends to its own lock-free
+// single-producer ring; a background thread drains the rings to a binary
+// file. A full ring drops events (counted) rather than stall the data path.
+//
+// File layout: "VKTRACE1", uint32 version, uint32 event size, then blocks of
+//   'N' uint32 count { uint32 id, uint16 length, name bytes }   (new file names)
+//   'E' uint32 count { TraceEvent }
+class Tracer {
+public:
+    explicit Tracer(const std::string& output_path,
+                    size_t ring_capacity = DEFAULT_RING_CAPACITY);
+    ~Tracer();
+
+    // Open the output and start the flusher; false if the file cannot be created
+    bool start();
+
+    // Flush everything recorded so far and close the file
+    void stop();
+
+    // Record an event (any thread, never blocks)
+    void record(TraceEventType type, const std::string& s3_key, uint64_t offset,
+                uint64_t size, uint64_t latency_us = 0,
+                std::optional<Priority> priority = std::nullopt, bool hit = false);
+
+    struct Stats {
+        ShardedCounter events_recorded;
+        std::atomic<uint64_t> events_written{0};   // Flusher only
+        ShardedCounter events_dropped;             // Ring full
+    };
+    const Stats& get_stats() const { return stats_; }
+
+    // Per-thread rings not yet freed (threads that exited are freed at the next flush)
+    size_t get_num_rings() const;
+
+    // Decode a trace file; false if it is not a valid trace
+    static bool read_file(const std::string& path, std::vector<std::string>& file_names,
+                          std::vector<TraceEvent>& events);
+
+    // Convert a trace file to Chrome trace-event JSON (chrome://tracing, Perfetto)
+    static bool write_chrome_json(const std::string& trace_path, std::ostream& out);
+
+    static constexpr size_t DEFAULT_RING_CAPACITY = 16384;   // Events per thread
+    static constexpr uint32_t FORMAT_VERSION = 1;
+
+private:
+    struct ThreadRing;
+
+    ThreadRing* ring_for_this_thread();
+    uint32_t file_id(ThreadRing& ring, const std::string& s3_key);
+    void flusher_loop();
+    void flush();
+
+    std::string output_path_;
+    size_t ring_capacity_;
+    uint64_t instance_id_;
+    std::chrono::steady_clock::time_point start_time_;
+
+    // Rings of live threads, and of exited ones until drained; only
+    // registration and the flusher take the lock
+    std::vector<std::shared_ptr<ThreadRing>> rings_;
+    uint16_t next_thread_ = 0;  // Thread index of the next ring
+    mutable std::mutex rings_mutex_;
+
+    // File name table; names not yet written are flushed before the events using them
+    std::unordered_map<std::string, uint32_t> file_ids_;
+    std::vector<std::string> file_names_;
+    size_t names_written_ = 0;                 // Flusher only
+    mutable std::shared_mutex names_mutex_;
+
+    std::ofstream out_;
+    std::mutex flush_mutex_;
+    std::thread flusher_thread_;
+    std::atomic<bool> stop_flag_{false};
+    bool started_ = false;
+
+    Stats stats_;
+
+    static constexpr std::chrono::milliseconds FLUSH_INTERVAL{100};
+};
+
+}  // namespace valkyrie
@@ -2,6 +2,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <exception>
 #include <string>
 
 namespace valkyrie {
@@ -19,12 +20,47 @@ enum class Priority {
     BACKGROUND   // Lookahead (N+2, N+3, ...)
 };
 
+constexpr size_t NUM_PRIORITIES = 3;
+
+// Which predictor produced a prefetch
+enum class PredictionSource {
+    SEQUENTIAL,  // Numeric filename pattern
+    MANIFEST,    // Static training-order manifest
+    MARKOV,      // Learned transition model
+    READAHEAD,   // Later chunks of the file being read
+    SHUFFLE,     // Seeded per-epoch permutation of the manifest
+    RECORD       // Next records of an indexed record file (TFRecord/ArrayRecord)
+};
+
+constexpr size_t NUM_PREDICTION_SOURCES = 6;
+
+// Information about an S3 object
+struct ObjectInfo {
+    std::string key;      // S3 key (relative to prefix)
+    size_t size;          // Object size in bytes
+    std::string etag{};   // As S3 returns it, quotes included ("" if unknown)
+    int64_t mtime = 0;    // Last modified, seconds since the epoch (0 if unknown)
+};
+
 // Constants
 constexpr size_t DEFAULT_CHUNK_SIZE = 4 * 1024 * 1024;  // 4MB
 constexpr size_t DEFAULT_CACHE_SIZE = 16ULL * 1024 * 1024 * 1024;  // 16GB
 constexpr int DEFAULT_WORKER_COUNT = 8;
 constexpr int DEFAULT_LOOKAHEAD = 3;
 constexpr size_t MAX_PREFETCH_QUEUE_SIZE = 100;
+constexpr int DEFAULT_DIRECTORY_TTL_SEC = 300;  // Per-directory listing lifetime
+constexpr size_t DEFAULT_MAX_CACHED_DIRECTORIES = 65536;  // Least recently used dropped past this
+
+// Column order of an S3 Inventory CSV report when --inventory-schema is not
+// given: the fileSchema of a report with Size, LastModifiedDate and ETag
+constexpr const char* DEFAULT_INVENTORY_SCHEMA = "Bucket, Key, Size, LastModifiedDate, ETag";
+
+// Adaptive prefetch window
+constexpr double WINDOW_LATENCY_MULTIPLE = 2.0;      // Stay 2x download latency ahead
+constexpr double MAX_WINDOW_CACHE_FRACTION = 0.5;    // Never plan more than half the cache
+
+// Prefetch admission: unread prefetched + in-flight bytes, as a fraction of the cache
+constexpr double DEFAULT_PREFETCH_BUDGET = 0.5;
 
 // S3 timeouts and retries
 constexpr int URGENT_TIMEOUT_MS = 5000;
@@ -47,6 +83,27 @@ inline size_t parse_size(const std::string& size_str) {
     }
 }
 
+// Strict variant for tool options: "1.5G" -> bytes (K/M/G/T, powers of
+// 1024). False for anything else, including zero and trailing junk.
+inline bool parse_size(const std::string& text, size_t& out) {
+    try {
+        size_t pos;
+        double value = std::stod(text, &pos);
+        std::string suffix = text.substr(pos);
+        double multiplier = 1;
+        if (suffix == "K" || suffix == "k") multiplier = 1024.0;
+        else if (suffix == "M" || suffix == "m") multiplier = 1024.0 * 1024;
+        else if (suffix == "G" || suffix == "g") multiplier = 1024.0 * 1024 * 1024;
+        else if (suffix == "T" || suffix == "t") multiplier = 1024.0 * 1024 * 1024 * 1024;
+        else if (!suffix.empty()) return false;
+        if (value <= 0) return false;
+        out = static_cast<size_t>(value * multiplier);
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
 // String conversion for enums (useful for logging)
 inline const char* to_string(CacheZone zone) {
     switch (zone) {
@@ -65,4 +122,16 @@ inline const char* to_string(Priority priority) {
     }
 }
 
+inline const char* to_string(PredictionSource source) {
+    switch (source) {
+        case PredictionSource::SEQUENTIAL: return "sequential";
+        case PredictionSource::MANIFEST: return "manifest";
+        case PredictionSource::MARKOV: return "markov";
+        case PredictionSource::READAHEAD: return "readahead";
+        case PredictionSource::SHUFFLE: return "shuffle";
+        case PredictionSource::RECORD: return "record";
+        default: return "unknown";
+    }
+}
+
 }  // namespace valkyrie
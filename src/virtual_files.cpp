@@ -0,0 +1,320 @@
+#include "virtual_files.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <iomanip>
+#include <sstream>
+
+namespace valkyrie {
+
+namespace {
+
+const std::string PREFIX = std::string(VirtualFiles::DIR) + "/";
+
+// {"count": N, "p50": .., "p90": .., "p99": .., "max": ..} in the histogram's unit
+void write_latency(std::ostringstream& oss, const LogLinearHistogram& hist) {
+    oss << "{\"count\": " << hist.count()
+        << ", \"p50\": " << hist.percentile(50)
+        << ", \"p90\": " << hist.percentile(90)
+        << ", \"p99\": " << hist.percentile(99)
+        << ", \"max\": " << hist.percentile(100) << "}";
+}
+
+// Keys are arbitrary bytes; escape what JSON strings cannot hold
+std::string json_escape(const std::string& value) {
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (unsigned char c : value) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += static_cast<char>(c);
+        } else if (c < 0x20) {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+            escaped += buf;
+        } else {
+            escaped += static_cast<char>(c);
+        }
+    }
+    return escaped;
+}
+
+void write_stall_totals(std::ostringstream& oss, const StallTotals& totals) {
+    oss << "\"reads\": " << totals.reads
+        << ", \"misses\": " << totals.misses
+        << ", \"bytes\": " << totals.bytes
+        << ", \"read_time_us\": " << totals.read_us
+        << ", \"stall_time_us\": " << totals.stall_us;
+}
+
+// Rest of the line after the verb, without surrounding whitespace
+std::string read_argument(std::istringstream& iss) {
+    std::string arg;
+    std::getline(iss >> std::ws, arg);
+    while (!arg.empty() && (arg.back() == '\r' || arg.back() == ' ')) {
+        arg.pop_back();
+    }
+    return arg;
+}
+
+}  // namespace
+
+VirtualFiles::VirtualFiles(CacheManager& cache,
+                           S3WorkerPool& worker_pool,
+                           Predictor& predictor,
+                           const ReadStats& read_stats,
+                           SizeLookup file_size)
+    : cache_(cache)
+    , worker_pool_(worker_pool)
+    , predictor_(predictor)
+    , read_stats_(read_stats)
+    , file_size_(std::move(file_size)) {
+}
+
+VirtualFiles::Node VirtualFiles::lookup(std::string_view s3_key) {
+    if (s3_key == DIR) return Node::DIR;
+    if (s3_key.compare(0, PREFIX.size(), PREFIX) != 0) return Node::NONE;
+
+    std::string_view name = s3_key.substr(PREFIX.size());
+    if (name == "stats.json") return Node::STATS;
+    if (name == "cache_map") return Node::CACHE_MAP;
+    if (name == "control") return Node::CONTROL;
+    return Node::NONE;
+}
+
+const std::vector<std::string>& VirtualFiles::entries() {
+    static const std::vector<std::string> names = {"stats.json", "cache_map", "control"};
+    return names;
+}
+
+std::string VirtualFiles::render(Node node) const {
+    switch (node) {
+        case Node::STATS: return render_stats_json();
+        case Node::CACHE_MAP: return render_cache_map();
+        case Node::CONTROL: return last_responses();
+        default: return "";
+    }
+}
+
+std::string VirtualFiles::render_stats_json() const {
+    // Lock-free counters and histograms only (same sources as /metrics)
+    const auto& worker_stats = worker_pool_.get_stats();
+    const auto& predictor_stats = predictor_.get_stats();
+    const auto& outcomes = cache_.get_prefetch_outcomes();
+
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(3);
+    oss << "{\n";
+
+    oss << "  \"cache\": {\"size_bytes\": " << cache_.get_size()
+        << ", \"capacity_bytes\": " << cache_.get_max_size()
+        << ", \"files\": " << cache_.get_num_files()
+        << ", \"chunks\": " << cache_.get_num_chunks()
+        << ", \"unread_prefetch_bytes\": " << cache_.get_unread_prefetch_bytes()
+        << ", \"pinned_files\": " << cache_.get_num_pinned()
+        << ", \"pinned_bytes\": " << cache_.get_pinned_bytes() << "},\n";
+
+    oss << "  \"workers\": {\"count\": " << worker_pool_.get_num_workers()
+        << ", \"downloads\": " << worker_stats.total_downloads
+        << ", \"failed\": " << worker_stats.failed_downloads
+        << ", \"downloaded_bytes\": " << worker_stats.bytes_downloaded
+        << ", \"prefetches_skipped\": " << worker_stats.prefetches_skipped << ",\n";
+    oss << "    \"ttfb_us\": ";
+    write_latency(oss, worker_stats.ttfb_us);
+    oss << ",\n    \"throughput_bytes_per_sec\": ";
+    write_latency(oss, worker_stats.throughput_bytes_per_sec);
+    oss << ",\n    \"queue_wait_us\": {";
+    for (size_t i = 0; i < NUM_PRIORITIES; ++i) {
+        auto priority = static_cast<Priority>(i);
+        std::string name = to_string(priority);
+        for (auto& c : name) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        oss << (i == 0 ? "\n" : ",\n") << "      \"" << name << "\": ";
+        write_latency(oss, worker_stats.queue_wait(priority));
+    }
+    oss << "\n    }\n  },\n";
+
+    oss << "  \"predictor\": {\"lookahead\": " << predictor_.get_lookahead()
+        << ", \"manifest_entries\": " << predictor_.get_manifest_size()
+        << ", \"shuffle_epoch\": " << predictor_stats.shuffle_epoch
+        << ", \"predictions_made\": " << predictor_stats.predictions_made
+        << ", \"prefetches_issued\": " << predictor_stats.prefetches_issued
+        << ", \"prefetches_deferred\": " << predictor_stats.prefetches_deferred << ",\n";
+    oss << "    \"consumption_bytes_per_sec\": " << predictor_stats.consumption_bytes_per_sec
+        << ", \"download_bytes_per_sec\": " << predictor_stats.download_bytes_per_sec
+        << ", \"window_bytes\": " << predictor_stats.window_bytes
+        << ", \"window_files\": " << predictor_stats.window_files << ",\n";
+    oss << "    \"accuracy\": {";
+    for (size_t i = 0; i < NUM_PREDICTION_SOURCES; ++i) {
+        auto source = static_cast<PredictionSource>(i);
+        oss << (i == 0 ? "" : ", ") << "\"" << to_string(source) << "\": "
+            << predictor_stats.accuracy(source);
+    }
+    oss << "}\n  },\n";
+
+    // Chunk counts per outcome, plus how far ahead of the reader they landed
+    oss << "  \"prefetch\": {";
+    for (size_t i = 0; i < NUM_PREDICTION_SOURCES; ++i) {
+        auto source = static_cast<PredictionSource>(i);
+        const auto& o = outcomes.source(source);
+        oss << (i == 0 ? "\n" : ",\n") << "    \"" << to_string(source) << "\": {"
+            << "\"inserted\": " << o.inserted.count
+            << ", \"useful\": " << o.useful.count
+            << ", \"wasted\": " << o.wasted.count
+            << ", \"late\": " << o.late.count
+            << ", \"wasted_bytes\": " << o.wasted.bytes
+            << ", \"lead_time_us_p50\": " << o.lead_time_us.percentile(50) << "}";
+    }
+    oss << "\n  },\n";
+
+    oss << "  \"reads\": {\"bytes\": " << read_stats_.bytes_read << ",\n";
+    oss << "    \"hit_latency_us\": ";
+    write_latency(oss, read_stats_.hit_latency_us);
+    oss << ",\n    \"miss_latency_us\": ";
+    write_latency(oss, read_stats_.miss_latency_us);
+    oss << "\n  },\n";
+
+    // Where readers' time went: blocked on S3 vs served from cache
+    auto stalls = read_stats_.stalls.snapshot(StallTracker::TOP_FILES);
+    oss << "  \"stalls\": {";
+    write_stall_totals(oss, stalls.total);
+    oss << ", \"stall_ratio\": " << stalls.stall_ratio() << ",\n    \"readers\": [";
+    for (size_t i = 0; i < stalls.readers.size(); ++i) {
+        const auto& [pid, totals] = stalls.readers[i];
+        oss << (i == 0 ? "\n" : ",\n") << "      {\"pid\": " << pid << ", ";
+        write_stall_totals(oss, totals);
+        oss << ", \"stall_ratio\": " << totals.stall_ratio()
+            << ", \"throughput_bytes_per_sec\": " << totals.throughput_bytes_per_sec() << "}";
+    }
+    oss << (stalls.readers.empty() ? "],\n" : "\n    ],\n");
+    oss << "    \"files\": [";
+    for (size_t i = 0; i < stalls.files.size(); ++i) {
+        const auto& [key, totals] = stalls.files[i];
+        oss << (i == 0 ? "\n" : ",\n") << "      {\"key\": \"" << json_escape(key) << "\", ";
+        write_stall_totals(oss, totals);
+        oss << "}";
+    }
+    oss << (stalls.files.empty() ? "]\n" : "\n    ]\n");
+    oss << "  }\n";
+
+    oss << "}\n";
+    return oss.str();
+}
+
+std::string VirtualFiles::render_cache_map() const {
+    std::ostringstream oss;
+    oss << "# zone pinned chunks cached_bytes size_bytes resident_pct key\n";
+
+    for (const auto& file : cache_.get_residency()) {
+        auto size = file_size_(file.s3_key);
+        double resident = size.has_value() && *size > 0
+            ? std::min(100.0, 100.0 * file.bytes / *size) : 100.0;
+
+        oss << to_string(file.zone) << " "
+            << (file.pinned ? "pinned" : "-") << " "
+            << file.chunks << " "
+            << file.bytes << " "
+            << (size.has_value() ? std::to_string(*size) : "?") << " "
+            << std::fixed << std::setprecision(1) << resident << " "
+            << file.s3_key << "\n";
+    }
+    return oss.str();
+}
+
+std::string VirtualFiles::execute(const std::string& command) {
+    std::istringstream iss(command);
+    std::string verb;
+    iss >> verb;
+
+    if (verb == "prefetch-file") {
+        std::string key = read_argument(iss);
+        if (key.empty()) return "ERR usage: prefetch-file KEY";
+        return handle_fetch(key, "prefetching");
+    }
+
+    if (verb == "pin") {
+        std::string key = read_argument(iss);
+        if (key.empty()) return "ERR usage: pin KEY";
+        auto size = file_size_(key);
+        if (!size.has_value()) return "ERR unknown file: " + key;
+        if (!cache_.pin(key, *size)) {
+            return "ERR pinned files would exceed " +
+                   std::to_string(static_cast<int>(CacheManager::MAX_PINNED_FRACTION * 100)) +
+                   "% of the cache: " + key;
+        }
+        return handle_fetch(key, "pinned");
+    }
+
+    if (verb == "unpin") {
+        std::string key = read_argument(iss);
+        if (key.empty()) return "ERR usage: unpin KEY";
+        if (!cache_.unpin(key)) return "ERR not pinned: " + key;
+        return "OK unpinned " + key;
+    }
+
+    if (verb == "evict") {
+        std::string key = read_argument(iss);
+        if (key.empty()) return "ERR usage: evict KEY";
+        if (!cache_.evict(key)) return "ERR not cached: " + key;
+        return "OK evicted " + key;
+    }
+
+    if (verb == "drop-caches") {
+        size_t dropped = cache_.drop_unpinned();
+        return "OK dropped " + std::to_string(dropped) + " files";
+    }
+
+    if (verb.empty()) return "ERR empty command";
+    return "ERR unknown command: " + verb;
+}
+
+std::string VirtualFiles::handle_fetch(const std::string& s3_key, const char* verb) {
+    auto size = file_size_(s3_key);
+    if (!size.has_value()) return "ERR unknown file: " + s3_key;
+
+    // Background priority: an operator's warm-up must not delay readers
+    size_t total = 0, queued = 0;
+    try {
+        for (size_t offset = 0; offset < *size; offset += DEFAULT_CHUNK_SIZE) {
+            ++total;
+            if (cache_.contains_chunk(s3_key, offset)) continue;
+            worker_pool_.submit(s3_key, offset, DEFAULT_CHUNK_SIZE, Priority::BACKGROUND);
+            ++queued;
+        }
+    } catch (const std::exception& e) {
+        return std::string("ERR ") + e.what();
+    }
+
+    return std::string("OK ") + verb + " " + s3_key + " (" + std::to_string(queued) +
+           " of " + std::to_string(total) + " chunks queued)";
+}
+
+bool VirtualFiles::write_control(const std::string& input) {
+    if (input.size() > MAX_CONTROL_WRITE) {
+        std::lock_guard<std::mutex> lock(responses_mutex_);
+        last_responses_ = "ERR command too long\n";
+        return false;
+    }
+
+    std::string responses;
+    bool ok = true;
+    std::istringstream lines(input);
+    std::string line;
+    while (std::getline(lines, line)) {
+        if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+
+        std::string response = execute(line);
+        ok = ok && response.rfind("OK", 0) == 0;
+        responses += response + "\n";
+    }
+
+    std::lock_guard<std::mutex> lock(responses_mutex_);
+    last_responses_ = std::move(responses);
+    return ok;
+}
+
+std::string VirtualFiles::last_responses() const {
+    std::lock_guard<std::mutex> lock(responses_mutex_);
+    return last_responses_;
+}
+
+}  // namespace valkyrie
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "cache_manager.hpp"
+#include "s3_worker_pool.hpp"
+#include "predictor.hpp"
+#include "read_stats.hpp"
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace valkyrie {
+
+// The hidden /.valkyrie/ directory in the mount, for operators who want
+// numbers without a Prometheus setup. Everything is rendered from memory
+// when a file is opened, so `watch -n1 cat` costs no S3 traffic:
+//
+//   stats.json   Cache, worker, predictor, prefetch, read-latency and stall snapshot
+//   cache_map    One line per cached file: zone, pin, chunks, bytes, residency
+//   control      Write commands, one per line; reading returns the responses
+//
+// Control commands answer "OK ..." / "ERR ..." like the control socket:
+//
+//   prefetch-file KEY   Queue every uncached chunk of KEY at background priority
+//   evict KEY           Drop KEY from the cache (even if pinned)
+//   pin KEY             Exempt KEY from eviction and fetch whatever is missing
+//   unpin KEY           Make KEY evictable again
+//   drop-caches         Evict every unpinned file
+class VirtualFiles {
+public:
+    // Size of an object in the bucket, if known
+    using SizeLookup = std::function<std::optional<size_t>(const std::string& s3_key)>;
+
+    VirtualFiles(CacheManager& cache,
+                 S3WorkerPool& worker_pool,
+                 Predictor& predictor,
+                 const ReadStats& read_stats,
+                 SizeLookup file_size);
+
+    // Mount-relative directory name (the key prefix is DIR + "/")
+    static constexpr const char* DIR = ".valkyrie";
+
+    enum class Node { NONE, DIR, STATS, CACHE_MAP, CONTROL };
+
+    // Which virtual node an S3-style key (no leading slash) names
+    static Node lookup(std::string_view s3_key);
+
+    // File names listed in the directory
+    static const std::vector<std::string>& entries();
+
+    std::string render_stats_json() const;
+    std::string render_cache_map() const;
+
+    // Content served when `node` is opened for reading (empty for DIR/NONE)
+    std::string render(Node node) const;
+
+    // Execute one command line and return the response line (without '\n')
+    std::string execute(const std::string& command);
+
+    // Execute each line written to `control`; false if any command failed.
+    // The responses become what `control` reads back.
+    bool write_control(const std::string& input);
+    std::string last_responses() const;
+
+private:
+    std::string handle_fetch(const std::string& s3_key, const char* verb);
+
+    CacheManager& cache_;
+    S3WorkerPool& worker_pool_;
+    Predictor& predictor_;
+    const ReadStats& read_stats_;
+    SizeLookup file_size_;
+
+    mutable std::mutex responses_mutex_;
+    std::string last_responses_;
+
+    static constexpr size_t MAX_CONTROL_WRITE = 64 * 1024;
+};
+
+}  // namespace valkyrie
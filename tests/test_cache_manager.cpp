@@ -27,12 +27,17 @@ void test_zone_promotion() {
 
     // Verify it's in PREFETCH zone
     assert(cache.get_zone("file2.bin") == CacheZone::PREFETCH);
+    assert(cache.get_prefetch_zone_size() == 1024 && cache.get_hot_zone_size() == 0);
 
     // Access the chunk (should promote to HOT)
     cache.access("file2.bin", 0);
 
     // Verify promotion
     assert(cache.get_zone("file2.bin") == CacheZone::HOT);
+    assert(cache.get_prefetch_zone_size() == 0 && cache.get_hot_zone_size() == 1024);
+
+    cache.evict("file2.bin");
+    assert(cache.get_hot_zone_size() == 0);
 
     std::cout << "test_zone_promotion: PASS\n";
 }
@@ -84,14 +89,158 @@ void test_chunked_file() {
     assert(c1.has_value() && c1->data[0] == 'B');
     assert(c2.has_value() && c2->data[0] == 'C');
 
+    assert(cache.contains_chunk("large_file.bin", 4096));
+    assert(!cache.contains_chunk("large_file.bin", 12288));
+    assert(!cache.contains_chunk("missing.bin", 0));
+
     std::cout << "test_chunked_file: PASS\n";
 }
 
+void test_prefetch_outcomes() {
+    CacheManager cache(3 * 1024);
+
+    std::vector<char> data(1024, 'P');
+    cache.insert_chunk("useful", 0, data, CacheZone::PREFETCH, PredictionSource::MANIFEST);
+    cache.insert_chunk("unread", 0, data, CacheZone::PREFETCH, PredictionSource::MANIFEST);
+    cache.insert_chunk("demand", 0, data, CacheZone::HOT);  // Not a prefetch
+
+    cache.access("useful", 0);
+    cache.access("useful", 0);  // Only the first read counts
+
+    // Force eviction of the unread prefetch (PREFETCH zone goes first)
+    cache.insert_chunk("next", 0, data, CacheZone::HOT);
+    assert(!cache.contains("unread"));
+
+    cache.record_late_prefetch(PredictionSource::SEQUENTIAL, 4096);
+
+    const auto& outcomes = cache.get_prefetch_outcomes();
+    const auto& manifest = outcomes.source(PredictionSource::MANIFEST);
+    assert(manifest.inserted.count.load() == 2);
+    assert(manifest.useful.count.load() == 1);
+    assert(manifest.useful.bytes.load() == 1024);
+    assert(manifest.wasted.count.load() == 1);
+    assert(manifest.wasted.bytes.load() == 1024);
+    assert(manifest.lead_time_us.count() == 1);
+    assert(cache.get_unread_prefetch_bytes() == 0);  // One read, one evicted
+
+    const auto& sequential = outcomes.source(PredictionSource::SEQUENTIAL);
+    assert(sequential.late.count.load() == 1);
+    assert(sequential.late.bytes.load() == 4096);
+
+    std::cout << "test_prefetch_outcomes: PASS\n";
+}
+
+void test_duplicate_insert_size() {
+    CacheManager cache(8 * 1024);
+
+    std::vector<char> data(1024, 'D');
+    cache.insert_chunk("dup", 0, data, CacheZone::HOT);
+    cache.insert_chunk("dup", 0, data, CacheZone::HOT);
+
+    assert(cache.get_stats().current_size == 1024);
+    std::cout << "test_duplicate_insert_size: PASS\n";
+}
+
+void test_chunk_containing() {
+    CacheManager cache(64 * 1024 * 1024);
+
+    // A record-aligned chunk inside the first fixed-size chunk's range
+    cache.insert_chunk("rec", 0, std::vector<char>(DEFAULT_CHUNK_SIZE, 'A'), CacheZone::PREFETCH);
+    cache.insert_chunk("rec", 5000, std::vector<char>(100, 'B'), CacheZone::PREFETCH);
+    cache.insert_chunk("rec", DEFAULT_CHUNK_SIZE + 300, std::vector<char>(200, 'C'),
+                       CacheZone::PREFETCH);
+
+    auto found = cache.get_chunk_containing("rec", 5050);
+    assert(found.has_value() && found->first == 5000);
+
+    // Past the small chunk, the fixed-size chunk still covers it
+    found = cache.get_chunk_containing("rec", 6000);
+    assert(found.has_value() && found->first == 0);
+
+    found = cache.get_chunk_containing("rec", DEFAULT_CHUNK_SIZE + 450);
+    assert(found.has_value() && found->second.data[0] == 'C');
+    assert(!cache.get_chunk_containing("rec", DEFAULT_CHUNK_SIZE + 100).has_value());
+    assert(!cache.get_chunk_containing("missing", 0).has_value());
+
+    assert(cache.contains_range("rec", 5000, 100));
+    assert(cache.contains_range("rec", 4000, 2000));       // Within chunk 0
+    assert(cache.contains_range("rec", DEFAULT_CHUNK_SIZE + 300, 200));
+    assert(!cache.contains_range("rec", DEFAULT_CHUNK_SIZE + 300, 201));
+    assert(!cache.contains_range("rec", DEFAULT_CHUNK_SIZE - 10, 20));  // Spans two chunks
+
+    std::cout << "test_chunk_containing: PASS\n";
+}
+
+void test_pin_evict_drop() {
+    CacheManager cache(3 * 1024);  // 3KB total
+
+    std::vector<char> data(1024, 'X');
+    bool pinned = cache.pin("pinned", 1024);
+    assert(pinned);
+    cache.insert_chunk("pinned", 0, data, CacheZone::PREFETCH);
+    cache.insert_chunk("hot", 0, data, CacheZone::HOT);
+    cache.insert_chunk("prefetch", 0, data, CacheZone::PREFETCH);
+
+    // Full: the oldest prefetch is pinned, so the next one goes
+    cache.insert_chunk("new", 0, data, CacheZone::HOT);
+    assert(cache.contains("pinned"));
+    assert(!cache.contains("prefetch"));
+
+    auto residency = cache.get_residency();
+    assert(residency.size() == 3);
+    assert(residency[0].s3_key == "hot" && residency[0].zone == CacheZone::HOT);
+    assert(residency[2].s3_key == "pinned" && residency[2].pinned);
+    assert(residency[2].bytes == 1024 && residency[2].chunks == 1);
+
+    // No unpinned prefetch left: the LRU hot file goes next
+    cache.insert_chunk("more", 0, data, CacheZone::HOT);
+    assert(!cache.contains("hot") && cache.contains("pinned"));
+
+    size_t dropped = cache.drop_unpinned();
+    assert(dropped == 2);
+    assert(cache.get_num_files() == 1 && cache.get_size() == 1024);
+
+    // Pins are bounded by a share of the capacity, so evicting unpinned
+    // files keeps the cache within it
+    pinned = cache.pin("big", 1024 + 1);
+    assert(!pinned);
+    assert(!cache.is_pinned("big") && cache.get_pinned_bytes() == 1024);
+    for (size_t offset = 0; offset < 3 * 1024; offset += 1024) {
+        cache.insert_chunk("big", offset, data, CacheZone::HOT);
+        assert(cache.get_size() <= 3 * 1024);
+    }
+    assert(cache.contains("pinned"));
+
+    // Pinning again replaces the reservation
+    pinned = cache.pin("pinned", 512);
+    assert(pinned && cache.get_pinned_bytes() == 512);
+    pinned = cache.pin("other", 1024);
+    assert(pinned && cache.get_pinned_bytes() == 1536);
+
+    bool evicted = cache.evict("pinned");  // Explicit eviction ignores the pin
+    assert(evicted);
+    evicted = cache.evict("pinned");
+    assert(!evicted);
+    assert(!cache.contains("pinned"));
+    assert(cache.is_pinned("pinned"));  // The pin outlives the chunks
+    bool unpinned = cache.unpin("pinned");
+    assert(unpinned);
+    unpinned = cache.unpin("pinned");
+    assert(!unpinned);
+    assert(cache.get_num_pinned() == 1 && cache.get_pinned_bytes() == 1024);
+
+    std::cout << "test_pin_evict_drop: PASS\n";
+}
+
 int main() {
     test_insert_and_get();
     test_zone_promotion();
     test_lru_eviction();
     test_chunked_file();
+    test_prefetch_outcomes();
+    test_duplicate_insert_size();
+    test_chunk_containing();
+    test_pin_evict_drop();
     std::cout << "All CacheManager tests passed!\n";
     return 0;
 }
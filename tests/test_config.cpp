@@ -25,6 +25,7 @@ void test_minimal_config() {
     // Defaults
     assert(config.cache_size == DEFAULT_CACHE_SIZE);
     assert(config.num_workers == DEFAULT_WORKER_COUNT);
+    assert(config.dir_ttl == DEFAULT_DIRECTORY_TTL_SEC);
 
     std::cout << "test_minimal_config: PASS\n";
 }
@@ -39,9 +40,14 @@ void test_full_config() {
         "--cache-size", "8G",
         "--workers", "16",
         "--lookahead", "5",
-        "--manifest", "files.txt"
+        "--manifest", "files.txt",
+        "--adaptive-lookahead",
+        "--prefetch-budget", "0.25",
+        "--parquet-columns", "image,meta.label",
+        "--dir-ttl", "60",
+        "--metadata-snapshot", "/var/cache/valkyrie/ns.snap"
     };
-    int argc = 17;
+    int argc = 26;
 
     Config config;
     bool success = config.parse(argc, const_cast<char**>(argv));
@@ -55,6 +61,13 @@ void test_full_config() {
     assert(config.num_workers == 16);
     assert(config.lookahead == 5);
     assert(config.manifest_path == "files.txt");
+    assert(config.adaptive_lookahead);
+    assert(config.prefetch_budget == 0.25);
+    assert(config.parquet_columns.size() == 2);
+    assert(config.parquet_columns[1] == "meta.label");
+    assert(config.dir_ttl == 60);
+    assert(config.metadata_snapshot == "/var/cache/valkyrie/ns.snap");
+    assert(config.list_bucket);  // The snapshot is refreshed by a listing
 
     std::cout << "test_full_config: PASS\n";
 }
@@ -93,11 +106,132 @@ void test_invalid_cache_size() {
     std::cout << "test_invalid_cache_size: PASS\n";
 }
 
+void test_log_level() {
+    const char* argv[] = {
+        "valkyrie",
+        "--mount", "/tmp/test",
+        "--bucket", "test",
+        "--region", "us-east-1",
+        "--log-level", "debug"
+    };
+
+    Config config;
+    assert(config.log_level == LogLevel::INFO);
+    bool success = config.parse(9, const_cast<char**>(argv));
+    assert(success);
+    assert(config.log_level == LogLevel::DEBUG);
+
+    argv[8] = "verbose";
+    Config invalid;
+    success = invalid.parse(9, const_cast<char**>(argv));
+    assert(!success);
+
+    std::cout << "test_log_level: PASS\n";
+}
+
+void test_mock_store() {
+    const char* argv[] = {
+        "valkyrie",
+        "--mount", "/tmp/test",
+        "--mock-s3", "16x8M",
+        "--mock-latency-ms", "5",
+        "--mock-bandwidth", "512M"
+    };
+
+    // No bucket or region needed
+    Config config;
+    bool success = config.parse(9, const_cast<char**>(argv));
+    assert(success);
+    assert(config.mock_objects == 16);
+    assert(config.mock_object_size == 8 * 1024 * 1024);
+    assert(config.mock_latency_ms == 5.0);
+    assert(config.mock_bandwidth == 512 * 1024 * 1024);
+    assert(Config::mock_object_key(7) == "shard_000007.bin");
+
+    argv[4] = "16";
+    Config invalid;
+    success = invalid.parse(9, const_cast<char**>(argv));
+    assert(!success);
+
+    argv[4] = "0x8M";
+    Config empty;
+    success = empty.parse(9, const_cast<char**>(argv));
+    assert(!success);
+
+    std::cout << "test_mock_store: PASS\n";
+}
+
+void test_inventory() {
+    const char* argv[] = {
+        "valkyrie",
+        "--mount", "/tmp/test",
+        "--bucket", "test",
+        "--region", "us-east-1",
+        "--inventory", "/data/inventory",
+        "--inventory-schema", "Bucket, Key, Size",
+        "--list-bucket"
+    };
+
+    Config config;
+    bool success = config.parse(11, const_cast<char**>(argv));
+    assert(success);
+    assert(config.inventory_path == "/data/inventory");
+    assert(config.inventory_schema == "Bucket, Key, Size");
+
+    // A fixed namespace is never listed
+    Config listed;
+    success = listed.parse(12, const_cast<char**>(argv));
+    assert(!success);
+
+    // Key and Size are required columns
+    argv[10] = "Bucket, Key, ETag";
+    Config no_size;
+    success = no_size.parse(11, const_cast<char**>(argv));
+    assert(!success);
+
+    std::cout << "test_inventory: PASS\n";
+}
+
+void test_metrics_endpoint() {
+    const char* argv[] = {
+        "valkyrie",
+        "--mount", "/tmp/test",
+        "--bucket", "test",
+        "--region", "us-east-1",
+        "--metrics-port", "0",
+        "--metrics-address", "0.0.0.0"
+    };
+
+    Config defaults;
+    bool success = defaults.parse(7, const_cast<char**>(argv));
+    assert(success);
+    assert(defaults.metrics_port == 9090);
+    assert(defaults.metrics_address == "127.0.0.1");
+
+    // Port 0 disables the endpoint
+    Config config;
+    success = config.parse(11, const_cast<char**>(argv));
+    assert(success);
+    assert(config.metrics_port == 0);
+    assert(config.metrics_address == "0.0.0.0");
+
+    argv[10] = "localhost";
+    Config hostname;
+    success = hostname.parse(11, const_cast<char**>(argv));
+    assert(!success);
+
+    std::cout << "test_metrics_endpoint: PASS\n";
+}
+
 int main() {
     test_minimal_config();
     test_full_config();
     test_missing_required();
     test_invalid_cache_size();
+    test_log_level();
+    test_mock_store();
+    test_inventory();
+    test_metrics_endpoint();
     std::cout << "All Config tests passed!\n";
     return 0;
 }
@@ -0,0 +1,126 @@
+#include "../src/control_server.hpp"
+#include <aws/core/Aws.h>
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace valkyrie;
+
+struct Fixture {
+    CacheManager cache{16 * 1024 * 1024};
+    S3Config config{"test", "us-east-1", ""};
+    S3WorkerPool pool{config, cache, 2};
+    Predictor predictor{cache, pool, 3};
+};
+
+void test_manifest_commands() {
+    Fixture f;
+    ControlServer server("/tmp/valkyrie_test_control.sock", f.predictor);
+
+    auto response = server.execute("manifest load tests/test_manifest.txt");
+    assert(response == "OK manifest entries=5");
+    assert(f.predictor.get_manifest_size() == 5);
+
+    response = server.execute("manifest append tests/test_shuffled_manifest.txt");
+    assert(response == "OK manifest entries=15");
+    assert(f.predictor.get_manifest()->shuffle().has_value());
+
+    response = server.execute("manifest clear");
+    assert(response == "OK manifest cleared");
+    assert(f.predictor.get_manifest_size() == 0);
+
+    response = server.execute("manifest load /nonexistent/manifest.txt");
+    assert(response.rfind("ERR", 0) == 0);
+
+    std::cout << "test_manifest_commands: PASS\n";
+}
+
+void test_position_and_lookahead() {
+    Fixture f;
+    ControlServer server("/tmp/valkyrie_test_control.sock", f.predictor);
+
+    auto response = server.execute("lookahead 7");
+    assert(response == "OK lookahead 7");
+    assert(f.predictor.get_lookahead() == 7);
+    response = server.execute("lookahead 1000");
+    assert(response.rfind("ERR", 0) == 0);
+    assert(f.predictor.get_lookahead() == 7);
+
+    server.execute("manifest load tests/test_manifest.txt");
+    response = server.execute("position #2");
+    assert(response == "OK position shard_003.bin");
+    response = server.execute("position #99");
+    assert(response.rfind("ERR", 0) == 0);
+    response = server.execute("position shard_010.bin");
+    assert(response == "OK position shard_010.bin");
+
+    // Epoch jumps only apply to shuffled manifests
+    response = server.execute("epoch 3");
+    assert(response.rfind("ERR", 0) == 0);
+    server.execute("manifest load tests/test_shuffled_manifest.txt");
+    response = server.execute("epoch 3");
+    assert(response == "OK epoch 3");
+    assert(f.predictor.get_shuffle_epoch() == 3);
+
+    response = server.execute("bogus");
+    assert(response.rfind("ERR unknown command", 0) == 0);
+
+    std::cout << "test_position_and_lookahead: PASS\n";
+}
+
+void test_socket_round_trip() {
+    Fixture f;
+    const std::string path = "/tmp/valkyrie_test_control.sock";
+    ControlServer server(path, f.predictor);
+    bool started = server.start();
+    assert(started);
+
+    // Only the owner may connect, whatever the umask
+    struct stat st;
+    assert(::stat(path.c_str(), &st) == 0 && (st.st_mode & 0777) == 0600);
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    int connected = ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    assert(connected == 0);
+
+    const char* commands = "lookahead 5\nstatus\n";
+    ssize_t sent = ::send(fd, commands, std::strlen(commands), 0);
+    assert(sent > 0);
+
+    std::string received;
+    char buf[256];
+    while (std::count(received.begin(), received.end(), '\n') < 2) {
+        ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+        assert(n > 0);
+        received.append(buf, n);
+    }
+    ::close(fd);
+
+    assert(received == "OK lookahead 5\nOK manifest_entries=0 lookahead=5 epoch=0\n");
+
+    server.stop();
+    assert(::access(path.c_str(), F_OK) != 0);  // Socket removed
+
+    std::cout << "test_socket_round_trip: PASS\n";
+}
+
+int main() {
+    Aws::SDKOptions sdk_options;
+    Aws::InitAPI(sdk_options);
+
+    test_manifest_commands();
+    test_position_and_lookahead();
+    test_socket_round_trip();
+    std::cout << "All ControlServer tests passed!\n";
+
+    Aws::ShutdownAPI(sdk_options);
+    return 0;
+}
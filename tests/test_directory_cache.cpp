@@ -0,0 +1,182 @@
+#include "../src/directory_cache.hpp"
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace valkyrie;
+
+static const std::vector<ObjectInfo> BUCKET = {
+    {"README", 10},
+    {"train/", 0},  // Console-created directory marker
+    {"train/part-0001/shard-0.tar", 1000},
+    {"train/part-0001/shard-1.tar", 1001},
+    {"train/part-0002/shard-0.tar", 2000},
+    {"train/labels.csv", 50},
+    {"val/shard-0.tar", 3000},
+};
+
+void test_group_directory() {
+    auto root = group_directory(BUCKET, "");
+    assert(root.files.size() == 1 && root.files[0].key == "README");
+    assert((root.subdirs == std::vector<std::string>{"train", "val"}));
+
+    auto train = group_directory(BUCKET, "train");
+    assert(train.files.size() == 1 && train.files[0].key == "labels.csv");
+    assert((train.subdirs == std::vector<std::string>{"part-0001", "part-0002"}));
+
+    auto part = group_directory(BUCKET, "train/part-0001");
+    assert(part.files.size() == 2 && part.files[1].key == "shard-1.tar" && part.files[1].size == 1001);
+    assert(part.subdirs.empty());
+
+    // "train" must not match "training/..."
+    auto empty = group_directory({{"training/x", 1}}, "train");
+    assert(empty.files.empty() && empty.subdirs.empty());
+
+    std::cout << "test_group_directory: PASS\n";
+}
+
+void test_lazy_listing() {
+    std::map<std::string, int> calls;
+    DirectoryCache cache([&calls](const std::string& dir) {
+        calls[dir]++;
+        return group_directory(BUCKET, dir);
+    });
+
+    // A nested lookup lists only the parent directory
+    auto entry = cache.lookup("train/part-0001/shard-1.tar");
+    assert(entry.type == DirectoryCache::EntryType::FILE && entry.size == 1001);
+    assert(calls.size() == 1 && calls["train/part-0001"] == 1);
+
+    entry = cache.lookup("train/part-0001/missing.tar");
+    assert(entry.type == DirectoryCache::EntryType::NONE);
+    assert(calls["train/part-0001"] == 1);  // Fresh listing answers misses too
+
+    entry = cache.lookup("train/part-0002");
+    assert(entry.type == DirectoryCache::EntryType::DIR);
+    entry = cache.lookup("train/labels.csv");
+    assert(entry.type == DirectoryCache::EntryType::FILE);
+    assert(calls["train"] == 1);
+    entry = cache.lookup("");
+    assert(entry.type == DirectoryCache::EntryType::DIR);
+
+    auto listing = cache.list("train");
+    assert(listing->files.size() == 1 && listing->subdirs.size() == 2);
+    assert(calls["train"] == 1 && cache.listings() == 2);
+
+    // Cached-only lookups never list
+    assert(cache.cached_lookup("val/shard-0.tar").type == DirectoryCache::EntryType::NONE);
+    assert(cache.cached_lookup("train/labels.csv").size == 50);
+    assert(calls.count("val") == 0);
+
+    cache.invalidate("train");
+    cache.list("train");
+    assert(calls["train"] == 2);
+
+    std::cout << "test_lazy_listing: PASS\n";
+}
+
+void test_ttl() {
+    int calls = 0;
+    DirectoryCache cache([&calls](const std::string& dir) {
+        calls++;
+        return group_directory(BUCKET, dir);
+    }, std::chrono::seconds(0));
+
+    // Zero TTL: every access lists again
+    cache.list("val");
+    cache.list("val");
+    assert(calls == 2);
+
+    std::cout << "test_ttl: PASS\n";
+}
+
+void test_bounded() {
+    std::map<std::string, int> calls;
+    DirectoryCache cache([&calls](const std::string& dir) {
+        calls[dir]++;
+        return group_directory(BUCKET, dir);
+    }, std::chrono::seconds(DEFAULT_DIRECTORY_TTL_SEC), 2);
+
+    // The least recently used directory is dropped first
+    cache.list("train");
+    cache.list("val");
+    cache.list("train");
+    cache.list("train/part-0001");
+    assert(cache.cached_directories() == 2);
+    cache.list("train");
+    assert(calls["train"] == 1);
+    cache.list("val");
+    assert(calls["val"] == 2);
+
+    // Paths that do not exist list as empty and are not kept
+    size_t cached = cache.cached_directories();
+    auto entry = cache.lookup("missing/x");
+    assert(entry.type == DirectoryCache::EntryType::NONE);
+    entry = cache.lookup("missing/y");
+    assert(entry.type == DirectoryCache::EntryType::NONE);
+    assert(calls["missing"] == 2);
+    assert(cache.cached_directories() == cached);
+    assert(cache.cached_lookup("train/labels.csv").type == DirectoryCache::EntryType::FILE);
+
+    std::cout << "test_bounded: PASS\n";
+}
+
+void test_concurrent_single_listing() {
+    std::atomic<int> calls{0};
+    DirectoryCache cache([&calls](const std::string& dir) {
+        calls++;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        return group_directory(BUCKET, dir);
+    });
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i) {
+        threads.emplace_back([&cache] {
+            auto entry = cache.lookup("val/shard-0.tar");
+            assert(entry.size == 3000);
+        });
+    }
+    for (auto& t : threads) t.join();
+    assert(calls == 1);
+
+    std::cout << "test_concurrent_single_listing: PASS\n";
+}
+
+void test_lister_failure() {
+    bool fail = true;
+    DirectoryCache cache([&fail](const std::string& dir) {
+        if (fail) throw std::runtime_error("ListObjectsV2 failed");
+        return group_directory(BUCKET, dir);
+    });
+
+    bool threw = false;
+    try {
+        cache.list("");
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+
+    // A failed listing is not cached
+    fail = false;
+    auto entry = cache.lookup("README");
+    assert(entry.type == DirectoryCache::EntryType::FILE);
+
+    std::cout << "test_lister_failure: PASS\n";
+}
+
+int main() {
+    test_group_directory();
+    test_lazy_listing();
+    test_ttl();
+    test_bounded();
+    test_concurrent_single_listing();
+    test_lister_failure();
+    std::cout << "All directory cache tests passed!\n";
+    return 0;
+}
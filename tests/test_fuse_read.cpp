@@ -0,0 +1,146 @@
+#include "../src/fuse_ops.hpp"
+#include <aws/core/Aws.h>
+#include <cassert>
+#include <cerrno>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+using namespace valkyrie;
+
+static const size_t OBJECT_SIZE = 2 * DEFAULT_CHUNK_SIZE;
+static const size_t RECORD_SIZE = 100 * 1024;
+
+// Mock store of zero-filled objects; no FUSE mount or S3
+static std::unique_ptr<FuseContext> make_context() {
+    Config config;
+    config.mount_point = "/tmp/valkyrie_test_fuse_read";
+    config.cache_size = 64 * 1024 * 1024;
+    config.num_workers = 2;
+    config.mock_objects = 1;
+    config.mock_object_size = OBJECT_SIZE;
+    config.mock_latency_ms = 0;
+    auto ctx = std::make_unique<FuseContext>(config);
+    ctx->worker_pool->start();
+    return ctx;
+}
+
+// A record-sized chunk at the start of the object, as record prefetch inserts it
+static void insert_record(FuseContext& ctx, const std::string& key) {
+    ctx.cache->insert_chunk(key, 0, std::vector<char>(RECORD_SIZE, 'r'), CacheZone::PREFETCH,
+                            PredictionSource::RECORD);
+}
+
+void test_read_past_record_chunk() {
+    auto ctx = make_context();
+    std::string key = Config::mock_object_key(0);
+    insert_record(*ctx, key);
+
+    // Same 4MB range as the record chunk, but beyond its end
+    std::vector<char> buf(4096, 'x');
+    int copied = ctx->read_object(key, buf.data(), buf.size(), 1024 * 1024, 0);
+    assert(copied == 4096);
+    assert(buf[0] == 0 && buf[4095] == 0);
+
+    std::cout << "test_read_past_record_chunk: PASS\n";
+}
+
+void test_read_at_record_end() {
+    auto ctx = make_context();
+    std::string key = Config::mock_object_key(0);
+    insert_record(*ctx, key);
+
+    std::vector<char> buf(4096, 'x');
+    int copied = ctx->read_object(key, buf.data(), buf.size(), RECORD_SIZE, 0);
+    assert(copied == 4096);
+    assert(buf[0] == 0);
+
+    std::cout << "test_read_at_record_end: PASS\n";
+}
+
+void test_read_across_record_end() {
+    auto ctx = make_context();
+    std::string key = Config::mock_object_key(0);
+    insert_record(*ctx, key);
+
+    // The tail of the record chunk, then the aligned chunk behind it
+    std::vector<char> buf(4096, 'x');
+    int copied = ctx->read_object(key, buf.data(), buf.size(), RECORD_SIZE - 10, 0);
+    assert(copied == 4096);
+    assert(buf[0] == 'r' && buf[9] == 'r' && buf[10] == 0);
+
+    std::cout << "test_read_across_record_end: PASS\n";
+}
+
+void test_read_at_object_end() {
+    auto ctx = make_context();
+    std::string key = Config::mock_object_key(0);
+
+    // Size not listed: the read past the end fails, leaving a short read
+    std::vector<char> buf(4096, 'x');
+    int copied = ctx->read_object(key, buf.data(), buf.size(), OBJECT_SIZE - 10, 0);
+    assert(copied == 10);
+    copied = ctx->read_object(key, buf.data(), buf.size(), OBJECT_SIZE, 0);
+    assert(copied == -EIO);
+
+    std::cout << "test_read_at_object_end: PASS\n";
+}
+
+void test_read_across_chunks_counted_once() {
+    auto ctx = make_context();
+    std::string key = Config::mock_object_key(0);
+
+    // Two chunk misses, one FUSE read
+    std::vector<char> buf(4096, 'x');
+    int copied = ctx->read_object(key, buf.data(), buf.size(), DEFAULT_CHUNK_SIZE - 10, 7);
+    assert(copied == 4096);
+
+    auto stalls = ctx->read_stats.stalls.snapshot();
+    assert(stalls.total.reads == 1 && stalls.total.misses == 1);
+    assert(stalls.total.bytes == 4096);
+    assert(ctx->read_stats.miss_latency_us.count() == 1);
+    assert(ctx->read_stats.hit_latency_us.count() == 0);
+
+    std::cout << "test_read_across_chunks_counted_once: PASS\n";
+}
+
+void test_tar_sidecar_waits_for_index() {
+    Config config;
+    config.mount_point = "/tmp/valkyrie_test_fuse_read";
+    config.cache_size = 64 * 1024 * 1024;
+    config.num_workers = 2;
+    config.mock_objects = 1;
+    config.mock_object_size = OBJECT_SIZE;
+    config.mock_latency_ms = 5;
+    FuseContext ctx(config);
+    ctx.mock_object_sizes["zeros.tar"] = OBJECT_SIZE;  // Before any fetch reads the map
+    ctx.worker_pool->start();
+
+    // Downloaded in the background: zeros end the archive at once
+    std::string rendered = "x";
+    int status = ctx.wait_tar_index("zeros.tar", rendered);
+    assert(status == 0);
+    assert(rendered.empty());
+    assert(ctx.tar_indexer->rendered_size("zeros.tar") == 0u);
+
+    status = ctx.wait_tar_index(Config::mock_object_key(0), rendered);
+    assert(status == -EIO);
+
+    std::cout << "test_tar_sidecar_waits_for_index: PASS\n";
+}
+
+int main() {
+    Aws::SDKOptions sdk_options;
+    Aws::InitAPI(sdk_options);
+
+    test_read_past_record_chunk();
+    test_read_at_record_end();
+    test_read_across_record_end();
+    test_read_at_object_end();
+    test_read_across_chunks_counted_once();
+    test_tar_sidecar_waits_for_index();
+    std::cout << "All FUSE read tests passed!\n";
+
+    Aws::ShutdownAPI(sdk_options);
+    return 0;
+}
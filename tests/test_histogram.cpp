@@ -0,0 +1,78 @@
+#include "../src/histogram.hpp"
+#include <cassert>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace valkyrie;
+
+void test_bucket_bounds() {
+    // Small values are exact
+    for (uint64_t v = 0; v < LogLinearHistogram::SUB_BUCKETS; ++v) {
+        assert(LogLinearHistogram::bucket_index(v) == v);
+    }
+
+    // Every value falls inside its bucket's bounds, buckets are contiguous
+    for (uint64_t v : {uint64_t{4}, uint64_t{5}, uint64_t{7}, uint64_t{8}, uint64_t{1000},
+                       uint64_t{123456789}, UINT64_MAX}) {
+        size_t i = LogLinearHistogram::bucket_index(v);
+        assert(i < LogLinearHistogram::NUM_BUCKETS);
+        assert(LogLinearHistogram::bucket_lower_bound(i) <= v);
+        assert(v <= LogLinearHistogram::bucket_upper_bound(i));
+    }
+    for (size_t i = 0; i + 1 < LogLinearHistogram::NUM_BUCKETS; ++i) {
+        assert(LogLinearHistogram::bucket_upper_bound(i) + 1 ==
+               LogLinearHistogram::bucket_lower_bound(i + 1));
+    }
+
+    std::cout << "test_bucket_bounds: PASS\n";
+}
+
+void test_percentiles() {
+    LogLinearHistogram hist;
+    for (uint64_t v = 1; v <= 1000; ++v) {
+        hist.record(v);
+    }
+
+    assert(hist.count() == 1000);
+    assert(hist.sum() == 500500);
+
+    // Relative error bounded by the sub-bucket width (25%)
+    uint64_t p50 = hist.percentile(50);
+    assert(p50 >= 500 && p50 <= 625);
+    uint64_t p99 = hist.percentile(99);
+    assert(p99 >= 990 && p99 <= 1250);
+
+    LogLinearHistogram empty;
+    assert(empty.percentile(50) == 0);
+
+    std::cout << "test_percentiles: PASS\n";
+}
+
+void test_concurrent_record() {
+    LogLinearHistogram hist;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&hist]() {
+            for (int i = 0; i < 10000; ++i) hist.record(i);
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    assert(hist.count() == 40000);
+
+    // Bucket counts from every thread's shard add up
+    uint64_t bucketed = 0;
+    for (size_t i = 0; i < LogLinearHistogram::NUM_BUCKETS; ++i) bucketed += hist.bucket_count(i);
+    assert(bucketed == 40000);
+    assert(hist.bucket_count(LogLinearHistogram::bucket_index(0)) == 4);
+    std::cout << "test_concurrent_record: PASS\n";
+}
+
+int main() {
+    test_bucket_bounds();
+    test_percentiles();
+    test_concurrent_record();
+    std::cout << "All LogLinearHistogram tests passed!\n";
+    return 0;
+}
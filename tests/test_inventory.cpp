@@ -0,0 +1,153 @@
+#include "../src/inventory.hpp"
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace valkyrie;
+
+static std::string temp_path(const char* name) {
+    return "/tmp/" + std::string(name) + "_" + std::to_string(getpid());
+}
+
+void test_split_row() {
+    std::vector<std::string> fields;
+    assert(InventoryReader::split_row("\"b\",\"k\",\"12\"", fields));
+    assert((fields == std::vector<std::string>{"b", "k", "12"}));
+
+    // Unquoted, empty and escaped fields
+    assert(InventoryReader::split_row("b,,\"say \"\"hi\"\", ok\",", fields));
+    assert((fields == std::vector<std::string>{"b", "", "say \"hi\", ok", ""}));
+
+    assert(!InventoryReader::split_row("\"unterminated", fields));
+    assert(!InventoryReader::split_row("\"a\"b,c", fields));
+
+    std::cout << "test_split_row: PASS\n";
+}
+
+void test_decoding() {
+    std::string key;
+    assert(InventoryReader::url_decode("train/part%2D1/a+b%2Bc.tar", key));
+    assert(key == "train/part-1/a b+c.tar");
+    assert(!InventoryReader::url_decode("bad%2", key));
+    assert(!InventoryReader::url_decode("bad%zz", key));
+
+    assert(InventoryReader::parse_timestamp("2024-03-01T12:00:00.000Z") == 1709294400);
+    assert(InventoryReader::parse_timestamp("yesterday") == 0);
+
+    std::cout << "test_decoding: PASS\n";
+}
+
+void test_load_report() {
+    std::string path = temp_path("test_inventory") + ".csv";
+    {
+        std::ofstream out(path);
+        out << "\"data\",\"shards/a.tar\",\"1000\",\"2024-03-01T12:00:00.000Z\",\"0123456789abcdef0123456789abcdef\"\n"
+            << "\"data\",\"shards/sub/b+c.tar\",\"2000\",\"2024-03-01T12:00:00.000Z\",\"0123456789abcdef0123456789abcdef-4\"\r\n"
+            << "\"data\",\"shards/\",\"0\",\"2024-03-01T12:00:00.000Z\",\"\"\n"  // Prefix marker
+            << "\"data\",\"other/x.tar\",\"5\",\"2024-03-01T12:00:00.000Z\",\"\"\n"
+            << "\"logs\",\"shards/y.tar\",\"7\",\"2024-03-01T12:00:00.000Z\",\"\"\n";
+    }
+
+    InventoryReader reader(DEFAULT_INVENTORY_SCHEMA, "data", "shards");
+    assert(reader.valid());
+    std::vector<ObjectInfo> objects;
+    bool loaded = reader.load(path, objects);
+    assert(loaded);
+    assert(objects.size() == 2);
+    assert(objects[0].key == "a.tar" && objects[0].size == 1000);
+    assert(objects[0].etag == "\"0123456789abcdef0123456789abcdef\"");
+    assert(objects[0].mtime == 1709294400);
+    assert(objects[1].key == "sub/b c.tar" && objects[1].size == 2000);
+
+    // A row with the wrong number of fields fails the load
+    {
+        std::ofstream out(path, std::ios::app);
+        out << "\"data\",\"shards/z.tar\"\n";
+    }
+    objects.clear();
+    loaded = reader.load(path, objects);
+    assert(!loaded);
+
+    unlink(path.c_str());
+    std::cout << "test_load_report: PASS\n";
+}
+
+void test_versioned_report_directory() {
+    std::string dir = temp_path("test_inventory_dir");
+    mkdir(dir.c_str(), 0755);
+    {
+        std::ofstream out(dir + "/part-0.csv");
+        out << "\"data\",\"a.bin\",\"v2\",\"true\",\"false\",\"10\"\n"
+            << "\"data\",\"a.bin\",\"v1\",\"false\",\"false\",\"9\"\n";
+    }
+    {
+        std::ofstream out(dir + "/part-1.csv");
+        out << "\"data\",\"b.bin\",\"v3\",\"true\",\"true\",\"\"\n"  // Deleted
+            << "\"data\",\"c.bin\",\"v4\",\"true\",\"false\",\"30\"\n";
+    }
+    {
+        std::ofstream out(dir + "/manifest.json");  // Not a data file
+        out << "{}\n";
+    }
+
+    InventoryReader reader("Bucket, Key, VersionId, IsLatest, IsDeleteMarker, Size", "data", "");
+    std::vector<ObjectInfo> objects;
+    bool loaded = reader.load(dir, objects);
+    assert(loaded);
+    assert(objects.size() == 2);
+    assert(objects[0].key == "a.bin" && objects[0].size == 10);
+    assert(objects[1].key == "c.bin" && objects[1].etag.empty() && objects[1].mtime == 0);
+
+    assert(!InventoryReader("Bucket, Key, ETag", "data", "").valid());
+
+    unlink((dir + "/part-0.csv").c_str());
+    unlink((dir + "/part-1.csv").c_str());
+    unlink((dir + "/manifest.json").c_str());
+    rmdir(dir.c_str());
+    std::cout << "test_versioned_report_directory: PASS\n";
+}
+
+void test_empty_report() {
+    std::string dir = temp_path("test_inventory_empty");
+    mkdir(dir.c_str(), 0755);
+    {
+        std::ofstream out(dir + "/part-0.csv.gz");  // Still compressed
+        out << "gzip";
+    }
+
+    InventoryReader reader(DEFAULT_INVENTORY_SCHEMA, "data", "shards");
+    std::vector<ObjectInfo> objects;
+    bool loaded = reader.load(dir, objects);
+    assert(!loaded);
+
+    // Rows, but none under the prefix
+    {
+        std::ofstream out(dir + "/part-0.csv");
+        out << "\"data\",\"other/x.tar\",\"5\",\"2024-03-01T12:00:00.000Z\",\"\"\n";
+    }
+    loaded = reader.load(dir, objects);
+    assert(!loaded);
+    loaded = reader.load(dir + "/part-0.csv", objects);
+    assert(!loaded);
+    assert(objects.empty());
+
+    unlink((dir + "/part-0.csv.gz").c_str());
+    unlink((dir + "/part-0.csv").c_str());
+    rmdir(dir.c_str());
+    std::cout << "test_empty_report: PASS\n";
+}
+
+int main() {
+    test_split_row();
+    test_decoding();
+    test_load_report();
+    test_versioned_report_directory();
+    test_empty_report();
+    std::cout << "All inventory tests passed!\n";
+    return 0;
+}
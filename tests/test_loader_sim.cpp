@@ -0,0 +1,165 @@
+#include "../src/loader_sim.hpp"
+#include <unistd.h>
+#include <cassert>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace valkyrie;
+
+// How many times all ranks together read each (file, offset)
+static std::map<std::pair<uint32_t, uint64_t>, int> coverage(const LoaderOptions& options,
+                                                             const std::vector<size_t>& sizes) {
+    std::map<std::pair<uint32_t, uint64_t>, int> seen;
+    for (int rank = 0; rank < options.processes; ++rank) {
+        for (const auto& read : plan_loader_reads(options, sizes, rank)) {
+            assert(read.offset + read.size <= sizes[read.file]);
+            seen[{read.file, read.offset}]++;
+        }
+    }
+    return seen;
+}
+
+void test_full_passes() {
+    std::vector<size_t> sizes = {10000, 4096, 9000, 1, 8192};
+    size_t chunks = 3 + 1 + 3 + 1 + 2;
+
+    // Every pattern but random reads each chunk exactly once per epoch
+    for (auto pattern : {LoadPattern::SEQUENTIAL, LoadPattern::SHUFFLED, LoadPattern::DDP}) {
+        LoaderOptions options;
+        options.pattern = pattern;
+        options.processes = 3;
+        options.epochs = 2;
+        options.read_size = 4096;
+
+        auto seen = coverage(options, sizes);
+        assert(seen.size() == chunks);
+        for (const auto& [range, count] : seen) {
+            assert(count == 2);
+        }
+    }
+
+    std::cout << "test_full_passes: PASS\n";
+}
+
+void test_patterns() {
+    std::vector<size_t> sizes(8, 4 * 4096);
+    LoaderOptions options;
+    options.processes = 2;
+    options.read_size = 4096;
+
+    // Sequential: rank 1 gets files 1, 3, 5, 7, each front to back
+    auto plan = plan_loader_reads(options, sizes, 1);
+    assert(plan.size() == 16);
+    assert(plan[0].file == 1 && plan[0].offset == 0 && plan[3].offset == 3 * 4096);
+    assert(plan[4].file == 3);
+
+    // Shuffled: a different file order each epoch, same for a given seed
+    options.pattern = LoadPattern::SHUFFLED;
+    options.epochs = 2;
+    auto shuffled = plan_loader_reads(options, sizes, 0);
+    assert(shuffled.size() == 32);
+    std::vector<uint32_t> epoch0, epoch1;
+    for (size_t i = 0; i < 16; i += 4) epoch0.push_back(shuffled[i].file);
+    for (size_t i = 16; i < 32; i += 4) epoch1.push_back(shuffled[i].file);
+    assert(epoch0 != epoch1);
+    auto again = plan_loader_reads(options, sizes, 0);
+    assert(again.size() == shuffled.size() && again[5].file == shuffled[5].file);
+
+    // DDP: ranks alternate records within each file
+    options.pattern = LoadPattern::DDP;
+    options.epochs = 1;
+    auto rank0 = plan_loader_reads(options, sizes, 0);
+    auto rank1 = plan_loader_reads(options, sizes, 1);
+    assert(rank0.size() == 16 && rank1.size() == 16);
+    assert(rank0[0].file == rank1[0].file);
+    assert(rank0[0].offset == 0 && rank1[0].offset == 4096 && rank0[1].offset == 2 * 4096);
+
+    // Random: small aligned reads, reproducible per rank
+    options.pattern = LoadPattern::RANDOM;
+    options.random_reads = 100;
+    options.read_size = 1024;
+    auto random = plan_loader_reads(options, sizes, 0);
+    assert(random.size() == 100);
+    std::set<uint32_t> files;
+    for (const auto& read : random) {
+        assert(read.offset % 4096 == 0 && read.size == 1024);
+        files.insert(read.file);
+    }
+    assert(files.size() > 1);
+    assert(plan_loader_reads(options, sizes, 1)[0].offset != random[0].offset ||
+           plan_loader_reads(options, sizes, 1)[0].file != random[0].file);
+
+    assert(parse_load_pattern("ddp") == LoadPattern::DDP);
+    assert(!parse_load_pattern("bogus").has_value());
+    assert(std::string(to_string(LoadPattern::SHUFFLED)) == "shuffled");
+    assert(plan_loader_reads(options, sizes, 2).empty());
+
+    std::cout << "test_patterns: PASS\n";
+}
+
+void test_result_merge() {
+    LoaderResult a, b;
+    for (uint64_t i = 1; i <= 98; ++i) a.record_read(100, 4096);
+    a.record_read(50000, 4096);
+    b.record_read(200000, 4096);
+    a.io_us = 1000;
+    a.wall_us = 4000;
+    b.io_us = 3000;
+    b.wall_us = 2000;
+
+    a.merge(b);
+    assert(a.reads == 100 && a.bytes == 100 * 4096);
+    assert(a.wall_us == 4000 && a.max_latency_us == 200000);
+
+    // Percentiles are bucket upper bounds, never above the observed max
+    assert(a.latency_percentile(50) >= 100 && a.latency_percentile(50) < 125);
+    assert(a.latency_percentile(99) >= 50000 && a.latency_percentile(99) < 62500);
+    assert(a.latency_percentile(100) == 200000);
+    assert(LoaderResult{}.latency_percentile(99) == 0);
+
+    assert(a.io_fraction(2) == 0.5);
+
+    std::cout << "test_result_merge: PASS\n";
+}
+
+void test_run_loader() {
+    char dir_template[] = "/tmp/test_loader_sim_XXXXXX";
+    std::string dir = mkdtemp(dir_template);
+    std::vector<std::string> files = {"a.bin", "b.bin"};
+    std::vector<size_t> sizes = {10000, 5000};
+    for (size_t i = 0; i < files.size(); ++i) {
+        std::ofstream(dir + "/" + files[i]) << std::string(sizes[i], 'x');
+    }
+
+    LoaderOptions options;
+    options.processes = 1;
+    options.read_size = 4096;
+    LoaderResult result;
+    assert(run_loader(dir, files, plan_loader_reads(options, sizes, 0), 0, false, result));
+    assert(result.reads == 5 && result.bytes == 15000 && result.errors == 0);
+    assert(result.io_us <= result.wall_us);
+
+    // A missing file is an error, not a crash
+    LoaderResult missing;
+    std::vector<std::string> gone = {"gone.bin"};
+    assert(!run_loader(dir, gone, {{0, 0, 4096}}, 0, false, missing));
+    assert(missing.errors == 1 && missing.reads == 0);
+
+    for (const auto& name : files) unlink((dir + "/" + name).c_str());
+    rmdir(dir.c_str());
+
+    std::cout << "test_run_loader: PASS\n";
+}
+
+int main() {
+    test_full_passes();
+    test_patterns();
+    test_result_merge();
+    test_run_loader();
+    std::cout << "All loader simulator tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,203 @@
+#include "../src/logger.hpp"
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace valkyrie;
+
+// Redirects stdout/stderr into strings for the lifetime of the object
+struct CapturedOutput {
+    std::ostringstream out, err;
+    std::streambuf* saved_out = std::cout.rdbuf(out.rdbuf());
+    std::streambuf* saved_err = std::cerr.rdbuf(err.rdbuf());
+
+    ~CapturedOutput() {
+        std::cout.rdbuf(saved_out);
+        std::cerr.rdbuf(saved_err);
+    }
+};
+
+static size_t count_lines(const std::string& text, const std::string& needle) {
+    size_t count = 0;
+    std::istringstream iss(text);
+    std::string line;
+    while (std::getline(iss, line)) {
+        if (line.find(needle) != std::string::npos) ++count;
+    }
+    return count;
+}
+
+void test_format_and_levels() {
+    Logger::set_level(LogLevel::INFO);
+    std::string out, err;
+    {
+        CapturedOutput captured;
+        std::string key = "shard_001.tar";
+        Logger::info("fuse", "Cache miss: ", key, " at offset ", size_t{4194304}, " ratio ", 0.5);
+        Logger::error("s3", "GetObject failed: ", "timeout", ' ', -3, " ", true);
+        Logger::debug("fuse", "filtered out");
+        Logger::warn("fuse", std::string(1000, 'x'));
+        out = captured.out.str();
+        err = captured.err.str();
+    }
+
+    // "YYYY-MM-DD HH:MM:SS.mmm [INFO] fuse: ..."
+    assert(out.size() > 24 && out[4] == '-' && out[10] == ' ' && out[19] == '.');
+    assert(out.find(" [INFO] fuse: Cache miss: shard_001.tar at offset 4194304 ratio 0.5\n")
+           != std::string::npos);
+    assert(err.find(" [ERROR] s3: GetObject failed: timeout -3 true\n") != std::string::npos);
+    assert(out.find("filtered out") == std::string::npos);
+
+    // Long messages are truncated, not overrun
+    assert(err.find(std::string(LogRecord::MAX_TEXT, 'x') + "\n") != std::string::npos);
+
+    std::cout << "test_format_and_levels: PASS\n";
+}
+
+void test_async_threads() {
+    constexpr int THREADS = 4;
+    constexpr int PER_THREAD = 50;
+
+    Logger::set_level(LogLevel::INFO);
+    Logger::set_rate_limit(0);
+    std::string out;
+    {
+        CapturedOutput captured;
+        Logger::start();
+        std::vector<std::thread> threads;
+        for (int t = 0; t < THREADS; ++t) {
+            threads.emplace_back([t]() {
+                for (int i = 0; i < PER_THREAD; ++i) {
+                    Logger::info("test", "thread ", t, " line ", i);
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        Logger::stop();
+        out = captured.out.str();
+    }
+    Logger::set_rate_limit(Logger::DEFAULT_RATE_LIMIT);
+
+    assert(count_lines(out, "[INFO] test: thread ") == THREADS * PER_THREAD);
+    for (int t = 0; t < THREADS; ++t) {
+        // Each thread's lines keep their order
+        size_t last = 0;
+        for (int i = 0; i < PER_THREAD; ++i) {
+            std::string line = "thread " + std::to_string(t) + " line " + std::to_string(i) + "\n";
+            size_t pos = out.find(line);
+            assert(pos != std::string::npos && pos >= last);
+            last = pos;
+        }
+    }
+
+    std::cout << "test_async_threads: PASS\n";
+}
+
+void test_exited_threads_reuse_rings() {
+    constexpr int THREADS = 10;
+
+    Logger::set_level(LogLevel::INFO);
+    std::string out;
+    size_t rings_before = Logger::thread_rings();
+    {
+        CapturedOutput captured;
+        Logger::start();
+        // One thread after another, each gone before the next flush
+        for (int t = 0; t < THREADS; ++t) {
+            std::thread([t]() { Logger::info("test", "short thread ", t); }).join();
+            std::this_thread::sleep_for(std::chrono::milliseconds(120));
+        }
+        Logger::stop();
+        out = captured.out.str();
+    }
+
+    // Each exited thread's ring was drained and handed to the next thread
+    assert(count_lines(out, "[INFO] test: short thread ") == THREADS);
+    assert(Logger::thread_rings() <= rings_before + 1);
+
+    std::cout << "test_exited_threads_reuse_rings: PASS\n";
+}
+
+void test_rate_limit() {
+    auto storm = []() {
+        for (int i = 0; i < 100; ++i) {
+            Logger::warn("fuse", "miss storm ", i);
+        }
+    };
+
+    Logger::set_level(LogLevel::INFO);
+    Logger::set_rate_limit(5);
+    std::string first, second;
+    {
+        CapturedOutput captured;
+        storm();
+        Logger::warn("fuse", "other call site");
+        first = captured.err.str();
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+        storm();
+        second = captured.err.str().substr(first.size());
+    }
+    Logger::set_rate_limit(Logger::DEFAULT_RATE_LIMIT);
+
+    // One window allows 5 lines; a second boundary mid-loop allows 5 more
+    size_t emitted = count_lines(first, "miss storm");
+    assert(emitted >= 5 && emitted <= 10);
+    assert(count_lines(first, "other call site") == 1);
+
+    // The next admitted line reports what was dropped
+    assert(second.find("similar lines suppressed)") != std::string::npos);
+
+    std::cout << "test_rate_limit: PASS\n";
+}
+
+void test_full_ring_drops() {
+    constexpr int LINES = 5000;
+
+    Logger::set_level(LogLevel::INFO);
+    Logger::set_rate_limit(0);
+    uint64_t dropped_before = Logger::dropped();
+    std::string out, err;
+    {
+        // Far more lines than a ring holds between flushes: the excess is
+        // dropped (and reported) instead of blocking the caller
+        CapturedOutput captured;
+        Logger::start();
+        for (int i = 0; i < LINES; ++i) {
+            Logger::info("test", "burst ", i);
+        }
+        Logger::stop();
+        out = captured.out.str();
+        err = captured.err.str();
+    }
+    Logger::set_rate_limit(Logger::DEFAULT_RATE_LIMIT);
+
+    uint64_t dropped = Logger::dropped() - dropped_before;
+    assert(count_lines(out, "burst ") + dropped == LINES);
+    assert(dropped == 0 || err.find("lines dropped (log ring full)") != std::string::npos);
+
+    std::cout << "test_full_ring_drops: PASS\n";
+}
+
+void test_parse_level() {
+    assert(Logger::parse_level("debug") == LogLevel::DEBUG);
+    assert(Logger::parse_level("warning") == LogLevel::WARN);
+    assert(Logger::parse_level("error") == LogLevel::ERROR);
+    assert(!Logger::parse_level("loud").has_value());
+    std::cout << "test_parse_level: PASS\n";
+}
+
+int main() {
+    test_format_and_levels();
+    test_async_threads();
+    test_exited_threads_reuse_rings();
+    test_rate_limit();
+    test_full_ring_drops();
+    test_parse_level();
+    std::cout << "All Logger tests passed!\n";
+    return 0;
+}
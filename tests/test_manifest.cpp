@@ -0,0 +1,141 @@
+#include "../src/manifest.hpp"
+#include "../src/shuffle.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+using namespace valkyrie;
+
+void test_plain_manifest() {
+    Manifest manifest;
+    bool loaded = manifest.load("tests/test_manifest.txt");
+    assert(loaded);
+    assert(manifest.size() == 5);
+    assert(!manifest.shuffle().has_value());
+
+    assert(manifest.find("shard_003.bin") == 2u);
+    assert(!manifest.find("shard_004.bin").has_value());
+
+    std::cout << "test_plain_manifest: PASS\n";
+}
+
+void test_shuffle_directive() {
+    Manifest manifest;
+    bool loaded = manifest.load("tests/test_shuffled_manifest.txt");
+    assert(loaded);
+    assert(manifest.size() == 10);
+    assert(manifest.shuffle().has_value());
+    assert(manifest.shuffle()->algorithm == SHUFFLE_PCG32_FISHER_YATES);
+    assert(manifest.shuffle()->seed == 42);
+    assert(manifest.shuffle()->epoch == 0);
+
+    std::cout << "test_shuffle_directive: PASS\n";
+}
+
+void test_invalid_directive() {
+    const std::string path = "/tmp/valkyrie_test_bad_manifest.txt";
+    {
+        std::ofstream out(path);
+        out << "#@shuffle mt19937 seed=1\nshard_0.bin\n";
+    }
+
+    Manifest manifest;
+    bool loaded = manifest.load(path);
+    assert(!loaded);
+
+    {
+        std::ofstream out(path);
+        out << "#@shuffle pcg32-fisher-yates epoch=3\nshard_0.bin\n";  // Missing seed
+    }
+    loaded = manifest.load(path);
+    assert(!loaded);
+
+    std::remove(path.c_str());
+    std::cout << "test_invalid_directive: PASS\n";
+}
+
+void test_pcg32_reference_stream() {
+    // First outputs of pcg32-demo (pcg32_srandom_r(&rng, 42u, 54u))
+    Pcg32 rng(42u, 54u);
+    const uint32_t expected[] = {0xa15c02b7u, 0x7b47f409u, 0xba1d3330u, 0x83d2f293u};
+    for (uint32_t value : expected) {
+        uint32_t output = rng.next();
+        assert(output == value);
+    }
+
+    std::cout << "test_pcg32_reference_stream: PASS\n";
+}
+
+void test_shuffled_order() {
+    auto epoch0 = shuffled_order(10, 42, 0);
+    assert((epoch0 == std::vector<uint32_t>{1, 6, 7, 8, 4, 3, 9, 5, 2, 0}));
+
+    // Deterministic per (seed, epoch), a permutation, and different across epochs
+    assert(shuffled_order(10, 42, 0) == epoch0);
+    auto epoch1 = shuffled_order(10, 42, 1);
+    assert(epoch1 != epoch0);
+
+    auto sorted = epoch1;
+    std::sort(sorted.begin(), sorted.end());
+    for (uint32_t i = 0; i < 10; ++i) {
+        assert(sorted[i] == i);
+    }
+
+    assert(shuffled_order(0, 42, 0).empty());
+    assert(shuffled_order(1, 42, 0) == std::vector<uint32_t>{0});
+
+    std::cout << "test_shuffled_order: PASS\n";
+}
+
+void test_size_columns() {
+    const std::string path = "/tmp/valkyrie_test_sized_manifest.txt";
+    {
+        std::ofstream out(path);
+        out << "train/a.tar\t1000\t0123456789abcdef0123456789abcdef\n"
+            << "train/b c.tar\t2000\n"  // Spaces belong to the key
+            << "train/d.tar\t0\t\"etag-2\"\n";
+    }
+
+    Manifest manifest;
+    bool loaded = manifest.load(path);
+    assert(loaded);
+    assert(manifest.size() == 3 && manifest.has_sizes());
+    assert(manifest.entries()[1] == "train/b c.tar");
+    assert(manifest.find("train/a.tar") == 0u);
+
+    const auto& objects = manifest.objects();
+    assert(objects[0].size == 1000 && objects[0].etag == "\"0123456789abcdef0123456789abcdef\"");
+    assert(objects[1].size == 2000 && objects[1].etag.empty());
+    assert(objects[2].size == 0 && objects[2].etag == "\"etag-2\"");
+
+    // Sizes on some entries only: not a complete namespace
+    {
+        std::ofstream out(path);
+        out << "train/a.tar\t1000\ntrain/b.tar\n";
+    }
+    loaded = manifest.load(path);
+    assert(loaded && manifest.size() == 2 && !manifest.has_sizes());
+
+    {
+        std::ofstream out(path);
+        out << "train/a.tar\tbig\n";
+    }
+    loaded = manifest.load(path);
+    assert(!loaded);
+
+    std::remove(path.c_str());
+    std::cout << "test_size_columns: PASS\n";
+}
+
+int main() {
+    test_plain_manifest();
+    test_shuffle_directive();
+    test_invalid_directive();
+    test_size_columns();
+    test_pcg32_reference_stream();
+    test_shuffled_order();
+    std::cout << "All Manifest tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,178 @@
+#include "../src/markov_model.hpp"
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace valkyrie;
+
+void test_first_order() {
+    MarkovModel model;
+
+    // Non-numeric order that repeats
+    for (int run = 0; run < 2; ++run) {
+        model.observe("eval/c.bin");
+        model.observe("eval/a.bin");
+        model.observe("eval/b.bin");
+    }
+
+    model.observe("eval/c.bin");
+    auto next = model.predict(2);
+    assert(next.size() == 2);
+    assert(next[0] == "eval/a.bin");
+    assert(next[1] == "eval/b.bin");
+
+    std::cout << "test_first_order: PASS\n";
+}
+
+void test_second_order_disambiguates() {
+    MarkovModel model;
+
+    // After "x", the next key depends on what came before it
+    for (int run = 0; run < 3; ++run) {
+        model.observe("a");
+        model.observe("x");
+        model.observe("b");
+        model.observe("c");
+        model.observe("x");
+        model.observe("d");
+    }
+
+    model.observe("a");
+    model.observe("x");
+    auto after_ax = model.predict(1);
+    assert(after_ax.size() == 1 && after_ax[0] == "b");
+
+    model.observe("c");
+    model.observe("x");
+    auto after_cx = model.predict(1);
+    assert(after_cx.size() == 1 && after_cx[0] == "d");
+
+    std::cout << "test_second_order_disambiguates: PASS\n";
+}
+
+void test_repeated_open_ignored() {
+    MarkovModel model;
+
+    model.observe("a");
+    model.observe("a");
+    model.observe("b");
+    model.observe("a");
+
+    auto next = model.predict(1);
+    assert(next.size() == 1 && next[0] == "b");
+    assert(model.num_keys() == 2);
+
+    std::cout << "test_repeated_open_ignored: PASS\n";
+}
+
+void test_unknown_state() {
+    MarkovModel model;
+    assert(model.predict(3).empty());
+
+    model.observe("never_followed");
+    assert(model.predict(3).empty());
+
+    std::cout << "test_unknown_state: PASS\n";
+}
+
+void test_trace_round_trip() {
+    const std::string path = "/tmp/valkyrie_test_markov_trace.txt";
+
+    {
+        MarkovModel recorder;
+        recorder.observe("s3.bin");
+        recorder.observe("s1.bin");
+        recorder.observe("s2.bin");
+        bool saved = recorder.save_trace(path);
+        assert(saved);
+    }
+
+    MarkovModel model;
+    bool loaded = model.load_trace(path);
+    assert(loaded);
+    assert(model.num_keys() == 3);
+
+    // Live stream picks up the learned transitions
+    model.observe("s3.bin");
+    auto next = model.predict(2);
+    assert(next.size() == 2);
+    assert(next[0] == "s1.bin" && next[1] == "s2.bin");
+
+    loaded = model.load_trace("/nonexistent/trace.txt");
+    assert(!loaded);
+
+    std::remove(path.c_str());
+    std::cout << "test_trace_round_trip: PASS\n";
+}
+
+void test_key_table_bounded() {
+    MarkovModel model(4, 8);
+
+    // Every access a new key: slots of old keys are reused
+    for (int i = 0; i < 100; ++i) {
+        model.observe("k" + std::to_string(i));
+        assert(model.num_keys() <= 8);
+    }
+
+    // The recent order is still learned
+    model.observe("k97");
+    auto next = model.predict(1);
+    assert(next.size() == 1 && next[0] == "k98");
+
+    // Transitions into evicted keys are not predicted as the slot's new key
+    model.observe("k10");
+    assert(model.predict(1).empty());
+
+    std::cout << "test_key_table_bounded: PASS\n";
+}
+
+void test_trace_carried_over() {
+    const std::string path = "/tmp/valkyrie_test_markov_carry.txt";
+
+    {
+        std::ofstream trace(path);
+        trace << "a\nb\nc\n";
+    }
+
+    MarkovModel model(4, 16);
+    bool loaded = model.load_trace(path);
+    assert(loaded);
+
+    for (int i = 0; i < 10; ++i) {
+        model.observe("n" + std::to_string(i));
+    }
+
+    model.observe("a");
+    auto next = model.predict(1);
+    assert(next.size() == 1 && next[0] == "b");
+
+    // The loaded keys are carried into the saved trace
+    bool saved = model.save_trace(path);
+    assert(saved);
+    std::ifstream saved_trace(path);
+    std::string line;
+    std::vector<std::string> keys;
+    while (std::getline(saved_trace, line)) {
+        if (!line.empty() && line[0] != '#') keys.push_back(line);
+    }
+    assert(keys.size() == 14);
+    assert(keys[0] == "a" && keys[1] == "b" && keys[2] == "c" && keys[3] == "n0");
+
+    std::remove(path.c_str());
+    std::cout << "test_trace_carried_over: PASS\n";
+}
+
+int main() {
+    test_first_order();
+    test_second_order_disambiguates();
+    test_repeated_open_ignored();
+    test_unknown_state();
+    test_trace_round_trip();
+    test_key_table_bounded();
+    test_trace_carried_over();
+    std::cout << "All MarkovModel tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,222 @@
+#include "../src/metadata_store.hpp"
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace valkyrie;
+
+static const std::string MD5 = "\"0123456789abcdef0123456789abcdef\"";
+
+static std::string temp_path(const char* name) {
+    return "/tmp/" + std::string(name) + "_" + std::to_string(getpid()) + ".snap";
+}
+
+static std::vector<ObjectInfo> make_keys(size_t dirs, size_t per_dir) {
+    std::vector<ObjectInfo> objects;
+    char key[64];
+    for (size_t d = 0; d < dirs; ++d) {
+        for (size_t i = 0; i < per_dir; ++i) {
+            snprintf(key, sizeof(key), "train/part-%04zu/shard-%06zu.tar", d, i);
+            objects.push_back({key, d * per_dir + i});
+        }
+    }
+    return objects;
+}
+
+void test_build_and_find() {
+    // Unsorted, with a duplicate: the last one wins
+    MetadataStore store({
+        {"b", 2}, {"a", 1}, {"c", 3}, {"a", 10},
+        {std::string(MetadataStore::MAX_KEY_BYTES + 1, 'x'), 4},
+    });
+    assert(store.size() == 3);
+    assert(store.dropped_keys() == 1);
+    assert(store.key_at(0) == "a" && store.size_at(0) == 10);
+    assert(store.find("c") == std::optional<size_t>(2));
+    assert(!store.find("bb") && !store.find("") && !store.find("d"));
+
+    MetadataStore empty;
+    assert(empty.empty() && !empty.find("a") && empty.lower_bound("a") == 0);
+
+    std::cout << "test_build_and_find: PASS\n";
+}
+
+void test_block_boundaries() {
+    auto objects = make_keys(3, 50);  // 150 keys, blocks of 16
+    MetadataStore store(objects);
+    assert(store.size() == objects.size());
+
+    // Input is already sorted, so indexes match
+    for (size_t i = 0; i < objects.size(); ++i) {
+        assert(store.find(objects[i].key) == std::optional<size_t>(i));
+        assert(store.key_at(i) == objects[i].key);
+        assert(store.size_at(i) == objects[i].size);
+    }
+
+    size_t i = 0;
+    for (MetadataStore::Cursor cursor(store, 0); cursor.valid(); cursor.next(), ++i) {
+        assert(cursor.key() == objects[i].key);
+    }
+    assert(i == objects.size());
+
+    assert(store.lower_bound("train/part-0001/") == 50);
+    assert(store.lower_bound("train/part-0001", "0") == 100);
+    assert(store.lower_bound("zzz") == store.size());
+    assert(store.lower_bound("") == 0);
+
+    std::cout << "test_block_boundaries: PASS\n";
+}
+
+void test_has_prefix() {
+    MetadataStore store({{"data/a", 1}, {"data2/b", 2}, {"datb", 3}});
+    assert(store.has_prefix("data", "/"));
+    assert(store.has_prefix("data2", "/"));
+    assert(!store.has_prefix("dat", "/"));
+    assert(!store.has_prefix("data/a", "/"));
+    assert(store.has_prefix("", ""));
+
+    std::cout << "test_has_prefix: PASS\n";
+}
+
+void test_list_directory() {
+    auto objects = make_keys(4, 40);
+    objects.push_back({"README", 10});
+    objects.push_back({"train/", 0});  // Directory marker
+    objects.push_back({"train/labels.csv", 50});
+    objects.push_back({"train.txt", 5});  // Sorts between "train" and "train/"
+    MetadataStore store(objects);
+
+    std::vector<ObjectInfo> files;
+    std::vector<std::string> subdirs;
+    store.list_directory("", files, subdirs);
+    assert(files.size() == 2 && files[0].key == "README" && files[1].key == "train.txt");
+    assert((subdirs == std::vector<std::string>{"train"}));
+
+    files.clear();
+    subdirs.clear();
+    store.list_directory("train", files, subdirs);
+    assert(files.size() == 1 && files[0].key == "labels.csv" && files[0].size == 50);
+    assert(subdirs.size() == 4 && subdirs[0] == "part-0000" && subdirs[3] == "part-0003");
+
+    files.clear();
+    subdirs.clear();
+    store.list_directory("train/part-0002", files, subdirs);
+    assert(files.size() == 40 && subdirs.empty());
+    assert(files[0].key == "shard-000000.tar" && files[0].size == 80);
+
+    files.clear();
+    store.list_directory("missing", files, subdirs);
+    assert(files.empty() && subdirs.empty());
+
+    std::cout << "test_list_directory: PASS\n";
+}
+
+void test_etags() {
+    std::string multipart = "\"0123456789abcdef0123456789abcdef-12\"";
+    std::string other = "\"not-an-md5\"";
+    MetadataStore store({
+        {"a", 1, MD5, 1700000000},
+        {"b", 2, multipart},
+        {"c", 3, other},
+        {"d", 4},
+        {"e", 5, "\"0123456789ABCDEF0123456789ABCDEF\""},  // Uppercase: stored verbatim
+    });
+    assert(store.etag_at(0) == MD5 && store.mtime_at(0) == 1700000000);
+    assert(store.etag_at(1) == multipart);
+    assert(store.etag_at(2) == other);
+    assert(store.etag_at(3).empty() && store.mtime_at(3) == 0);
+    assert(store.etag_at(4) == "\"0123456789ABCDEF0123456789ABCDEF\"");
+
+    std::cout << "test_etags: PASS\n";
+}
+
+void test_memory() {
+    auto objects = make_keys(100, 1000);  // 100,000 keys
+    size_t raw = 0;
+    for (auto& obj : objects) {
+        obj.etag = MD5;
+        raw += obj.key.size() + obj.etag.size() + sizeof(obj.size);
+    }
+    MetadataStore store(objects);
+
+    // Shared prefixes are stored once per block, ETags as 16 bytes: below
+    // the raw bytes alone, before any std::string or hash node overhead
+    assert(store.memory_bytes() < raw * 2 / 3);
+    assert(store.find("train/part-0099/shard-000999.tar") == std::optional<size_t>(99999));
+
+    std::cout << "test_memory: PASS (" << store.memory_bytes() / 1024 << " KB for "
+              << raw / 1024 << " KB of keys and ETags)\n";
+}
+
+void test_snapshot_round_trip() {
+    auto objects = make_keys(5, 100);
+    objects[0].etag = MD5;
+    objects[1].etag = "\"0123456789abcdef0123456789abcdef-3\"";
+    objects[2].etag = "\"opaque\"";
+    objects[3].mtime = 1700000000;
+    MetadataStore store(objects);
+
+    std::string path = temp_path("test_snapshot");
+    bool saved = store.save(path, "s3://bucket/prefix");
+    assert(saved);
+
+    auto mapped = MetadataStore::open_snapshot(path, "s3://bucket/prefix");
+    assert(mapped && mapped->mapped() && !store.mapped());
+    assert(mapped->size() == store.size());
+    assert(mapped->memory_bytes() < store.memory_bytes());  // Arrays are in the mapping
+    for (size_t i = 0; i < store.size(); ++i) {
+        assert(mapped->key_at(i) == store.key_at(i));
+        assert(mapped->size_at(i) == store.size_at(i));
+        assert(mapped->mtime_at(i) == store.mtime_at(i));
+        assert(mapped->etag_at(i) == store.etag_at(i));
+    }
+    assert(mapped->find("train/part-0004/shard-000099.tar") == std::optional<size_t>(499));
+
+    auto changes = MetadataStore::compare(store, *mapped);
+    assert(changes.added == 0 && changes.removed == 0 && changes.changed == 0);
+
+    // Snapshots of another bucket or prefix are not used
+    assert(!MetadataStore::open_snapshot(path, "s3://bucket/other"));
+    assert(!MetadataStore::open_snapshot(path + ".missing", "s3://bucket/prefix"));
+
+    // Nor truncated ones
+    std::ifstream in(path, std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    std::ofstream(path, std::ios::binary | std::ios::trunc).write(bytes.data(), bytes.size() / 2);
+    assert(!MetadataStore::open_snapshot(path, "s3://bucket/prefix"));
+
+    unlink(path.c_str());
+    std::cout << "test_snapshot_round_trip: PASS\n";
+}
+
+void test_compare() {
+    MetadataStore before({{"a", 1, MD5}, {"b", 2}, {"c", 3}, {"d", 4}});
+    MetadataStore now({{"a", 1, "\"ffffffffffffffffffffffffffffffff\""}, {"b", 2}, {"c", 30},
+                       {"e", 5}, {"f", 6}});
+    auto changes = MetadataStore::compare(before, now);
+    assert(changes.added == 2);    // e, f
+    assert(changes.removed == 1);  // d
+    assert(changes.changed == 2);  // a (ETag), c (size)
+
+    changes = MetadataStore::compare(MetadataStore(), now);
+    assert(changes.added == now.size() && changes.removed == 0);
+
+    std::cout << "test_compare: PASS\n";
+}
+
+int main() {
+    test_build_and_find();
+    test_block_boundaries();
+    test_has_prefix();
+    test_list_directory();
+    test_etags();
+    test_memory();
+    test_snapshot_round_trip();
+    test_compare();
+    std::cout << "All metadata store tests passed!\n";
+    return 0;
+}
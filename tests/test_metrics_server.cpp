@@ -0,0 +1,216 @@
+#include "../src/metrics_server.hpp"
+#include <aws/core/Aws.h>
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace valkyrie;
+
+struct Fixture {
+    CacheManager cache{16 * 1024 * 1024};
+    S3Config config{"test", "us-east-1", ""};
+    S3WorkerPool pool{config, cache, 2};
+    Predictor predictor{cache, pool, 3};
+    ReadStats read_stats;
+};
+
+// Value of the first sample line starting with `series`
+static double sample(const std::string& text, const std::string& series) {
+    std::istringstream iss(text);
+    std::string line;
+    while (std::getline(iss, line)) {
+        if (line.rfind(series + " ", 0) == 0) {
+            return std::stod(line.substr(series.size() + 1));
+        }
+    }
+    assert(false && "series not found");
+    return 0;
+}
+
+static std::string http_get(int port, const std::string& target) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int rc = ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    assert(rc == 0);
+
+    std::string request = "GET " + target + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    ssize_t sent = ::send(fd, request.data(), request.size(), 0);
+    assert(sent > 0);
+
+    std::string response;
+    char buf[4096];
+    ssize_t n;
+    while ((n = ::recv(fd, buf, sizeof(buf), 0)) > 0) {
+        response.append(buf, n);
+    }
+    ::close(fd);
+    return response;
+}
+
+void test_histogram_exposition() {
+    Fixture f;
+    MetricsServer server(0, f.cache, f.pool, f.predictor);
+    server.set_read_stats(&f.read_stats);
+
+    f.read_stats.hit_latency_us.record(50);
+    f.read_stats.hit_latency_us.record(70);
+    f.read_stats.hit_latency_us.record(3000);
+    f.read_stats.miss_latency_us.record(40000);
+    f.read_stats.bytes_read += 4096;
+
+    std::string text = server.generate_prometheus_metrics();
+
+    assert(text.find("# TYPE valkyrie_read_latency_seconds histogram") != std::string::npos);
+    assert(sample(text, "valkyrie_read_latency_seconds_count{result=\"hit\"}") == 3);
+    assert(sample(text, "valkyrie_read_latency_seconds_bucket{result=\"hit\",le=\"+Inf\"}") == 3);
+    assert(sample(text, "valkyrie_read_latency_seconds_sum{result=\"hit\"}") == 0.00312);
+    assert(sample(text, "valkyrie_read_latency_seconds_count{result=\"miss\"}") == 1);
+    assert(sample(text, "valkyrie_read_bytes_total") == 4096);
+
+    // Power-of-two buckets: 50 and 70us fall in [64,127]'s cumulative count, 3ms does not
+    assert(sample(text, "valkyrie_read_latency_seconds_bucket{result=\"hit\",le=\"0.000127\"}") == 2);
+    assert(sample(text, "valkyrie_read_latency_seconds_bucket{result=\"hit\",le=\"0.004095\"}") == 3);
+
+    // Buckets are cumulative
+    std::istringstream iss(text);
+    std::string line;
+    double previous = 0;
+    const std::string prefix = "valkyrie_read_latency_seconds_bucket{result=\"hit\"";
+    while (std::getline(iss, line)) {
+        if (line.rfind(prefix, 0) != 0) continue;
+        double value = std::stod(line.substr(line.rfind(' ') + 1));
+        assert(value >= previous);
+        previous = value;
+    }
+
+    // Empty histograms still expose a +Inf bucket per label set
+    assert(sample(text, "valkyrie_queue_wait_seconds_count{priority=\"urgent\"}") == 0);
+    assert(sample(text, "valkyrie_queue_wait_seconds_bucket{priority=\"background\",le=\"+Inf\"}") == 0);
+    assert(sample(text, "valkyrie_s3_ttfb_seconds_count") == 0);
+
+    // Prefetch lead time is a histogram per source
+    f.cache.insert_chunk("prefetched", 0, std::vector<char>(1024), CacheZone::PREFETCH,
+                         PredictionSource::MANIFEST);
+    f.cache.access("prefetched", 0);
+    text = server.generate_prometheus_metrics();
+    assert(text.find("# TYPE valkyrie_prefetch_lead_time_seconds histogram") != std::string::npos);
+    assert(sample(text, "valkyrie_prefetch_lead_time_seconds_count{source=\"manifest\"}") == 1);
+    assert(sample(text, "valkyrie_prefetch_lead_time_seconds_bucket{source=\"manifest\",le=\"+Inf\"}") == 1);
+    assert(sample(text, "valkyrie_prefetch_lead_time_seconds_count{source=\"sequential\"}") == 0);
+
+    // Stall accounting: seconds blocked vs served, per reader and file
+    f.read_stats.stalls.record(42, "slow \"file\".bin", 4096, 40000, 38000, true);
+    f.read_stats.stalls.record(42, "fast.bin", 4096, 2000, 0, false);
+    text = server.generate_prometheus_metrics();
+    assert(sample(text, "valkyrie_read_seconds_total{state=\"stalled\"}") == 0.038);
+    assert(sample(text, "valkyrie_read_seconds_total{state=\"served\"}") == 0.004);
+    assert(sample(text, "valkyrie_reader_stall_seconds_total{pid=\"42\"}") == 0.038);
+    assert(sample(text, "valkyrie_reader_read_bytes_total{pid=\"42\"}") == 8192);
+    double ratio = sample(text, "valkyrie_reader_data_stall_ratio{pid=\"42\"}");
+    assert(ratio > 0 && ratio <= 1);
+    assert(sample(text, "valkyrie_data_stall_ratio") == ratio);
+    assert(sample(text, "valkyrie_file_stall_seconds_total{key=\"slow \\\"file\\\".bin\"}") == 0.038);
+    assert(text.find("key=\"fast.bin\"") == std::string::npos);  // Never stalled
+
+    std::cout << "test_histogram_exposition: PASS\n";
+}
+
+void test_download_histograms() {
+    Fixture f;
+    f.pool.set_range_fetcher([](const std::string&, size_t, size_t size, std::vector<char>& data) {
+        usleep(2000);
+        data.assign(size, 'x');
+        return true;
+    });
+    f.pool.start();
+
+    bool fetched = f.pool.submit("a.bin", 0, 1024 * 1024, Priority::URGENT).get();
+    assert(fetched);
+    fetched = f.pool.submit("b.bin", 0, 1024 * 1024, Priority::NORMAL,
+                            PredictionSource::SEQUENTIAL).get();
+    assert(fetched);
+
+    const auto& stats = f.pool.get_stats();
+    assert(stats.queue_wait(Priority::URGENT).count() == 1);
+    assert(stats.queue_wait(Priority::NORMAL).count() == 1);
+    assert(stats.queue_wait(Priority::BACKGROUND).count() == 0);
+    assert(stats.throughput_bytes_per_sec.count() == 2);
+    assert(stats.throughput_bytes_per_sec.percentile(100) < 1024ULL * 1024 * 1000);  // >= 1ms each
+    assert(stats.ttfb_us.count() == 0);  // Not observable through a range fetcher
+
+    MetricsServer server(0, f.cache, f.pool, f.predictor);
+    std::string text = server.generate_prometheus_metrics();
+    assert(sample(text, "valkyrie_queue_wait_seconds_count{priority=\"normal\"}") == 1);
+    assert(sample(text, "valkyrie_s3_throughput_bytes_per_second_count") == 2);
+    assert(sample(text, "valkyrie_cache_chunks") == 2);
+    assert(sample(text, "valkyrie_cache_files") == 2);
+    assert(sample(text, "valkyrie_cache_size_bytes") == 2 * 1024 * 1024);
+    assert(sample(text, "valkyrie_cache_zone_bytes{zone=\"hot\"}") +
+           sample(text, "valkyrie_cache_zone_bytes{zone=\"prefetch\"}") == 2 * 1024 * 1024);
+    assert(sample(text, "valkyrie_cache_pinned_bytes") == 0);
+    assert(sample(text, "valkyrie_downloads_succeeded_total") == 2);
+    assert(sample(text, "valkyrie_prediction_rounds_total{predictor=\"markov\"}") == 0);
+    assert(sample(text, "valkyrie_parquet_footers_total{result=\"error\"}") == 0);
+
+    // Tar indexing is only exported when an indexer is attached
+    assert(text.find("valkyrie_tar_members_indexed_total") == std::string::npos);
+    TarIndexer tar_indexer(f.cache);
+    server.set_tar_indexer(&tar_indexer);
+    text = server.generate_prometheus_metrics();
+    assert(sample(text, "valkyrie_tar_archives_indexed_total") == 0);
+
+    // Read latency is only exported when the FUSE layer provides it
+    assert(text.find("valkyrie_read_latency_seconds") == std::string::npos);
+
+    f.pool.shutdown();
+    std::cout << "test_download_histograms: PASS\n";
+}
+
+void test_http_round_trip() {
+    Fixture f;
+    MetricsServer server(0, f.cache, f.pool, f.predictor);
+    bool started = server.start();
+    assert(started);
+    assert(server.get_port() > 0);
+
+    std::string response = http_get(server.get_port(), "/metrics");
+    assert(response.rfind("HTTP/1.0 200 OK\r\n", 0) == 0);
+    assert(response.find("Content-Type: text/plain; version=0.0.4") != std::string::npos);
+
+    size_t body_start = response.find("\r\n\r\n") + 4;
+    size_t length_pos = response.find("Content-Length: ") + std::strlen("Content-Length: ");
+    assert(std::stoul(response.substr(length_pos)) == response.size() - body_start);
+    assert(sample(response.substr(body_start), "valkyrie_cache_size_bytes") == 0);
+
+    response = http_get(server.get_port(), "/other");
+    assert(response.rfind("HTTP/1.0 404", 0) == 0);
+
+    server.stop();
+
+    MetricsServer unbindable(0, f.cache, f.pool, f.predictor);
+    unbindable.set_bind_address("not-an-address");
+    started = unbindable.start();
+    assert(!started);
+    std::cout << "test_http_round_trip: PASS\n";
+}
+
+int main() {
+    Aws::SDKOptions sdk_options;
+    Aws::InitAPI(sdk_options);
+
+    test_histogram_exposition();
+    test_download_histograms();
+    test_http_round_trip();
+    std::cout << "All MetricsServer tests passed!\n";
+
+    Aws::ShutdownAPI(sdk_options);
+    return 0;
+}
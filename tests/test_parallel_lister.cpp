@@ -0,0 +1,164 @@
+#include "../src/parallel_lister.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace valkyrie;
+
+// Sorted keys served 100 at a time, like ListObjectsV2 with StartAfter.
+// Each page takes 200us, so listers are idle while others wait on S3.
+static PageFetcher bucket_fetcher(const std::vector<ObjectInfo>& bucket, std::atomic<int>& requests) {
+    return [&bucket, &requests](const std::string& start_after) {
+        requests++;
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        auto it = std::upper_bound(bucket.begin(), bucket.end(), start_after,
+                                   [](const std::string& key, const ObjectInfo& obj) { return key < obj.key; });
+        ListPage page;
+        while (it != bucket.end() && page.objects.size() < 100) {
+            page.objects.push_back(*it++);
+        }
+        page.truncated = it != bucket.end();
+        return page;
+    };
+}
+
+static std::vector<ObjectInfo> make_bucket(size_t flat, size_t dirs, size_t per_dir) {
+    std::vector<ObjectInfo> bucket;
+    char key[64];
+    for (size_t i = 0; i < flat; ++i) {
+        snprintf(key, sizeof(key), "data/shard_%06zu.bin", i);
+        bucket.push_back({key, i});
+    }
+    for (size_t d = 0; d < dirs; ++d) {
+        for (size_t i = 0; i < per_dir; ++i) {
+            snprintf(key, sizeof(key), "data/train/part-%04zu/%05zu.tar", d, i);
+            bucket.push_back({key, d * per_dir + i});
+        }
+    }
+    std::sort(bucket.begin(), bucket.end(),
+              [](const ObjectInfo& a, const ObjectInfo& b) { return a.key < b.key; });
+    return bucket;
+}
+
+// Pure, and only called from assert(): unused in NDEBUG builds
+[[maybe_unused]] static bool same_keys(const std::vector<ObjectInfo>& a, const std::vector<ObjectInfo>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].key != b[i].key || a[i].size != b[i].size) return false;
+    }
+    return true;
+}
+
+void test_key_midpoint() {
+    std::vector<std::pair<std::string, std::string>> cases = {
+        {"a", "b"}, {"shard_000100.bin", "shard_009999.bin"}, {"data/x", ""},
+        {"", "zzz"}, {"abc", "abd"}, {"part-1/", "part-2/"}, {"ab", "ab~~~"},
+    };
+    for (const auto& [lo, hi] : cases) {
+        std::string mid = key_midpoint(lo, hi);
+        assert(!mid.empty());
+        assert(lo < mid);
+        assert(hi.empty() || mid < hi);
+    }
+
+    // Splits keep the common prefix
+    assert(key_midpoint("data/shard_000100", "data/shard_009999").compare(0, 11, "data/shard_") == 0);
+
+    // Nothing between adjacent or equal keys, and no splitting non-ASCII keys
+    assert(key_midpoint("abc", "abc").empty());
+    assert(key_midpoint("abc", "abc ").empty());
+    assert(key_midpoint("caf\xc3\xa9", "cag").empty());
+
+    std::cout << "test_key_midpoint: PASS\n";
+}
+
+void test_flat_namespace() {
+    // No split points: one range that splits itself across idle listers
+    auto bucket = make_bucket(20000, 0, 0);
+    std::atomic<int> requests{0};
+    ListStats stats;
+    auto listed = list_partitioned(bucket_fetcher(bucket, requests), {}, 8, &stats);
+
+    assert(same_keys(listed, bucket));
+    assert(stats.partitions > 1);
+    assert(stats.requests == static_cast<size_t>(requests.load()));
+    // Split ranges overlap by at most a page each
+    assert(stats.requests < 200 + 2 * stats.partitions);
+
+    std::cout << "test_flat_namespace: PASS (" << stats.partitions << " partitions, "
+              << stats.requests << " requests)\n";
+}
+
+void test_split_points() {
+    auto bucket = make_bucket(500, 40, 300);  // 12,500 objects
+    std::vector<std::string> split_points = {"data/shard_", "data/train/"};
+    for (int d = 0; d < 40; d += 10) {
+        char prefix[32];
+        snprintf(prefix, sizeof(prefix), "data/train/part-%04d/", d);
+        split_points.push_back(prefix);
+    }
+    std::sort(split_points.begin(), split_points.end());
+
+    for (int threads : {1, 4, 16}) {
+        std::atomic<int> requests{0};
+        ListStats stats;
+        auto listed = list_partitioned(bucket_fetcher(bucket, requests), split_points, threads, &stats);
+        assert(same_keys(listed, bucket));
+        assert(stats.partitions >= split_points.size() + 1);
+    }
+
+    std::cout << "test_split_points: PASS\n";
+}
+
+void test_no_object_cap() {
+    // Far past the old 1000-page limit at 100 keys per page
+    auto bucket = make_bucket(150000, 0, 0);
+    std::atomic<int> requests{0};
+    auto listed = list_partitioned(bucket_fetcher(bucket, requests), {}, 4);
+    assert(listed.size() == 150000);
+    assert(requests > 1000);
+
+    std::cout << "test_no_object_cap: PASS\n";
+}
+
+void test_errors_and_cancel() {
+    auto bucket = make_bucket(5000, 0, 0);
+    std::atomic<int> requests{0};
+    auto good = bucket_fetcher(bucket, requests);
+
+    PageFetcher failing = [&good, &requests](const std::string& start_after) {
+        if (requests.load() >= 5) throw std::runtime_error("ListObjectsV2 failed: SlowDown");
+        return good(start_after);
+    };
+    bool threw = false;
+    try {
+        list_partitioned(failing, {}, 4);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+
+    std::atomic<bool> cancel{true};
+    requests = 0;
+    auto partial = list_partitioned(good, {}, 4, nullptr, &cancel);
+    assert(partial.size() <= 400);  // At most one page per lister
+
+    std::cout << "test_errors_and_cancel: PASS\n";
+}
+
+int main() {
+    test_key_midpoint();
+    test_flat_namespace();
+    test_split_points();
+    test_no_object_cap();
+    test_errors_and_cancel();
+    std::cout << "All parallel lister tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,111 @@
+#include "../src/parquet_footer.hpp"
+#include <cassert>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+using namespace valkyrie;
+
+// tests/test_columns.parquet: 90 rows in 3 row groups of columns
+// id (int64), label (string), meta {width, height} (int64), uncompressed
+static std::string read_fixture() {
+    std::ifstream file("tests/test_columns.parquet", std::ios::binary);
+    assert(file.is_open());
+    return std::string(std::istreambuf_iterator<char>(file), {});
+}
+
+void test_metadata_length() {
+    std::string data = read_fixture();
+
+    auto length = ParquetFooter::metadata_length(data.data(), data.size());
+    assert(length.has_value());
+    assert(*length + ParquetFooter::TAIL_SIZE < data.size());
+
+    std::string bad = data.substr(0, data.size() - 1) + "X";
+    assert(!ParquetFooter::metadata_length(bad.data(), bad.size()).has_value());
+
+    assert(ParquetFooter::is_parquet_key("train/part-00000.parquet"));
+    assert(!ParquetFooter::is_parquet_key("train/part-00000.parquet.crc"));
+
+    std::cout << "test_metadata_length: PASS\n";
+}
+
+void test_parse_layout() {
+    std::string data = read_fixture();
+    uint32_t length = *ParquetFooter::metadata_length(data.data(), data.size());
+    const char* metadata = data.data() + data.size() - ParquetFooter::TAIL_SIZE - length;
+
+    ParquetFooter footer;
+    bool parsed = footer.parse(metadata, length);
+    assert(parsed);
+    assert(footer.num_rows() == 90);
+    assert(footer.num_row_groups() == 3);
+
+    // Values as reported by pyarrow for the fixture
+    const auto& chunks = footer.column_chunks();
+    assert(chunks.size() == 12);
+    assert(chunks[0].path == "id");
+    assert(chunks[0].row_group == 0);
+    assert(chunks[0].offset == 4);      // Dictionary page
+    assert(chunks[0].length == 347);
+    assert(chunks[1].path == "label");
+    assert(chunks[1].offset == 351);
+    assert(chunks[2].path == "meta.width");
+    assert(chunks[4].row_group == 1);
+    assert(chunks[4].offset == 1236);
+
+    // Chunks are contiguous and in file order
+    for (size_t i = 1; i < chunks.size(); ++i) {
+        assert(chunks[i - 1].offset + chunks[i - 1].length == chunks[i].offset);
+    }
+
+    std::cout << "test_parse_layout: PASS\n";
+}
+
+void test_select_columns() {
+    std::string data = read_fixture();
+    uint32_t length = *ParquetFooter::metadata_length(data.data(), data.size());
+
+    ParquetFooter footer;
+    bool parsed = footer.parse(data.data() + data.size() - ParquetFooter::TAIL_SIZE - length, length);
+    assert(parsed);
+
+    assert(footer.select({}).size() == 12);
+    assert(footer.select({"label"}).size() == 3);
+    assert(footer.select({"meta"}).size() == 6);        // Parent selects nested fields
+    assert(footer.select({"meta.height"}).size() == 3);
+    assert(footer.select({"met"}).empty());             // No partial-name matches
+
+    auto selected = footer.select({"id", "meta.width"});
+    assert(selected.size() == 6);
+    assert(selected[0].path == "id" && selected[1].path == "meta.width");
+
+    std::cout << "test_select_columns: PASS\n";
+}
+
+void test_malformed_footer() {
+    std::string data = read_fixture();
+    uint32_t length = *ParquetFooter::metadata_length(data.data(), data.size());
+    const char* metadata = data.data() + data.size() - ParquetFooter::TAIL_SIZE - length;
+
+    // Truncated metadata must fail cleanly, never read past the buffer
+    ParquetFooter footer;
+    bool parsed = footer.parse(metadata, length / 2);
+    assert(!parsed);
+    assert(footer.column_chunks().empty());
+
+    std::string junk(256, '\xff');
+    parsed = footer.parse(junk.data(), junk.size());
+    assert(!parsed);
+
+    std::cout << "test_malformed_footer: PASS\n";
+}
+
+int main() {
+    test_metadata_length();
+    test_parse_layout();
+    test_select_columns();
+    test_malformed_footer();
+    std::cout << "All ParquetFooter tests passed!\n";
+    return 0;
+}
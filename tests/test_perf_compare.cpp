@@ -0,0 +1,129 @@
+#include "../src/perf_compare.hpp"
+#include <cassert>
+#include <cmath>
+#include <iostream>
+
+using namespace valkyrie;
+
+void test_flatten() {
+    std::map<std::string, double> numbers;
+    assert(flatten_json_numbers(R"({
+        "quick": true, "name": "x\"y", "nothing": null,
+        "read_latency_us": {"p50": 120, "p99": 4.5e3},
+        "benchmarks": [
+            {"id": "cache.get_chunk/threads=1", "ns_per_op": 250.5, "params": {"threads": "1"}},
+            {"ns_per_op": -3}
+        ]
+    })", numbers));
+
+    assert(numbers.size() == 4);
+    assert(numbers.at("read_latency_us.p50") == 120);
+    assert(numbers.at("read_latency_us.p99") == 4500);
+    assert(numbers.at("benchmarks.cache.get_chunk/threads=1.ns_per_op") == 250.5);
+    assert(numbers.at("benchmarks.1.ns_per_op") == -3);
+
+    std::map<std::string, double> ignored;
+    assert(!flatten_json_numbers("{\"a\": }", ignored));
+    assert(!flatten_json_numbers("{\"a\": 1", ignored));
+    assert(!flatten_json_numbers("[1, 2] trailing", ignored));
+
+    std::cout << "test_flatten: PASS\n";
+}
+
+void test_summarize() {
+    // Fewer than 6 runs: min-max interval
+    auto five = summarize({5, 1, 4, 2, 3});
+    assert(five.samples == 5 && five.median == 3);
+    assert(five.ci_low == 1 && five.ci_high == 5);
+
+    // 9 runs at 95%: ranks 2 and 8
+    auto nine = summarize({9, 8, 7, 6, 5, 4, 3, 2, 1});
+    assert(nine.median == 5 && nine.ci_low == 2 && nine.ci_high == 8);
+
+    auto even = summarize({1, 2, 3, 4});
+    assert(even.median == 2.5);
+
+    assert(summarize({}).samples == 0);
+
+    std::cout << "test_summarize: PASS\n";
+}
+
+void test_compare() {
+    std::vector<MetricRule> rules = {
+        {".ns_per_op", false, 0.0},
+        {"throughput_bytes_per_sec", true, 0.0},
+        {"stall_ratio", false, 0.02},
+    };
+
+    std::map<std::string, MetricSummary> baseline = {
+        {"get.ns_per_op", {5, 100, 95, 105}},
+        {"put.ns_per_op", {5, 100, 95, 105}},
+        {"noisy.ns_per_op", {5, 100, 60, 140}},
+        {"e2e.throughput_bytes_per_sec", {5, 1000, 950, 1050}},
+        {"e2e.stall_ratio", {5, 0.010, 0.009, 0.011}},
+        {"gone.ns_per_op", {5, 1, 1, 1}},
+        {"e2e.reads", {5, 10, 10, 10}},
+    };
+    std::map<std::string, MetricSummary> current = {
+        {"get.ns_per_op", {5, 130, 125, 135}},            // 30% slower, separated
+        {"put.ns_per_op", {5, 70, 65, 75}},               // 30% faster
+        {"noisy.ns_per_op", {5, 130, 90, 170}},           // Overlapping intervals
+        {"e2e.throughput_bytes_per_sec", {5, 800, 780, 820}},
+        {"e2e.stall_ratio", {5, 0.015, 0.014, 0.016}},    // 50% worse, but tiny
+        {"new.ns_per_op", {5, 1, 1, 1}},
+        {"e2e.reads", {5, 20, 20, 20}},                   // No rule: not compared
+    };
+
+    auto comparisons = compare(baseline, current, rules, 0.10);
+    std::map<std::string, Comparison::Verdict> verdicts;
+    for (const auto& c : comparisons) verdicts[c.metric] = c.verdict;
+
+    assert(verdicts.size() == 7);
+    assert(verdicts["get.ns_per_op"] == Comparison::Verdict::REGRESSED);
+    assert(verdicts["put.ns_per_op"] == Comparison::Verdict::IMPROVED);
+    assert(verdicts["noisy.ns_per_op"] == Comparison::Verdict::OK);
+    assert(verdicts["e2e.throughput_bytes_per_sec"] == Comparison::Verdict::REGRESSED);
+    assert(verdicts["e2e.stall_ratio"] == Comparison::Verdict::OK);
+    assert(verdicts["new.ns_per_op"] == Comparison::Verdict::NEW);
+    assert(verdicts["gone.ns_per_op"] == Comparison::Verdict::MISSING);
+
+    for (const auto& c : comparisons) {
+        if (c.metric == "e2e.throughput_bytes_per_sec") assert(std::abs(c.change - 0.2) < 1e-9);
+    }
+
+    // Regressions and unbaselined metrics lead the report
+    std::string report = format_report(comparisons);
+    size_t first_line = report.find('\n') + 1;
+    assert(report.find("REGRESSED", first_line) < report.find("improved"));
+    assert(report.find("NO BASELINE", first_line) < report.find("improved"));
+    assert(report.find("MISSING") > report.find("NO BASELINE"));
+    assert(report.find("+30.0%") != std::string::npos);
+
+    std::cout << "test_compare: PASS\n";
+}
+
+void test_baseline_round_trip() {
+    std::map<std::string, MetricSummary> metrics = {
+        {"benchmarks.cache.get_chunk/threads=1/fill=0.5.ns_per_op", {7, 1901.25, 1850, 1999.5}},
+        {"e2e.sequential.read_latency_us.p99", {5, 42000, 41000, 43000}},
+    };
+
+    std::map<std::string, MetricSummary> parsed;
+    assert(parse_baseline_json(to_baseline_json(metrics), parsed));
+    assert(parsed.size() == 2);
+    const auto& summary = parsed.at("benchmarks.cache.get_chunk/threads=1/fill=0.5.ns_per_op");
+    assert(summary.samples == 7 && summary.median == 1901.25);
+    assert(summary.ci_low == 1850 && summary.ci_high == 1999.5);
+    assert(parsed.at("e2e.sequential.read_latency_us.p99").median == 42000);
+
+    std::cout << "test_baseline_round_trip: PASS\n";
+}
+
+int main() {
+    test_flatten();
+    test_summarize();
+    test_compare();
+    test_baseline_round_trip();
+    std::cout << "All perf comparison tests passed!\n";
+    return 0;
+}
@@ -1,7 +1,13 @@
 #include "../src/predictor.hpp"
+#include "../src/shuffle.hpp"
 #include <aws/core/Aws.h>
+#include <atomic>
 #include <cassert>
 #include <iostream>
+#include <chrono>
+#include <thread>
+#include <fstream>
+#include <iterator>
 
 using namespace valkyrie;
 
@@ -66,6 +72,402 @@ void test_manifest_loading() {
     std::cout << "test_manifest_loading: PASS\n";
 }
 
+void test_markov_fallback() {
+    CacheManager cache(16 * 1024 * 1024);
+
+    S3Config config;
+    config.bucket = "test";
+    config.region = "us-east-1";
+
+    S3WorkerPool pool(config, cache, 2);
+    Predictor predictor(cache, pool, 2);
+    predictor.start();
+
+    // No numeric pattern and no manifest: only the learned model can answer
+    predictor.on_file_accessed("eval/c.bin");
+    predictor.on_file_accessed("eval/a.bin");
+    predictor.on_file_accessed("eval/b.bin");
+    predictor.on_file_accessed("eval/c.bin");
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    const auto& stats = predictor.get_stats();
+    assert(stats.markov_hits.load() > 0);
+    assert(stats.source(PredictionSource::MARKOV).predicted.load() == 2);
+
+    // Following the learned order counts as a correct prediction
+    predictor.on_file_accessed("eval/a.bin");
+    assert(stats.source(PredictionSource::MARKOV).correct.load() == 1);
+
+    predictor.stop();
+    std::cout << "test_markov_fallback: PASS\n";
+}
+
+void test_adaptive_window() {
+    CacheManager cache(256 * 1024 * 1024);
+
+    S3Config config;
+    config.bucket = "test";
+    config.region = "us-east-1";
+
+    S3WorkerPool pool(config, cache, 2);
+    Predictor predictor(cache, pool, 8);
+    predictor.enable_adaptive_lookahead();
+    predictor.set_size_lookup([](const std::string&) -> std::optional<size_t> {
+        return 64 * DEFAULT_CHUNK_SIZE;
+    });
+    predictor.start();
+
+    predictor.on_file_accessed("big_shard_001.bin");
+
+    // Simulate a fast reader: 64MB over ~0.6s
+    for (int i = 1; i <= 16; ++i) {
+        predictor.on_bytes_read("big_shard_001.bin", DEFAULT_CHUNK_SIZE, i * DEFAULT_CHUNK_SIZE);
+        std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+    const auto& stats = predictor.get_stats();
+    assert(stats.consumption_bytes_per_sec.load() > 0);
+    assert(stats.window_bytes.load() >= DEFAULT_CHUNK_SIZE);
+    assert(stats.window_bytes.load() <= 128 * 1024 * 1024);  // Half the cache
+    assert(stats.window_files.load() >= 1 && stats.window_files.load() <= 8);
+    assert(stats.readahead_issued.load() > 0);
+
+    predictor.stop();
+    std::cout << "test_adaptive_window: PASS\n";
+}
+
+void test_read_position_per_file() {
+    CacheManager cache(256 * 1024 * 1024);
+
+    S3Config config;
+    config.bucket = "test";
+    config.region = "us-east-1";
+
+    // Pool not started: readahead stays in flight
+    S3WorkerPool pool(config, cache, 2);
+    Predictor predictor(cache, pool, 8);
+    predictor.enable_adaptive_lookahead();
+    predictor.set_size_lookup([](const std::string&) -> std::optional<size_t> {
+        return 64 * DEFAULT_CHUNK_SIZE;
+    });
+
+    // Another reader at the end of its file does not move this one's position
+    predictor.on_file_accessed("a.bin");
+    predictor.on_bytes_read("a.bin", DEFAULT_CHUNK_SIZE / 2, DEFAULT_CHUNK_SIZE / 2);
+    predictor.on_bytes_read("b.bin", DEFAULT_CHUNK_SIZE, 64 * DEFAULT_CHUNK_SIZE);
+    predictor.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(800));  // Past the first window sample
+
+    assert(predictor.get_stats().readahead_issued.load() > 0);
+
+    predictor.stop();
+    pool.shutdown();
+    std::cout << "test_read_position_per_file: PASS\n";
+}
+
+void test_lookahead_zero() {
+    CacheManager cache(256 * 1024 * 1024);
+
+    S3Config config;
+    config.bucket = "test";
+    config.region = "us-east-1";
+
+    // Pool not started: anything issued stays in flight
+    S3WorkerPool pool(config, cache, 2);
+    Predictor predictor(cache, pool, 0);
+    predictor.enable_adaptive_lookahead();
+    predictor.set_size_lookup([](const std::string&) -> std::optional<size_t> {
+        return 64 * DEFAULT_CHUNK_SIZE;
+    });
+
+    // No readahead into the open file and no next files
+    predictor.on_file_accessed("shard_001.bin");
+    predictor.on_bytes_read("shard_001.bin", DEFAULT_CHUNK_SIZE / 2, DEFAULT_CHUNK_SIZE / 2);
+    predictor.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(800));
+
+    const auto& stats = predictor.get_stats();
+    assert(stats.predictions_made.load() == 0);
+    assert(stats.readahead_issued.load() == 0);
+    assert(stats.prefetches_issued.load() == 0);
+
+    // Raising it at runtime resumes prefetching
+    bool changed = predictor.set_lookahead(2);
+    assert(changed);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    assert(stats.readahead_issued.load() > 0);
+
+    predictor.stop();
+    pool.shutdown();
+    std::cout << "test_lookahead_zero: PASS\n";
+}
+
+void test_shuffled_epochs() {
+    CacheManager cache(16 * 1024 * 1024);
+
+    S3Config config;
+    config.bucket = "test";
+    config.region = "us-east-1";
+
+    S3WorkerPool pool(config, cache, 2);
+    Predictor predictor(cache, pool, 2);
+
+    bool loaded = predictor.load_manifest("tests/test_shuffled_manifest.txt");
+    assert(loaded);
+    predictor.start();
+
+    auto shard = [](uint32_t i) {
+        return "shard_00" + std::to_string(i) + ".bin";
+    };
+
+    // Read epoch 0, then the head of epoch 1, in the seeded order
+    for (uint32_t index : shuffled_order(10, 42, 0)) {
+        predictor.on_file_accessed(shard(index));
+        std::this_thread::sleep_for(std::chrono::milliseconds(80));
+    }
+    assert(predictor.get_shuffle_epoch() == 0);
+
+    auto epoch1 = shuffled_order(10, 42, 1);
+    for (size_t pos = 0; pos < 3; ++pos) {
+        predictor.on_file_accessed(shard(epoch1[pos]));
+        std::this_thread::sleep_for(std::chrono::milliseconds(80));
+    }
+
+    const auto& stats = predictor.get_stats();
+    assert(predictor.get_shuffle_epoch() == 1);
+    assert(stats.epoch_rollovers.load() == 1);
+
+    // Every access after the first was predicted, including across the boundary
+    assert(stats.source(PredictionSource::SHUFFLE).correct.load() == 12);
+
+    predictor.stop();
+    std::cout << "test_shuffled_epochs: PASS\n";
+}
+
+void test_prefetch_budget() {
+    CacheManager cache(4 * DEFAULT_CHUNK_SIZE);
+
+    S3Config config;
+    config.bucket = "test";
+    config.region = "us-east-1";
+
+    // Pool not started: prefetches stay in flight and count against the budget
+    S3WorkerPool pool(config, cache, 2);
+    Predictor predictor(cache, pool, 5);
+    bool accepted = predictor.set_prefetch_budget(0.0);
+    assert(!accepted);
+    accepted = predictor.set_prefetch_budget(1.5);
+    assert(!accepted);
+    accepted = predictor.set_prefetch_budget(0.5);  // 2 chunks
+    assert(accepted);
+    predictor.start();
+
+    predictor.on_file_accessed("shard_001.bin");
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    const auto& stats = predictor.get_stats();
+    assert(stats.prefetches_issued.load() == 2);
+    assert(stats.prefetches_deferred.load() > 0);
+
+    // Raising the budget admits the deferred predictions
+    predictor.set_prefetch_budget(1.0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    assert(stats.prefetches_issued.load() == 4);
+
+    predictor.stop();
+    pool.shutdown();
+    std::cout << "test_prefetch_budget: PASS\n";
+}
+
+void test_parquet_footer_prefetch() {
+    CacheManager cache(64 * 1024 * 1024);
+
+    S3Config config;
+    config.bucket = "test";
+    config.region = "us-east-1";
+
+    // Pool not started: footer requests for the next file stay in flight
+    S3WorkerPool pool(config, cache, 2);
+    Predictor predictor(cache, pool, 1);
+
+    std::ifstream file("tests/test_columns.parquet", std::ios::binary);
+    std::vector<char> data((std::istreambuf_iterator<char>(file)), {});
+    assert(!data.empty());
+    size_t size = data.size();
+
+    predictor.set_size_lookup([size](const std::string&) -> std::optional<size_t> {
+        return size;
+    });
+    predictor.set_parquet_columns({"label"});
+
+    // The file being read is fully cached: its footer is parsed, nothing to fetch
+    cache.insert_chunk("part_001.parquet", 0, data, CacheZone::HOT);
+    predictor.start();
+    predictor.on_file_accessed("part_001.parquet");
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    const auto& stats = predictor.get_stats();
+    assert(stats.parquet_footers_parsed.load() == 1);
+    assert(stats.parquet_footer_errors.load() == 0);
+    assert(stats.parquet_chunks_issued.load() == 0);
+
+    // The predicted next file starts with its footer, not chunk 0 of the data
+    assert(stats.prefetches_issued.load() == 0);
+
+    predictor.stop();
+    pool.shutdown();
+    std::cout << "test_parquet_footer_prefetch: PASS\n";
+}
+
+void test_record_prefetch() {
+    CacheManager cache(64 * 1024 * 1024);
+
+    S3Config config;
+    config.bucket = "test";
+    config.region = "us-east-1";
+
+    // Pool not started: record prefetches stay in flight
+    S3WorkerPool pool(config, cache, 2);
+    Predictor predictor(cache, pool, 1);
+    RecordIndexStore indexes;
+    predictor.set_record_indexes(&indexes);
+
+    // Ten 1000-byte records; the sidecar is already cached
+    std::string sidecar;
+    for (int i = 0; i < 10; ++i) {
+        sidecar += std::to_string(i * 1000) + " 1000\n";
+    }
+    cache.insert_chunk("rec_001.tfrecord.index", 0,
+                       std::vector<char>(sidecar.begin(), sidecar.end()), CacheZone::HOT);
+
+    predictor.on_file_accessed("rec_001.tfrecord");
+    predictor.on_record_read("rec_001.tfrecord", 0);
+    predictor.on_record_read("rec_001.tfrecord", 1);
+    predictor.on_record_read("rec_001.tfrecord", 2);
+    predictor.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    // Stride 1 seen twice: records 3..9 are requested one range each
+    const auto& stats = predictor.get_stats();
+    assert(stats.record_indexes_loaded.load() == 1);
+    assert(indexes.get("rec_001.tfrecord")->size() == 10);
+    assert(stats.record_prefetches.load() == 7);
+    assert(stats.record_prefetch_bytes.load() == 7000);
+
+    // A sidecar still downloading does not hold up the predictor thread
+    predictor.on_file_accessed("rec_002.tfrecord");
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    assert(!indexes.attempted("rec_002.tfrecord"));
+
+    // It is used on a later tick, once it lands
+    cache.insert_chunk("rec_002.tfrecord.index", 0,
+                       std::vector<char>(sidecar.begin(), sidecar.end()), CacheZone::HOT);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    assert(stats.record_indexes_loaded.load() == 2);
+
+    predictor.stop();
+    pool.shutdown();
+    std::cout << "test_record_prefetch: PASS\n";
+}
+
+void test_record_keys_with_hash() {
+    CacheManager cache(64 * 1024 * 1024);
+
+    S3Config config;
+    config.bucket = "test";
+    config.region = "us-east-1";
+
+    S3WorkerPool pool(config, cache, 2);
+    Predictor predictor(cache, pool, 1);
+    RecordIndexStore indexes;
+    predictor.set_record_indexes(&indexes);
+
+    std::string sidecar;
+    for (int i = 0; i < 10; ++i) {
+        sidecar += std::to_string(i * 1000) + " 1000\n";
+    }
+    cache.insert_chunk("a.index", 0, std::vector<char>(sidecar.begin(), sidecar.end()),
+                       CacheZone::HOT);
+
+    // Record ids of "a#b" ("a#b#0") also start with "a#"
+    predictor.on_file_accessed("a");
+    for (int run = 0; run < 2; ++run) {
+        predictor.on_record_read("a", 5);
+        predictor.on_record_read("a#b", 0);
+        predictor.on_record_read("a", 7);
+    }
+    predictor.on_record_read("a", 5);
+    predictor.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    // "a#b#0" is skipped, record 7 of "a" still prefetched
+    assert(predictor.get_stats().record_prefetches.load() == 1);
+
+    predictor.stop();
+    pool.shutdown();
+    std::cout << "test_record_keys_with_hash: PASS\n";
+}
+
+void test_record_index_retry() {
+    CacheManager cache(64 * 1024 * 1024);
+
+    S3Config config;
+    config.bucket = "test";
+    config.region = "us-east-1";
+
+    std::string sidecar;
+    for (int i = 0; i < 10; ++i) {
+        sidecar += std::to_string(i * 1000) + " 1000\n";
+    }
+
+    // The sidecar's first two GETs fail (throttled); the data file is not read here
+    std::atomic<int> sidecar_gets{0};
+    S3WorkerPool pool(config, cache, 2);
+    pool.set_range_fetcher([&](const std::string& s3_key, size_t, size_t size,
+                               std::vector<char>& data) {
+        if (s3_key != "rec.tfrecord.index") {
+            data.assign(size, 'x');
+            return true;
+        }
+        if (++sidecar_gets <= 2) return false;
+        data.assign(sidecar.begin(), sidecar.end());
+        return true;
+    });
+    pool.start();
+
+    Predictor predictor(cache, pool, 1);
+    RecordIndexStore indexes;
+    predictor.set_record_indexes(&indexes);
+    predictor.set_size_lookup([&](const std::string& s3_key) -> std::optional<size_t> {
+        if (s3_key == "rec.tfrecord.index") return sidecar.size();
+        if (s3_key == "rec.tfrecord" || s3_key == "bare.tfrecord") return 10000;
+        return std::nullopt;
+    });
+
+    predictor.on_file_accessed("rec.tfrecord");
+    predictor.on_record_read("rec.tfrecord", 0);
+    predictor.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(800));
+
+    // Retried after backoff rather than remembered as absent
+    assert(sidecar_gets.load() == 3);
+    assert(predictor.get_stats().record_indexes_loaded.load() == 1);
+    assert(indexes.get("rec.tfrecord")->size() == 10);
+
+    // A listed file with no listed sidecar has none; nothing is fetched for it
+    predictor.on_file_accessed("bare.tfrecord");
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    assert(indexes.attempted("bare.tfrecord"));
+    assert(indexes.get("bare.tfrecord") == nullptr);
+    assert(sidecar_gets.load() == 3);
+
+    predictor.stop();
+    pool.shutdown();
+    std::cout << "test_record_index_retry: PASS\n";
+}
+
 int main() {
     // Initialize AWS SDK
     Aws::SDKOptions sdk_options;
@@ -77,6 +479,16 @@ int main() {
     test_no_pattern();
     test_rollover();
     test_manifest_loading();
+    test_markov_fallback();
+    test_adaptive_window();
+    test_read_position_per_file();
+    test_lookahead_zero();
+    test_shuffled_epochs();
+    test_prefetch_budget();
+    test_parquet_footer_prefetch();
+    test_record_prefetch();
+    test_record_keys_with_hash();
+    test_record_index_retry();
     std::cout << "All Predictor tests passed!\n";
 
     // Shutdown AWS SDK
@@ -0,0 +1,70 @@
+#include "../src/record_index.hpp"
+#include <cassert>
+#include <iostream>
+
+using namespace valkyrie;
+
+void test_parse() {
+    RecordIndex index;
+
+    // tfrecord2idx output; order and blank lines are tolerated
+    bool parsed = index.parse("0 120\n120 80\n\n# comment\n500 40\n200 300\n");
+    assert(parsed);
+    assert(index.size() == 4);
+    assert(index.record(0).offset == 0 && index.record(0).length == 120);
+    assert(index.record(2).offset == 200 && index.record(2).length == 300);
+    assert(index.record(3).offset == 500);
+
+    parsed = index.parse("0 120\nbogus\n");
+    assert(!parsed);
+    assert(index.size() == 0);
+    parsed = index.parse("0 0\n");
+    assert(!parsed);     // Empty records are malformed
+    parsed = index.parse("\n\n");
+    assert(!parsed);
+
+    std::cout << "test_parse: PASS\n";
+}
+
+void test_find() {
+    RecordIndex index;
+    bool parsed = index.parse("0 100\n100 50\n200 10\n");
+    assert(parsed);
+
+    assert(index.find(0) == 0u);
+    assert(index.find(99) == 0u);
+    assert(index.find(100) == 1u);
+    assert(index.find(149) == 1u);
+    assert(!index.find(150).has_value());   // Gap between records
+    assert(index.find(205) == 2u);
+    assert(!index.find(210).has_value());
+
+    std::cout << "test_find: PASS\n";
+}
+
+void test_store() {
+    RecordIndexStore store;
+    assert(RecordIndex::index_key_for("train/a.tfrecord") == "train/a.tfrecord.index");
+    assert(RecordIndex::is_index_key("train/a.tfrecord.index"));
+    assert(!RecordIndex::is_index_key("train/a.tfrecord"));
+
+    assert(!store.attempted("a"));
+    store.mark_missing("a");
+    assert(store.attempted("a") && store.get("a") == nullptr);
+
+    auto index = std::make_shared<RecordIndex>();
+    bool parsed = index->parse("0 10\n");
+    assert(parsed);
+    store.put("b", index);
+    assert(store.attempted("b") && store.get("b")->size() == 1);
+
+    std::cout << "test_store: PASS\n";
+}
+
+int main() {
+    test_parse();
+    test_find();
+    test_store();
+    std::cout << "All RecordIndex tests passed!\n";
+    return 0;
+}
@@ -1,10 +1,12 @@
 #include "../src/s3_worker_pool.hpp"
 #include "../src/cache_manager.hpp"
 #include <aws/core/Aws.h>
+#include <atomic>
 #include <cassert>
 #include <iostream>
 #include <chrono>
 #include <thread>
+#include <vector>
 
 using namespace valkyrie;
 
@@ -55,6 +57,127 @@ void test_task_submission() {
     std::cout << "test_task_submission: PASS\n";
 }
 
+void test_late_prefetch_dedup() {
+    CacheManager cache(16 * 1024 * 1024);
+
+    S3Config config;
+    config.bucket = "test-bucket";
+    config.region = "us-east-1";
+
+    // Not started: tasks stay queued, so the prefetch is "in flight" but not downloading
+    S3WorkerPool pool(config, cache, 2);
+
+    auto prefetch = pool.submit("shard.bin", 0, 4096, Priority::NORMAL, PredictionSource::MANIFEST);
+    auto duplicate = pool.submit("shard.bin", 0, 4096, Priority::NORMAL, PredictionSource::MANIFEST);
+    (void) prefetch;
+    (void) duplicate;
+
+    // Reader misses on the same chunk: counted as a late prefetch
+    auto urgent = pool.submit("shard.bin", 0, 4096, Priority::URGENT);
+    (void) urgent;
+
+    const auto& late = cache.get_prefetch_outcomes().source(PredictionSource::MANIFEST).late;
+    assert(late.count.load() == 1);
+    assert(late.bytes.load() == 4096);
+
+    pool.shutdown();
+    std::cout << "test_late_prefetch_dedup: PASS\n";
+}
+
+void test_record_and_chunk_at_same_offset() {
+    CacheManager cache(16 * 1024 * 1024);
+
+    S3Config config;
+    config.bucket = "test-bucket";
+    config.region = "us-east-1";
+
+    // The short record fetch lands after the full chunk
+    S3WorkerPool pool(config, cache, 2);
+    pool.set_range_fetcher([](const std::string&, size_t, size_t size, std::vector<char>& data) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(size < 4096 ? 100 : 10));
+        data.assign(size, 'x');
+        return true;
+    });
+    pool.start();
+
+    auto record = pool.submit("shard.bin", 0, 100, Priority::NORMAL, PredictionSource::RECORD);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));  // Record fetch has started
+
+    // A reader's full chunk at the same offset is its own download, not the record's
+    auto urgent = pool.submit("shard.bin", 0, 4096, Priority::URGENT);
+    bool fetched = urgent.get();
+    assert(fetched);
+    assert(cache.contains_range("shard.bin", 0, 4096));
+
+    // ...and the record chunk does not replace it when it lands
+    fetched = record.get();
+    assert(fetched);
+    assert(cache.contains_range("shard.bin", 0, 4096));
+
+    pool.shutdown();
+    std::cout << "test_record_and_chunk_at_same_offset: PASS\n";
+}
+
+void test_concurrent_misses_share_download() {
+    CacheManager cache(16 * 1024 * 1024);
+
+    S3Config config;
+    config.bucket = "test-bucket";
+    config.region = "us-east-1";
+
+    std::atomic<int> fetches{0};
+    S3WorkerPool pool(config, cache, 4);
+    pool.set_range_fetcher([&fetches](const std::string&, size_t, size_t size,
+                                      std::vector<char>& data) {
+        fetches++;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        data.assign(size, 'x');
+        return true;
+    });
+    pool.start();
+
+    // Readers racing on one missing chunk
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 8; ++i) {
+        readers.emplace_back([&pool] {
+            bool ok = pool.submit("shard.bin", 0, 4096, Priority::URGENT).get();
+            assert(ok);
+        });
+    }
+    for (auto& reader : readers) reader.join();
+    assert(fetches.load() == 1);
+
+    pool.shutdown();
+    std::cout << "test_concurrent_misses_share_download: PASS\n";
+}
+
+void test_object_lister() {
+    CacheManager cache(16 * 1024 * 1024);
+
+    S3Config config;
+    config.bucket = "test-bucket";
+    config.region = "us-east-1";
+
+    // Listing answered locally (as --mock-s3 does), no S3 request
+    S3WorkerPool pool(config, cache, 1);
+    pool.set_object_lister([] {
+        return std::vector<ObjectInfo>{{"a.bin", 100}, {"b.bin", 200}, {"train/c.bin", 300}};
+    });
+
+    auto objects = pool.list_objects();
+    assert(objects.size() == 3);
+    assert(objects[1].key == "b.bin" && objects[1].size == 200);
+
+    // Directory levels are grouped from the same list
+    auto root = pool.list_directory("");
+    assert(root.files.size() == 2);
+    assert(root.subdirs.size() == 1 && root.subdirs[0] == "train");
+    auto train = pool.list_directory("train");
+    assert(train.files.size() == 1 && train.files[0].key == "c.bin" && train.files[0].size == 300);
+
+    std::cout << "test_object_lister: PASS\n";
+}
+
 int main() {
     // Initialize AWS SDK
     Aws::SDKOptions sdk_options;
@@ -66,6 +189,10 @@ int main() {
 
     test_worker_pool_lifecycle();
     test_task_submission();
+    test_late_prefetch_dedup();
+    test_record_and_chunk_at_same_offset();
+    test_concurrent_misses_share_download();
+    test_object_lister();
 
     std::cout << "\nAll mock tests passed!\n";
 
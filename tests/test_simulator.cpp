@@ -0,0 +1,113 @@
+#include "../src/simulator.hpp"
+#include "../src/tracer.hpp"
+#include <aws/core/Aws.h>
+#include <cassert>
+#include <fstream>
+#include <iostream>
+#include <unistd.h>
+
+using namespace valkyrie;
+
+static std::string write_key_list(int files) {
+    std::string path = "/tmp/test_simulator_" + std::to_string(getpid()) + ".keys";
+    std::ofstream out(path);
+    for (int i = 1; i <= files; ++i) {
+        out << "shard_00" << i << ".bin\n";
+    }
+    return path;
+}
+
+void test_load_traces() {
+    std::string keys = write_key_list(3);
+    ReplayTrace trace;
+    bool loaded = trace.load_key_list(keys, 10 * 1024 * 1024, 4 * 1024 * 1024, 1e9);
+    assert(loaded);
+    assert(trace.object_sizes.size() == 3);
+    assert(trace.object_sizes["shard_002.bin"] == 10u * 1024 * 1024);
+    assert(trace.ops.size() == 3 * (1 + 3));     // Open + three reads per file
+    assert(trace.ops[0].open && !trace.ops[1].open);
+    assert(trace.ops[3].offset == 8u * 1024 * 1024 && trace.ops[3].size == 2u * 1024 * 1024);
+    unlink(keys.c_str());
+
+    // Binary traces recorded with --enable-tracing
+    std::string path = "/tmp/test_simulator_" + std::to_string(getpid()) + ".trace";
+    {
+        Tracer tracer(path);
+        bool started = tracer.start();
+        assert(started);
+        tracer.record(TraceEventType::OPEN, "a.bin", 0, 0);
+        tracer.record(TraceEventType::READ, "a.bin", 0, 4096, 10, std::nullopt, false);
+        tracer.record(TraceEventType::DOWNLOAD, "a.bin", 0, 4096, 9, Priority::URGENT);
+        tracer.record(TraceEventType::READ, "a.bin", 4096, 4096, 1, std::nullopt, true);
+        tracer.stop();
+    }
+    loaded = trace.load_binary(path);
+    assert(loaded);
+    assert(trace.ops.size() == 3);              // Downloads are not reader ops
+    assert(trace.object_sizes["a.bin"] == 8192);
+    loaded = trace.load_binary(keys);
+    assert(!loaded);
+    unlink(path.c_str());
+
+    std::cout << "test_load_traces: PASS\n";
+}
+
+void test_prefetch_reduces_stalls() {
+    // Eight 8MB files, read at 200MB/s; 20ms first-byte latency
+    std::string keys = write_key_list(8);
+    ReplayTrace trace;
+    bool loaded = trace.load_key_list(keys, 8 * 1024 * 1024, 1024 * 1024, 200.0 * 1024 * 1024);
+    assert(loaded);
+    unlink(keys.c_str());
+
+    SimConfig config;
+    config.cache_size = 256 * 1024 * 1024;
+    config.workers = 4;
+    config.lookahead = 2;
+    config.backend.latency_ms = 20;
+    config.backend.latency_sigma = 0;
+    config.backend.bandwidth = 2e9;
+
+    Simulator simulator(trace);
+
+    config.policy = "none";
+    SimResult none;
+    bool ran = simulator.run(config, none);
+    assert(ran);
+
+    // Without prefetch every chunk is a blocking miss
+    assert(none.chunk_reads == 8 * 8);
+    assert(none.chunk_hits == 8 * 8 - 16);     // Reads after the first in each chunk
+    assert(none.bytes_read == 64u * 1024 * 1024);
+    assert(none.bytes_fetched == 64u * 1024 * 1024);
+    assert(none.wasted_prefetch_bytes == 0);
+    assert(none.stall_us >= 16 * 20000);
+
+    config.policy = "fixed";
+    SimResult fixed;
+    ran = simulator.run(config, fixed);
+    assert(ran);
+    assert(fixed.bytes_read == none.bytes_read);
+    assert(fixed.hit_rate() > none.hit_rate());
+    assert(fixed.stall_us < none.stall_us);
+
+    config.policy = "bogus";
+    SimResult bogus;
+    ran = simulator.run(config, bogus);
+    assert(!ran);
+
+    std::cout << "test_prefetch_reduces_stalls: PASS\n";
+}
+
+int main() {
+    // The worker pool constructs an (unused) S3 client
+    Aws::SDKOptions sdk_options;
+    Aws::InitAPI(sdk_options);
+
+    test_load_traces();
+    test_prefetch_reduces_stalls();
+    std::cout << "All Simulator tests passed!\n";
+
+    Aws::ShutdownAPI(sdk_options);
+    return 0;
+}
@@ -0,0 +1,154 @@
+#include "../src/stall_tracker.hpp"
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace valkyrie;
+
+void test_per_reader_and_file() {
+    StallTracker tracker;
+
+    // Let the 20ms read actually take 20ms of the reader's wall time
+    tracker.record(100, "a.bin", 4096, 50, 0, false);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    tracker.record(100, "a.bin", 4096, 20000, 19000, true);
+    tracker.record(200, "b.bin", 8192, 30, 0, false);
+
+    auto snap = tracker.snapshot();
+    assert(snap.total.reads == 3 && snap.total.misses == 1);
+    assert(snap.total.bytes == 16384);
+    assert(snap.total.read_us == 20080 && snap.total.stall_us == 19000);
+    assert(snap.total.served_us() == 1080);
+
+    // Most stalled first
+    assert(snap.readers.size() == 2);
+    assert(snap.readers[0].first == 100 && snap.readers[0].second.stall_us == 19000);
+    assert(snap.readers[1].first == 200 && snap.readers[1].second.misses == 0);
+    assert(snap.files[0].first == "a.bin" && snap.files[0].second.reads == 2);
+
+    // The reader was active at least as long as its reads took
+    const auto& reader = snap.readers[0].second;
+    assert(reader.active_us() >= reader.read_us);
+    assert(reader.stall_ratio() > 0.5 && reader.stall_ratio() < 1.0);
+    assert(snap.readers[1].second.stall_ratio() == 0.0);
+    assert(snap.stall_ratio() > 0.0 && snap.stall_ratio() <= 1.0);
+
+    assert(tracker.snapshot(1).files.size() == 1);
+
+    std::cout << "test_per_reader_and_file: PASS\n";
+}
+
+void test_stall_ratio() {
+    StallTotals totals;
+    totals.first_us = 1000000;
+    totals.last_us = 3000000;    // Active for 2s
+    totals.stall_us = 500000;    // Blocked for 0.5s
+    totals.bytes = 4 * 1024 * 1024;
+    assert(std::abs(totals.stall_ratio() - 0.25) < 1e-9);
+    assert(std::abs(totals.throughput_bytes_per_sec() - 2 * 1024 * 1024) < 1e-6);
+
+    // Merging keeps the union of the activity windows
+    StallTotals other;
+    other.reads = 1;
+    other.first_us = 500000;
+    other.last_us = 2000000;
+    other.stall_us = 100000;
+    totals.reads = 1;
+    totals.merge(other);
+    assert(totals.first_us == 500000 && totals.last_us == 3000000);
+    assert(totals.stall_us == 600000 && totals.reads == 2);
+
+    assert(StallTotals{}.stall_ratio() == 0.0);
+
+    // Sums loaded mid-record() may show more stall than read time
+    totals.read_us = 500000;
+    assert(totals.served_us() == 0);
+
+    std::cout << "test_stall_ratio: PASS\n";
+}
+
+void test_concurrent_readers() {
+    StallTracker tracker;
+    constexpr int THREADS = 8;
+    constexpr int READS = 10000;
+
+    // FUSE serves one reader from several threads: shards must merge per PID
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&tracker, t] {
+            for (int i = 0; i < READS; ++i) {
+                bool miss = i % 10 == 0;
+                tracker.record(1000 + t % 2, "shard_" + std::to_string(i % 8), 100,
+                               miss ? 500 : 10, miss ? 490 : 0, miss);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    auto snap = tracker.snapshot();
+    assert(snap.readers.size() == 2);
+    assert(snap.total.reads == THREADS * READS);
+    assert(snap.total.misses == THREADS * READS / 10);
+    assert(snap.total.stall_us == 490ULL * THREADS * READS / 10);
+    assert(snap.files.size() == 8);
+
+    uint64_t file_reads = 0;
+    for (const auto& [key, totals] : snap.files) {
+        file_reads += totals.reads;
+    }
+    assert(file_reads == THREADS * READS);
+
+    std::cout << "test_concurrent_readers: PASS\n";
+}
+
+void test_bounded_entries() {
+    StallTracker tracker;
+
+    // One thread maps to one shard: its table is capped, idlest entries go first
+    for (size_t i = 0; i < StallTracker::MAX_FILES_PER_SHARD + 50; ++i) {
+        tracker.record(static_cast<pid_t>(i), "file_" + std::to_string(i), 1, 1, 0, false);
+    }
+
+    auto snap = tracker.snapshot();
+    assert(snap.files.size() == StallTracker::MAX_FILES_PER_SHARD);
+    assert(snap.readers.size() == StallTracker::MAX_READERS_PER_SHARD);
+
+    bool newest_kept = false;
+    for (const auto& [key, totals] : snap.files) {
+        newest_kept = newest_kept ||
+            key == "file_" + std::to_string(StallTracker::MAX_FILES_PER_SHARD + 49);
+    }
+    assert(newest_kept);
+
+    // Totals since mount keep the forgotten readers
+    assert(snap.total.reads == StallTracker::MAX_FILES_PER_SHARD + 50);
+    assert(snap.total.read_us == StallTracker::MAX_FILES_PER_SHARD + 50);
+
+    // A file read again is the most recent: the next newcomer evicts another
+    tracker.record(1, "file_50", 1, 1, 0, false);
+    tracker.record(2, "file_new", 1, 1, 0, false);
+    snap = tracker.snapshot();
+    bool file_50_kept = false, file_51_kept = false;
+    for (const auto& [key, totals] : snap.files) {
+        file_50_kept = file_50_kept || key == "file_50";
+        file_51_kept = file_51_kept || key == "file_51";
+    }
+    assert(file_50_kept && !file_51_kept);
+
+    std::cout << "test_bounded_entries: PASS\n";
+}
+
+int main() {
+    test_per_reader_and_file();
+    test_stall_ratio();
+    test_concurrent_readers();
+    test_bounded_entries();
+    std::cout << "All StallTracker tests passed!\n";
+    return 0;
+}
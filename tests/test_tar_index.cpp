@@ -0,0 +1,223 @@
+#include "../src/tar_index.hpp"
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+using namespace valkyrie;
+
+// Minimal ustar writer for building test archives
+class TarBuilder {
+public:
+    void add(const std::string& name, size_t size, char type = '0') {
+        std::string header(TarIndex::BLOCK_SIZE, '\0');
+        std::memcpy(&header[0], name.data(), std::min<size_t>(name.size(), 100));
+        std::snprintf(&header[100], 8, "%07o", 0644);
+        std::snprintf(&header[124], 12, "%011zo", size);
+        header[156] = type;
+        std::memcpy(&header[257], "ustar", 6);
+        std::memcpy(&header[263], "00", 2);
+
+        // Checksum over the header with the checksum field as spaces
+        std::memset(&header[148], ' ', 8);
+        unsigned sum = 0;
+        for (char c : header) sum += static_cast<unsigned char>(c);
+        std::snprintf(&header[148], 8, "%06o", sum);
+
+        data_ += header;
+        payload_start_ = data_.size();
+        data_.append(size, 'x');
+        data_.append((TarIndex::BLOCK_SIZE - size % TarIndex::BLOCK_SIZE) % TarIndex::BLOCK_SIZE, '\0');
+    }
+
+    // GNU long name, then the member it names
+    void add_long(const std::string& name, size_t size) {
+        add("././@LongLink", name.size() + 1, 'L');
+        data_.replace(payload_start_, name.size() + 1, name + '\0');
+        add("truncated", size);
+    }
+
+    // Pax extended header overriding path, then the member
+    void add_pax(const std::string& name, size_t size) {
+        std::string record = " path=" + name + "\n";
+        size_t length = record.size() + 2;  // Two length digits
+        record = std::to_string(length) + record;
+        add("PaxHeader", record.size(), 'x');
+        data_.replace(payload_start_, record.size(), record);
+        add("short", size);
+    }
+
+    std::string finish() {
+        data_.append(2 * TarIndex::BLOCK_SIZE, '\0');
+        return data_;
+    }
+
+private:
+    std::string data_;
+    size_t payload_start_ = 0;  // Of the last entry added
+};
+
+void test_parse_members() {
+    TarBuilder builder;
+    builder.add("000000.jpg", 1000);
+    builder.add("000000.cls", 1);
+    builder.add("dir", 0, '5');
+    builder.add_long(std::string(150, 'a') + ".jpg", 700);
+    builder.add_pax("sample/with spaces.json", 12);
+    std::string tar = builder.finish();
+
+    TarIndex index;
+    index.feed(0, tar.data(), tar.size(), true);
+
+    assert(index.state() == TarIndex::State::COMPLETE);
+    const auto& members = index.members();
+    assert(members.size() == 4);
+    assert(members[0].name == "000000.jpg");
+    assert(members[0].offset == 512);
+    assert(members[0].size == 1000);
+    assert(members[1].name == "000000.cls");
+    assert(members[1].offset == 512 + 1024 + 512);
+    assert(members[2].name == std::string(150, 'a') + ".jpg");
+    assert(members[3].name == "sample/with spaces.json");
+    assert(members[3].size == 12);
+
+    // Every member's data really is where the index says
+    for (const auto& m : members) {
+        assert(tar.substr(m.offset, m.size) == std::string(m.size, 'x'));
+    }
+
+    assert(index.member_at(0) == 0u);
+    assert(index.member_at(1511) == 0u);
+    assert(index.member_at(1512) == 1u);
+    assert(!index.member_at(tar.size()).has_value());
+
+    std::string rendered = index.render();
+    assert(rendered.rfind("512 1000 000000.jpg\n", 0) == 0);
+
+    std::cout << "test_parse_members: PASS\n";
+}
+
+void test_incremental_chunks() {
+    TarBuilder builder;
+    for (int i = 0; i < 20; ++i) {
+        builder.add("sample_" + std::to_string(i) + ".bin", 300 + i * 97);
+    }
+    builder.add_long(std::string(600, 'n'), 5);  // Long name payload spans chunks
+    std::string tar = builder.finish();
+
+    // Feed 1KB chunks out of order: only the chunk holding the next header advances
+    const size_t chunk = 1024;
+    TarIndex index;
+    bool advanced = index.feed(chunk, tar.data() + chunk, chunk, false);
+    assert(!advanced);
+    assert(index.next_offset() == 0);
+
+    for (size_t offset = 0; offset < tar.size(); offset += chunk) {
+        size_t size = std::min(chunk, tar.size() - offset);
+        index.feed(offset, tar.data() + offset, size, offset + size == tar.size());
+    }
+
+    assert(index.state() == TarIndex::State::COMPLETE);
+    assert(index.members().size() == 21);
+    assert(index.members()[20].name == std::string(600, 'n'));
+
+    std::cout << "test_incremental_chunks: PASS\n";
+}
+
+void test_invalid_archive() {
+    std::string junk(4096, 'j');
+
+    TarIndex index;
+    index.feed(0, junk.data(), junk.size(), true);
+    assert(index.state() == TarIndex::State::INVALID);
+
+    std::cout << "test_invalid_archive: PASS\n";
+}
+
+void test_indexer_catch_up() {
+    CacheManager cache(64 * 1024 * 1024);
+    TarIndexer indexer(cache);
+
+    // Large members so headers land in several 4MB chunks
+    TarBuilder builder;
+    for (int i = 0; i < 4; ++i) {
+        builder.add("big_" + std::to_string(i) + ".bin", 3 * 1024 * 1024);
+    }
+    std::string tar = builder.finish();
+
+    auto chunk_at = [&tar](size_t offset) {
+        size_t size = std::min(DEFAULT_CHUNK_SIZE, tar.size() - offset);
+        return std::vector<char>(tar.begin() + offset, tar.begin() + offset + size);
+    };
+
+    assert(TarIndexer::is_tar_key("train/shard-000.tar"));
+    assert(!TarIndexer::is_tar_key("train/shard-000.tar.idx"));
+    assert(TarIndexer::is_index_key("train/shard-000.tar.idx"));
+    assert(TarIndexer::archive_for_index("train/shard-000.tar.idx") == "train/shard-000.tar");
+    assert(indexer.next_chunk("shard.tar") == 0u);
+
+    // Later chunks land first (prefetch), then the head (reader)
+    for (size_t offset = DEFAULT_CHUNK_SIZE; offset < tar.size(); offset += DEFAULT_CHUNK_SIZE) {
+        auto data = chunk_at(offset);
+        cache.insert_chunk("shard.tar", offset, data, CacheZone::PREFETCH);
+        indexer.on_chunk("shard.tar", offset, data);
+    }
+    assert(!indexer.render("shard.tar").has_value());
+
+    auto head = chunk_at(0);
+    cache.insert_chunk("shard.tar", 0, head, CacheZone::HOT);
+    indexer.on_chunk("shard.tar", 0, head);
+
+    auto rendered = indexer.render("shard.tar");
+    assert(rendered.has_value());
+    assert(!indexer.next_chunk("shard.tar").has_value());
+    assert(indexer.get_stats().members_indexed.load() == 4);
+
+    auto members = indexer.members_in_range("shard.tar", 4 * 1024 * 1024, 1024);
+    assert(members.size() == 1);
+    assert(members[0].name == "big_1.bin");
+
+    std::cout << "test_indexer_catch_up: PASS\n";
+}
+
+void test_indexer_request() {
+    CacheManager cache(64 * 1024 * 1024);
+    TarIndexer indexer(cache);
+
+    TarBuilder builder;
+    builder.add("a.jpg", 1000);
+    std::string tar = builder.finish();
+    std::vector<char> data(tar.begin(), tar.end());
+
+    indexer.request("notes.txt");
+    assert(!indexer.requested("notes.txt"));
+
+    // Requested until the index completes
+    indexer.request("shard.tar");
+    assert(indexer.requested("shard.tar"));
+    indexer.on_chunk("shard.tar", 0, data);
+    assert(indexer.render("shard.tar").has_value());
+    assert(!indexer.requested("shard.tar"));
+    assert(indexer.rendered_size("shard.tar") == indexer.render("shard.tar")->size());
+    bool indexed = indexer.wait_indexed("shard.tar", std::chrono::milliseconds(0));
+    assert(indexed);
+    indexed = indexer.wait_indexed("other.tar", std::chrono::milliseconds(10));
+    assert(!indexed);
+
+    // Already complete: nothing to fetch
+    indexer.request("shard.tar");
+    assert(!indexer.requested("shard.tar"));
+
+    std::cout << "test_indexer_request: PASS\n";
+}
+
+int main() {
+    test_parse_members();
+    test_incremental_chunks();
+    test_invalid_archive();
+    test_indexer_catch_up();
+    test_indexer_request();
+    std::cout << "All TarIndex tests passed!\n";
+    return 0;
+}
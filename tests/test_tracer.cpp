@@ -0,0 +1,175 @@
+#include "../src/tracer.hpp"
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+
+using namespace valkyrie;
+
+static std::string temp_path(const char* name) {
+    return "/tmp/" + std::string(name) + "_" + std::to_string(getpid()) + ".trace";
+}
+
+void test_round_trip() {
+    std::string path = temp_path("test_round_trip");
+    {
+        Tracer tracer(path);
+        bool started = tracer.start();
+        assert(started);
+
+        // Several producers, each with its own ring
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&tracer, t]() {
+                std::string key = "shard_" + std::to_string(t) + ".bin";
+                for (int i = 0; i < 1000; ++i) {
+                    tracer.record(TraceEventType::READ, key, i * 4096, 4096, 12,
+                                  std::nullopt, i % 2 == 0);
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+
+        tracer.record(TraceEventType::DOWNLOAD, "shard_0.bin", 8 << 20, 4 << 20, 35000,
+                      Priority::BACKGROUND);
+        tracer.stop();
+
+        assert(tracer.get_stats().events_written.load() == 4001);
+        assert(tracer.get_stats().events_dropped.load() == 0);
+    }
+
+    std::vector<std::string> names;
+    std::vector<TraceEvent> events;
+    assert(Tracer::read_file(path, names, events));
+    assert(names.size() == 4);
+    assert(events.size() == 4001);
+
+    size_t hits = 0;
+    for (const auto& event : events) {
+        assert(event.file_id < names.size());
+        if (event.type == TraceEventType::READ && event.hit()) hits++;
+    }
+    assert(hits == 2000);
+
+    const auto& download = events.back();
+    assert(download.type == TraceEventType::DOWNLOAD);
+    assert(names[download.file_id] == "shard_0.bin");
+    assert(download.offset == (8u << 20) && download.size == (4u << 20));
+    assert(download.latency_us == 35000);
+    assert(download.priority() == Priority::BACKGROUND);
+    assert(!download.hit());
+
+    unlink(path.c_str());
+    std::cout << "test_round_trip: PASS\n";
+}
+
+void test_ring_full_drops() {
+    // Not started: nothing drains, so the ring fills and later events drop
+    Tracer tracer(temp_path("test_ring_full"), 16);
+    for (int i = 0; i < 20; ++i) {
+        tracer.record(TraceEventType::OPEN, "a", 0, 0);
+    }
+
+    assert(tracer.get_stats().events_recorded.load() == 16);
+    assert(tracer.get_stats().events_dropped.load() == 4);
+    std::cout << "test_ring_full_drops: PASS\n";
+}
+
+void test_exited_threads_free_rings() {
+    constexpr int THREADS = 50;
+    std::string path = temp_path("test_exited_threads");
+    {
+        Tracer tracer(path);
+        bool started = tracer.start();
+        assert(started);
+
+        // Short-lived threads, one after another (e.g. a loader's worker pool restarting)
+        for (int i = 0; i < THREADS; ++i) {
+            std::thread([&tracer, i] {
+                tracer.record(TraceEventType::OPEN, "shard_" + std::to_string(i), 0, 0);
+            }).join();
+        }
+        assert(tracer.get_num_rings() <= THREADS);
+
+        tracer.stop();
+        assert(tracer.get_num_rings() == 0);
+        assert(tracer.get_stats().events_written.load() == THREADS);
+    }
+
+    std::vector<std::string> names;
+    std::vector<TraceEvent> events;
+    assert(Tracer::read_file(path, names, events));
+    assert(events.size() == THREADS && names.size() == THREADS);
+
+    unlink(path.c_str());
+    std::cout << "test_exited_threads_free_rings: PASS\n";
+}
+
+void test_chrome_json() {
+    std::string path = temp_path("test_chrome_json");
+    {
+        Tracer tracer(path);
+        bool started = tracer.start();
+        assert(started);
+        tracer.record(TraceEventType::OPEN, "dir/\"quoted\".bin", 0, 0);
+        tracer.record(TraceEventType::MISS, "dir/\"quoted\".bin", 0, 4096, 800, Priority::URGENT);
+        tracer.stop();
+    }
+
+    std::ostringstream json;
+    bool written = Tracer::write_chrome_json(path, json);
+    assert(written);
+    std::string text = json.str();
+
+    assert(text.find("\"traceEvents\":[") != std::string::npos);
+    assert(text.find("\"name\":\"open\"") != std::string::npos);
+    assert(text.find("\"ph\":\"i\"") != std::string::npos);
+    assert(text.find("\"name\":\"miss\"") != std::string::npos);
+    assert(text.find("\"dur\":800") != std::string::npos);
+    assert(text.find("\"priority\":\"urgent\"") != std::string::npos);
+    assert(text.find("dir/\\\"quoted\\\".bin") != std::string::npos);
+
+    std::ostringstream bad;
+    written = Tracer::write_chrome_json("/nonexistent/trace", bad);
+    assert(!written);
+
+    unlink(path.c_str());
+    std::cout << "test_chrome_json: PASS\n";
+}
+
+void test_record_overhead() {
+    std::string path = temp_path("test_overhead");
+    Tracer tracer(path, 1 << 16);
+    bool started = tracer.start();
+    assert(started);
+
+    constexpr int N = 50000;  // Fits the ring: every call does the full write
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < N; ++i) {
+        tracer.record(TraceEventType::READ, "shard_000.bin", i * 131072ULL, 131072, 5,
+                      std::nullopt, true);
+    }
+    double ns = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - start).count() / N;
+    tracer.stop();
+    assert(tracer.get_stats().events_dropped.load() == 0);
+
+    // A 128KB FUSE read takes tens of microseconds; 1% of that is ~1us
+    std::cout << "  record(): " << ns << " ns/event\n";
+    assert(ns < 1000);
+
+    unlink(path.c_str());
+    std::cout << "test_record_overhead: PASS\n";
+}
+
+int main() {
+    test_round_trip();
+    test_ring_full_drops();
+    test_exited_threads_free_rings();
+    test_chrome_json();
+    test_record_overhead();
+    std::cout << "All Tracer tests passed!\n";
+    return 0;
+}
@@ -10,6 +10,19 @@ void test_parse_size() {
     assert(parse_size("1M") == 1024 * 1024);
     assert(parse_size("1G") == 1024ULL * 1024 * 1024);
     assert(parse_size("16G") == 16ULL * 1024 * 1024 * 1024);
+
+    // Strict variant: fractions and T, nothing else
+    size_t bytes = 0;
+    bool parsed = parse_size("1.5K", bytes);
+    assert(parsed && bytes == 1536);
+    parsed = parse_size("2T", bytes);
+    assert(parsed && bytes == 2ULL * 1024 * 1024 * 1024 * 1024);
+    parsed = parse_size("64MB", bytes);
+    assert(!parsed);
+    parsed = parse_size("0", bytes);
+    assert(!parsed);
+    parsed = parse_size("", bytes);
+    assert(!parsed);
     std::cout << "test_parse_size: PASS\n";
 }
 
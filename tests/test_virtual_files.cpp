@@ -0,0 +1,174 @@
+#include "../src/virtual_files.hpp"
+#include <aws/core/Aws.h>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <thread>
+
+using namespace valkyrie;
+
+struct Fixture {
+    CacheManager cache{64 * 1024 * 1024};
+    S3Config config{"test", "us-east-1", ""};
+    S3WorkerPool pool{config, cache, 2};
+    Predictor predictor{cache, pool, 3};
+    ReadStats read_stats;
+    std::map<std::string, size_t> sizes{
+        {"a.bin", 2 * DEFAULT_CHUNK_SIZE + 100},
+        {"b.bin", DEFAULT_CHUNK_SIZE},
+    };
+    VirtualFiles files{cache, pool, predictor, read_stats,
+                       [this](const std::string& key) -> std::optional<size_t> {
+                           auto it = sizes.find(key);
+                           if (it == sizes.end()) return std::nullopt;
+                           return it->second;
+                       }};
+
+    Fixture() {
+        pool.set_range_fetcher([this](const std::string& key, size_t offset, size_t size,
+                                      std::vector<char>& data) {
+            size_t total = sizes.at(key);
+            data.assign(offset < total ? std::min(size, total - offset) : 0, 'x');
+            return true;
+        });
+        pool.start();
+    }
+
+    ~Fixture() { pool.shutdown(); }
+
+    // Background downloads finish asynchronously
+    void wait_for_bytes(size_t bytes) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (cache.get_size() < bytes) {
+            assert(std::chrono::steady_clock::now() < deadline);
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }
+};
+
+void test_lookup() {
+    assert(VirtualFiles::lookup(".valkyrie") == VirtualFiles::Node::DIR);
+    assert(VirtualFiles::lookup(".valkyrie/stats.json") == VirtualFiles::Node::STATS);
+    assert(VirtualFiles::lookup(".valkyrie/cache_map") == VirtualFiles::Node::CACHE_MAP);
+    assert(VirtualFiles::lookup(".valkyrie/control") == VirtualFiles::Node::CONTROL);
+    assert(VirtualFiles::lookup(".valkyrie/other") == VirtualFiles::Node::NONE);
+    assert(VirtualFiles::lookup(".valkyrie_data/stats.json") == VirtualFiles::Node::NONE);
+    assert(VirtualFiles::lookup("data/stats.json") == VirtualFiles::Node::NONE);
+    assert(VirtualFiles::entries().size() == 3);
+
+    std::cout << "test_lookup: PASS\n";
+}
+
+void test_stats_json() {
+    Fixture f;
+    f.read_stats.hit_latency_us.record(100);
+    f.read_stats.miss_latency_us.record(30000);
+    f.read_stats.bytes_read += 8192;
+
+    f.read_stats.stalls.record(7, "odd\"key\n.bin", 4096, 30000, 29000, true);
+
+    std::string json = f.files.render(VirtualFiles::Node::STATS);
+
+    // Balanced braces, one object
+    int depth = 0;
+    for (char c : json) {
+        if (c == '{') ++depth;
+        if (c == '}') --depth;
+        assert(depth >= 0);
+    }
+    assert(depth == 0 && json.front() == '{');
+
+    assert(json.find("\"capacity_bytes\": 67108864") != std::string::npos);
+    assert(json.find("\"workers\": {\"count\": 2") != std::string::npos);
+    assert(json.find("\"bytes\": 8192") != std::string::npos);
+    assert(json.find("\"hit_latency_us\": {\"count\": 1") != std::string::npos);
+    assert(json.find("\"background\": {\"count\": 0") != std::string::npos);
+    assert(json.find("\"sequential\": {\"inserted\": 0") != std::string::npos);
+    assert(json.find("{\"pid\": 7, \"reads\": 1, \"misses\": 1, \"bytes\": 4096, "
+                     "\"read_time_us\": 30000, \"stall_time_us\": 29000") != std::string::npos);
+    assert(json.find("{\"key\": \"odd\\\"key\\u000a.bin\"") != std::string::npos);
+
+    std::cout << "test_stats_json: PASS\n";
+}
+
+void test_control_commands() {
+    Fixture f;
+
+    std::string response = f.files.execute("prefetch-file a.bin");
+    assert(response == "OK prefetching a.bin (3 of 3 chunks queued)");
+    f.wait_for_bytes(f.sizes["a.bin"]);
+    assert(f.cache.get_num_chunks() == 3);
+
+    // Cached chunks are not fetched again
+    response = f.files.execute("prefetch-file a.bin");
+    assert(response == "OK prefetching a.bin (0 of 3 chunks queued)");
+
+    response = f.files.execute("pin b.bin");
+    assert(response == "OK pinned b.bin (1 of 1 chunks queued)");
+    f.wait_for_bytes(f.sizes["a.bin"] + f.sizes["b.bin"]);
+
+    std::string map = f.files.render(VirtualFiles::Node::CACHE_MAP);
+    assert(map.find("PREFETCH - 3 " + std::to_string(f.sizes["a.bin"]) + " " +
+                    std::to_string(f.sizes["a.bin"]) + " 100.0 a.bin\n") != std::string::npos);
+    assert(map.find("PREFETCH pinned 1 ") != std::string::npos);
+
+    response = f.files.execute("drop-caches");
+    assert(response == "OK dropped 1 files");
+    assert(!f.cache.contains("a.bin") && f.cache.contains("b.bin"));
+
+    response = f.files.execute("unpin b.bin");
+    assert(response == "OK unpinned b.bin");
+    response = f.files.execute("evict b.bin");
+    assert(response == "OK evicted b.bin");
+    response = f.files.execute("evict b.bin");
+    assert(response == "ERR not cached: b.bin");
+    response = f.files.execute("pin missing.bin");
+    assert(response == "ERR unknown file: missing.bin");
+
+    // Pins may reserve at most half the cache
+    f.sizes["huge.bin"] = f.cache.get_max_size();
+    response = f.files.execute("pin huge.bin");
+    assert(response == "ERR pinned files would exceed 50% of the cache: huge.bin");
+    assert(!f.cache.is_pinned("huge.bin"));
+    response = f.files.execute("prefetch-file");
+    assert(response == "ERR usage: prefetch-file KEY");
+    response = f.files.execute("frobnicate");
+    assert(response == "ERR unknown command: frobnicate");
+
+    std::cout << "test_control_commands: PASS\n";
+}
+
+void test_control_writes() {
+    Fixture f;
+
+    // One write may carry several lines; reading control returns the responses
+    bool accepted = f.files.write_control("drop-caches\n\nunpin a.bin\n");
+    assert(!accepted);
+    assert(f.files.render(VirtualFiles::Node::CONTROL) ==
+           "OK dropped 0 files\nERR not pinned: a.bin\n");
+
+    accepted = f.files.write_control("drop-caches");
+    assert(accepted);
+    assert(f.files.last_responses() == "OK dropped 0 files\n");
+
+    accepted = f.files.write_control(std::string(128 * 1024, 'x'));
+    assert(!accepted);
+    assert(f.files.last_responses() == "ERR command too long\n");
+
+    std::cout << "test_control_writes: PASS\n";
+}
+
+int main() {
+    Aws::SDKOptions sdk_options;
+    Aws::InitAPI(sdk_options);
+
+    test_lookup();
+    test_stats_json();
+    test_control_commands();
+    test_control_writes();
+    std::cout << "All VirtualFiles tests passed!\n";
+
+    Aws::ShutdownAPI(sdk_options);
+    return 0;
+}
@@ -0,0 +1,390 @@
+// Microbenchmarks for the structures on the read path: CacheManager lookups,
+// inserts and eviction, the worker task queue, sequential-name prediction
+// and manifest lookup. Prints one JSON document, so runs from two commits
+// can be compared (see valkyrie-perf-check).
+#include "cache_manager.hpp"
+#include "thread_safe_queue.hpp"
+#include "predictor.hpp"
+#include "manifest.hpp"
+#include "shuffle.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace valkyrie;
+
+namespace {
+
+struct Settings {
+    bool quick = false;
+    double min_seconds = 0.3;  // Measured time per benchmark
+    std::string filter;
+};
+
+struct Result {
+    std::string name;
+    std::vector<std::pair<std::string, std::string>> params;
+    uint64_t ops = 0;
+    double seconds = 0;
+
+    // "cache.get_chunk/threads=4/fill=0.5": stable across runs, for comparisons
+    std::string id() const {
+        std::string text = name;
+        for (const auto& [key, value] : params) text += "/" + key + "=" + value;
+        return text;
+    }
+};
+
+std::string format(double value) {
+    std::ostringstream oss;
+    oss << value;
+    return oss.str();
+}
+
+// Run body(thread, stop) on `threads` threads for min_seconds after all are
+// ready; each returns the operations it completed
+template <typename Body>
+Result run_threads(const Settings& settings, int threads, Body body) {
+    std::atomic<int> ready{0};
+    std::atomic<bool> go{false};
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> ops{0};
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            ready++;
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            ops += body(t, stop);
+        });
+    }
+    while (ready.load() < threads) std::this_thread::yield();
+
+    auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    std::this_thread::sleep_for(std::chrono::duration<double>(settings.min_seconds));
+    stop.store(true, std::memory_order_release);
+    for (auto& worker : workers) worker.join();
+
+    Result result;
+    result.ops = ops.load();
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+bool stopped(const std::atomic<bool>& stop) {
+    return stop.load(std::memory_order_relaxed);
+}
+
+std::string chunk_key(size_t file) {
+    char key[48];
+    snprintf(key, sizeof(key), "bench/shard_%06zu.bin", file);
+    return key;
+}
+
+class Suite {
+public:
+    explicit Suite(const Settings& settings) : settings_(settings) {}
+
+    bool wanted(const std::string& name) const {
+        return settings_.filter.empty() || name.find(settings_.filter) != std::string::npos;
+    }
+
+    void add(Result result, const std::string& name,
+             std::vector<std::pair<std::string, std::string>> params) {
+        result.name = name;
+        result.params = std::move(params);
+        std::cerr << std::left << std::setw(60) << result.id() << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(12)
+                  << (result.ops == 0 ? 0.0 : result.seconds * 1e9 / result.ops) << " ns/op\n";
+        results_.push_back(std::move(result));
+    }
+
+    std::string to_json() const {
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(3);
+        oss << "{\n  \"quick\": " << (settings_.quick ? "true" : "false")
+            << ",\n  \"hardware_threads\": " << std::thread::hardware_concurrency()
+            << ",\n  \"benchmarks\": [";
+        for (size_t i = 0; i < results_.size(); ++i) {
+            const auto& r = results_[i];
+            double ns_per_op = r.ops == 0 ? 0.0 : r.seconds * 1e9 / r.ops;
+            double ops_per_sec = r.seconds == 0 ? 0.0 : r.ops / r.seconds;
+            oss << (i == 0 ? "\n" : ",\n") << "    {\"id\": \"" << r.id()
+                << "\", \"name\": \"" << r.name << "\", \"params\": {";
+            for (size_t p = 0; p < r.params.size(); ++p) {
+                oss << (p == 0 ? "" : ", ") << "\"" << r.params[p].first << "\": \""
+                    << r.params[p].second << "\"";
+            }
+            oss << "}, \"ops\": " << r.ops << ", \"seconds\": " << r.seconds
+                << ", \"ops_per_sec\": " << ops_per_sec << ", \"ns_per_op\": " << ns_per_op << "}";
+        }
+        oss << "\n  ]\n}\n";
+        return oss.str();
+    }
+
+private:
+    const Settings& settings_;
+    std::vector<Result> results_;
+};
+
+constexpr size_t CHUNKS_PER_FILE = 16;
+constexpr size_t CACHE_CHUNKS = 4096;
+
+// Cache holding `chunks` chunks of files of CHUNKS_PER_FILE
+void fill_cache(CacheManager& cache, size_t chunks, const std::vector<char>& data) {
+    for (size_t i = 0; i < chunks; ++i) {
+        cache.insert_chunk(chunk_key(i / CHUNKS_PER_FILE), (i % CHUNKS_PER_FILE) * data.size(),
+                           data, CacheZone::HOT);
+    }
+}
+
+void bench_cache_hot_path(Suite& suite, const Settings& settings) {
+    size_t chunk_bytes = settings.quick ? 16 * 1024 : 64 * 1024;
+    std::vector<char> data(chunk_bytes, 'x');
+    std::vector<int> thread_counts = settings.quick ? std::vector<int>{1, 4}
+                                                    : std::vector<int>{1, 2, 4, 8, 16, 32, 64};
+    std::vector<double> fills = settings.quick ? std::vector<double>{0.5}
+                                               : std::vector<double>{0.1, 0.5, 0.9};
+
+    for (double fill : fills) {
+        size_t filled = static_cast<size_t>(CACHE_CHUNKS * fill);
+
+        for (int threads : thread_counts) {
+            std::vector<std::pair<std::string, std::string>> params = {
+                {"threads", std::to_string(threads)}, {"fill", format(fill)},
+                {"chunk_bytes", std::to_string(chunk_bytes)}};
+
+            if (suite.wanted("cache.get_chunk")) {
+                CacheManager cache(CACHE_CHUNKS * chunk_bytes);
+                fill_cache(cache, filled, data);
+                auto result = run_threads(settings, threads, [&](int t, const std::atomic<bool>& stop) {
+                    Pcg32 rng(1, t);
+                    uint64_t ops = 0;
+                    while (!stopped(stop)) {
+                        size_t i = rng.bounded(static_cast<uint32_t>(filled));
+                        auto chunk = cache.get_chunk(chunk_key(i / CHUNKS_PER_FILE),
+                                                     (i % CHUNKS_PER_FILE) * chunk_bytes);
+                        ops += chunk.has_value();
+                    }
+                    return ops;
+                });
+                suite.add(result, "cache.get_chunk", params);
+            }
+
+            if (suite.wanted("cache.access")) {
+                CacheManager cache(CACHE_CHUNKS * chunk_bytes);
+                fill_cache(cache, filled, data);
+                auto result = run_threads(settings, threads, [&](int t, const std::atomic<bool>& stop) {
+                    Pcg32 rng(2, t);
+                    uint64_t ops = 0;
+                    for (; !stopped(stop); ++ops) {
+                        size_t i = rng.bounded(static_cast<uint32_t>(filled));
+                        cache.access(chunk_key(i / CHUNKS_PER_FILE), (i % CHUNKS_PER_FILE) * chunk_bytes);
+                    }
+                    return ops;
+                });
+                suite.add(result, "cache.access", params);
+            }
+
+            // New files on top of the fill: at high fill most inserts also evict
+            if (suite.wanted("cache.insert_chunk")) {
+                CacheManager cache(CACHE_CHUNKS * chunk_bytes);
+                fill_cache(cache, filled, data);
+                auto result = run_threads(settings, threads, [&](int t, const std::atomic<bool>& stop) {
+                    uint64_t ops = 0;
+                    for (; !stopped(stop); ++ops) {
+                        std::string key = "insert/" + std::to_string(t) + "/" +
+                                          std::to_string(ops / CHUNKS_PER_FILE);
+                        cache.insert_chunk(key, (ops % CHUNKS_PER_FILE) * chunk_bytes, data,
+                                           CacheZone::PREFETCH);
+                    }
+                    return ops;
+                });
+                suite.add(result, "cache.insert_chunk", params);
+            }
+        }
+    }
+}
+
+// Steady-state insert into a full cache, so every file inserted evicts one
+void bench_cache_eviction(Suite& suite, const Settings& settings) {
+    if (!suite.wanted("cache.evict")) return;
+
+    constexpr size_t CHUNK_BYTES = 64;
+    std::vector<char> data(CHUNK_BYTES, 'x');
+    std::vector<size_t> sizes = settings.quick ? std::vector<size_t>{10000, 100000}
+                                               : std::vector<size_t>{10000, 100000, 1000000};
+
+    for (size_t chunks : sizes) {
+        CacheManager cache(chunks * CHUNK_BYTES);
+        fill_cache(cache, chunks, data);
+        auto result = run_threads(settings, 1, [&](int, const std::atomic<bool>& stop) {
+            uint64_t ops = 0;
+            for (; !stopped(stop); ++ops) {
+                cache.insert_chunk(chunk_key(chunks / CHUNKS_PER_FILE + 1 + ops / CHUNKS_PER_FILE),
+                                   (ops % CHUNKS_PER_FILE) * CHUNK_BYTES, data, CacheZone::HOT);
+            }
+            return ops;
+        });
+        suite.add(result, "cache.evict", {{"chunks", std::to_string(chunks)}});
+    }
+}
+
+void bench_queue(Suite& suite, const Settings& settings) {
+    // Uncontended: one thread pushes a batch, then drains it
+    if (suite.wanted("queue.push_pop")) {
+        ThreadSafeQueue<uint64_t> queue;
+        auto result = run_threads(settings, 1, [&](int, const std::atomic<bool>& stop) {
+            constexpr uint64_t BATCH = 256;
+            uint64_t ops = 0;
+            while (!stopped(stop)) {
+                for (uint64_t i = 0; i < BATCH; ++i) {
+                    queue.push(i, static_cast<Priority>(i % NUM_PRIORITIES));
+                }
+                for (uint64_t i = 0; i < BATCH; ++i) {
+                    ops += queue.try_pop().has_value();
+                }
+            }
+            return ops;
+        });
+        suite.add(result, "queue.push_pop", {{"threads", "1"}});
+    }
+
+    // Producers and consumers on separate threads, as submit() and the workers are
+    std::vector<int> pairs = settings.quick ? std::vector<int>{1, 4} : std::vector<int>{1, 4, 16};
+    for (int n : pairs) {
+        if (!suite.wanted("queue.mpmc")) break;
+
+        ThreadSafeQueue<uint64_t> queue;
+        std::atomic<uint64_t> popped{0};
+        std::vector<std::thread> consumers;
+        for (int c = 0; c < n; ++c) {
+            consumers.emplace_back([&] {
+                while (queue.pop().has_value()) popped++;
+            });
+        }
+        auto result = run_threads(settings, n, [&](int t, const std::atomic<bool>& stop) {
+            uint64_t ops = 0;
+            for (; !stopped(stop); ++ops) {
+                queue.push(ops, static_cast<Priority>((ops + t) % NUM_PRIORITIES));
+            }
+            return ops;
+        });
+        queue.shutdown();
+        for (auto& consumer : consumers) consumer.join();
+        result.ops = popped.load();  // Delivered, not just queued
+        suite.add(result, "queue.mpmc", {{"producers", std::to_string(n)},
+                                         {"consumers", std::to_string(n)}});
+    }
+}
+
+void bench_predictor(Suite& suite, const Settings& settings) {
+    if (suite.wanted("predictor.predict_next_sequential")) {
+        const std::vector<std::string> names = {
+            "train/shard_000123.tar", "data-00042-of-01024.parquet",
+            "images/batch_7.bin", "model.ckpt", "2024/05/part-00017.tfrecord",
+        };
+        auto result = run_threads(settings, 1, [&](int, const std::atomic<bool>& stop) {
+            uint64_t ops = 0;
+            for (; !stopped(stop); ++ops) {
+                auto next = Predictor::predict_next_sequential(names[ops % names.size()]);
+                (void) next;
+            }
+            return ops;
+        });
+        suite.add(result, "predictor.predict_next_sequential", {});
+    }
+
+    if (suite.wanted("manifest.find")) {
+        std::vector<size_t> sizes = settings.quick ? std::vector<size_t>{10000, 100000}
+                                                   : std::vector<size_t>{10000, 100000, 1000000};
+        for (size_t entries : sizes) {
+            std::vector<std::string> keys;
+            keys.reserve(entries);
+            for (size_t i = 0; i < entries; ++i) keys.push_back(chunk_key(i));
+            Manifest manifest;
+            manifest.assign(keys, std::nullopt);
+
+            auto result = run_threads(settings, 1, [&](int, const std::atomic<bool>& stop) {
+                Pcg32 rng(3, 0);
+                uint64_t ops = 0;
+                for (; !stopped(stop); ++ops) {
+                    auto position = manifest.find(keys[rng.bounded(static_cast<uint32_t>(entries))]);
+                    (void) position;
+                }
+                return ops;
+            });
+            suite.add(result, "manifest.find", {{"entries", std::to_string(entries)}});
+        }
+    }
+}
+
+void print_usage(const char* program_name) {
+    std::cout << "Usage: " << program_name << " [OPTIONS]\n\n"
+              << "  --quick                 Fewer thread counts and sizes (CI)\n"
+              << "  --min-time SECONDS      Measured time per benchmark (default: 0.3)\n"
+              << "  --filter TEXT           Only benchmarks whose name contains TEXT\n"
+              << "  --output PATH           Write JSON here instead of stdout\n";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    Settings settings;
+    std::string output_path;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            print_usage(argv[0]);
+            return 0;
+        }
+        if (arg == "--quick") {
+            settings.quick = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Error: " << arg << " requires an argument\n";
+            return 1;
+        }
+        std::string value = argv[++i];
+        try {
+            if (arg == "--min-time") settings.min_seconds = std::stod(value);
+            else if (arg == "--filter") settings.filter = value;
+            else if (arg == "--output") output_path = value;
+            else {
+                std::cerr << "Error: Unknown option: " << arg << "\n";
+                return 1;
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Error: Invalid value for " << arg << "\n";
+            return 1;
+        }
+    }
+
+    Suite suite(settings);
+    bench_cache_hot_path(suite, settings);
+    bench_cache_eviction(suite, settings);
+    bench_queue(suite, settings);
+    bench_predictor(suite, settings);
+
+    if (output_path.empty()) {
+        std::cout << suite.to_json();
+    } else {
+        std::ofstream out(output_path);
+        out << suite.to_json();
+        if (!out) {
+            std::cerr << "Error: Cannot write " << output_path << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
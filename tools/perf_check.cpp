@@ -0,0 +1,270 @@
+// Performance regression gate: runs valkyrie-microbench and valkyrie-bench
+// (mock object store) several times, summarises every tracked metric as a
+// median with a confidence interval, and compares it with a checked-in
+// baseline. Exits non-zero, with a table of what regressed and by how much,
+// when a metric is reliably worse than the tolerance allows. Tracked metrics
+// with no baseline are listed and warned about, but not gated. Baselines are
+// machine-specific and none is checked in: a missing one, or one recorded
+// with fewer than MIN_BASELINE_RUNS runs, is a setup error.
+#include "perf_compare.hpp"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+using namespace valkyrie;
+
+// Fewest runs for which summarize() gives an interval narrower than min-max
+static constexpr int MIN_BASELINE_RUNS = 6;
+
+static void print_usage(const char* program_name) {
+    std::cout << "Usage: " << program_name << " --baseline PATH [OPTIONS]\n\n"
+              << "  --baseline PATH         Baseline JSON to compare with (or write, with --update)\n"
+              << "  --micro PATH            valkyrie-microbench binary (omit to skip)\n"
+              << "  --bench PATH            valkyrie-bench binary (omit to skip)\n"
+              << "  --patterns LIST         End-to-end loader patterns (default: sequential,shuffled)\n"
+              << "  --repeat N              Runs of each benchmark (default: 6, the fewest\n"
+              << "                          that give a 95% interval narrower than min-max)\n"
+              << "  --tolerance F           Relative change treated as noise (default: 0.10)\n"
+              << "  --confidence F          Median confidence interval (default: 0.95)\n"
+              << "  --update                Write the measured medians as the new baseline\n"
+              << "  --output PATH           Also write this run's summary (baseline format)\n";
+}
+
+static std::vector<std::string> split_list(const std::string& text) {
+    std::vector<std::string> items;
+    std::istringstream iss(text);
+    std::string item;
+    while (std::getline(iss, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+static std::string shell_quote(const std::string& text) {
+    std::string quoted = "'";
+    for (char c : text) {
+        if (c == '\'') quoted += "'\\''";
+        else quoted += c;
+    }
+    return quoted + "'";
+}
+
+static std::string read_file(const std::string& path) {
+    std::ifstream file(path);
+    return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+// Run `command`, then flatten the JSON it wrote to `output` into `numbers`
+static bool run_benchmark(const std::string& command, const std::string& output,
+                          std::map<std::string, double>& numbers) {
+    std::cerr << "perf-check: " << command << "\n";
+    int status = std::system(command.c_str());
+    if (status == -1 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        std::cerr << "Error: benchmark failed (status " << status << ")\n";
+        return false;
+    }
+    if (!flatten_json_numbers(read_file(output), numbers)) {
+        std::cerr << "Error: benchmark wrote invalid JSON to " << output << "\n";
+        return false;
+    }
+    unlink(output.c_str());
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    std::string baseline_path, micro, bench, output_path;
+    std::vector<std::string> patterns = {"sequential", "shuffled"};
+    int repeat = 6;
+    double tolerance = 0.10;
+    double confidence = 0.95;
+    bool update = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            print_usage(argv[0]);
+            return 0;
+        }
+        if (arg == "--update") {
+            update = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Error: " << arg << " requires an argument\n";
+            return 1;
+        }
+        std::string value = argv[++i];
+
+        try {
+            if (arg == "--baseline") baseline_path = value;
+            else if (arg == "--micro") micro = value;
+            else if (arg == "--bench") bench = value;
+            else if (arg == "--patterns") patterns = split_list(value);
+            else if (arg == "--repeat") repeat = std::stoi(value);
+            else if (arg == "--tolerance") tolerance = std::stod(value);
+            else if (arg == "--confidence") confidence = std::stod(value);
+            else if (arg == "--output") output_path = value;
+            else {
+                std::cerr << "Error: Unknown option: " << arg << "\n";
+                return 1;
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Error: Invalid value for " << arg << "\n";
+            return 1;
+        }
+    }
+
+    if (baseline_path.empty() || (micro.empty() && bench.empty()) || repeat < 1 ||
+        !(confidence > 0 && confidence < 1)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    // Metrics compared, and what counts as noise regardless of the ratio
+    const std::vector<MetricRule> rules = {
+        {".ns_per_op", false, 1.0},
+        {".throughput_bytes_per_sec", true, 0.0},
+        {".read_latency_us.p50", false, 50.0},
+        {".read_latency_us.p99", false, 200.0},
+        {".read_latency_us.p999", false, 500.0},
+        {".stall_ratio", false, 0.02},
+        {".cpu_sec_per_gb", false, 0.05},
+    };
+
+    if (repeat < MIN_BASELINE_RUNS) {
+        if (update) {
+            std::cerr << "Error: A baseline needs --repeat " << MIN_BASELINE_RUNS
+                      << " or more; with " << repeat << " runs every confidence interval"
+                      << " is the min-max range\n";
+            return 1;
+        }
+        std::cerr << "perf-check: WARNING, with " << repeat << " runs every confidence"
+                  << " interval is the min-max range\n";
+    }
+
+    // Checked before benchmarking: without a usable baseline nothing is gated
+    std::map<std::string, MetricSummary> baseline;
+    if (!update) {
+        std::string baseline_json = read_file(baseline_path);
+        if (baseline_json.empty()) {
+            std::cerr << "Error: No baseline at " << baseline_path << ". Record one with"
+                      << " `make perf-baseline` on the machine that runs the gate, and commit it\n";
+            return 1;
+        }
+        if (!parse_baseline_json(baseline_json, baseline)) {
+            std::cerr << "Error: Cannot parse baseline " << baseline_path << "\n";
+            return 1;
+        }
+        for (const auto& [metric, summary] : baseline) {
+            if (summary.samples < static_cast<size_t>(MIN_BASELINE_RUNS)) {
+                std::cerr << "Error: Baseline metric " << metric << " has " << summary.samples
+                          << " samples; re-record " << baseline_path << " with at least "
+                          << MIN_BASELINE_RUNS << " runs (`make perf-baseline`)\n";
+                return 1;
+            }
+        }
+    }
+
+    char dir_template[] = "/tmp/valkyrie-perf-XXXXXX";
+    if (mkdtemp(dir_template) == nullptr) {
+        perror("mkdtemp");
+        return 1;
+    }
+    std::string dir = dir_template;
+    std::string output = dir + "/result.json";
+
+    // Runs are interleaved, so slow drift on the machine spreads over all metrics
+    std::map<std::string, std::vector<double>> samples;
+    for (int run = 0; run < repeat; ++run) {
+        std::map<std::string, double> numbers;
+
+        if (!micro.empty()) {
+            std::string command = shell_quote(micro) + " --quick --output " + shell_quote(output) +
+                                  " 2>/dev/null";
+            if (!run_benchmark(command, output, numbers)) return 1;
+            for (const auto& [path, value] : numbers) {
+                // "benchmarks.<id>.ns_per_op" -> "micro.<id>.ns_per_op"
+                if (path.compare(0, 11, "benchmarks.") == 0) {
+                    samples["micro." + path.substr(11)].push_back(value);
+                }
+            }
+        }
+
+        for (const auto& pattern : patterns) {
+            if (bench.empty()) break;
+            numbers.clear();
+            std::string command = shell_quote(bench) + " --pattern " + shell_quote(pattern) +
+                                  " --processes 4 --files 32 --file-size 16M --latency-ms 10"
+                                  " --mount " + shell_quote(dir + "/mnt") +
+                                  " --log " + shell_quote(dir + "/valkyrie.log") +
+                                  " --output " + shell_quote(output);
+            if (!run_benchmark(command, output, numbers)) {
+                std::cerr << "See " << dir << "/valkyrie.log\n";
+                return 1;
+            }
+            for (const auto& [path, value] : numbers) {
+                samples["e2e." + pattern + "." + path].push_back(value);
+            }
+        }
+    }
+    unlink((dir + "/valkyrie.log").c_str());
+    rmdir((dir + "/mnt").c_str());
+    rmdir(dir.c_str());
+
+    std::map<std::string, MetricSummary> current;
+    for (const auto& [metric, values] : samples) {
+        if (find_rule(rules, metric) != nullptr) {
+            current[metric] = summarize(values, confidence);
+        }
+    }
+
+    if (!output_path.empty()) {
+        std::ofstream(output_path) << to_baseline_json(current);
+    }
+
+    if (update) {
+        std::ofstream out(baseline_path);
+        out << to_baseline_json(current);
+        if (!out) {
+            std::cerr << "Error: Cannot write " << baseline_path << "\n";
+            return 1;
+        }
+        std::cout << "Baseline written: " << baseline_path << " (" << current.size()
+                  << " metrics, " << repeat << " runs)\n";
+        return 0;
+    }
+
+    auto comparisons = compare(baseline, current, rules, tolerance);
+    std::cout << format_report(comparisons);
+
+    size_t regressed = 0, unbaselined = 0, missing = 0;
+    for (const auto& c : comparisons) {
+        regressed += c.verdict == Comparison::Verdict::REGRESSED;
+        unbaselined += c.verdict == Comparison::Verdict::NEW;
+        missing += c.verdict == Comparison::Verdict::MISSING;
+    }
+    if (missing > 0) {
+        std::cout << "\nperf-check: WARNING, " << missing
+                  << " baseline metrics were not measured by this run\n";
+    }
+    if (unbaselined > 0) {
+        // Not gated: nothing to compare with until a baseline is recorded
+        std::cout << "\nperf-check: WARNING, " << unbaselined << " tracked metrics have no"
+                  << " baseline in " << baseline_path << " and are NOT gated. Record them with"
+                  << " `make perf-baseline` on the machine that runs the gate, and commit it.\n";
+    }
+    if (regressed > 0) {
+        std::cout << "\nperf-check: FAIL, " << regressed << " of "
+                  << comparisons.size() - unbaselined << " gated metrics regressed by more than "
+                  << tolerance * 100 << "% with non-overlapping " << confidence * 100
+                  << "% intervals\n";
+        return 1;
+    }
+    std::cout << "\nperf-check: PASS (" << comparisons.size() - unbaselined << " gated metrics)\n";
+    return 0;
+}
@@ -0,0 +1,30 @@
+// Convert a Valkyrie-FS binary trace (--enable-tracing) to Chrome trace-event
+// JSON, viewable in chrome://tracing or ui.perfetto.dev.
+#include "tracer.hpp"
+#include <fstream>
+#include <iostream>
+
+using namespace valkyrie;
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "Usage: " << argv[0] << " TRACE [OUTPUT.json]\n";
+        return 1;
+    }
+
+    std::ofstream file;
+    if (argc == 3) {
+        file.open(argv[2]);
+        if (!file.is_open()) {
+            std::cerr << "Error: Cannot write " << argv[2] << "\n";
+            return 1;
+        }
+    }
+    std::ostream& out = argc == 3 ? file : std::cout;
+
+    if (!Tracer::write_chrome_json(argv[1], out)) {
+        std::cerr << "Error: Not a valid trace: " << argv[1] << "\n";
+        return 1;
+    }
+    return 0;
+}
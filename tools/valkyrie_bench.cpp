@@ -0,0 +1,384 @@
+// End-to-end benchmark: mounts Valkyrie-FS over its mock object store
+// (--mock-s3, injected latency and bandwidth), drives it with forked loader
+// processes replaying a training access pattern, and prints one JSON object
+// with throughput, read latency percentiles, stall ratio and CPU per GB.
+// Needs FUSE (allow_other: run as root or set user_allow_other), no S3.
+#include "loader_sim.hpp"
+#include "types.hpp"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+using namespace valkyrie;
+
+static void print_usage(const char* program_name) {
+    std::cout << "Usage: " << program_name << " [OPTIONS] [-- VALKYRIE_OPTIONS]\n\n"
+              << "Loader:\n"
+              << "  --pattern NAME          sequential, shuffled, ddp or random (default: sequential)\n"
+              << "  --processes N           Loader processes (default: 4)\n"
+              << "  --epochs N              Passes over the dataset (default: 1)\n"
+              << "  --read-size SIZE        Bytes per read (default: 1M, random: 16K)\n"
+              << "  --random-reads N        Reads per process per epoch for random (default: 2000)\n"
+              << "  --compute-ms-per-mb MS  Simulated training time per MiB read (default: 0)\n"
+              << "  --keep-page-cache       Let later epochs hit the kernel page cache\n"
+              << "  --seed N                Shuffle/offset seed (default: 1)\n\n"
+              << "Dataset (mock object store):\n"
+              << "  --files N               Objects (default: 64)\n"
+              << "  --file-size SIZE        Object size (default: 64M)\n"
+              << "  --latency-ms MS         Median time to first byte (default: 30)\n"
+              << "  --bandwidth SIZE        Aggregate bytes/s (default: 1G)\n\n"
+              << "Valkyrie-FS:\n"
+              << "  --valkyrie PATH         Binary (default: next to this one)\n"
+              << "  --mount PATH            Mount point (default: /tmp/valkyrie-bench-mnt)\n"
+              << "  --cache-size SIZE       (default: 2G)\n"
+              << "  --workers N             (default: 8)\n"
+              << "  --lookahead N           (default: 3)\n"
+              << "  --metrics-port PORT     (default: 19090)\n"
+              << "  --log PATH              Valkyrie output (default: valkyrie-bench.log)\n\n"
+              << "  --output PATH           Write the JSON result here instead of stdout\n";
+}
+
+// utime + stime of `pid` in seconds (Linux /proc); negative if unavailable
+static double process_cpu_seconds(pid_t pid) {
+    std::ifstream file("/proc/" + std::to_string(pid) + "/stat");
+    std::string stat((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    size_t paren = stat.rfind(')');
+    if (paren == std::string::npos) return -1.0;
+
+    // Fields after "pid (comm)" start at 3 (state); utime and stime are 14 and 15
+    std::istringstream iss(stat.substr(paren + 1));
+    std::string field;
+    unsigned long long utime = 0, stime = 0;
+    for (int index = 3; index <= 15 && iss >> field; ++index) {
+        if (index == 14) utime = std::stoull(field);
+        if (index == 15) stime = std::stoull(field);
+    }
+    return static_cast<double>(utime + stime) / sysconf(_SC_CLK_TCK);
+}
+
+// Number following "field": after `section` in a stats.json document
+static double json_number(const std::string& json, const std::string& section,
+                          const std::string& field) {
+    size_t at = json.find("\"" + section + "\"");
+    if (at == std::string::npos) return -1.0;
+    at = json.find("\"" + field + "\": ", at);
+    if (at == std::string::npos) return -1.0;
+    try {
+        return std::stod(json.substr(at + field.size() + 4));
+    } catch (const std::exception&) {
+        return -1.0;
+    }
+}
+
+static std::string read_file(const std::string& path) {
+    std::ifstream file(path);
+    return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+// Poll until /.valkyrie/stats.json appears; false if valkyrie exited or timed out
+static bool wait_for_mount(const std::string& mount, pid_t valkyrie_pid) {
+    std::string probe = mount + "/.valkyrie/stats.json";
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while (std::chrono::steady_clock::now() < deadline) {
+        struct stat st;
+        if (stat(probe.c_str(), &st) == 0) return true;
+        int status;
+        if (waitpid(valkyrie_pid, &status, WNOHANG) == valkyrie_pid) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    return false;
+}
+
+static void unmount(const std::string& mount, pid_t valkyrie_pid) {
+#ifdef __APPLE__
+    std::string command = "umount '" + mount + "'";
+#else
+    std::string command = "fusermount3 -u '" + mount + "' 2>/dev/null || fusermount -u '" +
+                          mount + "' 2>/dev/null || umount '" + mount + "'";
+#endif
+    if (std::system(command.c_str()) != 0) {
+        std::cerr << "Warning: unmount failed, stopping valkyrie\n";
+        kill(valkyrie_pid, SIGTERM);
+    }
+
+    // Valkyrie exits once the mount is gone
+    for (int i = 0; i < 100; ++i) {
+        int status;
+        if (waitpid(valkyrie_pid, &status, WNOHANG) == valkyrie_pid) return;
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    kill(valkyrie_pid, SIGKILL);
+    waitpid(valkyrie_pid, nullptr, 0);
+}
+
+int main(int argc, char* argv[]) {
+    LoaderOptions options;
+    bool read_size_set = false;
+    uint64_t compute_us_per_mb = 0;
+    bool keep_page_cache = false;
+    size_t num_files = 64;
+    size_t file_size = 64 * 1024 * 1024;
+    std::string latency_ms = "30";
+    std::string bandwidth = "1G";
+    std::string cache_size = "2G";
+    std::string workers = "8";
+    std::string lookahead = "3";
+    std::string metrics_port = "19090";
+    std::string mount = "/tmp/valkyrie-bench-mnt";
+    std::string log_path = "valkyrie-bench.log";
+    std::string output_path;
+    std::vector<std::string> extra_args;
+
+    std::string program = argv[0];
+    size_t slash = program.rfind('/');
+    std::string valkyrie = slash == std::string::npos ? "valkyrie"
+                                                      : program.substr(0, slash + 1) + "valkyrie";
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            print_usage(argv[0]);
+            return 0;
+        }
+        if (arg == "--") {
+            extra_args.assign(argv + i + 1, argv + argc);
+            break;
+        }
+        if (arg == "--keep-page-cache") {
+            keep_page_cache = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Error: " << arg << " requires an argument\n";
+            return 1;
+        }
+        std::string value = argv[++i];
+
+        bool ok = true;
+        try {
+            if (arg == "--pattern") {
+                auto pattern = parse_load_pattern(value);
+                ok = pattern.has_value();
+                if (ok) options.pattern = *pattern;
+            }
+            else if (arg == "--processes") options.processes = std::stoi(value);
+            else if (arg == "--epochs") options.epochs = std::stoi(value);
+            else if (arg == "--read-size") ok = read_size_set = parse_size(value, options.read_size);
+            else if (arg == "--random-reads") options.random_reads = std::stoul(value);
+            else if (arg == "--compute-ms-per-mb") compute_us_per_mb = static_cast<uint64_t>(std::stod(value) * 1000);
+            else if (arg == "--seed") options.seed = std::stoull(value);
+            else if (arg == "--files") num_files = std::stoul(value);
+            else if (arg == "--file-size") ok = parse_size(value, file_size);
+            else if (arg == "--latency-ms") latency_ms = value;
+            else if (arg == "--bandwidth") bandwidth = value;
+            else if (arg == "--valkyrie") valkyrie = value;
+            else if (arg == "--mount") mount = value;
+            else if (arg == "--cache-size") cache_size = value;
+            else if (arg == "--workers") workers = value;
+            else if (arg == "--lookahead") lookahead = value;
+            else if (arg == "--metrics-port") metrics_port = value;
+            else if (arg == "--log") log_path = value;
+            else if (arg == "--output") output_path = value;
+            else {
+                std::cerr << "Error: Unknown option: " << arg << "\n";
+                return 1;
+            }
+        } catch (const std::exception&) {
+            ok = false;
+        }
+        if (!ok) {
+            std::cerr << "Error: Invalid value for " << arg << "\n";
+            return 1;
+        }
+    }
+
+    if (options.processes < 1 || options.epochs < 1 || num_files == 0) {
+        std::cerr << "Error: --processes, --epochs and --files must be at least 1\n";
+        return 1;
+    }
+    if (options.pattern == LoadPattern::RANDOM && !read_size_set) {
+        options.read_size = 16 * 1024;
+    }
+
+    mkdir(mount.c_str(), 0755);
+
+    // Mount over the mock store, output to the log
+    std::vector<std::string> valkyrie_args = {
+        valkyrie, "--mount", mount,
+        "--mock-s3", std::to_string(num_files) + "x" + std::to_string(file_size),
+        "--mock-latency-ms", latency_ms, "--mock-bandwidth", bandwidth,
+        "--cache-size", cache_size, "--workers", workers, "--lookahead", lookahead,
+        "--metrics-port", metrics_port,
+    };
+    valkyrie_args.insert(valkyrie_args.end(), extra_args.begin(), extra_args.end());
+
+    pid_t valkyrie_pid = fork();
+    if (valkyrie_pid < 0) {
+        perror("fork");
+        return 1;
+    }
+    if (valkyrie_pid == 0) {
+        int log_fd = open(log_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (log_fd >= 0) {
+            dup2(log_fd, STDOUT_FILENO);
+            dup2(log_fd, STDERR_FILENO);
+            close(log_fd);
+        }
+        std::vector<char*> exec_argv;
+        for (auto& arg : valkyrie_args) exec_argv.push_back(arg.data());
+        exec_argv.push_back(nullptr);
+        execvp(exec_argv[0], exec_argv.data());
+        perror("execvp");
+        _exit(127);
+    }
+
+    if (!wait_for_mount(mount, valkyrie_pid)) {
+        std::cerr << "Error: Valkyrie-FS did not mount " << mount << " (see " << log_path << ")\n";
+        kill(valkyrie_pid, SIGTERM);
+        waitpid(valkyrie_pid, nullptr, 0);
+        return 1;
+    }
+
+    // The dataset as the mount lists it (hidden entries such as .valkyrie skipped)
+    std::vector<std::string> files;
+    if (DIR* dir = opendir(mount.c_str())) {
+        while (struct dirent* entry = readdir(dir)) {
+            if (entry->d_name[0] != '.') files.push_back(entry->d_name);
+        }
+        closedir(dir);
+    }
+    std::sort(files.begin(), files.end());
+    std::vector<size_t> file_sizes;
+    for (const auto& name : files) {
+        struct stat st;
+        file_sizes.push_back(stat((mount + "/" + name).c_str(), &st) == 0 ? st.st_size : 0);
+    }
+
+    std::cerr << "Benchmark: " << to_string(options.pattern) << ", " << options.processes
+              << " processes, " << files.size() << " files, " << options.epochs << " epochs\n";
+
+    double cpu_before = process_cpu_seconds(valkyrie_pid);
+    auto start = std::chrono::steady_clock::now();
+
+    // One forked loader per rank; each reports its LoaderResult through a pipe
+    std::vector<std::pair<pid_t, int>> loaders;
+    for (int rank = 0; rank < options.processes; ++rank) {
+        int fds[2];
+        if (pipe(fds) != 0) {
+            perror("pipe");
+            break;
+        }
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(fds[0]);
+            LoaderResult result;
+            run_loader(mount, files, plan_loader_reads(options, file_sizes, rank),
+                       compute_us_per_mb, keep_page_cache, result);
+            ssize_t written = write(fds[1], &result, sizeof(result));
+            _exit(written == static_cast<ssize_t>(sizeof(result)) ? 0 : 1);
+        }
+        close(fds[1]);
+        if (pid < 0) {
+            perror("fork");
+            close(fds[0]);
+            break;
+        }
+        loaders.emplace_back(pid, fds[0]);
+    }
+
+    LoaderResult total;
+    bool loaders_ok = static_cast<int>(loaders.size()) == options.processes;
+    for (auto& [pid, fd] : loaders) {
+        LoaderResult result;
+        size_t received = 0;
+        while (received < sizeof(result)) {
+            ssize_t n = read(fd, reinterpret_cast<char*>(&result) + received,
+                             sizeof(result) - received);
+            if (n <= 0) break;
+            received += n;
+        }
+        close(fd);
+        int status = 0;
+        waitpid(pid, &status, 0);
+        if (received == sizeof(result)) {
+            total.merge(result);
+        } else {
+            loaders_ok = false;
+        }
+    }
+
+    double elapsed_sec = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    double cpu_after = process_cpu_seconds(valkyrie_pid);
+    std::string stats = read_file(mount + "/.valkyrie/stats.json");
+
+    unmount(mount, valkyrie_pid);
+
+    double gigabytes = total.bytes / (1024.0 * 1024 * 1024);
+    double cpu_sec = cpu_before >= 0 && cpu_after >= 0 ? cpu_after - cpu_before : -1.0;
+
+    std::ostringstream json;
+    json << std::fixed << std::setprecision(3);
+    json << "{\n"
+         << "  \"pattern\": \"" << to_string(options.pattern) << "\",\n"
+         << "  \"processes\": " << options.processes << ",\n"
+         << "  \"epochs\": " << options.epochs << ",\n"
+         << "  \"files\": " << files.size() << ",\n"
+         << "  \"file_size_bytes\": " << file_size << ",\n"
+         << "  \"read_size_bytes\": " << options.read_size << ",\n"
+         << "  \"backend\": {\"latency_ms\": " << latency_ms
+         << ", \"bandwidth\": \"" << bandwidth << "\"},\n"
+         << "  \"reads\": " << total.reads << ",\n"
+         << "  \"errors\": " << total.errors << ",\n"
+         << "  \"bytes\": " << total.bytes << ",\n"
+         << "  \"elapsed_sec\": " << elapsed_sec << ",\n"
+         << "  \"throughput_bytes_per_sec\": "
+         << (elapsed_sec > 0 ? total.bytes / elapsed_sec : 0.0) << ",\n"
+         << "  \"read_latency_us\": {\"p50\": " << total.latency_percentile(50)
+         << ", \"p99\": " << total.latency_percentile(99)
+         << ", \"p999\": " << total.latency_percentile(99.9)
+         << ", \"max\": " << total.max_latency_us << "},\n"
+         << "  \"stall_ratio\": " << json_number(stats, "stalls", "stall_ratio") << ",\n"
+         << "  \"loader_io_fraction\": " << total.io_fraction(options.processes) << ",\n"
+         << "  \"s3_downloaded_bytes\": "
+         << static_cast<uint64_t>(std::max(0.0, json_number(stats, "workers", "downloaded_bytes")))
+         << ",\n";
+    if (cpu_sec >= 0) {
+        json << "  \"valkyrie_cpu_sec\": " << cpu_sec << ",\n"
+             << "  \"cpu_sec_per_gb\": " << (gigabytes > 0 ? cpu_sec / gigabytes : 0.0) << "\n";
+    } else {
+        json << "  \"valkyrie_cpu_sec\": null,\n"
+             << "  \"cpu_sec_per_gb\": null\n";
+    }
+    json << "}\n";
+
+    if (output_path.empty()) {
+        std::cout << json.str();
+    } else {
+        std::ofstream out(output_path);
+        out << json.str();
+        if (!out) {
+            std::cerr << "Error: Cannot write " << output_path << "\n";
+            return 1;
+        }
+    }
+
+    std::cerr << "Benchmark: " << std::setprecision(1) << std::fixed
+              << total.bytes / (1024.0 * 1024) / std::max(elapsed_sec, 1e-9) << " MB/s, p99 "
+              << total.latency_percentile(99) / 1000.0 << " ms, " << total.errors << " errors\n";
+
+    return loaders_ok && total.errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,185 @@
+// Offline cache/prefetch simulator: replays an access trace through the real
+// CacheManager, S3WorkerPool and Predictor against a simulated S3 backend,
+// sweeping cache sizes, prefetch policies and lookahead values.
+#include "simulator.hpp"
+#include <aws/core/Aws.h>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+using namespace valkyrie;
+
+static void print_usage(const char* program_name) {
+    std::cout << "Usage: " << program_name << " --trace PATH [OPTIONS]\n\n"
+              << "Trace:\n"
+              << "  --trace PATH            Binary trace (--enable-tracing) or key list\n"
+              << "                          (--access-history format)\n"
+              << "  --file-size SIZE        Object size for key lists (default: 64M)\n"
+              << "  --read-size SIZE        Read size for key lists (default: 1M)\n"
+              << "  --read-rate SIZE        Reader bytes/s for key lists (default: 200M)\n\n"
+              << "Sweep (comma-separated lists):\n"
+              << "  --cache-sizes LIST      Cache sizes (default: 1G)\n"
+              << "  --policies LIST         none, fixed, adaptive (default: none,fixed,adaptive)\n"
+              << "  --lookaheads LIST       Lookahead values (default: 3)\n\n"
+              << "Simulated S3:\n"
+              << "  --workers N             Worker threads (default: 8)\n"
+              << "  --latency-ms MS         Median time to first byte (default: 30)\n"
+              << "  --latency-sigma S       Log-normal latency spread (default: 0.5)\n"
+              << "  --bandwidth SIZE        Aggregate bytes/s (default: 1G)\n"
+              << "  --speed X               Run X times faster than real time (default: 1)\n"
+              << "  --seed N                Latency RNG seed (default: 1)\n\n"
+              << "  --csv PATH              Also write results as CSV\n";
+}
+
+static std::vector<std::string> split_list(const std::string& text) {
+    std::vector<std::string> items;
+    std::istringstream iss(text);
+    std::string item;
+    while (std::getline(iss, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+int main(int argc, char* argv[]) {
+    std::string trace_path, csv_path;
+    size_t file_size = 64 * 1024 * 1024;
+    size_t read_size = 1024 * 1024;
+    size_t read_rate = 200 * 1024 * 1024;
+    std::vector<std::string> cache_sizes = {"1G"};
+    std::vector<std::string> policies = {"none", "fixed", "adaptive"};
+    std::vector<std::string> lookaheads = {"3"};
+    SimConfig base;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            print_usage(argv[0]);
+            return 0;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Error: " << arg << " requires an argument\n";
+            return 1;
+        }
+        std::string value = argv[++i];
+
+        bool ok = true;
+        try {
+            if (arg == "--trace") trace_path = value;
+            else if (arg == "--csv") csv_path = value;
+            else if (arg == "--file-size") ok = parse_size(value, file_size);
+            else if (arg == "--read-size") ok = parse_size(value, read_size);
+            else if (arg == "--read-rate") ok = parse_size(value, read_rate);
+            else if (arg == "--cache-sizes") cache_sizes = split_list(value);
+            else if (arg == "--policies") policies = split_list(value);
+            else if (arg == "--lookaheads") lookaheads = split_list(value);
+            else if (arg == "--workers") base.workers = std::stoi(value);
+            else if (arg == "--latency-ms") base.backend.latency_ms = std::stod(value);
+            else if (arg == "--latency-sigma") base.backend.latency_sigma = std::stod(value);
+            else if (arg == "--speed") base.backend.time_scale = std::stod(value);
+            else if (arg == "--seed") base.backend.seed = std::stoull(value);
+            else if (arg == "--bandwidth") {
+                size_t bandwidth;
+                ok = parse_size(value, bandwidth);
+                base.backend.bandwidth = static_cast<double>(bandwidth);
+            } else {
+                std::cerr << "Error: Unknown option: " << arg << "\n";
+                return 1;
+            }
+        } catch (const std::exception&) {
+            ok = false;
+        }
+        if (!ok) {
+            std::cerr << "Error: Invalid value for " << arg << "\n";
+            return 1;
+        }
+    }
+
+    if (trace_path.empty()) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    ReplayTrace trace;
+    if (!trace.load_binary(trace_path) &&
+        !trace.load_key_list(trace_path, file_size, read_size, static_cast<double>(read_rate))) {
+        std::cerr << "Error: Cannot load trace: " << trace_path << "\n";
+        return 1;
+    }
+    std::cout << "Replaying " << trace.ops.size() << " ops over "
+              << trace.object_sizes.size() << " objects\n\n";
+
+    std::ofstream csv;
+    if (!csv_path.empty()) {
+        csv.open(csv_path);
+        if (!csv.is_open()) {
+            std::cerr << "Error: Cannot write " << csv_path << "\n";
+            return 1;
+        }
+        csv << "cache_size,policy,lookahead,hit_rate,stall_ms,stall_ratio,elapsed_ms,"
+               "bytes_read,bytes_fetched,wasted_prefetch_bytes\n";
+    }
+
+    // The worker pool constructs an (unused) S3 client
+    Aws::SDKOptions sdk_options;
+    Aws::InitAPI(sdk_options);
+
+    std::cout << std::left << std::setw(10) << "cache" << std::setw(10) << "policy"
+              << std::setw(6) << "look" << std::setw(9) << "hit%" << std::setw(12) << "stall_ms"
+              << std::setw(8) << "stall%" << std::setw(12) << "fetched_MB"
+              << "wasted_MB\n";
+
+    Simulator simulator(trace);
+    int status = 0;
+
+    for (const auto& cache_size : cache_sizes) {
+        for (const auto& policy : policies) {
+            for (const auto& lookahead : lookaheads) {
+                SimConfig config = base;
+                config.policy = policy;
+                try {
+                    config.lookahead = std::stoi(lookahead);
+                } catch (const std::exception&) {
+                    config.lookahead = -1;
+                }
+                if (!parse_size(cache_size, config.cache_size)) {
+                    std::cerr << "Error: Invalid cache size: " << cache_size << "\n";
+                    status = 1;
+                    continue;
+                }
+
+                // Component start/stop chatter would bury the table
+                SimResult result;
+                auto* saved = std::cout.rdbuf(nullptr);
+                bool ok = simulator.run(config, result);
+                std::cout.rdbuf(saved);
+                std::cout.clear();
+                if (!ok) {
+                    status = 1;
+                    continue;
+                }
+
+                std::cout << std::left << std::setw(10) << cache_size << std::setw(10) << policy
+                          << std::setw(6) << config.lookahead
+                          << std::setw(9) << std::fixed << std::setprecision(1)
+                          << result.hit_rate() * 100
+                          << std::setw(12) << result.stall_us / 1000
+                          << std::setw(8) << result.stall_ratio() * 100
+                          << std::setw(12) << result.bytes_fetched / (1024 * 1024)
+                          << result.wasted_prefetch_bytes / (1024 * 1024) << "\n";
+
+                if (csv.is_open()) {
+                    csv << config.cache_size << "," << policy << "," << config.lookahead << ","
+                        << result.hit_rate() << "," << result.stall_us / 1000 << ","
+                        << result.stall_ratio() << "," << result.elapsed_us / 1000 << ","
+                        << result.bytes_read << "," << result.bytes_fetched << ","
+                        << result.wasted_prefetch_bytes << "\n";
+                }
+            }
+        }
+    }
+
+    Aws::ShutdownAPI(sdk_options);
+    return status;
+}